@@ -0,0 +1,27 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface NSData (SRGUserData)
+
+/**
+ *  Enumerate the immutable JSON objects stored in the receiver, one per line. Lines which cannot be parsed are reported
+ *  as `nil`.
+ */
+- (void)srguserdata_enumerateJSONLinesUsingBlock:(void (^)(id _Nullable JSONObject))block;
+
+/**
+ *  Return the JSON representation of the specified object as a single line, or `nil` if the object cannot be
+ *  represented as JSON.
+ */
++ (nullable NSData *)srguserdata_JSONLineWithObject:(id)object error:(NSError * __autoreleasing *)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,42 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "NSData+SRGUserData.h"
+
+@implementation NSData (SRGUserData)
+
+#pragma mark Class methods
+
++ (NSData *)srguserdata_JSONLineWithObject:(id)object error:(NSError * __autoreleasing *)error
+{
+    // The compact JSON representation never contains line breaks, which can therefore be used as separators.
+    NSMutableData *data = [[NSJSONSerialization dataWithJSONObject:object options:0 error:error] mutableCopy];
+    [data appendBytes:"\n" length:1];
+    return data.copy;
+}
+
+#pragma mark Public methods
+
+- (void)srguserdata_enumerateJSONLinesUsingBlock:(void (^)(id _Nullable))block
+{
+    const char *bytes = self.bytes;
+    NSUInteger location = 0;
+    while (location < self.length) {
+        const char *end = memchr(bytes + location, '\n', self.length - location);
+        NSUInteger length = end ? (NSUInteger)(end - (bytes + location)) : self.length - location;
+        
+        if (length != 0) {
+            @autoreleasepool {
+                NSData *lineData = [self subdataWithRange:NSMakeRange(location, length)];
+                block([NSJSONSerialization JSONObjectWithData:lineData options:0 error:NULL]);
+            }
+        }
+        
+        location += length + 1;
+    }
+}
+
+@end
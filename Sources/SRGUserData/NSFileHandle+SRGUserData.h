@@ -0,0 +1,24 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface NSFileHandle (SRGUserData)
+
+/**
+ *  Return a file handle to append JSON lines to the file at the specified URL, creating the file if needed. If the
+ *  file ends with a partial line (e.g. because the application was killed while a line was being written), the file
+ *  is truncated after its last complete line first, so that appended lines never get merged with it.
+ *
+ *  @discussion The returned file handle is positioned at the end of the file.
+ */
++ (nullable NSFileHandle *)srguserdata_fileHandleForAppendingJSONLinesAtURL:(NSURL *)fileURL;
+
+@end
+
+NS_ASSUME_NONNULL_END
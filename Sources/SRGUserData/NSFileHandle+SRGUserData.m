@@ -0,0 +1,58 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "NSFileHandle+SRGUserData.h"
+
+// Size of the chunks read backwards when looking for the last line separator.
+static const unsigned long long SRGUserDataFileHandleChunkLength = 4096;
+
+@implementation NSFileHandle (SRGUserData)
+
+#pragma mark Class methods
+
++ (NSFileHandle *)srguserdata_fileHandleForAppendingJSONLinesAtURL:(NSURL *)fileURL
+{
+    if (! [NSFileManager.defaultManager fileExistsAtPath:fileURL.path]) {
+        [NSFileManager.defaultManager createFileAtPath:fileURL.path contents:nil attributes:nil];
+    }
+    
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForUpdatingAtPath:fileURL.path];
+    if (! fileHandle) {
+        return nil;
+    }
+    
+    unsigned long long length = [fileHandle seekToEndOfFile];
+    unsigned long long completeLength = length;
+    
+    // Look for the last line separator, starting from the end of the file
+    while (completeLength > 0) {
+        unsigned long long chunkLength = MIN(completeLength, SRGUserDataFileHandleChunkLength);
+        [fileHandle seekToFileOffset:completeLength - chunkLength];
+        NSData *chunk = [fileHandle readDataOfLength:(NSUInteger)chunkLength];
+        if (chunk.length != chunkLength) {
+            [fileHandle closeFile];
+            return nil;
+        }
+        
+        const char *bytes = chunk.bytes;
+        NSUInteger index = chunk.length;
+        while (index > 0 && bytes[index - 1] != '\n') {
+            index--;
+        }
+        completeLength -= chunkLength - index;
+        if (index > 0) {
+            break;
+        }
+    }
+    
+    if (completeLength != length) {
+        [fileHandle truncateFileAtOffset:completeLength];
+    }
+    [fileHandle seekToEndOfFile];
+    return fileHandle;
+}
+
+@end
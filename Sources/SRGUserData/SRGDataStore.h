@@ -27,6 +27,11 @@ typedef void (^SRGDataStoreWriteCompletionBlock)(NSError * _Nullable error);
  *  enough so that the worker queue can move on to pending items fast. Tasks submitted to the main thread should also
  *  be lightweight enough to avoid blocking the user interface.
  *
+ *  By default background reads are processed by the same serial worker queue as writes, in submission order. If reads
+ *  should not have to wait for pending writes to be processed, the data store can be switched to reader / writer mode
+ *  (@see `maximumConcurrentBackgroundReadTaskCount`), in which case reads are performed concurrently while writes remain
+ *  serialized.
+ *
  *  Credits: The strategy implemented by this class was inspired by the following talk: https://vimeo.com/89370886.
  */
 @interface SRGDataStore : NSObject
@@ -41,6 +46,45 @@ typedef void (^SRGDataStoreWriteCompletionBlock)(NSError * _Nullable error);
  */
 @property (nonatomic, readonly) NSPersistentContainer *persistentContainer;
 
+/**
+ *  The maximum number of background reads which can be performed concurrently. Default value is 1, in which case
+ *  background reads and writes are processed by a single serial worker queue, in the order they were submitted (and
+ *  according to their priority).
+ *
+ *  For values greater than 1, the data store operates in reader / writer mode. Background reads are then performed
+ *  on a separate bounded queue, concurrently with each other and with the serial write queue. Each read sees the last
+ *  committed state of the store when it starts, but not changes from writes still pending or being executed. Priority
+ *  and cancellation still apply, though priorities of reads and writes are only compared within their own queue.
+ *
+ *  @discussion The underlying persistent store should be an SQLite store in WAL journaling mode (the default), with a
+ *              connection pool large enough to serve concurrent reads (@see `NSPersistentStoreConnectionPoolMaxSizeKey`).
+ *              Changing the value only affects tasks submitted afterwards.
+ */
+@property (nonatomic) NSInteger maximumConcurrentBackgroundReadTaskCount;
+
+/**
+ *  The maximum number of background contexts kept alive for reuse by background tasks. Default value is 4. Set to 0
+ *  to use a new context for each task.
+ *
+ *  @discussion Pooled contexts are reset between tasks, and their `userInfo` is emptied. Contexts from which a read
+ *              task returned managed objects are never reused, so that these objects remain valid.
+ */
+@property (nonatomic) NSUInteger backgroundManagedObjectContextPoolSize;
+
+/**
+ *  If set to `YES`, write tasks waiting in the serial queue are executed together and committed with a single save,
+ *  reducing per-write persistence overhead when many small writes are submitted in a row. Default value is `NO`.
+ *
+ *  @discussion Only writes pending right after the one being executed, in submission order and with the same priority,
+ *              are grouped, so that a write is never performed before a task submitted earlier. Each write is performed
+ *              in its own child context, and its completion block is called with its own result: a failing or cancelled
+ *              write is rollbacked without affecting other writes of the same group. If the final save fails, changes
+ *              made by each write of the group are saved again one by one, so that only failing writes receive an error.
+ *              Tasks are never performed twice. Batch requests are executed against the store outside the group, once
+ *              previous writes of the group have been saved.
+ */
+@property (nonatomic, getter=isGroupCommitEnabled) BOOL groupCommitEnabled;
+
 /**
  *  Perform a read operation on the main thread. The read should be efficient since slow operations might block the main
  *  thread while performed.
@@ -57,7 +101,8 @@ typedef void (^SRGDataStoreWriteCompletionBlock)(NSError * _Nullable error);
 - (nullable id)performMainThreadReadTask:(id _Nullable (NS_NOESCAPE ^)(NSManagedObjectContext *managedObjectContext))task;
 
 /**
- *  Enqueue a read operation on the serial queue, with a priority level. Pending tasks with higher priority will be moved
+ *  Enqueue a read operation on the serial queue (or on the concurrent read queue in reader / writer mode), with a
+ *  priority level. Pending tasks with higher priority will be moved
  *  to the front and executed first. The mandatory completion block will be called on completion.
  *
  *  @parameter task             The read task to be executed. The background context is provided, on which Core Data
@@ -10,18 +10,106 @@
 #import "SRGUserDataLogger.h"
 #import "SRGUserDataError.h"
 
+@import libextobjc;
+
+static const NSUInteger SRGDataStoreMaximumGroupCommitTaskCount = 100;
+
+static NSError *SRGDataStoreCancellationError(void)
+{
+    return [NSError errorWithDomain:SRGUserDataErrorDomain
+                               code:SRGUserDataErrorCancelled
+                           userInfo:@{ NSLocalizedDescriptionKey : SRGUserDataLocalizedString(@"The operation has been cancelled", @"Error message returned when an operation has been cancelled") }];
+}
+
+// Collections are searched recursively, since read tasks might return nested collections (e.g. arrays of objects by
+// uid)
+static BOOL SRGDataStoreResultContainsManagedObjects(id result)
+{
+    if ([result isKindOfClass:NSManagedObject.class]) {
+        return YES;
+    }
+    else if ([result isKindOfClass:NSDictionary.class]) {
+        return SRGDataStoreResultContainsManagedObjects([result allValues]);
+    }
+    else if ([result conformsToProtocol:@protocol(NSFastEnumeration)]) {
+        for (id object in result) {
+            if (SRGDataStoreResultContainsManagedObjects(object)) {
+                return YES;
+            }
+        }
+    }
+    return NO;
+}
+
+/**
+ *  Snapshot of the changes pending in a context, which can be applied again to another context. Objects are identified
+ *  by their permanent identifiers.
+ */
+@interface SRGDataStoreChanges : NSObject
+
+/**
+ *  Capture changes pending in the specified context. Must be called from the context queue.
+ */
+- (instancetype)initWithManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
+
+@property (nonatomic, readonly) NSArray<NSManagedObjectID *> *insertedObjectIDs;
+
+/**
+ *  Apply changes to the specified context. Objects inserted in the context are added to the provided map, which is
+ *  used to resolve objects inserted by previously applied changes. Must be called from the context queue.
+ */
+- (void)applyToManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+                    insertedObjects:(NSMutableDictionary<NSManagedObjectID *, NSManagedObject *> *)insertedObjects;
+
+@end
+
+/**
+ *  A write task performed as part of a group commit, with its result.
+ */
+@interface SRGDataStoreGroupTask : NSObject
+
+- (instancetype)initWithTask:(void (^)(NSManagedObjectContext *managedObjectContext))task completionBlock:(SRGDataStoreWriteCompletionBlock)completionBlock;
+
+@property (nonatomic, readonly, copy) void (^task)(NSManagedObjectContext *managedObjectContext);
+@property (nonatomic, readonly, copy) SRGDataStoreWriteCompletionBlock completionBlock;
+
+@property (nonatomic) SRGDataStoreChanges *changes;
+@property (nonatomic) NSError *error;
+
+@end
+
+/**
+ *  Child context in which a task of a group commit is performed. Batch requests operate on the store directly, thus
+ *  cannot be isolated in a child context nor rollbacked with the group. They are executed outside the group instead,
+ *  once changes of previous tasks in the group have been committed.
+ */
+@interface SRGDataStoreGroupTaskManagedObjectContext : NSManagedObjectContext
+
+@property (nonatomic, copy) void (^batchRequestBlock)(void);
+
+@end
+
 @interface SRGDataStore ()
 
 @property (nonatomic) NSPersistentContainer *persistentContainer;
 
 @property (nonatomic) NSOperationQueue *serialOperationQueue;
+@property (nonatomic) NSOperationQueue *readOperationQueue;
 @property (nonatomic) NSMapTable<NSString *, NSOperation *> *operations;
 
 @property (nonatomic) NSMapTable<NSString *, SRGDataStoreReadCompletionBlock> *readCompletionBlocks;
 @property (nonatomic) NSMapTable<NSString *, SRGDataStoreWriteCompletionBlock> *writeCompletionBlocks;
 
+@property (nonatomic) NSMapTable<NSString *, void (^)(NSManagedObjectContext *)> *writeTasks;
+@property (nonatomic) NSMutableOrderedSet<NSString *> *pendingHandles;
+
+@property (nonatomic) NSMutableArray<NSManagedObjectContext *> *readManagedObjectContexts;
+@property (nonatomic) NSManagedObjectContext *writeManagedObjectContext;
+
 @property (nonatomic) dispatch_queue_t concurrentQueue;
 
+@property (nonatomic, readonly, getter=isReaderWriterModeEnabled) BOOL readerWriterModeEnabled;
+
 @end
 
 @implementation SRGDataStore
@@ -45,20 +133,54 @@
         self.serialOperationQueue = [[NSOperationQueue alloc] init];
         self.serialOperationQueue.maxConcurrentOperationCount = 1;
         
+        self.readOperationQueue = [[NSOperationQueue alloc] init];
+        self.readOperationQueue.maxConcurrentOperationCount = 1;
+        
         self.operations = [NSMapTable strongToWeakObjectsMapTable];
         
         self.readCompletionBlocks = [NSMapTable strongToStrongObjectsMapTable];
         self.writeCompletionBlocks = [NSMapTable strongToStrongObjectsMapTable];
         
-        self.concurrentQueue = dispatch_queue_create("ch.srgssr.playsrg.SRGDataStore.concurrent", DISPATCH_QUEUE_CONCURRENT);
+        self.writeTasks = [NSMapTable strongToStrongObjectsMapTable];
+        self.pendingHandles = [NSMutableOrderedSet orderedSet];
+        
+        self.readManagedObjectContexts = [NSMutableArray array];
         
+        self.concurrentQueue = dispatch_queue_create("ch.srgssr.playsrg.SRGDataStore.concurrent", DISPATCH_QUEUE_CONCURRENT);
         
+        self.backgroundManagedObjectContextPoolSize = 4;
     }
     return self;
 }
 
 #pragma mark Getters and setters
 
+- (NSInteger)maximumConcurrentBackgroundReadTaskCount
+{
+    return self.readOperationQueue.maxConcurrentOperationCount;
+}
+
+- (void)setMaximumConcurrentBackgroundReadTaskCount:(NSInteger)maximumConcurrentBackgroundReadTaskCount
+{
+    self.readOperationQueue.maxConcurrentOperationCount = MAX(maximumConcurrentBackgroundReadTaskCount, 1);
+}
+
+- (void)setBackgroundManagedObjectContextPoolSize:(NSUInteger)backgroundManagedObjectContextPoolSize
+{
+    _backgroundManagedObjectContextPoolSize = backgroundManagedObjectContextPoolSize;
+    
+    dispatch_barrier_async(self.concurrentQueue, ^{
+        while (self.readManagedObjectContexts.count > backgroundManagedObjectContextPoolSize) {
+            [self.readManagedObjectContexts removeLastObject];
+        }
+    });
+}
+
+- (BOOL)isReaderWriterModeEnabled
+{
+    return self.readOperationQueue.maxConcurrentOperationCount > 1;
+}
+
 #pragma mark Task execution
 
 - (id)performMainThreadReadTask:(id (NS_NOESCAPE ^)(NSManagedObjectContext *managedObjectContext))task
@@ -77,8 +199,11 @@
 {
     NSString *handle = NSUUID.UUID.UUIDString;
     NSOperation *operation = [NSBlockOperation blockOperationWithBlock:^{
-        NSManagedObjectContext *managedObjectContext = self.persistentContainer.newBackgroundContext;
-        managedObjectContext.undoManager = nil;
+        dispatch_barrier_async(self.concurrentQueue, ^{
+            [self.pendingHandles removeObject:handle];
+        });
+        
+        NSManagedObjectContext *managedObjectContext = [self dequeueReadManagedObjectContext];
         
         __block id result = nil;
         
@@ -100,12 +225,12 @@
             completionBlock ? completionBlock(result, nil) : nil;
         }
         else {
-            NSError *error = [NSError errorWithDomain:SRGUserDataErrorDomain
-                                                 code:SRGUserDataErrorCancelled
-                                             userInfo:@{ NSLocalizedDescriptionKey : SRGUserDataLocalizedString(@"The operation has been cancelled", @"Error message returned when an operation has been cancelled") }];
+            NSError *error = SRGDataStoreCancellationError();
             completionBlock ? completionBlock(nil, error) : nil;
         }
         
+        [self recycleReadManagedObjectContext:managedObjectContext withResult:result];
+        
         dispatch_barrier_async(self.concurrentQueue, ^{
             [self.operations removeObjectForKey:handle];
             [self.readCompletionBlocks removeObjectForKey:handle];
@@ -113,10 +238,18 @@
     }];
     operation.queuePriority = priority;
     
+    // In reader / writer mode, reads are performed on their own bounded queue and therefore never wait for pending writes.
+    // Each read task uses a fresh or reset context, thus sees the last committed store state.
+    NSOperationQueue *operationQueue = self.readerWriterModeEnabled ? self.readOperationQueue : self.serialOperationQueue;
     dispatch_barrier_async(self.concurrentQueue, ^{
         [self.readCompletionBlocks setObject:completionBlock forKey:handle];
         [self.operations setObject:operation forKey:handle];
-        [self.serialOperationQueue addOperation:operation];
+        
+        // Reads waiting on the serial queue are tracked as well, so that group commits never move writes before them
+        if (operationQueue == self.serialOperationQueue) {
+            [self.pendingHandles addObject:handle];
+        }
+        [operationQueue addOperation:operation];
     });
     
     return handle;
@@ -128,64 +261,42 @@
 {
     NSString *handle = NSUUID.UUID.UUIDString;
     NSOperation *operation = [NSBlockOperation blockOperationWithBlock:^{
-        // If clients use the API as expected (i.e. do not perform changes in `-performMainThreadReadTask:`, which should
-        // be enforced during development), merging behavior setup is not really required for background contexts, as
-        // transactions can never be made in parallel. But if this happens for some reason, provide a meaningful
-        // setup (context is the reference).
-        NSManagedObjectContext *managedObjectContext = self.persistentContainer.newBackgroundContext;
-        managedObjectContext.automaticallyMergesChangesFromParent = YES;
-        managedObjectContext.mergePolicy = NSMergeByPropertyObjectTrumpMergePolicy;
-        managedObjectContext.undoManager = nil;
-        
-        [NSNotificationCenter.defaultCenter addObserver:self
-                                               selector:@selector(backgroundManagedObjectContextDidSave:)
-                                                   name:NSManagedObjectContextDidSaveNotification
-                                                 object:managedObjectContext];
-        
-        __block NSError *error = nil;
-        __block BOOL cancelled = NO;
-        
-        dispatch_sync(self.concurrentQueue, ^{
-            NSOperation *operation = [self.operations objectForKey:handle];
-            cancelled = operation.cancelled;
-        });
-        
-        [managedObjectContext performBlockAndWait:^{
-            task(managedObjectContext);
+        __block BOOL grouped = NO;
+        __block NSArray<NSString *> *groupedHandles = nil;
+        dispatch_barrier_sync(self.concurrentQueue, ^{
+            NSUInteger index = [self.pendingHandles indexOfObject:handle];
+            grouped = (index == NSNotFound);
+            if (grouped) {
+                return;
+            }
             
-            if (managedObjectContext.hasChanges) {
-                if (cancelled) {
-                    [managedObjectContext rollback];
-                }
-                else if (! [managedObjectContext save:&error]) {
-                    [managedObjectContext rollback];
-                }
+            [self.pendingHandles removeObjectAtIndex:index];
+            [self.writeTasks removeObjectForKey:handle];
+            
+            if (self.groupCommitEnabled) {
+                NSOperation *operation = [self.operations objectForKey:handle];
+                groupedHandles = [self drainGroupableWriteHandlesFromIndex:index withPriority:operation.queuePriority];
             }
-        }];
+        });
         
-        if (! cancelled) {
-            completionBlock ? completionBlock(error) : nil;
+        // The task has already been executed as part of a group commit.
+        if (grouped) {
+            return;
+        }
+        
+        if (groupedHandles.count != 0) {
+            [self performGroupCommitWithTask:task handle:handle groupedHandles:groupedHandles completionBlock:completionBlock];
         }
         else {
-            NSError *error = [NSError errorWithDomain:SRGUserDataErrorDomain
-                                                 code:SRGUserDataErrorCancelled
-                                             userInfo:@{ NSLocalizedDescriptionKey : SRGUserDataLocalizedString(@"The operation has been cancelled", @"Error message returned when an operation has been cancelled") }];
-            completionBlock ? completionBlock(error) : nil;
+            [self performWriteTask:task withHandle:handle completionBlock:completionBlock];
         }
-        
-        [NSNotificationCenter.defaultCenter removeObserver:self
-                                                      name:NSManagedObjectContextDidSaveNotification
-                                                    object:managedObjectContext];
-        
-        dispatch_barrier_async(self.concurrentQueue, ^{
-            [self.operations removeObjectForKey:handle];
-            [self.writeCompletionBlocks removeObjectForKey:handle];
-        });
     }];
     operation.queuePriority = priority;
     
     dispatch_barrier_async(self.concurrentQueue, ^{
+        [self.writeTasks setObject:task forKey:handle];
         [self.writeCompletionBlocks setObject:completionBlock forKey:handle];
+        [self.pendingHandles addObject:handle];
         [self.operations setObject:operation forKey:handle];
         [self.serialOperationQueue addOperation:operation];
     });
@@ -202,9 +313,10 @@
         [operation cancel];
         
         if (! operation.executing) {
-            NSError *error = [NSError errorWithDomain:SRGUserDataErrorDomain
-                                                 code:SRGUserDataErrorCancelled
-                                             userInfo:@{ NSLocalizedDescriptionKey : SRGUserDataLocalizedString(@"The operation has been cancelled", @"Error message returned when an operation has been cancelled") }];
+            [self.pendingHandles removeObject:handle];
+            [self.writeTasks removeObjectForKey:handle];
+            
+            NSError *error = SRGDataStoreCancellationError();
             SRGDataStoreReadCompletionBlock readCompletionBlock = [self.readCompletionBlocks objectForKey:handle];
             if (readCompletionBlock) {
                 readCompletionBlock(nil, error);
@@ -230,6 +342,298 @@
     }
 }
 
+#pragma mark Context pool
+
+// Contexts are long-lived and reset between tasks, so that each task starts from the last committed store state while
+// setup costs are only paid once.
+
+- (NSManagedObjectContext *)dequeueReadManagedObjectContext
+{
+    __block NSManagedObjectContext *managedObjectContext = nil;
+    dispatch_barrier_sync(self.concurrentQueue, ^{
+        managedObjectContext = self.readManagedObjectContexts.lastObject;
+        [self.readManagedObjectContexts removeLastObject];
+    });
+    
+    if (! managedObjectContext) {
+        managedObjectContext = self.persistentContainer.newBackgroundContext;
+        managedObjectContext.undoManager = nil;
+    }
+    return managedObjectContext;
+}
+
+- (void)recycleReadManagedObjectContext:(NSManagedObjectContext *)managedObjectContext withResult:(id)result
+{
+    // Objects returned by a read task must remain usable after the task completes. A reset would turn them into
+    // invalid faults, so their context is simply discarded instead.
+    if (self.backgroundManagedObjectContextPoolSize == 0 || SRGDataStoreResultContainsManagedObjects(result)) {
+        return;
+    }
+    
+    // State attached by the task through the context `userInfo` must not leak into the next task either
+    [managedObjectContext performBlockAndWait:^{
+        [managedObjectContext reset];
+        [managedObjectContext.userInfo removeAllObjects];
+    }];
+    
+    dispatch_barrier_async(self.concurrentQueue, ^{
+        if (self.readManagedObjectContexts.count < self.backgroundManagedObjectContextPoolSize) {
+            [self.readManagedObjectContexts addObject:managedObjectContext];
+        }
+    });
+}
+
+// Writes are serialized, a single context is therefore enough. It is only accessed from the serial queue.
+- (NSManagedObjectContext *)dequeueWriteManagedObjectContext
+{
+    if (self.writeManagedObjectContext) {
+        return self.writeManagedObjectContext;
+    }
+    
+    // If clients use the API as expected (i.e. do not perform changes in `-performMainThreadReadTask:`, which should
+    // be enforced during development), merging behavior setup is not really required for background contexts, as
+    // transactions can never be made in parallel. But if this happens for some reason, provide a meaningful
+    // setup (context is the reference).
+    NSManagedObjectContext *managedObjectContext = self.persistentContainer.newBackgroundContext;
+    managedObjectContext.automaticallyMergesChangesFromParent = YES;
+    managedObjectContext.mergePolicy = NSMergeByPropertyObjectTrumpMergePolicy;
+    managedObjectContext.undoManager = nil;
+    
+    [NSNotificationCenter.defaultCenter addObserver:self
+                                           selector:@selector(backgroundManagedObjectContextDidSave:)
+                                               name:NSManagedObjectContextDidSaveNotification
+                                             object:managedObjectContext];
+    
+    if (self.backgroundManagedObjectContextPoolSize != 0) {
+        self.writeManagedObjectContext = managedObjectContext;
+    }
+    return managedObjectContext;
+}
+
+- (void)recycleWriteManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    if (self.backgroundManagedObjectContextPoolSize != 0 && managedObjectContext == self.writeManagedObjectContext) {
+        [managedObjectContext performBlockAndWait:^{
+            [managedObjectContext reset];
+        }];
+    }
+    else {
+        [NSNotificationCenter.defaultCenter removeObserver:self
+                                                      name:NSManagedObjectContextDidSaveNotification
+                                                    object:managedObjectContext];
+        if (managedObjectContext == self.writeManagedObjectContext) {
+            self.writeManagedObjectContext = nil;
+        }
+    }
+}
+
+#pragma mark Write execution
+
+- (void)performWriteTask:(void (^)(NSManagedObjectContext *managedObjectContext))task
+              withHandle:(NSString *)handle
+         completionBlock:(SRGDataStoreWriteCompletionBlock)completionBlock
+{
+    NSManagedObjectContext *managedObjectContext = [self dequeueWriteManagedObjectContext];
+    
+    __block NSError *error = nil;
+    __block BOOL cancelled = NO;
+    
+    dispatch_sync(self.concurrentQueue, ^{
+        NSOperation *operation = [self.operations objectForKey:handle];
+        cancelled = operation.cancelled;
+    });
+    
+    [managedObjectContext performBlockAndWait:^{
+        task(managedObjectContext);
+        
+        if (managedObjectContext.hasChanges) {
+            if (cancelled) {
+                [managedObjectContext rollback];
+            }
+            else if (! [managedObjectContext save:&error]) {
+                [managedObjectContext rollback];
+            }
+        }
+    }];
+    
+    if (! cancelled) {
+        completionBlock ? completionBlock(error) : nil;
+    }
+    else {
+        completionBlock ? completionBlock(SRGDataStoreCancellationError()) : nil;
+    }
+    
+    [self recycleWriteManagedObjectContext:managedObjectContext];
+    
+    dispatch_barrier_async(self.concurrentQueue, ^{
+        [self.operations removeObjectForKey:handle];
+        [self.writeCompletionBlocks removeObjectForKey:handle];
+    });
+}
+
+// Must be called within a barrier on the concurrent queue. Return the handles of the write tasks pending right after the
+// specified position, in submission order, and with the same priority. Draining stops at the first task which cannot be
+// grouped (e.g. a read), so that a write is never performed before a task submitted earlier.
+- (NSArray<NSString *> *)drainGroupableWriteHandlesFromIndex:(NSUInteger)index withPriority:(NSOperationQueuePriority)priority
+{
+    NSMutableArray<NSString *> *handles = [NSMutableArray array];
+    for (NSUInteger i = index; i < self.pendingHandles.count; ++i) {
+        if (handles.count == SRGDataStoreMaximumGroupCommitTaskCount - 1) {
+            break;
+        }
+        
+        NSString *pendingHandle = self.pendingHandles[i];
+        NSOperation *pendingOperation = [self.operations objectForKey:pendingHandle];
+        if (! [self.writeTasks objectForKey:pendingHandle] || ! pendingOperation || pendingOperation.queuePriority != priority) {
+            break;
+        }
+        [handles addObject:pendingHandle];
+    }
+    [self.pendingHandles removeObjectsInArray:handles];
+    return handles.copy;
+}
+
+- (void)performGroupCommitWithTask:(void (^)(NSManagedObjectContext *managedObjectContext))task
+                            handle:(NSString *)handle
+                    groupedHandles:(NSArray<NSString *> *)groupedHandles
+                   completionBlock:(SRGDataStoreWriteCompletionBlock)completionBlock
+{
+    NSManagedObjectContext *managedObjectContext = [self dequeueWriteManagedObjectContext];
+    
+    NSMutableArray<SRGDataStoreGroupTask *> *groupTasks = [NSMutableArray array];
+    __block NSUInteger uncommittedTaskIndex = 0;
+    
+    // Each task is performed in its own child context, so that a cancelled or failing task can be rollbacked without
+    // affecting other tasks in the group. Successful changes are pushed to the group context and saved at once.
+    void (^performGroupTask)(SRGDataStoreGroupTask *, BOOL) = ^(SRGDataStoreGroupTask *groupTask, BOOL cancelled) {
+        SRGDataStoreGroupTaskManagedObjectContext *childManagedObjectContext = [[SRGDataStoreGroupTaskManagedObjectContext alloc] initWithConcurrencyType:NSPrivateQueueConcurrencyType];
+        childManagedObjectContext.parentContext = managedObjectContext;
+        childManagedObjectContext.mergePolicy = NSMergeByPropertyObjectTrumpMergePolicy;
+        childManagedObjectContext.undoManager = nil;
+        
+        NSUInteger taskIndex = groupTasks.count;
+        [groupTasks addObject:groupTask];
+        
+        childManagedObjectContext.batchRequestBlock = ^{
+            NSArray<SRGDataStoreGroupTask *> *uncommittedTasks = [groupTasks subarrayWithRange:NSMakeRange(uncommittedTaskIndex, taskIndex - uncommittedTaskIndex)];
+            [self commitGroupTasks:uncommittedTasks inManagedObjectContext:managedObjectContext];
+            uncommittedTaskIndex = taskIndex;
+        };
+        
+        __block NSError *error = nil;
+        [childManagedObjectContext performBlockAndWait:^{
+            groupTask.task(childManagedObjectContext);
+            
+            if (childManagedObjectContext.hasChanges) {
+                if (cancelled) {
+                    [childManagedObjectContext rollback];
+                    return;
+                }
+                
+                // Keep changes so that they can be saved on their own if the group save fails
+                SRGDataStoreChanges *changes = [[SRGDataStoreChanges alloc] initWithManagedObjectContext:childManagedObjectContext];
+                if ([childManagedObjectContext save:&error]) {
+                    groupTask.changes = changes;
+                }
+                else {
+                    [childManagedObjectContext rollback];
+                }
+            }
+        }];
+        groupTask.error = cancelled ? SRGDataStoreCancellationError() : error;
+    };
+    
+    __block BOOL cancelled = NO;
+    dispatch_sync(self.concurrentQueue, ^{
+        NSOperation *operation = [self.operations objectForKey:handle];
+        cancelled = operation.cancelled;
+    });
+    
+    performGroupTask([[SRGDataStoreGroupTask alloc] initWithTask:task completionBlock:completionBlock], cancelled);
+    
+    for (NSString *groupedHandle in groupedHandles) {
+        // Grouped tasks are not executing from the point of view of their operation. Take ownership of the completion
+        // block so that cancellation does not call it anymore. If the task was cancelled before, the completion block
+        // has already been called and the task must be skipped.
+        __block BOOL skipped = NO;
+        __block void (^groupedTask)(NSManagedObjectContext *) = nil;
+        __block SRGDataStoreWriteCompletionBlock groupedCompletionBlock = nil;
+        dispatch_barrier_sync(self.concurrentQueue, ^{
+            NSOperation *operation = [self.operations objectForKey:groupedHandle];
+            skipped = ! operation || operation.cancelled;
+            
+            groupedTask = [self.writeTasks objectForKey:groupedHandle];
+            groupedCompletionBlock = [self.writeCompletionBlocks objectForKey:groupedHandle];
+            
+            [self.writeTasks removeObjectForKey:groupedHandle];
+            [self.writeCompletionBlocks removeObjectForKey:groupedHandle];
+        });
+        
+        if (skipped || ! groupedTask) {
+            continue;
+        }
+        
+        performGroupTask([[SRGDataStoreGroupTask alloc] initWithTask:groupedTask completionBlock:groupedCompletionBlock], NO);
+    }
+    
+    NSArray<SRGDataStoreGroupTask *> *uncommittedTasks = [groupTasks subarrayWithRange:NSMakeRange(uncommittedTaskIndex, groupTasks.count - uncommittedTaskIndex)];
+    [self commitGroupTasks:uncommittedTasks inManagedObjectContext:managedObjectContext];
+    
+    for (SRGDataStoreGroupTask *groupTask in groupTasks) {
+        groupTask.completionBlock ? groupTask.completionBlock(groupTask.error) : nil;
+    }
+    
+    [self recycleWriteManagedObjectContext:managedObjectContext];
+    
+    dispatch_barrier_async(self.concurrentQueue, ^{
+        [self.operations removeObjectForKey:handle];
+        [self.writeCompletionBlocks removeObjectForKey:handle];
+        
+        // Discard operations of grouped tasks, which have nothing left to do
+        for (NSString *groupedHandle in groupedHandles) {
+            [[self.operations objectForKey:groupedHandle] cancel];
+            [self.operations removeObjectForKey:groupedHandle];
+        }
+    });
+}
+
+// Save changes made by the specified tasks to the group context at once. If the save fails, changes are rollbacked and
+// changes of each task are applied and saved again one by one, so that only failing tasks receive an error. Task blocks
+// are never performed again.
+- (void)commitGroupTasks:(NSArray<SRGDataStoreGroupTask *> *)groupTasks inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    __block BOOL saved = NO;
+    [managedObjectContext performBlockAndWait:^{
+        saved = ! managedObjectContext.hasChanges || [managedObjectContext save:NULL];
+        if (! saved) {
+            [managedObjectContext rollback];
+        }
+    }];
+    
+    if (saved) {
+        return;
+    }
+    
+    NSMutableDictionary<NSManagedObjectID *, NSManagedObject *> *insertedObjects = [NSMutableDictionary dictionary];
+    for (SRGDataStoreGroupTask *groupTask in groupTasks) {
+        // Changes of failed or cancelled tasks have not been kept
+        if (groupTask.error || ! groupTask.changes) {
+            continue;
+        }
+        
+        [managedObjectContext performBlockAndWait:^{
+            [groupTask.changes applyToManagedObjectContext:managedObjectContext insertedObjects:insertedObjects];
+            
+            NSError *error = nil;
+            if (managedObjectContext.hasChanges && ! [managedObjectContext save:&error]) {
+                [managedObjectContext rollback];
+                [insertedObjects removeObjectsForKeys:groupTask.changes.insertedObjectIDs];
+            }
+            groupTask.error = error;
+        }];
+    }
+}
+
 #pragma mark Notifications
 
 - (void)backgroundManagedObjectContextDidSave:(NSNotification *)notification
@@ -250,3 +654,178 @@
 }
 
 @end
+
+@interface SRGDataStoreChanges ()
+
+@property (nonatomic) NSArray<NSManagedObjectID *> *insertedObjectIDs;
+@property (nonatomic) NSDictionary<NSManagedObjectID *, NSString *> *insertedEntityNames;
+@property (nonatomic) NSDictionary<NSManagedObjectID *, NSDictionary<NSString *, id> *> *changedValues;
+@property (nonatomic) NSArray<NSManagedObjectID *> *deletedObjectIDs;
+
+@end
+
+@implementation SRGDataStoreChanges
+
+#pragma mark Class methods
+
+// Values of the specified keys, with related objects replaced with their identifiers and `nil` with `NSNull`
++ (NSDictionary<NSString *, id> *)valuesOfObject:(NSManagedObject *)object forKeys:(NSArray<NSString *> *)keys
+{
+    NSDictionary<NSString *, NSRelationshipDescription *> *relationships = object.entity.relationshipsByName;
+    
+    NSMutableDictionary<NSString *, id> *values = [NSMutableDictionary dictionary];
+    for (NSString *key in keys) {
+        [object willAccessValueForKey:key];
+        id value = [object primitiveValueForKey:key];
+        [object didAccessValueForKey:key];
+        
+        if (! value || ! relationships[key]) {
+            values[key] = value ?: NSNull.null;
+        }
+        else if ([value isKindOfClass:NSManagedObject.class]) {
+            values[key] = [value objectID];
+        }
+        else if ([value isKindOfClass:NSOrderedSet.class]) {
+            values[key] = [NSOrderedSet orderedSetWithArray:[[value array] valueForKey:@keypath(NSManagedObject.new, objectID)]];
+        }
+        else if ([value isKindOfClass:NSSet.class]) {
+            values[key] = [value valueForKey:@keypath(NSManagedObject.new, objectID)];
+        }
+    }
+    return values.copy;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    if (self = [super init]) {
+        // Temporary identifiers are specific to a context. Obtain permanent ones so that objects can be matched later.
+        NSArray<NSManagedObject *> *insertedObjects = managedObjectContext.insertedObjects.allObjects;
+        [managedObjectContext obtainPermanentIDsForObjects:insertedObjects error:NULL];
+        
+        NSMutableArray<NSManagedObjectID *> *insertedObjectIDs = [NSMutableArray array];
+        NSMutableDictionary<NSManagedObjectID *, NSString *> *insertedEntityNames = [NSMutableDictionary dictionary];
+        NSMutableDictionary<NSManagedObjectID *, NSDictionary<NSString *, id> *> *changedValues = [NSMutableDictionary dictionary];
+        
+        for (NSManagedObject *object in insertedObjects) {
+            NSEntityDescription *entity = object.entity;
+            NSArray<NSString *> *keys = [entity.attributesByName.allKeys arrayByAddingObjectsFromArray:entity.relationshipsByName.allKeys];
+            
+            [insertedObjectIDs addObject:object.objectID];
+            insertedEntityNames[object.objectID] = entity.name;
+            changedValues[object.objectID] = [SRGDataStoreChanges valuesOfObject:object forKeys:keys];
+        }
+        
+        for (NSManagedObject *object in managedObjectContext.updatedObjects) {
+            changedValues[object.objectID] = [SRGDataStoreChanges valuesOfObject:object forKeys:object.changedValues.allKeys];
+        }
+        
+        self.insertedObjectIDs = insertedObjectIDs.copy;
+        self.insertedEntityNames = insertedEntityNames.copy;
+        self.changedValues = changedValues.copy;
+        self.deletedObjectIDs = [managedObjectContext.deletedObjects.allObjects valueForKey:@keypath(NSManagedObject.new, objectID)];
+    }
+    return self;
+}
+
+#pragma mark Changes
+
+- (void)applyToManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+                    insertedObjects:(NSMutableDictionary<NSManagedObjectID *, NSManagedObject *> *)insertedObjects
+{
+    // Insert all objects first, so that relationships between them can be restored
+    for (NSManagedObjectID *objectID in self.insertedObjectIDs) {
+        insertedObjects[objectID] = [NSEntityDescription insertNewObjectForEntityForName:self.insertedEntityNames[objectID] inManagedObjectContext:managedObjectContext];
+    }
+    
+    NSManagedObject * (^objectWithID)(NSManagedObjectID *) = ^(NSManagedObjectID *objectID) {
+        return insertedObjects[objectID] ?: [managedObjectContext existingObjectWithID:objectID error:NULL];
+    };
+    
+    [self.changedValues enumerateKeysAndObjectsUsingBlock:^(NSManagedObjectID * _Nonnull objectID, NSDictionary<NSString *, id> * _Nonnull values, BOOL * _Nonnull stop) {
+        NSManagedObject *object = objectWithID(objectID);
+        if (! object) {
+            return;
+        }
+        
+        NSDictionary<NSString *, NSRelationshipDescription *> *relationships = object.entity.relationshipsByName;
+        [values enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, id _Nonnull value, BOOL * _Nonnull stop) {
+            id primitiveValue = nil;
+            if (value == NSNull.null) {
+                primitiveValue = nil;
+            }
+            else if (! relationships[key]) {
+                primitiveValue = value;
+            }
+            else if ([value isKindOfClass:NSManagedObjectID.class]) {
+                primitiveValue = objectWithID(value);
+            }
+            else {
+                NSMutableOrderedSet<NSManagedObject *> *relatedObjects = [NSMutableOrderedSet orderedSet];
+                for (NSManagedObjectID *relatedObjectID in value) {
+                    NSManagedObject *relatedObject = objectWithID(relatedObjectID);
+                    if (relatedObject) {
+                        [relatedObjects addObject:relatedObject];
+                    }
+                }
+                primitiveValue = [value isKindOfClass:NSOrderedSet.class] ? relatedObjects.copy : relatedObjects.set;
+            }
+            
+            [object willChangeValueForKey:key];
+            [object setPrimitiveValue:primitiveValue forKey:key];
+            [object didChangeValueForKey:key];
+        }];
+    }];
+    
+    for (NSManagedObjectID *objectID in self.deletedObjectIDs) {
+        NSManagedObject *object = objectWithID(objectID);
+        if (object) {
+            [managedObjectContext deleteObject:object];
+        }
+    }
+}
+
+@end
+
+@implementation SRGDataStoreGroupTask
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithTask:(void (^)(NSManagedObjectContext *))task completionBlock:(SRGDataStoreWriteCompletionBlock)completionBlock
+{
+    if (self = [super init]) {
+        _task = task;
+        _completionBlock = completionBlock;
+    }
+    return self;
+}
+
+@end
+
+@implementation SRGDataStoreGroupTaskManagedObjectContext
+
+#pragma mark Overrides
+
+- (NSPersistentStoreResult *)executeRequest:(NSPersistentStoreRequest *)request error:(NSError * __autoreleasing *)error
+{
+    if (request.requestType == NSFetchRequestType || request.requestType == NSSaveRequestType) {
+        return [super executeRequest:request error:error];
+    }
+    
+    self.batchRequestBlock ? self.batchRequestBlock() : nil;
+    
+    NSManagedObjectContext *parentContext = self.parentContext;
+    __block NSPersistentStoreResult *result = nil;
+    __block NSError *requestError = nil;
+    [parentContext performBlockAndWait:^{
+        result = [parentContext executeRequest:request error:&requestError];
+    }];
+    
+    if (error) {
+        *error = requestError;
+    }
+    return result;
+}
+
+@end
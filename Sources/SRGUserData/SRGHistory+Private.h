@@ -0,0 +1,43 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGHistory.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Private interface for implementation purposes.
+ */
+@interface SRGHistory (Private)
+
+/**
+ *  The maximum number of history entries sent with a single push request. Default is 500.
+ */
+@property (nonatomic) NSUInteger pushChunkSize;
+
+/**
+ *  The maximum number of push requests running at the same time. Default is 2.
+ */
+@property (nonatomic) NSUInteger maximumConcurrentPushCount;
+
+/**
+ *  The maximum number of pulled history pages received but not saved yet. Default is 2.
+ */
+@property (nonatomic) NSUInteger pullPrefetchDepth;
+
+/**
+ *  Write buffered playback positions to the store, calling the specified block on completion.
+ */
+- (void)flushPlaybackPositionsWithCompletionBlock:(nullable void (^)(NSError * _Nullable error))completionBlock;
+
+/**
+ *  Synchronize history entries saved in the store, without writing buffered playback positions first.
+ */
+- (void)synchronizeSavedHistoryEntriesWithCompletionBlock:(void (^)(NSError * _Nullable error))completionBlock;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -4,7 +4,7 @@
 //  License information is available from the LICENSE file.
 //
 
-#import "SRGHistory.h"
+#import "SRGHistory+Private.h"
 
 #import "NSArray+SRGUserData.h"
 #import "NSBundle+SRGUserData.h"
@@ -12,8 +12,11 @@
 #import "SRGDataStore.h"
 #import "SRGHistoryEntry+Private.h"
 #import "SRGHistoryRequest.h"
+#import "SRGPagePipeline.h"
 #import "SRGUser+Private.h"
 #import "SRGUserData+Private.h"
+#import "SRGUserDataError.h"
+#import "SRGUserDataLogger.h"
 #import "SRGUserDataService+Private.h"
 #import "SRGUserDataService+Subclassing.h"
 #import "SRGUserObject+Private.h"
@@ -27,10 +30,59 @@
 NSString * const SRGHistoryEntriesDidChangeNotification = @"SRGHistoryEntriesDidChangeNotification";
 NSString * const SRGHistoryEntriesUidsKey = @"SRGHistoryEntriesUids";
 
+static const NSUInteger SRGHistoryPullPageSize = 500;
+
+static NSError *SRGHistoryCancellationError(void)
+{
+    return [NSError errorWithDomain:SRGUserDataErrorDomain
+                               code:SRGUserDataErrorCancelled
+                           userInfo:@{ NSLocalizedDescriptionKey : SRGUserDataLocalizedString(@"The operation has been cancelled", @"Error message returned when an operation has been cancelled") }];
+}
+
+/**
+ *  Most recent playback information saved for a history entry but not written to the store yet, and completion blocks
+ *  of the saves coalesced into it (in submission order).
+ */
+@interface SRGHistoryBufferedUpdate : NSObject
+
+@property (nonatomic) SRGHistoryEntryOverlay *overlay;
+
+@property (nonatomic, copy) NSString *handle;
+
+@property (nonatomic) NSMutableArray<NSString *> *handles;
+@property (nonatomic) NSMutableDictionary<NSString *, void (^)(NSError *)> *completionBlocks;
+
+@end
+
+@implementation SRGHistoryBufferedUpdate
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        self.handles = [NSMutableArray array];
+        self.completionBlocks = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+@end
+
 @interface SRGHistory ()
 
+@property (nonatomic, weak) SRGPagePipeline *pullPipeline;
 @property (nonatomic, weak) SRGPageRequest *pullRequest;
-@property (nonatomic, weak) SRGRequest *pushRequest;
+@property (nonatomic) NSHashTable<SRGRequest *> *pushRequests;
+
+@property (nonatomic) NSUInteger pushChunkSize;
+@property (nonatomic) NSUInteger maximumConcurrentPushCount;
+@property (nonatomic) NSUInteger pullPrefetchDepth;
+
+@property (nonatomic) NSMutableDictionary<NSString *, SRGHistoryBufferedUpdate *> *bufferedUpdates;
+@property (nonatomic) NSMutableDictionary<NSString *, NSString *> *bufferedHandles;
+@property (nonatomic) NSMutableSet<NSString *> *activeUids;
+@property (nonatomic) SRGHistoryEntryOverlayTable *overlayTable;
+@property (nonatomic, getter=isFlushScheduled) BOOL flushScheduled;
+@property (nonatomic) dispatch_queue_t bufferQueue;
 
 @property (nonatomic) NSURLSession *session;
 
@@ -45,6 +97,22 @@ NSString * const SRGHistoryEntriesUidsKey = @"SRGHistoryEntriesUids";
     if (self = [super initWithServiceURL:serviceURL userData:userData]) {
         NSURLSessionConfiguration *sessionConfiguration = [NSURLSessionConfiguration defaultSessionConfiguration];
         self.session = [NSURLSession sessionWithConfiguration:sessionConfiguration];
+        self.pushRequests = [NSHashTable weakObjectsHashTable];
+        self.pushChunkSize = 500;
+        self.maximumConcurrentPushCount = 2;
+        self.pullPrefetchDepth = 2;
+        
+        self.playbackPositionFlushInterval = 1.;
+        self.bufferedUpdates = [NSMutableDictionary dictionary];
+        self.bufferedHandles = [NSMutableDictionary dictionary];
+        self.activeUids = [NSMutableSet set];
+        self.overlayTable = [[SRGHistoryEntryOverlayTable alloc] init];
+        self.bufferQueue = dispatch_queue_create("ch.srgssr.userdata.history.buffer", DISPATCH_QUEUE_SERIAL);
+        
+        [NSNotificationCenter.defaultCenter addObserver:self
+                                               selector:@selector(applicationDidEnterBackground:)
+                                                   name:UIApplicationDidEnterBackgroundNotification
+                                                 object:nil];
     }
     return self;
 }
@@ -61,24 +129,162 @@ NSString * const SRGHistoryEntriesUidsKey = @"SRGHistoryEntriesUids";
     NSMutableSet<NSString *> *changedUids = [NSMutableSet set];
     
     [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
-        for (NSDictionary *historyEntryDictionary in historyEntryDictionaries) {
-            SRGHistoryEntry *historyEntry = [SRGHistoryEntry synchronizeWithDictionary:historyEntryDictionary matchingPredicate:nil inManagedObjectContext:managedObjectContext];
-            if (historyEntry) {
-                [changedUids addObject:historyEntry.uid];
-            }
+        NSArray<SRGHistoryEntry *> *historyEntries = [SRGHistoryEntry synchronizeWithDictionaries:historyEntryDictionaries matchingPredicate:nil inManagedObjectContext:managedObjectContext];
+        for (SRGHistoryEntry *historyEntry in historyEntries) {
+            [changedUids addObject:historyEntry.uid];
         }
     } withPriority:NSOperationQueuePriorityLow completionBlock:^(NSError * _Nullable error) {
         if (! error && changedUids.count > 0) {
-            dispatch_sync(dispatch_get_main_queue(), ^{
-                [NSNotificationCenter.defaultCenter postNotificationName:SRGHistoryEntriesDidChangeNotification
-                                                                  object:self
-                                                                userInfo:@{ SRGHistoryEntriesUidsKey : changedUids.copy }];
+            [self.userData.notificationDispatcher postNotificationName:SRGHistoryEntriesDidChangeNotification
+                                                                object:self
+                                                              userInfo:@{ SRGHistoryEntriesUidsKey : changedUids.copy }
+                                                  coalescingUidsForKey:SRGHistoryEntriesUidsKey];
+        }
+        [self.userData.notificationDispatcher dispatchBlock:^{
+            completionBlock(error);
+        }];
+    }];
+}
+
+#pragma mark Playback position buffer
+
+// Must be called on the buffer queue
+- (void)scheduleFlush
+{
+    if (self.flushScheduled) {
+        return;
+    }
+    
+    self.flushScheduled = YES;
+    
+    @weakify(self)
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.playbackPositionFlushInterval * NSEC_PER_SEC)), self.bufferQueue, ^{
+        @strongify(self)
+        [self flushBufferedUpdatesWithCompletionBlock:nil];
+    });
+}
+
+// Must be called on the buffer queue. The write is enqueued before the method returns, so that writes submitted later
+// are applied after it.
+- (void)flushBufferedUpdatesWithCompletionBlock:(void (^)(NSError *error))completionBlock
+{
+    self.flushScheduled = NO;
+    
+    // Entries updated since the last flush are considered as still being played and their next update is buffered as
+    // well. Other ones are written immediately again.
+    NSDictionary<NSString *, SRGHistoryBufferedUpdate *> *bufferedUpdates = self.bufferedUpdates.copy;
+    [self.bufferedUpdates removeAllObjects];
+    [self.bufferedHandles removeAllObjects];
+    [self.activeUids setSet:[NSSet setWithArray:bufferedUpdates.allKeys]];
+    
+    // Always perform a write, even if empty, so that the completion block is called after all previous flushes
+    [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        NSArray<NSString *> *uids = bufferedUpdates.allKeys;
+        NSArray<SRGHistoryEntry *> *historyEntries = [SRGHistoryEntry upsertWithUids:uids matchingPredicate:nil inManagedObjectContext:managedObjectContext];
+        [historyEntries enumerateObjectsUsingBlock:^(SRGHistoryEntry * _Nonnull historyEntry, NSUInteger idx, BOOL * _Nonnull stop) {
+            SRGHistoryEntryOverlay *overlay = bufferedUpdates[uids[idx]].overlay;
+            historyEntry.lastPlaybackTime = overlay.lastPlaybackTime;
+            historyEntry.deviceUid = overlay.deviceUid;
+            historyEntry.date = overlay.date;
+        }];
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+        if (error) {
+            SRGUserDataLogError(@"history", @"Could not write buffered playback positions. Reason: %@", error);
+            
+            // Put the updates back into the buffer so that they are not lost, unless more recent ones were made in the
+            // meantime. Completion blocks are kept as well, so that they are called once the updates have been written.
+            dispatch_async(self.bufferQueue, ^{
+                [self restoreBufferedUpdates:bufferedUpdates];
+                completionBlock ? completionBlock(error) : nil;
             });
+            return;
+        }
+        
+        if (bufferedUpdates.count != 0) {
+            [self.userData.notificationDispatcher postNotificationName:SRGHistoryEntriesDidChangeNotification
+                                                                object:self
+                                                              userInfo:@{ SRGHistoryEntriesUidsKey : [NSSet setWithArray:bufferedUpdates.allKeys] }
+                                                  coalescingUidsForKey:SRGHistoryEntriesUidsKey];
         }
-        completionBlock(error);
+        [self.userData.notificationDispatcher dispatchBlock:^{
+            // Changes saved to the store have been merged into the main thread context at this point. Overlays can be
+            // removed without saved values being visible in the meantime, unless they were replaced by newer updates.
+            [bufferedUpdates enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull uid, SRGHistoryBufferedUpdate * _Nonnull bufferedUpdate, BOOL * _Nonnull stop) {
+                [self.overlayTable removeOverlay:bufferedUpdate.overlay forUid:uid];
+            }];
+            
+            for (SRGHistoryBufferedUpdate *bufferedUpdate in bufferedUpdates.allValues) {
+                for (NSString *handle in bufferedUpdate.handles) {
+                    bufferedUpdate.completionBlocks[handle](nil);
+                }
+            }
+            completionBlock ? completionBlock(nil) : nil;
+        }];
     }];
 }
 
+// Must be called on the buffer queue
+- (void)restoreBufferedUpdates:(NSDictionary<NSString *, SRGHistoryBufferedUpdate *> *)bufferedUpdates
+{
+    [bufferedUpdates enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull uid, SRGHistoryBufferedUpdate * _Nonnull bufferedUpdate, BOOL * _Nonnull stop) {
+        SRGHistoryBufferedUpdate *recentBufferedUpdate = self.bufferedUpdates[uid];
+        if (recentBufferedUpdate) {
+            [recentBufferedUpdate.handles insertObjects:bufferedUpdate.handles atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, bufferedUpdate.handles.count)]];
+            [recentBufferedUpdate.completionBlocks addEntriesFromDictionary:bufferedUpdate.completionBlocks];
+        }
+        else {
+            self.bufferedUpdates[uid] = bufferedUpdate;
+        }
+        
+        for (NSString *handle in bufferedUpdate.handles) {
+            self.bufferedHandles[handle] = uid;
+        }
+    }];
+    
+    if (self.bufferedUpdates.count != 0) {
+        [self scheduleFlush];
+    }
+}
+
+// Must be called on the buffer queue
+- (void)discardBufferedUpdatesWithUids:(NSArray<NSString *> *)uids error:(NSError *)error
+{
+    NSArray<SRGHistoryBufferedUpdate *> *bufferedUpdates = nil;
+    if (uids) {
+        bufferedUpdates = [self.bufferedUpdates objectsForKeys:uids notFoundMarker:NSNull.null];
+        bufferedUpdates = [bufferedUpdates filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"self != %@", NSNull.null]];
+        [self.bufferedUpdates removeObjectsForKeys:uids];
+    }
+    else {
+        bufferedUpdates = self.bufferedUpdates.allValues;
+        [self.bufferedUpdates removeAllObjects];
+    }
+    
+    for (SRGHistoryBufferedUpdate *bufferedUpdate in bufferedUpdates) {
+        [self.bufferedHandles removeObjectsForKeys:bufferedUpdate.handles];
+    }
+    [self.overlayTable removeOverlaysForUids:uids];
+    
+    if (bufferedUpdates.count == 0) {
+        return;
+    }
+    
+    [self.userData.notificationDispatcher dispatchBlock:^{
+        for (SRGHistoryBufferedUpdate *bufferedUpdate in bufferedUpdates) {
+            for (NSString *handle in bufferedUpdate.handles) {
+                bufferedUpdate.completionBlocks[handle](error);
+            }
+        }
+    }];
+}
+
+- (void)flushPlaybackPositionsWithCompletionBlock:(void (^)(NSError * _Nullable))completionBlock
+{
+    dispatch_async(self.bufferQueue, ^{
+        [self flushBufferedUpdatesWithCompletionBlock:completionBlock];
+    });
+}
+
 #pragma mark Requests
 
 - (void)pullHistoryEntriesForSessionToken:(NSString *)sessionToken
@@ -90,64 +296,125 @@ NSString * const SRGHistoryEntriesUidsKey = @"SRGHistoryEntriesUids";
     
     __block SRGFirstPageRequest *firstRequest = nil;
     
+    // The next page is requested while the current one is being saved. The server date is only returned once all pages
+    // have been saved.
     @weakify(self)
-    firstRequest = [[[SRGHistoryRequest historyUpdatesFromServiceURL:self.serviceURL forSessionToken:sessionToken afterDate:date withDeletedEntries:YES session:self.session completionBlock:^(NSArray<NSDictionary *> * _Nullable historyEntryDictionaries, NSDate * _Nullable serverDate, SRGPage * _Nullable page, SRGPage * _Nullable nextPage, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
+    SRGPagePipeline *pullPipeline = [[SRGPagePipeline alloc] initWithPrefetchDepth:self.pullPrefetchDepth fetchBlock:^(SRGPage * _Nullable requestedPage, SRGPagePipelineFetchCompletionBlock fetchCompletionBlock) {
         @strongify(self)
         
-        void (^pullCompletionBlock)(NSDate *, NSError *) = ^(NSDate *serverDate, NSError *error) {
-            completionBlock(serverDate, error);
-            firstRequest = nil;
-        };
-        
-        if (error) {
-            pullCompletionBlock(nil, error);
-            return;
+        SRGPageRequest *request = nil;
+        if (! requestedPage) {
+            firstRequest = [[[SRGHistoryRequest historyUpdatesFromServiceURL:self.serviceURL forSessionToken:sessionToken afterDate:date withDeletedEntries:YES session:self.session completionBlock:^(NSArray<NSDictionary *> * _Nullable historyEntryDictionaries, NSDate * _Nullable serverDate, SRGPage * _Nullable page, SRGPage * _Nullable nextPage, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
+                fetchCompletionBlock(historyEntryDictionaries, serverDate, nextPage, error);
+            }] requestWithPageSize:SRGHistoryPullPageSize] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled | SRGRequestOptionCancellationErrorsEnabled];
+            request = firstRequest;
         }
+        else {
+            request = [firstRequest requestWithPage:requestedPage];
+        }
+        [request resume];
+        self.pullRequest = request;
+    } saveBlock:^(NSArray<NSDictionary *> * _Nonnull historyEntryDictionaries, SRGPagePipelineSaveCompletionBlock saveCompletionBlock) {
+        @strongify(self)
+        [self saveHistoryEntryDictionaries:historyEntryDictionaries withCompletionBlock:saveCompletionBlock];
+    }];
+    [pullPipeline startWithCompletionBlock:^(NSDate * _Nullable serverDate, NSError * _Nullable error) {
+        completionBlock(serverDate, error);
+        firstRequest = nil;
+    }];
+    self.pullPipeline = pullPipeline;
+}
+
+// Must be called on the queue of the context the entries belong to. Chunks only contain plain dictionaries (indexed by
+// entry object identifier), so that they can be pushed from any thread.
+- (NSArray<NSDictionary<NSManagedObjectID *, NSDictionary *> *> *)pushChunksForHistoryEntries:(NSArray<SRGHistoryEntry *> *)historyEntries
+                                                                                    chunkSize:(NSUInteger)chunkSize
+{
+    chunkSize = MAX(chunkSize, 1);
+    
+    NSMutableArray<NSDictionary<NSManagedObjectID *, NSDictionary *> *> *chunks = [NSMutableArray array];
+    for (NSUInteger i = 0; i < historyEntries.count; i += chunkSize) {
+        NSUInteger length = MIN(chunkSize, historyEntries.count - i);
         
-        [self saveHistoryEntryDictionaries:historyEntryDictionaries withCompletionBlock:^(NSError *error) {
-            if (error) {
-                pullCompletionBlock(nil, error);
-                return;
-            }
-            
-            if (nextPage) {
-                SRGPageRequest *nextRequest = [firstRequest requestWithPage:nextPage];
-                [nextRequest resume];
-                self.pullRequest = nextRequest;
-            }
-            else {
-                pullCompletionBlock(serverDate, nil);
+        NSMutableDictionary<NSManagedObjectID *, NSDictionary *> *chunk = [NSMutableDictionary dictionaryWithCapacity:length];
+        @autoreleasepool {
+            for (SRGHistoryEntry *historyEntry in [historyEntries subarrayWithRange:NSMakeRange(i, length)]) {
+                chunk[historyEntry.objectID] = historyEntry.dictionary;
             }
-        }];
-    }] requestWithPageSize:500] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled | SRGRequestOptionCancellationErrorsEnabled];
-    [firstRequest resume];
-    self.pullRequest = firstRequest;
+        }
+        [chunks addObject:chunk.copy];
+    }
+    return chunks.copy;
 }
 
-- (void)pushHistoryEntries:(NSArray<SRGHistoryEntry *> *)historyEntries
-           forSessionToken:(NSString *)sessionToken
-       withCompletionBlock:(void (^)(NSError *error))completionBlock
+- (void)pushHistoryEntryChunks:(NSArray<NSDictionary<NSManagedObjectID *, NSDictionary *> *> *)chunks
+               forSessionToken:(NSString *)sessionToken
+           withCompletionBlock:(void (^)(NSError *error))completionBlock
 {
-    NSParameterAssert(historyEntries);
+    NSParameterAssert(chunks);
     NSParameterAssert(sessionToken);
     NSParameterAssert(completionBlock);
     
-    if (historyEntries.count == 0) {
+    if (chunks.count == 0) {
         completionBlock(nil);
         return;
     }
     
-    NSMutableDictionary<NSManagedObjectID *, NSDictionary *> *historyEntriesMap = [NSMutableDictionary dictionary];
-    for (SRGHistoryEntry *historyEntry in historyEntries) {
-        historyEntriesMap[historyEntry.objectID] = historyEntry.dictionary;
+    // Chunks are distributed over a bounded number of lanes, each one pushing its chunks one after the other. A failing
+    // lane stops, but chunks already acknowledged by the service remain so.
+    NSUInteger laneCount = MIN(MAX(self.maximumConcurrentPushCount, 1), chunks.count);
+    dispatch_group_t group = dispatch_group_create();
+    __block NSError *pushError = nil;
+    
+    for (NSUInteger lane = 0; lane < laneCount; ++lane) {
+        dispatch_group_enter(group);
+        [self pushHistoryEntryChunks:chunks fromIndex:lane stride:laneCount forSessionToken:sessionToken withCompletionBlock:^(NSError *error) {
+            if (error) {
+                @synchronized(group) {
+                    pushError = pushError ?: error;
+                }
+            }
+            dispatch_group_leave(group);
+        }];
+    }
+    
+    dispatch_group_notify(group, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        completionBlock(pushError);
+    });
+}
+
+- (void)pushHistoryEntryChunks:(NSArray<NSDictionary<NSManagedObjectID *, NSDictionary *> *> *)chunks
+                     fromIndex:(NSUInteger)index
+                        stride:(NSUInteger)stride
+               forSessionToken:(NSString *)sessionToken
+           withCompletionBlock:(void (^)(NSError *error))completionBlock
+{
+    if (index >= chunks.count) {
+        completionBlock(nil);
+        return;
     }
     
+    [self pushHistoryEntryChunk:chunks[index] forSessionToken:sessionToken withCompletionBlock:^(NSError *error) {
+        if (error) {
+            completionBlock(error);
+            return;
+        }
+        
+        [self pushHistoryEntryChunks:chunks fromIndex:index + stride stride:stride forSessionToken:sessionToken withCompletionBlock:completionBlock];
+    }];
+}
+
+- (void)pushHistoryEntryChunk:(NSDictionary<NSManagedObjectID *, NSDictionary *> *)historyEntriesMap
+              forSessionToken:(NSString *)sessionToken
+          withCompletionBlock:(void (^)(NSError *error))completionBlock
+{
     SRGRequest *pushRequest = [[SRGHistoryRequest postBatchOfHistoryEntryDictionaries:historyEntriesMap.allValues toServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:^(NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
         if (error) {
             completionBlock(error);
             return;
         }
         
+        // Acknowledged entries are marked as clean immediately, so that they are not pushed again if a later chunk fails
         [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
             for (NSManagedObjectID *historyEntryID in historyEntriesMap) {
                 SRGHistoryEntry *historyEntry = [managedObjectContext existingObjectWithID:historyEntryID error:NULL];
@@ -162,25 +429,48 @@ NSString * const SRGHistoryEntriesUidsKey = @"SRGHistoryEntriesUids";
         } withPriority:NSOperationQueuePriorityLow completionBlock:completionBlock];
     }] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled | SRGRequestOptionCancellationErrorsEnabled];
     [pushRequest resume];
-    self.pushRequest = pushRequest;
+    
+    @synchronized(self.pushRequests) {
+        [self.pushRequests addObject:pushRequest];
+    }
 }
 
 #pragma mark Subclassing hooks
 
 - (void)synchronizeWithCompletionBlock:(void (^)(NSError * _Nullable))completionBlock
+{
+    // Write buffered playback positions first, so that they are pushed as well
+    [self flushPlaybackPositionsWithCompletionBlock:^(NSError * _Nullable error) {
+        if (error) {
+            completionBlock(error);
+            return;
+        }
+        
+        [self synchronizeSavedHistoryEntriesWithCompletionBlock:completionBlock];
+    }];
+}
+
+- (void)synchronizeSavedHistoryEntriesWithCompletionBlock:(void (^)(NSError * _Nullable))completionBlock
 {
     NSString *sessionToken = self.userData.identityService.sessionToken;
     
+    NSUInteger pushChunkSize = self.pushChunkSize;
+    
+    // Entries are only accessed on the read context queue. Pushes only receive plain dictionaries.
     [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        // Only saved values must be pushed, as entries are marked as clean once the push succeeds
+        [SRGHistoryEntry setOverlayTable:nil forManagedObjectContext:managedObjectContext];
+        
         NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == YES", @keypath(SRGHistoryEntry.new, dirty)];
-        return [SRGHistoryEntry objectsMatchingPredicate:predicate sortedWithDescriptors:nil inManagedObjectContext:managedObjectContext];
-    } withPriority:NSOperationQueuePriorityLow completionBlock:^(NSArray<SRGHistoryEntry *> * _Nullable historyEntries, NSError * _Nullable error) {
+        NSArray<SRGHistoryEntry *> *historyEntries = [SRGHistoryEntry objectsMatchingPredicate:predicate sortedWithDescriptors:nil inManagedObjectContext:managedObjectContext];
+        return [self pushChunksForHistoryEntries:historyEntries chunkSize:pushChunkSize];
+    } withPriority:NSOperationQueuePriorityLow completionBlock:^(NSArray<NSDictionary<NSManagedObjectID *, NSDictionary *> *> * _Nullable chunks, NSError * _Nullable error) {
         if (error) {
             completionBlock(error);
             return;
         }
         
-        [self pushHistoryEntries:historyEntries forSessionToken:sessionToken withCompletionBlock:^(NSError *error) {
+        [self pushHistoryEntryChunks:chunks forSessionToken:sessionToken withCompletionBlock:^(NSError *error) {
             if (error) {
                 completionBlock(error);
                 return;
@@ -213,8 +503,14 @@ NSString * const SRGHistoryEntriesUidsKey = @"SRGHistoryEntriesUids";
 
 - (void)cancelSynchronization
 {
+    [self.pullPipeline cancel];
     [self.pullRequest cancel];
-    [self.pushRequest cancel];
+    
+    NSArray<SRGRequest *> *pushRequests = nil;
+    @synchronized(self.pushRequests) {
+        pushRequests = self.pushRequests.allObjects;
+    }
+    [pushRequests makeObjectsPerformSelector:@selector(cancel)];
 }
 
 - (NSArray<SRGUserObject *> *)userObjectsInManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
@@ -226,19 +522,23 @@ NSString * const SRGHistoryEntriesUidsKey = @"SRGHistoryEntriesUids";
 {
     __block NSSet<NSString *> *previousUids = nil;
     
+    dispatch_sync(self.bufferQueue, ^{
+        [self discardBufferedUpdatesWithUids:nil error:SRGHistoryCancellationError()];
+        [self.activeUids removeAllObjects];
+    });
+    
     [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
         NSArray<SRGHistoryEntry *> *historyEntries = [SRGHistoryEntry objectsMatchingPredicate:nil sortedWithDescriptors:nil inManagedObjectContext:managedObjectContext];
         NSString *keyPath = [NSString stringWithFormat:@"@distinctUnionOfObjects.%@", @keypath(SRGHistoryEntry.new, uid)];
         previousUids = [NSSet setWithArray:[historyEntries valueForKeyPath:keyPath]];
         [SRGHistoryEntry deleteAllObjectsMatchingPredicate:nil inManagedObjectContext:managedObjectContext];
     } withPriority:NSOperationQueuePriorityVeryHigh completionBlock:^(NSError * _Nullable error) {
-        dispatch_sync(dispatch_get_main_queue(), ^{
-            if (previousUids.count > 0) {
-                [NSNotificationCenter.defaultCenter postNotificationName:SRGHistoryEntriesDidChangeNotification
-                                                                  object:self
-                                                                userInfo:@{ SRGHistoryEntriesUidsKey : previousUids }];
-            }
-        });
+        if (previousUids.count > 0) {
+            [self.userData.notificationDispatcher postNotificationName:SRGHistoryEntriesDidChangeNotification
+                                                                object:self
+                                                              userInfo:@{ SRGHistoryEntriesUidsKey : previousUids }
+                                                  coalescingUidsForKey:SRGHistoryEntriesUidsKey];
+        }
     }];
 }
 
@@ -250,15 +550,61 @@ NSString * const SRGHistoryEntriesUidsKey = @"SRGHistoryEntriesUids";
     if (predicate) {
         historyEntriesPredicate = [NSCompoundPredicate andPredicateWithSubpredicates:@[historyEntriesPredicate, predicate]];
     }
+    [SRGHistoryEntry setOverlayTable:self.overlayTable forManagedObjectContext:managedObjectContext];
     return [SRGHistoryEntry objectsMatchingPredicate:historyEntriesPredicate sortedWithDescriptors:sortDescriptors inManagedObjectContext:managedObjectContext];
 }
 
+- (NSArray<SRGHistoryEntry *> *)historyEntriesMatchingPredicate:(NSPredicate *)predicate
+                                                          limit:(NSUInteger)limit
+                                                    afterCursor:(SRGUserObjectCursor *)cursor
+                                                     nextCursor:(SRGUserObjectCursor * __autoreleasing *)pNextCursor
+                                         inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    NSPredicate *historyEntriesPredicate = [NSPredicate predicateWithFormat:@"%K == NO", @keypath(SRGHistoryEntry.new, discarded)];
+    if (predicate) {
+        historyEntriesPredicate = [NSCompoundPredicate andPredicateWithSubpredicates:@[historyEntriesPredicate, predicate]];
+    }
+    [SRGHistoryEntry setOverlayTable:self.overlayTable forManagedObjectContext:managedObjectContext];
+    return [SRGHistoryEntry objectsMatchingPredicate:historyEntriesPredicate
+                                       dateAscending:NO
+                                               limit:limit
+                                         afterCursor:cursor
+                                          nextCursor:pNextCursor
+                              inManagedObjectContext:managedObjectContext];
+}
+
+- (NSUInteger)historyEntryCountMatchingPredicate:(NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext error:(NSError * __autoreleasing *)error
+{
+    NSPredicate *historyEntriesPredicate = [NSPredicate predicateWithFormat:@"%K == NO", @keypath(SRGHistoryEntry.new, discarded)];
+    if (predicate) {
+        historyEntriesPredicate = [NSCompoundPredicate andPredicateWithSubpredicates:@[historyEntriesPredicate, predicate]];
+    }
+    return [SRGHistoryEntry countOfObjectsMatchingPredicate:historyEntriesPredicate inManagedObjectContext:managedObjectContext error:error];
+}
+
+- (double)totalLastPlaybackPositionOfHistoryEntriesMatchingPredicate:(NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext error:(NSError * __autoreleasing *)error
+{
+    NSPredicate *historyEntriesPredicate = [NSPredicate predicateWithFormat:@"%K == NO", @keypath(SRGHistoryEntry.new, discarded)];
+    if (predicate) {
+        historyEntriesPredicate = [NSCompoundPredicate andPredicateWithSubpredicates:@[historyEntriesPredicate, predicate]];
+    }
+    return [SRGHistoryEntry sumOfValuesForKeyPath:@keypath(SRGHistoryEntry.new, lastPlaybackPosition) ofObjectsMatchingPredicate:historyEntriesPredicate inManagedObjectContext:managedObjectContext error:error];
+}
+
 - (SRGHistoryEntry *)historyEntryWithUid:(NSString *)uid inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
 {
     NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == NO", @keypath(SRGHistoryEntry.new, discarded)];
+    [SRGHistoryEntry setOverlayTable:self.overlayTable forManagedObjectContext:managedObjectContext];
     return [SRGHistoryEntry objectWithUid:uid matchingPredicate:predicate inManagedObjectContext:managedObjectContext];
 }
 
+- (NSDictionary<NSString *, SRGHistoryEntry *> *)historyEntriesWithUids:(NSArray<NSString *> *)uids inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == NO", @keypath(SRGHistoryEntry.new, discarded)];
+    [SRGHistoryEntry setOverlayTable:self.overlayTable forManagedObjectContext:managedObjectContext];
+    return [SRGHistoryEntry objectsWithUids:uids matchingPredicate:predicate inManagedObjectContext:managedObjectContext];
+}
+
 - (NSArray<SRGHistoryEntry *> *)historyEntriesMatchingPredicate:(NSPredicate *)predicate sortedWithDescriptors:(NSArray<NSSortDescriptor *> *)sortDescriptors
 {
     return [self.userData.dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
@@ -273,6 +619,41 @@ NSString * const SRGHistoryEntriesUidsKey = @"SRGHistoryEntriesUids";
     } withPriority:NSOperationQueuePriorityNormal completionBlock:completionBlock];
 }
 
+- (NSArray<SRGHistoryEntry *> *)historyEntriesMatchingPredicate:(NSPredicate *)predicate
+                                                          limit:(NSUInteger)limit
+                                                    afterCursor:(SRGUserObjectCursor *)cursor
+                                                     nextCursor:(SRGUserObjectCursor * __autoreleasing *)pNextCursor
+{
+    __block SRGUserObjectCursor *nextCursor = nil;
+    NSArray<SRGHistoryEntry *> *page = [self.userData.dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        SRGUserObjectCursor *pageNextCursor = nil;
+        NSArray<SRGHistoryEntry *> *historyEntries = [self historyEntriesMatchingPredicate:predicate limit:limit afterCursor:cursor nextCursor:&pageNextCursor inManagedObjectContext:managedObjectContext];
+        nextCursor = pageNextCursor;
+        return historyEntries;
+    }];
+    
+    if (pNextCursor) {
+        *pNextCursor = nextCursor;
+    }
+    return page;
+}
+
+- (NSString *)historyEntriesMatchingPredicate:(NSPredicate *)predicate
+                                        limit:(NSUInteger)limit
+                                  afterCursor:(SRGUserObjectCursor *)cursor
+                              completionBlock:(void (^)(NSArray<SRGHistoryEntry *> * _Nullable, SRGUserObjectCursor * _Nullable, NSError * _Nullable))completionBlock
+{
+    __block SRGUserObjectCursor *nextCursor = nil;
+    return [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        SRGUserObjectCursor *pageNextCursor = nil;
+        NSArray<SRGHistoryEntry *> *historyEntries = [self historyEntriesMatchingPredicate:predicate limit:limit afterCursor:cursor nextCursor:&pageNextCursor inManagedObjectContext:managedObjectContext];
+        nextCursor = pageNextCursor;
+        return historyEntries;
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(id _Nullable result, NSError * _Nullable error) {
+        completionBlock(result, nextCursor, error);
+    }];
+}
+
 - (SRGHistoryEntry *)historyEntryWithUid:(NSString *)uid
 {
     return [self.userData.dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
@@ -287,7 +668,98 @@ NSString * const SRGHistoryEntriesUidsKey = @"SRGHistoryEntriesUids";
     } withPriority:NSOperationQueuePriorityNormal completionBlock:completionBlock];
 }
 
+- (NSDictionary<NSString *, SRGHistoryEntry *> *)historyEntriesWithUids:(NSArray<NSString *> *)uids
+{
+    return [self.userData.dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        return [self historyEntriesWithUids:uids inManagedObjectContext:managedObjectContext];
+    }];
+}
+
+- (NSString *)historyEntriesWithUids:(NSArray<NSString *> *)uids completionBlock:(void (^)(NSDictionary<NSString *, SRGHistoryEntry *> * _Nullable, NSError * _Nullable))completionBlock
+{
+    return [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        return [self historyEntriesWithUids:uids inManagedObjectContext:managedObjectContext];
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:completionBlock];
+}
+
+- (NSUInteger)historyEntryCountMatchingPredicate:(NSPredicate *)predicate
+{
+    NSNumber *count = [self.userData.dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        return @([self historyEntryCountMatchingPredicate:predicate inManagedObjectContext:managedObjectContext error:NULL]);
+    }];
+    return count.unsignedIntegerValue;
+}
+
+- (NSString *)historyEntryCountMatchingPredicate:(NSPredicate *)predicate completionBlock:(void (^)(NSUInteger, NSError * _Nullable))completionBlock
+{
+    __block NSError *countError = nil;
+    return [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        NSError *error = nil;
+        NSUInteger count = [self historyEntryCountMatchingPredicate:predicate inManagedObjectContext:managedObjectContext error:&error];
+        countError = error;
+        return @(count);
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSNumber * _Nullable count, NSError * _Nullable error) {
+        completionBlock(count.unsignedIntegerValue, error ?: countError);
+    }];
+}
+
+- (double)totalLastPlaybackPositionOfHistoryEntriesMatchingPredicate:(NSPredicate *)predicate
+{
+    NSNumber *total = [self.userData.dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        return @([self totalLastPlaybackPositionOfHistoryEntriesMatchingPredicate:predicate inManagedObjectContext:managedObjectContext error:NULL]);
+    }];
+    return total.doubleValue;
+}
+
+- (NSString *)totalLastPlaybackPositionOfHistoryEntriesMatchingPredicate:(NSPredicate *)predicate completionBlock:(void (^)(double, NSError * _Nullable))completionBlock
+{
+    __block NSError *totalError = nil;
+    return [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        NSError *error = nil;
+        double total = [self totalLastPlaybackPositionOfHistoryEntriesMatchingPredicate:predicate inManagedObjectContext:managedObjectContext error:&error];
+        totalError = error;
+        return @(total);
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSNumber * _Nullable total, NSError * _Nullable error) {
+        completionBlock(total.doubleValue, error ?: totalError);
+    }];
+}
+
 - (NSString *)saveHistoryEntryWithUid:(NSString *)uid lastPlaybackTime:(CMTime)lastPlaybackTime deviceUid:(NSString *)deviceUid completionBlock:(void (^)(NSError * _Nonnull))completionBlock
+{
+    __block NSString *handle = nil;
+    
+    // Decide and enqueue atomically, so that writes are applied in submission order
+    dispatch_sync(self.bufferQueue, ^{
+        if (self.playbackPositionFlushInterval <= 0. || ! [self.activeUids containsObject:uid]) {
+            [self.activeUids addObject:uid];
+            handle = [self writeHistoryEntryWithUid:uid lastPlaybackTime:lastPlaybackTime deviceUid:deviceUid completionBlock:completionBlock];
+            return;
+        }
+        
+        SRGHistoryBufferedUpdate *bufferedUpdate = self.bufferedUpdates[uid];
+        if (! bufferedUpdate) {
+            bufferedUpdate = [[SRGHistoryBufferedUpdate alloc] init];
+            self.bufferedUpdates[uid] = bufferedUpdate;
+        }
+        
+        handle = NSUUID.UUID.UUIDString;
+        bufferedUpdate.overlay = [[SRGHistoryEntryOverlay alloc] initWithLastPlaybackTime:lastPlaybackTime deviceUid:deviceUid date:NSDate.date];
+        bufferedUpdate.handle = handle;
+        [bufferedUpdate.handles addObject:handle];
+        bufferedUpdate.completionBlocks[handle] = ^(NSError *error) {
+            completionBlock ? completionBlock(error) : nil;
+        };
+        self.bufferedHandles[handle] = uid;
+        [self.overlayTable setOverlay:bufferedUpdate.overlay forUid:uid];
+        
+        [self scheduleFlush];
+    });
+    
+    return handle;
+}
+
+// Must be called on the buffer queue
+- (NSString *)writeHistoryEntryWithUid:(NSString *)uid lastPlaybackTime:(CMTime)lastPlaybackTime deviceUid:(NSString *)deviceUid completionBlock:(void (^)(NSError * _Nonnull))completionBlock
 {
     return [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
         SRGHistoryEntry *historyEntry = [SRGHistoryEntry upsertWithUid:uid matchingPredicate:nil inManagedObjectContext:managedObjectContext];
@@ -295,38 +767,91 @@ NSString * const SRGHistoryEntriesUidsKey = @"SRGHistoryEntriesUids";
         historyEntry.deviceUid = deviceUid;
     } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
         if (! error) {
-            dispatch_sync(dispatch_get_main_queue(), ^{
-                [NSNotificationCenter.defaultCenter postNotificationName:SRGHistoryEntriesDidChangeNotification
-                                                                  object:self
-                                                                userInfo:@{ SRGHistoryEntriesUidsKey : [NSSet setWithObject:uid] }];
-            });
+            [self.userData.notificationDispatcher postNotificationName:SRGHistoryEntriesDidChangeNotification
+                                                                object:self
+                                                              userInfo:@{ SRGHistoryEntriesUidsKey : [NSSet setWithObject:uid] }
+                                                  coalescingUidsForKey:SRGHistoryEntriesUidsKey];
         }
-        completionBlock ? completionBlock(error) : nil;
+        [self.userData.notificationDispatcher dispatchBlock:^{
+            completionBlock ? completionBlock(error) : nil;
+        }];
     }];
 }
 
 - (NSString *)discardHistoryEntriesWithUids:(NSArray<NSString *> *)uids completionBlock:(void (^)(NSError * _Nonnull))completionBlock
 {
     __block NSSet<NSString *> *changedUids = nil;
+    __block NSString *handle = nil;
     
-    return [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
-        NSArray<NSString *> *discardedUids = [SRGHistoryEntry discardObjectsWithUids:uids matchingPredicate:nil inManagedObjectContext:managedObjectContext];
-        changedUids = [NSSet setWithArray:discardedUids];
-    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
-        if (! error && changedUids.count > 0) {
-            dispatch_sync(dispatch_get_main_queue(), ^{
-                [NSNotificationCenter.defaultCenter postNotificationName:SRGHistoryEntriesDidChangeNotification
-                                                                  object:self
-                                                                userInfo:@{ SRGHistoryEntriesUidsKey : changedUids }];
-            });
+    // Buffered updates are superseded by the discard. Since the first update of an entry is always written immediately,
+    // the entry already exists in the store and will be discarded. Next updates are written immediately again.
+    dispatch_sync(self.bufferQueue, ^{
+        [self discardBufferedUpdatesWithUids:uids error:nil];
+        if (uids) {
+            [self.activeUids minusSet:[NSSet setWithArray:uids]];
         }
-        completionBlock ? completionBlock(error) : nil;
-    }];
+        else {
+            [self.activeUids removeAllObjects];
+        }
+        
+        handle = [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+            NSArray<NSString *> *discardedUids = [SRGHistoryEntry discardObjectsWithUids:uids matchingPredicate:nil inManagedObjectContext:managedObjectContext];
+            changedUids = [NSSet setWithArray:discardedUids];
+        } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+            if (! error && changedUids.count > 0) {
+                [self.userData.notificationDispatcher postNotificationName:SRGHistoryEntriesDidChangeNotification
+                                                                    object:self
+                                                                  userInfo:@{ SRGHistoryEntriesUidsKey : changedUids }
+                                                      coalescingUidsForKey:SRGHistoryEntriesUidsKey];
+            }
+            [self.userData.notificationDispatcher dispatchBlock:^{
+                completionBlock ? completionBlock(error) : nil;
+            }];
+        }];
+    });
+    
+    return handle;
 }
 
 - (void)cancelTaskWithHandle:(NSString *)handle
 {
-    [self.userData.dataStore cancelBackgroundTaskWithHandle:handle];
+    __block BOOL buffered = NO;
+    
+    dispatch_sync(self.bufferQueue, ^{
+        NSString *uid = self.bufferedHandles[handle];
+        if (! uid) {
+            return;
+        }
+        
+        buffered = YES;
+        
+        // Cancelling the most recent update of an entry also cancels the ones it replaced
+        SRGHistoryBufferedUpdate *bufferedUpdate = self.bufferedUpdates[uid];
+        if ([bufferedUpdate.handle isEqualToString:handle]) {
+            [self discardBufferedUpdatesWithUids:@[ uid ] error:SRGHistoryCancellationError()];
+        }
+        else {
+            void (^completionBlock)(NSError *) = bufferedUpdate.completionBlocks[handle];
+            [bufferedUpdate.handles removeObject:handle];
+            [bufferedUpdate.completionBlocks removeObjectForKey:handle];
+            [self.bufferedHandles removeObjectForKey:handle];
+            
+            [self.userData.notificationDispatcher dispatchBlock:^{
+                completionBlock(SRGHistoryCancellationError());
+            }];
+        }
+    });
+    
+    if (! buffered) {
+        [self.userData.dataStore cancelBackgroundTaskWithHandle:handle];
+    }
+}
+
+#pragma mark Notifications
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification
+{
+    [self flushPlaybackPositionsWithCompletionBlock:nil];
 }
 
 @end
@@ -5,6 +5,7 @@
 //
 
 #import "SRGHistoryEntry.h"
+#import "SRGHistoryEntryOverlay.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -19,6 +20,13 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic) CMTime lastPlaybackTime;
 @property (nonatomic, copy) NSString *deviceUid;
 
+/**
+ *  Attach an overlay table to a managed object context. History entries read from this context then reflect the
+ *  overlay matching their uid, if any, in place of the playback position, device identifier and date saved in the
+ *  store. Must be called from the context queue.
+ */
++ (void)setOverlayTable:(nullable SRGHistoryEntryOverlayTable *)overlayTable forManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -4,17 +4,21 @@
 //  License information is available from the LICENSE file.
 //
 
-#import "SRGHistoryEntry.h"
+#import "SRGHistoryEntry+Private.h"
 
 #import "SRGUserObject+Subclassing.h"
 
 @import libextobjc;
 
+static NSString * const SRGHistoryEntryOverlayTableKey = @"SRGHistoryEntryOverlayTable";
+
 @interface SRGHistoryEntry ()
 
 @property (nonatomic) double lastPlaybackPosition;
 @property (nonatomic, copy) NSString *deviceUid;
 
+@property (nonatomic, readonly) SRGHistoryEntryOverlay *overlay;
+
 @end
 
 @implementation SRGHistoryEntry
@@ -22,8 +26,69 @@
 @dynamic lastPlaybackPosition;
 @dynamic deviceUid;
 
+#pragma mark Class methods
+
++ (void)setOverlayTable:(SRGHistoryEntryOverlayTable *)overlayTable forManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    managedObjectContext.userInfo[SRGHistoryEntryOverlayTableKey] = overlayTable;
+}
+
 #pragma mark Getters and Setters
 
+- (double)lastPlaybackPosition
+{
+    SRGHistoryEntryOverlay *overlay = self.overlay;
+    if (overlay) {
+        return CMTimeGetSeconds(overlay.lastPlaybackTime);
+    }
+    
+    NSString *key = @keypath(SRGHistoryEntry.new, lastPlaybackPosition);
+    [self willAccessValueForKey:key];
+    NSNumber *lastPlaybackPosition = [self primitiveValueForKey:key];
+    [self didAccessValueForKey:key];
+    return lastPlaybackPosition.doubleValue;
+}
+
+- (NSString *)deviceUid
+{
+    SRGHistoryEntryOverlay *overlay = self.overlay;
+    if (overlay) {
+        return overlay.deviceUid;
+    }
+    
+    NSString *key = @keypath(SRGHistoryEntry.new, deviceUid);
+    [self willAccessValueForKey:key];
+    NSString *deviceUid = [self primitiveValueForKey:key];
+    [self didAccessValueForKey:key];
+    return deviceUid;
+}
+
+- (NSDate *)date
+{
+    SRGHistoryEntryOverlay *overlay = self.overlay;
+    if (overlay) {
+        return overlay.date;
+    }
+    
+    NSString *key = @keypath(SRGHistoryEntry.new, date);
+    [self willAccessValueForKey:key];
+    NSDate *date = [self primitiveValueForKey:key];
+    [self didAccessValueForKey:key];
+    return date;
+}
+
+- (SRGHistoryEntryOverlay *)overlay
+{
+    // Only read contexts have an overlay table attached. Entries in other contexts always reflect saved values.
+    SRGHistoryEntryOverlayTable *overlayTable = self.managedObjectContext.userInfo[SRGHistoryEntryOverlayTableKey];
+    if (! overlayTable) {
+        return nil;
+    }
+    
+    NSString *uid = self.uid;
+    return uid ? [overlayTable overlayForUid:uid] : nil;
+}
+
 - (CMTime)lastPlaybackTime
 {
     return CMTimeMakeWithSeconds(self.lastPlaybackPosition, NSEC_PER_SEC);
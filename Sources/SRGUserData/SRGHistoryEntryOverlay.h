@@ -0,0 +1,67 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+@import CoreMedia;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Playback information saved for a history entry but not written to the store yet. Immutable.
+ */
+@interface SRGHistoryEntryOverlay : NSObject
+
+/**
+ *  Create an overlay with the specified values.
+ */
+- (instancetype)initWithLastPlaybackTime:(CMTime)lastPlaybackTime deviceUid:(nullable NSString *)deviceUid date:(NSDate *)date;
+
+/**
+ *  Values reflected by history entries in place of the ones saved in the store.
+ */
+@property (nonatomic, readonly) CMTime lastPlaybackTime;
+@property (nonatomic, readonly, copy, nullable) NSString *deviceUid;
+@property (nonatomic, readonly) NSDate *date;
+
+@end
+
+@interface SRGHistoryEntryOverlay (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/**
+ *  Overlays of history entries, by uid. Entries read from a managed object context the table has been attached to
+ *  reflect the overlay matching their uid, if any, without any change being made to the context. All methods are
+ *  thread-safe.
+ */
+@interface SRGHistoryEntryOverlayTable : NSObject
+
+/**
+ *  Return the overlay for the specified uid, if any.
+ */
+- (nullable SRGHistoryEntryOverlay *)overlayForUid:(NSString *)uid;
+
+/**
+ *  Set the overlay for the specified uid, replacing any existing one.
+ */
+- (void)setOverlay:(SRGHistoryEntryOverlay *)overlay forUid:(NSString *)uid;
+
+/**
+ *  Remove the overlay for the specified uid, provided it has not been replaced in the meantime.
+ */
+- (void)removeOverlay:(SRGHistoryEntryOverlay *)overlay forUid:(NSString *)uid;
+
+/**
+ *  Remove overlays for the specified uids, or all overlays if `uids` is `nil`.
+ */
+- (void)removeOverlaysForUids:(nullable NSArray<NSString *> *)uids;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,88 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGHistoryEntryOverlay.h"
+
+@interface SRGHistoryEntryOverlay ()
+
+@property (nonatomic) CMTime lastPlaybackTime;
+@property (nonatomic, copy) NSString *deviceUid;
+@property (nonatomic) NSDate *date;
+
+@end
+
+@implementation SRGHistoryEntryOverlay
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithLastPlaybackTime:(CMTime)lastPlaybackTime deviceUid:(NSString *)deviceUid date:(NSDate *)date
+{
+    if (self = [super init]) {
+        self.lastPlaybackTime = lastPlaybackTime;
+        self.deviceUid = deviceUid;
+        self.date = date;
+    }
+    return self;
+}
+
+@end
+
+@interface SRGHistoryEntryOverlayTable ()
+
+@property (nonatomic) NSMutableDictionary<NSString *, SRGHistoryEntryOverlay *> *overlays;
+
+@end
+
+@implementation SRGHistoryEntryOverlayTable
+
+#pragma mark Object lifecycle
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        self.overlays = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+#pragma mark Overlays
+
+- (SRGHistoryEntryOverlay *)overlayForUid:(NSString *)uid
+{
+    @synchronized(self) {
+        return self.overlays[uid];
+    }
+}
+
+- (void)setOverlay:(SRGHistoryEntryOverlay *)overlay forUid:(NSString *)uid
+{
+    @synchronized(self) {
+        self.overlays[uid] = overlay;
+    }
+}
+
+- (void)removeOverlay:(SRGHistoryEntryOverlay *)overlay forUid:(NSString *)uid
+{
+    @synchronized(self) {
+        if (self.overlays[uid] == overlay) {
+            [self.overlays removeObjectForKey:uid];
+        }
+    }
+}
+
+- (void)removeOverlaysForUids:(NSArray<NSString *> *)uids
+{
+    @synchronized(self) {
+        if (uids) {
+            [self.overlays removeObjectsForKeys:uids];
+        }
+        else {
+            [self.overlays removeAllObjects];
+        }
+    }
+}
+
+@end
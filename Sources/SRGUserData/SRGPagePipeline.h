@@ -0,0 +1,57 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Block signatures.
+typedef void (^SRGPagePipelineFetchCompletionBlock)(NSArray<NSDictionary *> * _Nullable dictionaries, NSDate * _Nullable serverDate, id _Nullable nextPage, NSError * _Nullable error);
+typedef void (^SRGPagePipelineFetchBlock)(id _Nullable page, SRGPagePipelineFetchCompletionBlock completionBlock);
+typedef void (^SRGPagePipelineSaveCompletionBlock)(NSError * _Nullable error);
+typedef void (^SRGPagePipelineSaveBlock)(NSArray<NSDictionary *> *dictionaries, SRGPagePipelineSaveCompletionBlock completionBlock);
+
+/**
+ *  Pull of a paginated list of dictionaries, requesting the next page while the current one is being saved.
+ *
+ *  The number of pages received but not saved yet never exceeds the prefetch depth. Pages are submitted for saving
+ *  in the order they are received, and the pipeline only completes successfully once all of them have been saved.
+ */
+@interface SRGPagePipeline : NSObject
+
+/**
+ *  Create a pipeline.
+ *
+ *  @param prefetchDepth The maximum number of pages pending save (at least 1, which disables prefetching).
+ *  @param fetchBlock    Block fetching the specified page (`nil` for the first one), calling its completion block
+ *                       when done. At most one page is fetched at a time.
+ *  @param saveBlock     Block saving the dictionaries of a page, calling its completion block when done. Saves are
+ *                       submitted in page order.
+ */
+- (instancetype)initWithPrefetchDepth:(NSUInteger)prefetchDepth
+                           fetchBlock:(SRGPagePipelineFetchBlock)fetchBlock
+                            saveBlock:(SRGPagePipelineSaveBlock)saveBlock;
+
+/**
+ *  Start the pipeline. The completion block is called once, either with the server date received with the last page
+ *  after all pages have been saved, or with the first error encountered.
+ */
+- (void)startWithCompletionBlock:(void (^)(NSDate * _Nullable serverDate, NSError * _Nullable error))completionBlock;
+
+/**
+ *  Stop fetching pages and complete with a cancellation error. Saves already submitted are not cancelled.
+ */
+- (void)cancel;
+
+@end
+
+@interface SRGPagePipeline (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,176 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPagePipeline.h"
+
+#import "NSBundle+SRGUserData.h"
+#import "SRGUserDataError.h"
+
+@interface SRGPagePipeline ()
+
+@property (nonatomic) NSUInteger prefetchDepth;
+
+@property (nonatomic, copy) SRGPagePipelineFetchBlock fetchBlock;
+@property (nonatomic, copy) SRGPagePipelineSaveBlock saveBlock;
+@property (nonatomic, copy) void (^completionBlock)(NSDate * _Nullable serverDate, NSError * _Nullable error);
+
+@property (nonatomic) NSUInteger pendingSaveCount;
+@property (nonatomic) id deferredPage;
+@property (nonatomic, getter=isLastPageReceived) BOOL lastPageReceived;
+@property (nonatomic) NSDate *serverDate;
+@property (nonatomic, getter=isFinished) BOOL finished;
+
+@property (nonatomic) dispatch_queue_t queue;
+
+@end
+
+@implementation SRGPagePipeline
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithPrefetchDepth:(NSUInteger)prefetchDepth fetchBlock:(SRGPagePipelineFetchBlock)fetchBlock saveBlock:(SRGPagePipelineSaveBlock)saveBlock
+{
+    NSParameterAssert(fetchBlock);
+    NSParameterAssert(saveBlock);
+    
+    if (self = [super init]) {
+        self.prefetchDepth = MAX(prefetchDepth, 1);
+        self.fetchBlock = fetchBlock;
+        self.saveBlock = saveBlock;
+        self.queue = dispatch_queue_create("ch.srgssr.userdata.pagepipeline", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+#pragma mark Pipeline
+
+- (void)startWithCompletionBlock:(void (^)(NSDate * _Nullable, NSError * _Nullable))completionBlock
+{
+    NSParameterAssert(completionBlock);
+    
+    dispatch_async(self.queue, ^{
+        NSAssert(! self.completionBlock && ! self.finished, @"A pipeline can only be started once");
+        
+        self.completionBlock = completionBlock;
+        [self fetchPage:nil];
+    });
+}
+
+- (void)cancel
+{
+    dispatch_async(self.queue, ^{
+        NSError *error = [NSError errorWithDomain:SRGUserDataErrorDomain
+                                             code:SRGUserDataErrorCancelled
+                                         userInfo:@{ NSLocalizedDescriptionKey : SRGUserDataLocalizedString(@"The operation has been cancelled", @"Error message returned when an operation has been cancelled") }];
+        [self finishWithServerDate:nil error:error];
+    });
+}
+
+// Must be called on the pipeline queue
+- (void)fetchPage:(id)page
+{
+    if (self.finished) {
+        return;
+    }
+    
+    // The same completion block is used for all pages. Only one page is fetched at a time.
+    self.fetchBlock(page, ^(NSArray<NSDictionary *> * _Nullable dictionaries, NSDate * _Nullable serverDate, id _Nullable nextPage, NSError * _Nullable error) {
+        dispatch_async(self.queue, ^{
+            [self receiveDictionaries:dictionaries serverDate:serverDate nextPage:nextPage error:error];
+        });
+    });
+}
+
+// Must be called on the pipeline queue
+- (void)receiveDictionaries:(NSArray<NSDictionary *> *)dictionaries serverDate:(NSDate *)serverDate nextPage:(id)nextPage error:(NSError *)error
+{
+    if (self.finished) {
+        return;
+    }
+    
+    if (error) {
+        [self finishWithServerDate:nil error:error];
+        return;
+    }
+    
+    self.pendingSaveCount += 1;
+    
+    // Back-pressure: only fetch the next page if the number of pages waiting to be saved allows it. Otherwise the
+    // fetch resumes as soon as a save completes.
+    if (nextPage) {
+        if (self.pendingSaveCount < self.prefetchDepth) {
+            [self fetchPage:nextPage];
+        }
+        else {
+            self.deferredPage = nextPage;
+        }
+    }
+    else {
+        self.lastPageReceived = YES;
+        self.serverDate = serverDate;
+    }
+    
+    self.saveBlock(dictionaries ?: @[], ^(NSError * _Nullable error) {
+        dispatch_async(self.queue, ^{
+            [self saveDidCompleteWithError:error];
+        });
+    });
+}
+
+// Must be called on the pipeline queue
+- (void)saveDidCompleteWithError:(NSError *)error
+{
+    if (self.finished) {
+        return;
+    }
+    
+    if (error) {
+        [self finishWithServerDate:nil error:error];
+        return;
+    }
+    
+    self.pendingSaveCount -= 1;
+    
+    if (self.deferredPage) {
+        id page = self.deferredPage;
+        self.deferredPage = nil;
+        [self fetchPage:page];
+    }
+    else if (self.lastPageReceived && self.pendingSaveCount == 0) {
+        [self finishWithServerDate:self.serverDate error:nil];
+    }
+}
+
+// Must be called on the pipeline queue
+- (void)finishWithServerDate:(NSDate *)serverDate error:(NSError *)error
+{
+    if (self.finished) {
+        return;
+    }
+    
+    self.finished = YES;
+    self.deferredPage = nil;
+    
+    // Release blocks, which might retain the pipeline
+    self.fetchBlock = nil;
+    self.saveBlock = nil;
+    
+    void (^completionBlock)(NSDate *, NSError *) = self.completionBlock;
+    self.completionBlock = nil;
+    completionBlock ? completionBlock(serverDate, error) : nil;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; prefetchDepth = %@>",
+            self.class,
+            self,
+            @(self.prefetchDepth)];
+}
+
+@end
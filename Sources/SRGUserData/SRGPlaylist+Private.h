@@ -19,7 +19,11 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, copy) NSString *name;
 @property (nonatomic) SRGPlaylistType type;
 
-@property (nonatomic, nullable) NSOrderedSet<SRGPlaylistEntry *> *entries;
+/**
+ *  The entries of the playlist, in no specific order. Prefer fetching entries matching the playlist, which uses an index,
+ *  to faulting in the whole relationship.
+ */
+@property (nonatomic, nullable) NSSet<SRGPlaylistEntry *> *entries;
 
 @end
 
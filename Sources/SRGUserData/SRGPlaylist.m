@@ -32,7 +32,7 @@ SRGPlaylistUid const SRGPlaylistUidWatchLater = @"watch_later";
 @property (nonatomic, copy) NSString *name;
 @property (nonatomic) SRGPlaylistType type;
 
-@property (nonatomic) NSOrderedSet<SRGPlaylistEntry *> *entries;
+@property (nonatomic) NSSet<SRGPlaylistEntry *> *entries;
 
 @end
 
@@ -0,0 +1,71 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Block signatures.
+typedef void (^SRGPlaylistMembershipIndexLoaderCompletionBlock)(NSDictionary<NSString *, NSSet<NSString *> *> * _Nullable playlistUids);
+typedef void (^SRGPlaylistMembershipIndexLoader)(SRGPlaylistMembershipIndexLoaderCompletionBlock completionBlock);
+
+/**
+ *  In-memory index of the playlists containing each (non-discarded) entry uid.
+ *
+ *  The index is loaded in the background or, if not available yet, when first accessed, then kept current by applying
+ *  changes once they have been saved to the store. All methods are thread-safe.
+ */
+@interface SRGPlaylistMembershipIndex : NSObject
+
+/**
+ *  Create an index.
+ *
+ *  @param loader Block reading the uids of the playlists containing each entry uid, as currently saved, and calling the
+ *                completion block with them (from any thread), or with `nil` if they could not be read. Called once,
+ *                or again on next access after a failure. Must not wait for the index itself.
+ */
+- (instancetype)initWithLoader:(SRGPlaylistMembershipIndexLoader)loader;
+
+/**
+ *  Load the index in the background. Accessing the index before it has been loaded waits for loading to complete.
+ */
+- (void)loadInBackground;
+
+/**
+ *  Return the uids of the playlists containing an entry with the specified uid.
+ */
+- (NSSet<NSString *> *)playlistUidsContainingEntryWithUid:(NSString *)uid;
+
+/**
+ *  Return the uids of the playlists containing entries with the specified uids, by entry uid. Entries not contained in
+ *  any playlist are omitted.
+ */
+- (NSDictionary<NSString *, NSSet<NSString *> *> *)playlistUidsContainingEntriesWithUids:(NSArray<NSString *> *)uids;
+
+/**
+ *  Record that entries have been added to a playlist.
+ */
+- (void)addEntriesWithUids:(NSSet<NSString *> *)uids toPlaylistWithUid:(NSString *)playlistUid;
+
+/**
+ *  Record that entries have been removed from a playlist.
+ */
+- (void)removeEntriesWithUids:(NSSet<NSString *> *)uids fromPlaylistWithUid:(NSString *)playlistUid;
+
+/**
+ *  Record that all entries have been removed.
+ */
+- (void)removeAllEntries;
+
+@end
+
+@interface SRGPlaylistMembershipIndex (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
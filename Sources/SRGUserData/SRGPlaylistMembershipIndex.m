@@ -0,0 +1,185 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPlaylistMembershipIndex.h"
+
+// Block signatures.
+typedef void (^SRGPlaylistMembershipIndexChange)(NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *playlistUids);
+
+@interface SRGPlaylistMembershipIndex ()
+
+@property (nonatomic, copy) SRGPlaylistMembershipIndexLoader loader;
+@property (nonatomic) dispatch_group_t loadGroup;
+
+// Playlist uids by entry uid, `nil` until loaded
+@property (nonatomic) NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *playlistUids;
+
+// Changes recorded while the index is being loaded, `nil` otherwise
+@property (nonatomic) NSMutableArray<SRGPlaylistMembershipIndexChange> *pendingChanges;
+
+@end
+
+@implementation SRGPlaylistMembershipIndex
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithLoader:(SRGPlaylistMembershipIndexLoader)loader
+{
+    NSParameterAssert(loader);
+    
+    if (self = [super init]) {
+        self.loader = loader;
+        self.loadGroup = dispatch_group_create();
+    }
+    return self;
+}
+
+#pragma mark Loading
+
+// The loader is called without the lock being held, so that the index can still record changes meanwhile. Changes
+// recorded during loading are replayed in order once loaded. Changes already read by the loader are replayed as well,
+// which is harmless since they are idempotent and the order is preserved. If loading fails, recorded changes are
+// dropped, as they will be read from the store by the next attempt.
+- (void)loadInBackground
+{
+    @synchronized(self) {
+        if (self.playlistUids || self.pendingChanges) {
+            return;
+        }
+        self.pendingChanges = [NSMutableArray array];
+        dispatch_group_enter(self.loadGroup);
+    }
+    
+    self.loader(^(NSDictionary<NSString *, NSSet<NSString *> *> * _Nullable savedPlaylistUids) {
+        NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *playlistUids = nil;
+        if (savedPlaylistUids) {
+            playlistUids = [NSMutableDictionary dictionaryWithCapacity:savedPlaylistUids.count];
+            [savedPlaylistUids enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull uid, NSSet<NSString *> * _Nonnull uidPlaylistUids, BOOL * _Nonnull stop) {
+                playlistUids[uid] = uidPlaylistUids.mutableCopy;
+            }];
+        }
+        
+        @synchronized(self) {
+            if (playlistUids) {
+                for (SRGPlaylistMembershipIndexChange change in self.pendingChanges) {
+                    change(playlistUids);
+                }
+                self.playlistUids = playlistUids;
+            }
+            self.pendingChanges = nil;
+        }
+        
+        dispatch_group_leave(self.loadGroup);
+    });
+}
+
+// Must not be called within a synchronized block
+- (void)loadIfNeeded
+{
+    [self loadInBackground];
+    dispatch_group_wait(self.loadGroup, DISPATCH_TIME_FOREVER);
+}
+
+// Must be called within a synchronized block. Changes made while the index is neither loaded nor being loaded are
+// ignored, as they are read from the store when loading.
+- (void)applyChange:(SRGPlaylistMembershipIndexChange)change
+{
+    if (self.playlistUids) {
+        change(self.playlistUids);
+    }
+    else if (self.pendingChanges) {
+        [self.pendingChanges addObject:change];
+    }
+}
+
+#pragma mark Index
+
+- (NSSet<NSString *> *)playlistUidsContainingEntryWithUid:(NSString *)uid
+{
+    [self loadIfNeeded];
+    
+    @synchronized(self) {
+        return [self.playlistUids[uid] copy] ?: [NSSet set];
+    }
+}
+
+- (NSDictionary<NSString *,NSSet<NSString *> *> *)playlistUidsContainingEntriesWithUids:(NSArray<NSString *> *)uids
+{
+    [self loadIfNeeded];
+    
+    @synchronized(self) {
+        NSMutableDictionary<NSString *, NSSet<NSString *> *> *playlistUids = [NSMutableDictionary dictionary];
+        for (NSString *uid in uids) {
+            NSSet<NSString *> *uidPlaylistUids = self.playlistUids[uid];
+            if (uidPlaylistUids) {
+                playlistUids[uid] = uidPlaylistUids.copy;
+            }
+        }
+        return playlistUids.copy;
+    }
+}
+
+- (void)addEntriesWithUids:(NSSet<NSString *> *)uids toPlaylistWithUid:(NSString *)playlistUid
+{
+    @synchronized(self) {
+        [self applyChange:^(NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *playlistUids) {
+            for (NSString *uid in uids) {
+                NSMutableSet<NSString *> *uidPlaylistUids = playlistUids[uid];
+                if (uidPlaylistUids) {
+                    [uidPlaylistUids addObject:playlistUid];
+                }
+                else {
+                    playlistUids[uid] = [NSMutableSet setWithObject:playlistUid];
+                }
+            }
+        }];
+    }
+}
+
+- (void)removeEntriesWithUids:(NSSet<NSString *> *)uids fromPlaylistWithUid:(NSString *)playlistUid
+{
+    @synchronized(self) {
+        [self applyChange:^(NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *playlistUids) {
+            for (NSString *uid in uids) {
+                NSMutableSet<NSString *> *uidPlaylistUids = playlistUids[uid];
+                [uidPlaylistUids removeObject:playlistUid];
+                if (uidPlaylistUids.count == 0) {
+                    [playlistUids removeObjectForKey:uid];
+                }
+            }
+        }];
+    }
+}
+
+- (void)removeAllEntries
+{
+    @synchronized(self) {
+        // Nothing needs to be loaded anymore
+        if (! self.playlistUids && ! self.pendingChanges) {
+            self.playlistUids = [NSMutableDictionary dictionary];
+            return;
+        }
+        
+        [self applyChange:^(NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *playlistUids) {
+            [playlistUids removeAllObjects];
+        }];
+    }
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    @synchronized(self) {
+        return [NSString stringWithFormat:@"<%@: %p; loaded = %@; entries = %@>",
+                self.class,
+                self,
+                self.playlistUids ? @"YES" : @"NO",
+                @(self.playlistUids.count)];
+    }
+}
+
+@end
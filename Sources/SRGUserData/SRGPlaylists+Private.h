@@ -0,0 +1,23 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPlaylists.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Private interface for implementation purposes.
+ */
+@interface SRGPlaylists (Private)
+
+/**
+ *  The maximum number of playlist requests running at the same time during synchronization. Default is 4.
+ */
+@property (nonatomic) NSUInteger maximumConcurrentRequestCount;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -4,7 +4,7 @@
 //  License information is available from the LICENSE file.
 //
 
-#import "SRGPlaylists.h"
+#import "SRGPlaylists+Private.h"
 
 #import "NSArray+SRGUserData.h"
 #import "NSBundle+SRGUserData.h"
@@ -12,10 +12,13 @@
 #import "SRGDataStore.h"
 #import "SRGPlaylist+Private.h"
 #import "SRGPlaylistEntry+Private.h"
+#import "SRGPlaylistMembershipIndex.h"
 #import "SRGPlaylistsRequest.h"
+#import "SRGRequestScheduler.h"
 #import "SRGUser+Private.h"
 #import "SRGUserData+Private.h"
 #import "SRGUserDataError.h"
+#import "SRGUserDataLogger.h"
 #import "SRGUserDataService+Private.h"
 #import "SRGUserDataService+Subclassing.h"
 #import "SRGUserObject+Private.h"
@@ -58,7 +61,11 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
 @interface SRGPlaylists ()
 
 @property (nonatomic, weak) SRGRequest *pullPlaylistsRequest;
-@property (nonatomic) SRGRequestQueue *requestQueue;
+@property (nonatomic) SRGRequestScheduler *requestScheduler;
+
+@property (nonatomic) NSUInteger maximumConcurrentRequestCount;
+
+@property (nonatomic) SRGPlaylistMembershipIndex *membershipIndex;
 
 @property (nonatomic) NSURLSession *session;
 
@@ -73,6 +80,14 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
     if (self = [super initWithServiceURL:serviceURL userData:userData]) {
         NSURLSessionConfiguration *sessionConfiguration = [NSURLSessionConfiguration defaultSessionConfiguration];
         self.session = [NSURLSession sessionWithConfiguration:sessionConfiguration];
+        self.maximumConcurrentRequestCount = 4;
+        
+        @weakify(self)
+        self.membershipIndex = [[SRGPlaylistMembershipIndex alloc] initWithLoader:^(SRGPlaylistMembershipIndexLoaderCompletionBlock completionBlock) {
+            @strongify(self)
+            [self savedPlaylistMembershipsWithCompletionBlock:completionBlock];
+        }];
+        [self.membershipIndex loadInBackground];
         
         // Insert local objects for non-synchronizable default playlists (whose entries can be synchronized, though)
         NSArray<NSString *> *reservedUIds = SRGPlaylist.reservedUids;
@@ -85,117 +100,164 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
 
 #pragma mark Data
 
-- (void)savePlaylistDictionaries:(NSArray<NSDictionary *> *)playlistDictionaries withCompletionBlock:(void (^)(NSError *error))completionBlock
+// Save playlist dictionaries received from the service. A complete list describes the whole remote state, while an
+// incomplete list only contains playlists updated or deleted since the last synchronization. The completion block
+// receives the uids of the playlists whose remote modification date has changed.
+- (void)savePlaylistDictionaries:(NSArray<NSDictionary *> *)playlistDictionaries
+                        complete:(BOOL)complete
+             withCompletionBlock:(void (^)(NSSet<NSString *> *updatedUids, NSError *error))completionBlock
 {
     if (playlistDictionaries.count == 0) {
-        completionBlock(nil);
+        completionBlock([NSSet set], nil);
         return;
     }
     
+    NSMutableSet<NSString *> *updatedUids = [NSMutableSet set];
     NSMutableSet<NSString *> *changedUids = [NSMutableSet set];
     NSMutableDictionary<NSString *, NSSet<NSString *> *> *playlistEntriesUidsIndex = [NSMutableDictionary dictionary];
     
     [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
         NSArray<SRGPlaylist *> *previousPlaylists = [SRGPlaylist objectsMatchingPredicate:nil sortedWithDescriptors:nil inManagedObjectContext:managedObjectContext];
-        NSArray<NSDictionary *> *replacementPlaylistDictionaries = [SRGPlaylist dictionariesForObjects:previousPlaylists replacedWithDictionaries:playlistDictionaries];
         
-        if (replacementPlaylistDictionaries.count == 0) {
+        NSMutableDictionary<NSString *, NSDate *> *previousDates = [NSMutableDictionary dictionary];
+        for (SRGPlaylist *playlist in previousPlaylists) {
+            previousDates[playlist.uid] = playlist.date;
+        }
+        
+        for (NSDictionary *playlistDictionary in playlistDictionaries) {
+            NSString *uid = playlistDictionary[SRGPlaylist.uidKey];
+            if (! uid || [playlistDictionary[@"deleted"] boolValue]) {
+                continue;
+            }
+            
+            NSNumber *timestamp = playlistDictionary[@"date"];
+            NSDate *previousDate = previousDates[uid];
+            if (! timestamp || ! previousDate || timestamp.doubleValue != round(previousDate.timeIntervalSince1970 * 1000.)) {
+                [updatedUids addObject:uid];
+            }
+        }
+        
+        NSArray<NSDictionary *> *dictionaries = nil;
+        if (complete) {
+            SRGUserObjectReconciliation *reconciliation = [SRGPlaylist reconciliationForObjects:previousPlaylists withRemoteDictionaries:playlistDictionaries];
+            dictionaries = reconciliation.dictionaries;
+            [changedUids unionSet:reconciliation.changedUids];
+        }
+        else {
+            NSPredicate *predicate = [NSPredicate predicateWithFormat:@"NOT (%K IN %@)", SRGPlaylist.uidKey, SRGPlaylist.reservedUids];
+            dictionaries = [playlistDictionaries filteredArrayUsingPredicate:predicate];
+            [changedUids addObjectsFromArray:[dictionaries valueForKey:SRGPlaylist.uidKey]];
+        }
+        
+        if (dictionaries.count == 0) {
             return;
         }
         
-        for (NSDictionary *playlistDictionary in replacementPlaylistDictionaries) {
-            SRGPlaylist *playlist = [SRGPlaylist synchronizeWithDictionary:playlistDictionary matchingPredicate:nil inManagedObjectContext:managedObjectContext];
-            if (playlist) {
-                if (playlist.deleted) {
-                    NSArray<NSString *> *discardedEntriesUids = [playlist.entries.array valueForKeyPath:@keypath(SRGPlaylistEntry.new, uid)];
-                    if (discardedEntriesUids.count > 0) {
-                        playlistEntriesUidsIndex[playlist.uid] = [NSSet setWithArray:discardedEntriesUids];
-                    }
+        NSArray<SRGPlaylist *> *playlists = [SRGPlaylist synchronizeWithDictionaries:dictionaries matchingPredicate:nil inManagedObjectContext:managedObjectContext];
+        for (SRGPlaylist *playlist in playlists) {
+            if (playlist.deleted) {
+                NSSet<NSString *> *discardedEntriesUids = [playlist.entries valueForKeyPath:@keypath(SRGPlaylistEntry.new, uid)];
+                if (discardedEntriesUids.count > 0) {
+                    playlistEntriesUidsIndex[playlist.uid] = discardedEntriesUids;
                 }
-                [changedUids addObject:playlist.uid];
             }
         }
     } withPriority:NSOperationQueuePriorityLow completionBlock:^(NSError * _Nullable error) {
         if (! error && changedUids.count > 0) {
-            dispatch_sync(dispatch_get_main_queue(), ^{
-                [playlistEntriesUidsIndex enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull playlistUid, NSSet<NSString *> * _Nonnull playlistEntriesUids, BOOL * _Nonnull stop) {
-                    [NSNotificationCenter.defaultCenter postNotificationName:SRGPlaylistEntriesDidChangeNotification
-                                                                      object:self
-                                                                    userInfo:@{ SRGPlaylistUidKey : playlistUid,
-                                                                                SRGPlaylistEntriesUidsKey : playlistEntriesUids }];
-                }];
-                
-                [NSNotificationCenter.defaultCenter postNotificationName:SRGPlaylistsDidChangeNotification
-                                                                  object:self
-                                                                userInfo:@{ SRGPlaylistsUidsKey : changedUids.copy }];
-            });
+            [playlistEntriesUidsIndex enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull playlistUid, NSSet<NSString *> * _Nonnull playlistEntriesUids, BOOL * _Nonnull stop) {
+                [self.membershipIndex removeEntriesWithUids:playlistEntriesUids fromPlaylistWithUid:playlistUid];
+                [self.userData.notificationDispatcher postNotificationName:SRGPlaylistEntriesDidChangeNotification
+                                                                    object:self
+                                                                  userInfo:@{ SRGPlaylistUidKey : playlistUid,
+                                                                              SRGPlaylistEntriesUidsKey : playlistEntriesUids }
+                                                      coalescingUidsForKey:SRGPlaylistEntriesUidsKey];
+            }];
+            
+            [self.userData.notificationDispatcher postNotificationName:SRGPlaylistsDidChangeNotification
+                                                                object:self
+                                                              userInfo:@{ SRGPlaylistsUidsKey : changedUids.copy }
+                                                  coalescingUidsForKey:SRGPlaylistsUidsKey];
         }
-        completionBlock(error);
+        [self.userData.notificationDispatcher dispatchBlock:^{
+            completionBlock(updatedUids.copy, error);
+        }];
     }];
 }
 
-- (void)savePlaylistEntryDictionaries:(NSArray<NSDictionary *> *)playlistEntryDictionaries toPlaylistWithUid:(NSString *)playlistUid completionBlock:(void (^)(NSError *error))completionBlock
+// Synchronize playlist entry dictionaries received from the service, either as complete list or as updates (see above).
+// Return the uids of the entries which changed, `nil` if the playlist does not exist anymore. The uids of entries which
+// the playlist contains or not after synchronization are added to the specified sets.
+- (NSSet<NSString *> *)synchronizePlaylistEntryDictionaries:(NSArray<NSDictionary *> *)playlistEntryDictionaries
+                                                   complete:(BOOL)complete
+                                          inPlaylistWithUid:(NSString *)playlistUid
+                                     inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+                                           memberEntriesUids:(NSMutableSet<NSString *> *)memberEntriesUids
+                                        nonMemberEntriesUids:(NSMutableSet<NSString *> *)nonMemberEntriesUids
 {
-    __block BOOL playlistFound = NO;
+    SRGPlaylist *playlist = [SRGPlaylist objectWithUid:playlistUid matchingPredicate:nil inManagedObjectContext:managedObjectContext];
+    if (! playlist) {
+        return nil;
+    }
+    
     NSMutableSet<NSString *> *changedUids = [NSMutableSet set];
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %@", @keypath(SRGPlaylistEntry.new, playlist), playlist];
     
-    [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
-        SRGPlaylist *playlist = [SRGPlaylist objectWithUid:playlistUid matchingPredicate:nil inManagedObjectContext:managedObjectContext];
-        if (! playlist) {
-            return;
-        }
-        
-        playlistFound = YES;
-        
-        NSArray<SRGPlaylistEntry *> *previousPlaylistEntries = playlist.entries.array;
-        NSArray<NSDictionary *> *replacementPlaylistEntryDictionaries = [SRGPlaylistEntry dictionariesForObjects:previousPlaylistEntries replacedWithDictionaries:playlistEntryDictionaries];
-        if (replacementPlaylistEntryDictionaries.count == 0) {
-            return;
+    NSArray<NSDictionary *> *dictionaries = nil;
+    if (complete) {
+        NSArray<SRGPlaylistEntry *> *previousPlaylistEntries = [SRGPlaylistEntry objectsMatchingPredicate:predicate sortedWithDescriptors:nil inManagedObjectContext:managedObjectContext];
+        SRGUserObjectReconciliation *reconciliation = [SRGPlaylistEntry reconciliationForObjects:previousPlaylistEntries withRemoteDictionaries:playlistEntryDictionaries];
+        dictionaries = reconciliation.dictionaries;
+        [changedUids unionSet:reconciliation.changedUids];
+    }
+    else {
+        dictionaries = playlistEntryDictionaries;
+        [changedUids addObjectsFromArray:[dictionaries valueForKey:SRGPlaylistEntry.uidKey]];
+    }
+    
+    if (dictionaries.count == 0) {
+        return changedUids.copy;
+    }
+    
+    NSArray<SRGPlaylistEntry *> *playlistEntries = [SRGPlaylistEntry synchronizeWithDictionaries:dictionaries matchingPredicate:predicate inManagedObjectContext:managedObjectContext];
+    for (SRGPlaylistEntry *playlistEntry in playlistEntries) {
+        if (playlistEntry.inserted) {
+            playlistEntry.playlist = playlist;
         }
         
-        NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %@", @keypath(SRGPlaylistEntry.new, playlist.uid), playlistUid];
-        for (NSDictionary *playlistEntryDictionary in replacementPlaylistEntryDictionaries) {
-            SRGPlaylistEntry *playlistEntry = [SRGPlaylistEntry synchronizeWithDictionary:playlistEntryDictionary matchingPredicate:predicate inManagedObjectContext:managedObjectContext];
-            if (playlistEntry) {
-                if (playlistEntry.inserted) {
-                    playlistEntry.playlist = playlist;
-                }
-                [changedUids addObject:playlistEntry.uid];
-            }
+        if (playlistEntry.deleted || playlistEntry.discarded) {
+            [nonMemberEntriesUids addObject:playlistEntry.uid];
         }
-    } withPriority:NSOperationQueuePriorityLow completionBlock:^(NSError * _Nullable error) {
-        if (! playlistFound) {
-            error = [NSError errorWithDomain:SRGUserDataErrorDomain
-                                        code:SRGUserDataErrorNotFound
-                                    userInfo:@{ NSLocalizedDescriptionKey : SRGUserDataLocalizedString(@"The playlist does not exist", @"Error message returned when removing some entries from an unknown playlist.") }];
+        else {
+            [memberEntriesUids addObject:playlistEntry.uid];
         }
-        else if (! error && changedUids.count > 0) {
-            dispatch_sync(dispatch_get_main_queue(), ^{
-                [NSNotificationCenter.defaultCenter postNotificationName:SRGPlaylistEntriesDidChangeNotification
-                                                                  object:self
-                                                                userInfo:@{ SRGPlaylistUidKey : playlistUid,
-                                                                            SRGPlaylistEntriesUidsKey : changedUids }];
-            });
-        }
-        completionBlock ? completionBlock(error) : nil;
-    }];
+    }
+    return changedUids.copy;
 }
 
 #pragma mark Requests
 
+// The completion block receives the uids of the playlists whose entries must be pulled, `nil` if entries of all
+// playlists must be pulled, as well as the server date to use for the next synchronization, if any.
 - (void)pullPlaylistsForSessionToken:(NSString *)sessionToken
-                 withCompletionBlock:(void (^)(NSError *error))completionBlock
+                           afterDate:(NSDate *)date
+                 withCompletionBlock:(void (^)(NSSet<NSString *> *updatedUids, NSDate *serverDate, NSError *error))completionBlock
 {
     NSParameterAssert(sessionToken);
     NSParameterAssert(completionBlock);
     
-    SRGRequest *request = [[SRGPlaylistsRequest playlistsFromServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:^(NSArray<NSDictionary *> * _Nullable playlistDictionaries, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
+    SRGRequest *request = [[SRGPlaylistsRequest playlistUpdatesFromServiceURL:self.serviceURL forSessionToken:sessionToken afterDate:date withSession:self.session completionBlock:^(NSArray<NSDictionary *> * _Nullable playlistDictionaries, NSDate * _Nullable serverDate, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
         if (error) {
-            completionBlock(error);
+            completionBlock(nil, nil, error);
             return;
         }
         
-        [self savePlaylistDictionaries:playlistDictionaries withCompletionBlock:completionBlock];
+        // Services which do not support updates always return the complete list
+        BOOL complete = ! date || ! serverDate;
+        [self savePlaylistDictionaries:playlistDictionaries complete:complete withCompletionBlock:^(NSSet<NSString *> *updatedUids, NSError *error) {
+            // Entries of all playlists must be pulled when synchronizing for the first time, or when the service does
+            // not support updates
+            completionBlock((date && serverDate) ? updatedUids : nil, serverDate, error);
+        }];
     }] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled | SRGRequestOptionCancellationErrorsEnabled];
     [request resume];
     self.pullPlaylistsRequest = request;
@@ -217,76 +279,117 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
         return;
     }
     
-    self.requestQueue = [[[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
-        if (finished) {
-            completionBlock(error);
-        }
-    }] requestQueueWithOptions:SRGRequestQueueOptionAutomaticCancellationOnErrorEnabled];
+    SRGRequestScheduler *requestScheduler = [[SRGRequestScheduler alloc] initWithDataStore:self.userData.dataStore maximumConcurrentRequestCount:self.maximumConcurrentRequestCount];
     
     for (SRGPlaylist *playlist in playlists) {
         NSManagedObjectID *playlistID = playlist.objectID;
         
         if (playlist.discarded) {
-            SRGRequest *deleteRequest = [[SRGPlaylistsRequest deletePlaylistWithUid:playlist.uid fromServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:^(NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
-                [self.requestQueue reportError:error];
-                
-                if (! error) {
-                    [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+            NSString *playlistUid = playlist.uid;
+            [requestScheduler addRequestWithBlock:^SRGRequest * _Nullable(SRGRequestSchedulerResultBlock _Nonnull resultBlock) {
+                return [[SRGPlaylistsRequest deletePlaylistWithUid:playlistUid fromServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:^(NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
+                    if (error) {
+                        resultBlock(nil, nil, error);
+                        return;
+                    }
+                    
+                    resultBlock(^(NSManagedObjectContext * _Nonnull managedObjectContext) {
                         SRGPlaylist *playlist = [managedObjectContext existingObjectWithID:playlistID error:NULL];
-                        [managedObjectContext deleteObject:playlist];
-                    } withPriority:NSOperationQueuePriorityLow completionBlock:nil];
-                }
-            }] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled | SRGRequestOptionCancellationErrorsEnabled];
-            [self.requestQueue addRequest:deleteRequest resume:YES];
+                        if (playlist) {
+                            [managedObjectContext deleteObject:playlist];
+                        }
+                    }, nil, nil);
+                }] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled | SRGRequestOptionCancellationErrorsEnabled];
+            }];
         }
         else {
-            SRGRequest *postRequest = [[SRGPlaylistsRequest postPlaylistDictionary:playlist.dictionary toServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:^(NSDictionary * _Nullable playlistDictionary, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
-                [self.requestQueue reportError:error];
-                
-                if (! error) {
-                    [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+            NSDictionary *playlistDictionary = playlist.dictionary;
+            [requestScheduler addRequestWithBlock:^SRGRequest * _Nullable(SRGRequestSchedulerResultBlock _Nonnull resultBlock) {
+                return [[SRGPlaylistsRequest postPlaylistDictionary:playlistDictionary toServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:^(NSDictionary * _Nullable playlistDictionary, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
+                    if (error) {
+                        resultBlock(nil, nil, error);
+                        return;
+                    }
+                    
+                    resultBlock(^(NSManagedObjectContext * _Nonnull managedObjectContext) {
                         SRGPlaylist *playlist = [managedObjectContext existingObjectWithID:playlistID error:NULL];
                         [playlist updateWithDictionary:playlistDictionary];
                         playlist.dirty = NO;
-                    } withPriority:NSOperationQueuePriorityLow completionBlock:nil];
-                }
-            }] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled | SRGRequestOptionCancellationErrorsEnabled];
-            [self.requestQueue addRequest:postRequest resume:YES];
+                    }, nil, nil);
+                }] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled | SRGRequestOptionCancellationErrorsEnabled];
+            }];
         }
     }
+    
+    [requestScheduler startWithCompletionBlock:completionBlock];
+    self.requestScheduler = requestScheduler;
 }
 
+// Pull entries of the playlists with the specified uids (all playlists if `nil`)
 - (void)pullPlaylistEntriesForSessionToken:(NSString *)sessionToken
+                      forPlaylistsWithUids:(NSSet<NSString *> *)playlistUids
+                                 afterDate:(NSDate *)date
                        withCompletionBlock:(void (^)(NSError *error))completionBlock
 {
     NSParameterAssert(sessionToken);
     NSParameterAssert(completionBlock);
     
+    if (playlistUids && playlistUids.count == 0) {
+        completionBlock(nil);
+        return;
+    }
+    
     [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
-        return [SRGPlaylist objectsMatchingPredicate:nil sortedWithDescriptors:nil inManagedObjectContext:managedObjectContext];
+        NSPredicate *predicate = playlistUids ? [NSPredicate predicateWithFormat:@"%K IN %@", @keypath(SRGPlaylist.new, uid), playlistUids] : nil;
+        return [SRGPlaylist objectsMatchingPredicate:predicate sortedWithDescriptors:nil inManagedObjectContext:managedObjectContext];
     } withPriority:NSOperationQueuePriorityLow completionBlock:^(NSArray<SRGPlaylist *> * _Nullable playlists, NSError * _Nullable error) {
         if (playlists.count == 0) {
             completionBlock(nil);
             return;
         }
         
-        self.requestQueue = [[[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
-            if (finished) {
-                completionBlock(error);
-            }
-        }] requestQueueWithOptions:SRGRequestQueueOptionAutomaticCancellationOnErrorEnabled];
+        SRGRequestScheduler *requestScheduler = [[SRGRequestScheduler alloc] initWithDataStore:self.userData.dataStore maximumConcurrentRequestCount:self.maximumConcurrentRequestCount];
         
         NSArray<NSString *> *playlistUids = [playlists valueForKeyPath:[NSString stringWithFormat:@"@distinctUnionOfObjects.%@", @keypath(SRGPlaylist.new, uid)]];
         for (NSString *playlistUid in playlistUids) {
-            SRGRequest *request = [SRGPlaylistsRequest entriesForPlaylistWithUid:playlistUid fromServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:^(NSArray<NSDictionary *> * _Nullable playlistEntryDictionaries, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
-                [self.requestQueue reportError:error];
-                
-                if (! error) {
-                    [self savePlaylistEntryDictionaries:playlistEntryDictionaries toPlaylistWithUid:playlistUid completionBlock:nil];
-                }
+            [requestScheduler addRequestWithBlock:^SRGRequest * _Nullable(SRGRequestSchedulerResultBlock _Nonnull resultBlock) {
+                return [SRGPlaylistsRequest entryUpdatesForPlaylistWithUid:playlistUid fromServiceURL:self.serviceURL forSessionToken:sessionToken afterDate:date withSession:self.session completionBlock:^(NSArray<NSDictionary *> * _Nullable playlistEntryDictionaries, NSDate * _Nullable serverDate, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
+                    if (error) {
+                        resultBlock(nil, nil, error);
+                        return;
+                    }
+                    
+                    BOOL complete = ! date || ! serverDate;
+                    __block NSSet<NSString *> *changedUids = nil;
+                    NSMutableSet<NSString *> *memberEntriesUids = [NSMutableSet set];
+                    NSMutableSet<NSString *> *nonMemberEntriesUids = [NSMutableSet set];
+                    resultBlock(^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+                        changedUids = [self synchronizePlaylistEntryDictionaries:playlistEntryDictionaries
+                                                                        complete:complete
+                                                               inPlaylistWithUid:playlistUid
+                                                          inManagedObjectContext:managedObjectContext
+                                                                memberEntriesUids:memberEntriesUids
+                                                             nonMemberEntriesUids:nonMemberEntriesUids];
+                    }, ^(NSError * _Nullable error) {
+                        if (! error) {
+                            [self.membershipIndex addEntriesWithUids:memberEntriesUids toPlaylistWithUid:playlistUid];
+                            [self.membershipIndex removeEntriesWithUids:nonMemberEntriesUids fromPlaylistWithUid:playlistUid];
+                        }
+                        
+                        if (! error && changedUids.count > 0) {
+                            [self.userData.notificationDispatcher postNotificationName:SRGPlaylistEntriesDidChangeNotification
+                                                                                object:self
+                                                                              userInfo:@{ SRGPlaylistUidKey : playlistUid,
+                                                                                          SRGPlaylistEntriesUidsKey : changedUids }
+                                                                  coalescingUidsForKey:SRGPlaylistEntriesUidsKey];
+                        }
+                    }, nil);
+                }];
             }];
-            [self.requestQueue addRequest:request resume:YES];
         }
+        
+        [requestScheduler startWithCompletionBlock:completionBlock];
+        self.requestScheduler = requestScheduler;
     }];
 }
 
@@ -303,11 +406,7 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
         return;
     }
     
-    self.requestQueue = [[[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
-        if (finished) {
-            completionBlock(error);
-        }
-    }] requestQueueWithOptions:SRGRequestQueueOptionAutomaticCancellationOnErrorEnabled];
+    SRGRequestScheduler *requestScheduler = [[SRGRequestScheduler alloc] initWithDataStore:self.userData.dataStore maximumConcurrentRequestCount:self.maximumConcurrentRequestCount];
     
     NSArray<NSString *> *playlistUids = [playlistEntries valueForKeyPath:[NSString stringWithFormat:@"%@.@distinctUnionOfObjects.%@", @keypath(SRGPlaylistEntry.new, playlist), @keypath(SRGPlaylist.new, uid)]];
     for (NSString *playlistUid in playlistUids) {
@@ -321,19 +420,23 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
             NSArray<NSManagedObjectID *> *discardedPlaylistEntryIDs = [discardedPlaylistEntries valueForKeyPath:[NSString stringWithFormat:@"@distinctUnionOfObjects.%@", @keypath(SRGPlaylistEntry.new, objectID)]];
             NSArray<NSString *> *discardedPlaylistEntryUids = [discardedPlaylistEntries valueForKeyPath:[NSString stringWithFormat:@"@distinctUnionOfObjects.%@", @keypath(SRGPlaylistEntry.new, uid)]];
             
-            SRGRequest *deleteRequest = [SRGPlaylistsRequest deletePlaylistEntriesWithUids:discardedPlaylistEntryUids forPlaylistWithUid:playlistUid fromServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:^(NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
-                [self.requestQueue reportError:error];
-                
-                if (! error) {
-                    [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+            [requestScheduler addRequestWithBlock:^SRGRequest * _Nullable(SRGRequestSchedulerResultBlock _Nonnull resultBlock) {
+                return [SRGPlaylistsRequest deletePlaylistEntriesWithUids:discardedPlaylistEntryUids forPlaylistWithUid:playlistUid fromServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:^(NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
+                    if (error) {
+                        resultBlock(nil, nil, error);
+                        return;
+                    }
+                    
+                    resultBlock(^(NSManagedObjectContext * _Nonnull managedObjectContext) {
                         for (NSManagedObjectID *playlistEntryID in discardedPlaylistEntryIDs) {
                             SRGPlaylistEntry *playlistEntry = [managedObjectContext existingObjectWithID:playlistEntryID error:NULL];
-                            [managedObjectContext deleteObject:playlistEntry];
+                            if (playlistEntry) {
+                                [managedObjectContext deleteObject:playlistEntry];
+                            }
                         }
-                    } withPriority:NSOperationQueuePriorityLow completionBlock:nil];
-                }
+                    }, nil, nil);
+                }];
             }];
-            [self.requestQueue addRequest:deleteRequest resume:YES];
         }
         
         NSArray<SRGPlaylistEntry *> *updatedPlaylistEntries = [filteredPlaylistEntries srguserdata_arrayByRemovingObjectsInArray:discardedPlaylistEntries];
@@ -345,23 +448,28 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
                 updatedPlaylistEntryDictionaryIndex[playlistEntry.uid] = playlistEntry.dictionary;
             }
             
-            SRGRequest *putRequest = [SRGPlaylistsRequest putPlaylistEntryDictionaries:updatedPlaylistEntryDictionaryIndex.allValues forPlaylistWithUid:playlistUid toServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:^(NSArray<NSDictionary *> * _Nullable playlistEntryDictionaries, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
-                [self.requestQueue reportError:error];
-                
-                if (! error) {
-                    [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+            [requestScheduler addRequestWithBlock:^SRGRequest * _Nullable(SRGRequestSchedulerResultBlock _Nonnull resultBlock) {
+                return [SRGPlaylistsRequest putPlaylistEntryDictionaries:updatedPlaylistEntryDictionaryIndex.allValues forPlaylistWithUid:playlistUid toServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:^(NSArray<NSDictionary *> * _Nullable playlistEntryDictionaries, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
+                    if (error) {
+                        resultBlock(nil, nil, error);
+                        return;
+                    }
+                    
+                    resultBlock(^(NSManagedObjectContext * _Nonnull managedObjectContext) {
                         for (NSManagedObjectID *playlistEntryID in updatedPlaylistEntryIDs) {
                             SRGPlaylistEntry *playlistEntry = [managedObjectContext existingObjectWithID:playlistEntryID error:NULL];
                             NSDictionary *playlistEntryDictionary = updatedPlaylistEntryDictionaryIndex[playlistEntry.uid];
                             [playlistEntry updateWithDictionary:playlistEntryDictionary];
                             playlistEntry.dirty = NO;
                         }
-                    } withPriority:NSOperationQueuePriorityLow completionBlock:nil];
-                }
+                    }, nil, nil);
+                }];
             }];
-            [self.requestQueue addRequest:putRequest resume:YES];
         }
     }
+    
+    [requestScheduler startWithCompletionBlock:completionBlock];
+    self.requestScheduler = requestScheduler;
 }
 
 #pragma mark Subclassing hooks
@@ -379,6 +487,7 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
         }
         
         NSManagedObjectID *userID = user.objectID;
+        NSDate *synchronizationDate = user.playlistsSynchronizationDate;
         [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
             NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == YES", @keypath(SRGPlaylist.new, dirty)];
             return [SRGPlaylist objectsMatchingPredicate:predicate sortedWithDescriptors:nil inManagedObjectContext:managedObjectContext];
@@ -409,13 +518,13 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
                             return;
                         }
                         
-                        [self pullPlaylistsForSessionToken:sessionToken withCompletionBlock:^(NSError * _Nullable error) {
+                        [self pullPlaylistsForSessionToken:sessionToken afterDate:synchronizationDate withCompletionBlock:^(NSSet<NSString *> * _Nullable updatedPlaylistUids, NSDate * _Nullable serverDate, NSError * _Nullable error) {
                             if (error) {
                                 completionBlock(error);
                                 return;
                             }
                             
-                            [self pullPlaylistEntriesForSessionToken:sessionToken withCompletionBlock:^(NSError *error) {
+                            [self pullPlaylistEntriesForSessionToken:sessionToken forPlaylistsWithUids:updatedPlaylistUids afterDate:synchronizationDate withCompletionBlock:^(NSError *error) {
                                 if (error) {
                                     completionBlock(error);
                                     return;
@@ -423,7 +532,9 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
                                 
                                 [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
                                     SRGUser *user = [managedObjectContext existingObjectWithID:userID error:NULL];
-                                    user.playlistsSynchronizationDate = NSDate.date;
+                                    // Without server date, the next synchronization must pull everything again. The device clock cannot be
+                                    // used instead, as it might not be in sync with the server.
+                                    user.playlistsSynchronizationDate = serverDate;
                                 } withPriority:NSOperationQueuePriorityLow completionBlock:completionBlock];
                             }];
                         }];
@@ -437,7 +548,7 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
 - (void)cancelSynchronization
 {
     [self.pullPlaylistsRequest cancel];
-    [self.requestQueue cancel];
+    [self.requestScheduler cancel];
 }
 
 - (NSArray<SRGUserObject *> *)userObjectsInManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
@@ -458,9 +569,9 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
         for (SRGPlaylist *playlist in playlists) {
             NSString *playlistUid = playlist.uid;
             
-            NSArray<NSString *> *playlistEntriesUids = [playlist.entries.array valueForKeyPath:@keypath(SRGPlaylistEntry.new, uid)];
+            NSSet<NSString *> *playlistEntriesUids = [playlist.entries valueForKeyPath:@keypath(SRGPlaylistEntry.new, uid)];
             if (playlistEntriesUids.count > 0) {
-                playlistEntriesUidsIndex[playlist.uid] = [NSSet setWithArray:playlistEntriesUids];
+                playlistEntriesUidsIndex[playlist.uid] = playlistEntriesUids;
             }
             
             
@@ -474,20 +585,24 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
         
         [SRGPlaylistEntry deleteAllObjectsMatchingPredicate:nil inManagedObjectContext:managedObjectContext];
     } withPriority:NSOperationQueuePriorityVeryHigh completionBlock:^(NSError * _Nullable error) {
-        dispatch_sync(dispatch_get_main_queue(), ^{
-            if (! error && deletedUids.count > 0) {
-                [playlistEntriesUidsIndex enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull playlistUid, NSSet<NSString *> * _Nonnull playlistEntriesUids, BOOL * _Nonnull stop) {
-                    [NSNotificationCenter.defaultCenter postNotificationName:SRGPlaylistEntriesDidChangeNotification
-                                                                      object:self
-                                                                    userInfo:@{ SRGPlaylistUidKey : playlistUid,
-                                                                                SRGPlaylistEntriesUidsKey : playlistEntriesUids }];
-                }];
-                
-                [NSNotificationCenter.defaultCenter postNotificationName:SRGPlaylistsDidChangeNotification
-                                                                  object:self
-                                                                userInfo:@{ SRGPlaylistsUidsKey : deletedUids.copy }];
-            }
-        });
+        if (! error) {
+            [self.membershipIndex removeAllEntries];
+        }
+        
+        if (! error && deletedUids.count > 0) {
+            [playlistEntriesUidsIndex enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull playlistUid, NSSet<NSString *> * _Nonnull playlistEntriesUids, BOOL * _Nonnull stop) {
+                [self.userData.notificationDispatcher postNotificationName:SRGPlaylistEntriesDidChangeNotification
+                                                                    object:self
+                                                                  userInfo:@{ SRGPlaylistUidKey : playlistUid,
+                                                                              SRGPlaylistEntriesUidsKey : playlistEntriesUids }
+                                                      coalescingUidsForKey:SRGPlaylistEntriesUidsKey];
+            }];
+            
+            [self.userData.notificationDispatcher postNotificationName:SRGPlaylistsDidChangeNotification
+                                                                object:self
+                                                              userInfo:@{ SRGPlaylistsUidsKey : deletedUids.copy }
+                                                  coalescingUidsForKey:SRGPlaylistsUidsKey];
+        }
     }];
 }
 
@@ -502,6 +617,19 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
     return [SRGPlaylist objectsMatchingPredicate:playlistsPredicate sortedWithDescriptors:sortDescriptors inManagedObjectContext:managedObjectContext];
 }
 
+- (NSArray<SRGPlaylist *> *)playlistsMatchingPredicate:(NSPredicate *)predicate
+                                                 limit:(NSUInteger)limit
+                                           afterCursor:(SRGUserObjectCursor *)cursor
+                                            nextCursor:(SRGUserObjectCursor * __autoreleasing *)pNextCursor
+                                inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    NSPredicate *playlistsPredicate = [NSPredicate predicateWithFormat:@"%K == NO", @keypath(SRGPlaylist.new, discarded)];
+    if (predicate) {
+        playlistsPredicate = [NSCompoundPredicate andPredicateWithSubpredicates:@[playlistsPredicate, predicate]];
+    }
+    return [SRGPlaylist objectsMatchingPredicate:playlistsPredicate dateAscending:NO limit:limit afterCursor:cursor nextCursor:pNextCursor inManagedObjectContext:managedObjectContext];
+}
+
 - (SRGPlaylist *)playlistWithUid:(NSString *)uid inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
 {
     NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == NO", @keypath(SRGPlaylist.new, discarded)];
@@ -522,6 +650,41 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
     } withPriority:NSOperationQueuePriorityNormal completionBlock:completionBlock];
 }
 
+- (NSArray<SRGPlaylist *> *)playlistsMatchingPredicate:(NSPredicate *)predicate
+                                                 limit:(NSUInteger)limit
+                                           afterCursor:(SRGUserObjectCursor *)cursor
+                                            nextCursor:(SRGUserObjectCursor * __autoreleasing *)pNextCursor
+{
+    __block SRGUserObjectCursor *nextCursor = nil;
+    NSArray<SRGPlaylist *> *page = [self.userData.dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        SRGUserObjectCursor *pageNextCursor = nil;
+        NSArray<SRGPlaylist *> *playlists = [self playlistsMatchingPredicate:predicate limit:limit afterCursor:cursor nextCursor:&pageNextCursor inManagedObjectContext:managedObjectContext];
+        nextCursor = pageNextCursor;
+        return playlists;
+    }];
+    
+    if (pNextCursor) {
+        *pNextCursor = nextCursor;
+    }
+    return page;
+}
+
+- (NSString *)playlistsMatchingPredicate:(NSPredicate *)predicate
+                                   limit:(NSUInteger)limit
+                             afterCursor:(SRGUserObjectCursor *)cursor
+                         completionBlock:(void (^)(NSArray<SRGPlaylist *> * _Nullable, SRGUserObjectCursor * _Nullable, NSError * _Nullable))completionBlock
+{
+    __block SRGUserObjectCursor *nextCursor = nil;
+    return [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        SRGUserObjectCursor *pageNextCursor = nil;
+        NSArray<SRGPlaylist *> *playlists = [self playlistsMatchingPredicate:predicate limit:limit afterCursor:cursor nextCursor:&pageNextCursor inManagedObjectContext:managedObjectContext];
+        nextCursor = pageNextCursor;
+        return playlists;
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(id _Nullable result, NSError * _Nullable error) {
+        completionBlock(result, nextCursor, error);
+    }];
+}
+
 - (SRGPlaylist *)playlistWithUid:(NSString *)uid
 {
     return [self.userData.dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
@@ -572,13 +735,14 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
                                     userInfo:@{ NSLocalizedDescriptionKey : SRGUserDataLocalizedString(@"The playlist cannot be edited", @"Error message returned when attempting to edit a default read-only playlist") }];
         }
         else if (! error) {
-            dispatch_sync(dispatch_get_main_queue(), ^{
-                [NSNotificationCenter.defaultCenter postNotificationName:SRGPlaylistsDidChangeNotification
-                                                                  object:self
-                                                                userInfo:@{ SRGPlaylistsUidsKey : [NSSet setWithObject:uid] }];
-            });
+            [self.userData.notificationDispatcher postNotificationName:SRGPlaylistsDidChangeNotification
+                                                                object:self
+                                                              userInfo:@{ SRGPlaylistsUidsKey : [NSSet setWithObject:uid] }
+                                                  coalescingUidsForKey:SRGPlaylistsUidsKey];
         }
-        completionBlock ? completionBlock(uid, error) : nil;
+        [self.userData.notificationDispatcher dispatchBlock:^{
+            completionBlock ? completionBlock(uid, error) : nil;
+        }];
     }];
 }
 
@@ -594,7 +758,7 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
                 continue;
             }
             
-            NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %@", @keypath(SRGPlaylistEntry.new, playlist.uid), playlist.uid];
+            NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %@", @keypath(SRGPlaylistEntry.new, playlist), playlist];
             NSArray<NSString *> *discardedEntriesUids = [SRGPlaylistEntry discardObjectsWithUids:nil matchingPredicate:predicate inManagedObjectContext:managedObjectContext];
             if (discardedEntriesUids.count > 0) {
                 playlistEntriesUidsIndex[uid] = [NSSet setWithArray:discardedEntriesUids];
@@ -605,20 +769,23 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
         changedUids = [NSSet setWithArray:discardedUids];
     } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
         if (! error && changedUids.count > 0) {
-            dispatch_sync(dispatch_get_main_queue(), ^{
-                [playlistEntriesUidsIndex enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull playlistUid, NSSet<NSString *> * _Nonnull playlistEntriesUids, BOOL * _Nonnull stop) {
-                    [NSNotificationCenter.defaultCenter postNotificationName:SRGPlaylistEntriesDidChangeNotification
-                                                                      object:self
-                                                                    userInfo:@{ SRGPlaylistUidKey : playlistUid,
-                                                                                SRGPlaylistEntriesUidsKey : playlistEntriesUids }];
-                }];
-                
-                [NSNotificationCenter.defaultCenter postNotificationName:SRGPlaylistsDidChangeNotification
-                                                                  object:self
-                                                                userInfo:@{ SRGPlaylistsUidsKey : changedUids }];
-            });
+            [playlistEntriesUidsIndex enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull playlistUid, NSSet<NSString *> * _Nonnull playlistEntriesUids, BOOL * _Nonnull stop) {
+                [self.membershipIndex removeEntriesWithUids:playlistEntriesUids fromPlaylistWithUid:playlistUid];
+                [self.userData.notificationDispatcher postNotificationName:SRGPlaylistEntriesDidChangeNotification
+                                                                    object:self
+                                                                  userInfo:@{ SRGPlaylistUidKey : playlistUid,
+                                                                              SRGPlaylistEntriesUidsKey : playlistEntriesUids }
+                                                      coalescingUidsForKey:SRGPlaylistEntriesUidsKey];
+            }];
+            
+            [self.userData.notificationDispatcher postNotificationName:SRGPlaylistsDidChangeNotification
+                                                                object:self
+                                                              userInfo:@{ SRGPlaylistsUidsKey : changedUids }
+                                                  coalescingUidsForKey:SRGPlaylistsUidsKey];
         }
-        completionBlock ? completionBlock(error) : nil;
+        [self.userData.notificationDispatcher dispatchBlock:^{
+            completionBlock ? completionBlock(error) : nil;
+        }];
     }];
 }
 
@@ -631,7 +798,9 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
     if (! playlist) {
         return nil;
     }
-    NSPredicate *fetchPredicate = [NSPredicate predicateWithFormat:@"%K == %@ AND %K == NO", @keypath(SRGPlaylistEntry.new, playlist.uid), playlistUid, @keypath(SRGPlaylistEntry.new, discarded)];
+    
+    // Matches the playlist / discarded / date index
+    NSPredicate *fetchPredicate = [NSPredicate predicateWithFormat:@"%K == %@ AND %K == NO", @keypath(SRGPlaylistEntry.new, playlist), playlist, @keypath(SRGPlaylistEntry.new, discarded)];
     if (predicate) {
         fetchPredicate = [NSCompoundPredicate andPredicateWithSubpredicates:@[fetchPredicate, predicate]];
     }
@@ -647,6 +816,26 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
     return [SRGPlaylistEntry objectsMatchingPredicate:fetchPredicate sortedWithDescriptors:playlistEntriesSortDescriptor.copy inManagedObjectContext:managedObjectContext];
 }
 
+- (NSArray<SRGPlaylistEntry *> *)playlistEntriesInPlaylistWithUid:(NSString *)playlistUid
+                                                matchingPredicate:(NSPredicate *)predicate
+                                                            limit:(NSUInteger)limit
+                                                      afterCursor:(SRGUserObjectCursor *)cursor
+                                                       nextCursor:(SRGUserObjectCursor * __autoreleasing *)pNextCursor
+                                           inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    SRGPlaylist *playlist = [SRGPlaylist objectWithUid:playlistUid matchingPredicate:nil inManagedObjectContext:managedObjectContext];
+    if (! playlist) {
+        return nil;
+    }
+    
+    // Matches the playlist / discarded / date index
+    NSPredicate *fetchPredicate = [NSPredicate predicateWithFormat:@"%K == %@ AND %K == NO", @keypath(SRGPlaylistEntry.new, playlist), playlist, @keypath(SRGPlaylistEntry.new, discarded)];
+    if (predicate) {
+        fetchPredicate = [NSCompoundPredicate andPredicateWithSubpredicates:@[fetchPredicate, predicate]];
+    }
+    return [SRGPlaylistEntry objectsMatchingPredicate:fetchPredicate dateAscending:YES limit:limit afterCursor:cursor nextCursor:pNextCursor inManagedObjectContext:managedObjectContext];
+}
+
 - (NSArray<SRGPlaylistEntry *> *)playlistEntriesInPlaylistWithUid:(NSString *)playlistUid matchingPredicate:(NSPredicate *)predicate sortedWithDescriptors:(NSArray<NSSortDescriptor *> *)sortDescriptors
 {
     return [self.userData.dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
@@ -661,6 +850,193 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
     } withPriority:NSOperationQueuePriorityNormal completionBlock:completionBlock];
 }
 
+- (NSArray<SRGPlaylistEntry *> *)playlistEntriesInPlaylistWithUid:(NSString *)playlistUid
+                                                matchingPredicate:(NSPredicate *)predicate
+                                                            limit:(NSUInteger)limit
+                                                      afterCursor:(SRGUserObjectCursor *)cursor
+                                                       nextCursor:(SRGUserObjectCursor * __autoreleasing *)pNextCursor
+{
+    __block SRGUserObjectCursor *nextCursor = nil;
+    NSArray<SRGPlaylistEntry *> *page = [self.userData.dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        SRGUserObjectCursor *pageNextCursor = nil;
+        NSArray<SRGPlaylistEntry *> *playlistEntries = [self playlistEntriesInPlaylistWithUid:playlistUid matchingPredicate:predicate limit:limit afterCursor:cursor nextCursor:&pageNextCursor inManagedObjectContext:managedObjectContext];
+        nextCursor = pageNextCursor;
+        return playlistEntries;
+    }];
+    
+    if (pNextCursor) {
+        *pNextCursor = nextCursor;
+    }
+    return page;
+}
+
+- (NSString *)playlistEntriesInPlaylistWithUid:(NSString *)playlistUid
+                             matchingPredicate:(NSPredicate *)predicate
+                                         limit:(NSUInteger)limit
+                                   afterCursor:(SRGUserObjectCursor *)cursor
+                               completionBlock:(void (^)(NSArray<SRGPlaylistEntry *> * _Nullable, SRGUserObjectCursor * _Nullable, NSError * _Nullable))completionBlock
+{
+    __block SRGUserObjectCursor *nextCursor = nil;
+    return [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        SRGUserObjectCursor *pageNextCursor = nil;
+        NSArray<SRGPlaylistEntry *> *playlistEntries = [self playlistEntriesInPlaylistWithUid:playlistUid matchingPredicate:predicate limit:limit afterCursor:cursor nextCursor:&pageNextCursor inManagedObjectContext:managedObjectContext];
+        nextCursor = pageNextCursor;
+        return playlistEntries;
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(id _Nullable result, NSError * _Nullable error) {
+        completionBlock(result, nextCursor, error);
+    }];
+}
+
+- (NSDictionary<NSString *, SRGPlaylistEntry *> *)playlistEntriesWithUids:(NSArray<NSString *> *)uids
+                                                         inPlaylistWithUid:(NSString *)playlistUid
+                                                    inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    SRGPlaylist *playlist = [SRGPlaylist objectWithUid:playlistUid matchingPredicate:nil inManagedObjectContext:managedObjectContext];
+    if (! playlist) {
+        return nil;
+    }
+    
+    // Matches the playlist / uid index
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %@ AND %K == NO", @keypath(SRGPlaylistEntry.new, playlist), playlist, @keypath(SRGPlaylistEntry.new, discarded)];
+    return [SRGPlaylistEntry objectsWithUids:uids matchingPredicate:predicate inManagedObjectContext:managedObjectContext];
+}
+
+- (NSDictionary<NSString *, SRGPlaylistEntry *> *)playlistEntriesWithUids:(NSArray<NSString *> *)uids inPlaylistWithUid:(NSString *)playlistUid
+{
+    return [self.userData.dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        return [self playlistEntriesWithUids:uids inPlaylistWithUid:playlistUid inManagedObjectContext:managedObjectContext];
+    }];
+}
+
+- (NSString *)playlistEntriesWithUids:(NSArray<NSString *> *)uids inPlaylistWithUid:(NSString *)playlistUid completionBlock:(void (^)(NSDictionary<NSString *, SRGPlaylistEntry *> * _Nullable, NSError * _Nullable))completionBlock
+{
+    return [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        return [self playlistEntriesWithUids:uids inPlaylistWithUid:playlistUid inManagedObjectContext:managedObjectContext];
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:completionBlock];
+}
+
+- (NSUInteger)playlistEntryCountInPlaylistWithUid:(NSString *)playlistUid
+                                 matchingPredicate:(NSPredicate *)predicate
+                            inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+                                             error:(NSError * __autoreleasing *)error
+{
+    SRGPlaylist *playlist = [SRGPlaylist objectWithUid:playlistUid matchingPredicate:nil inManagedObjectContext:managedObjectContext];
+    if (! playlist) {
+        return 0;
+    }
+    
+    // Matches the playlist / discarded / date index
+    NSPredicate *countPredicate = [NSPredicate predicateWithFormat:@"%K == %@ AND %K == NO", @keypath(SRGPlaylistEntry.new, playlist), playlist, @keypath(SRGPlaylistEntry.new, discarded)];
+    if (predicate) {
+        countPredicate = [NSCompoundPredicate andPredicateWithSubpredicates:@[countPredicate, predicate]];
+    }
+    return [SRGPlaylistEntry countOfObjectsMatchingPredicate:countPredicate inManagedObjectContext:managedObjectContext error:error];
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)playlistEntryCountsMatchingPredicate:(NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext error:(NSError * __autoreleasing *)error
+{
+    NSString *playlistUidKeyPath = [NSString stringWithFormat:@"%@.%@", @keypath(SRGPlaylistEntry.new, playlist), @keypath(SRGPlaylist.new, uid)];
+    NSString *playlistDiscardedKeyPath = [NSString stringWithFormat:@"%@.%@", @keypath(SRGPlaylistEntry.new, playlist), @keypath(SRGPlaylist.new, discarded)];
+    
+    NSPredicate *countPredicate = [NSPredicate predicateWithFormat:@"%K == NO AND %K == NO", @keypath(SRGPlaylistEntry.new, discarded), playlistDiscardedKeyPath];
+    if (predicate) {
+        countPredicate = [NSCompoundPredicate andPredicateWithSubpredicates:@[countPredicate, predicate]];
+    }
+    return [SRGPlaylistEntry countsOfObjectsMatchingPredicate:countPredicate groupedByKeyPath:playlistUidKeyPath inManagedObjectContext:managedObjectContext error:error];
+}
+
+- (NSUInteger)playlistEntryCountInPlaylistWithUid:(NSString *)playlistUid matchingPredicate:(NSPredicate *)predicate
+{
+    NSNumber *count = [self.userData.dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        return @([self playlistEntryCountInPlaylistWithUid:playlistUid matchingPredicate:predicate inManagedObjectContext:managedObjectContext error:NULL]);
+    }];
+    return count.unsignedIntegerValue;
+}
+
+- (NSString *)playlistEntryCountInPlaylistWithUid:(NSString *)playlistUid matchingPredicate:(NSPredicate *)predicate completionBlock:(void (^)(NSUInteger, NSError * _Nullable))completionBlock
+{
+    __block NSError *countError = nil;
+    return [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        NSError *error = nil;
+        NSUInteger count = [self playlistEntryCountInPlaylistWithUid:playlistUid matchingPredicate:predicate inManagedObjectContext:managedObjectContext error:&error];
+        countError = error;
+        return @(count);
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSNumber * _Nullable count, NSError * _Nullable error) {
+        completionBlock(count.unsignedIntegerValue, error ?: countError);
+    }];
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)playlistEntryCountsMatchingPredicate:(NSPredicate *)predicate
+{
+    return [self.userData.dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        return [self playlistEntryCountsMatchingPredicate:predicate inManagedObjectContext:managedObjectContext error:NULL] ?: @{};
+    }];
+}
+
+- (NSString *)playlistEntryCountsMatchingPredicate:(NSPredicate *)predicate completionBlock:(void (^)(NSDictionary<NSString *, NSNumber *> * _Nullable, NSError * _Nullable))completionBlock
+{
+    __block NSError *countsError = nil;
+    return [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        NSError *error = nil;
+        NSDictionary<NSString *, NSNumber *> *counts = [self playlistEntryCountsMatchingPredicate:predicate inManagedObjectContext:managedObjectContext error:&error];
+        countsError = error;
+        return counts;
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSDictionary<NSString *, NSNumber *> * _Nullable counts, NSError * _Nullable error) {
+        completionBlock(counts, error ?: countsError);
+    }];
+}
+
+// Read the uids of the playlists containing each entry from the store, in a single fetch. Reading has a high priority,
+// as accessing the membership index waits for it.
+- (void)savedPlaylistMembershipsWithCompletionBlock:(void (^)(NSDictionary<NSString *, NSSet<NSString *> *> * _Nullable playlistUids))completionBlock
+{
+    [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        NSString *playlistUidKeyPath = [NSString stringWithFormat:@"%@.%@", @keypath(SRGPlaylistEntry.new, playlist), @keypath(SRGPlaylist.new, uid)];
+        
+        NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass(SRGPlaylistEntry.class)];
+        fetchRequest.predicate = [NSPredicate predicateWithFormat:@"%K == NO AND %K != nil", @keypath(SRGPlaylistEntry.new, discarded), @keypath(SRGPlaylistEntry.new, playlist)];
+        fetchRequest.resultType = NSDictionaryResultType;
+        fetchRequest.propertiesToFetch = @[ @keypath(SRGPlaylistEntry.new, uid), playlistUidKeyPath ];
+        
+        NSError *error = nil;
+        NSArray<NSDictionary *> *results = [managedObjectContext executeFetchRequest:fetchRequest error:&error];
+        if (error) {
+            SRGUserDataLogError(@"playlists", @"Could not read playlist memberships. Reason: %@", error);
+            return nil;
+        }
+        
+        NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *playlistUids = [NSMutableDictionary dictionary];
+        for (NSDictionary *result in results) {
+            NSString *uid = result[@keypath(SRGPlaylistEntry.new, uid)];
+            NSString *playlistUid = result[playlistUidKeyPath];
+            if (! uid || ! playlistUid) {
+                continue;
+            }
+            
+            NSMutableSet<NSString *> *uidPlaylistUids = playlistUids[uid];
+            if (uidPlaylistUids) {
+                [uidPlaylistUids addObject:playlistUid];
+            }
+            else {
+                playlistUids[uid] = [NSMutableSet setWithObject:playlistUid];
+            }
+        }
+        return playlistUids.copy;
+    } withPriority:NSOperationQueuePriorityHigh completionBlock:^(NSDictionary<NSString *, NSSet<NSString *> *> * _Nullable playlistUids, NSError * _Nullable error) {
+        completionBlock(playlistUids);
+    }];
+}
+
+- (NSSet<NSString *> *)playlistUidsContainingEntryWithUid:(NSString *)uid
+{
+    return [self.membershipIndex playlistUidsContainingEntryWithUid:uid];
+}
+
+- (NSDictionary<NSString *, NSSet<NSString *> *> *)playlistUidsContainingEntriesWithUids:(NSArray<NSString *> *)uids
+{
+    return [self.membershipIndex playlistUidsContainingEntriesWithUids:uids];
+}
+
 - (NSString *)savePlaylistEntryWithUid:(NSString *)uid inPlaylistWithUid:(NSString *)playlistUid completionBlock:(void (^)(NSError * _Nullable))completionBlock
 {
     __block BOOL playlistFound = NO;
@@ -673,7 +1049,7 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
         
         playlistFound = YES;
         
-        NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %@", @keypath(SRGPlaylistEntry.new, playlist.uid), playlistUid];
+        NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %@", @keypath(SRGPlaylistEntry.new, playlist), playlist];
         SRGPlaylistEntry *playlistEntry = [SRGPlaylistEntry upsertWithUid:uid matchingPredicate:predicate inManagedObjectContext:managedObjectContext];
         if (playlistEntry.inserted) {
             playlistEntry.playlist = playlist;
@@ -685,14 +1061,16 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
                                     userInfo:@{ NSLocalizedDescriptionKey : SRGUserDataLocalizedString(@"The playlist does not exist", @"Error message returned when adding an entry to an unknown playlist.") }];
         }
         else if (! error) {
-            dispatch_sync(dispatch_get_main_queue(), ^{
-                [NSNotificationCenter.defaultCenter postNotificationName:SRGPlaylistEntriesDidChangeNotification
-                                                                  object:self
-                                                                userInfo:@{ SRGPlaylistUidKey : playlistUid,
-                                                                            SRGPlaylistEntriesUidsKey : [NSSet setWithObject:uid] }];
-            });
-        }
-        completionBlock ? completionBlock(error) : nil;
+            [self.membershipIndex addEntriesWithUids:[NSSet setWithObject:uid] toPlaylistWithUid:playlistUid];
+            [self.userData.notificationDispatcher postNotificationName:SRGPlaylistEntriesDidChangeNotification
+                                                                object:self
+                                                              userInfo:@{ SRGPlaylistUidKey : playlistUid,
+                                                                          SRGPlaylistEntriesUidsKey : [NSSet setWithObject:uid] }
+                                                  coalescingUidsForKey:SRGPlaylistEntriesUidsKey];
+        }
+        [self.userData.notificationDispatcher dispatchBlock:^{
+            completionBlock ? completionBlock(error) : nil;
+        }];
     }];
 }
 
@@ -709,7 +1087,7 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
         
         playlistFound = YES;
         
-        NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %@", @keypath(SRGPlaylistEntry.new, playlist.uid), playlistUid];
+        NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %@", @keypath(SRGPlaylistEntry.new, playlist), playlist];
         NSArray<NSString *> *discardedUids = [SRGPlaylistEntry discardObjectsWithUids:uids matchingPredicate:predicate inManagedObjectContext:managedObjectContext];
         changedUids = [NSSet setWithArray:discardedUids];
     } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
@@ -719,14 +1097,16 @@ NSString * const SRGPlaylistEntriesUidsKey = @"SRGPlaylistEntriesUids";
                                     userInfo:@{ NSLocalizedDescriptionKey : SRGUserDataLocalizedString(@"The playlist does not exist", @"Error message returned when removing some entries from an unknown playlist.") }];
         }
         else if (! error && changedUids.count > 0) {
-            dispatch_sync(dispatch_get_main_queue(), ^{
-                [NSNotificationCenter.defaultCenter postNotificationName:SRGPlaylistEntriesDidChangeNotification
-                                                                  object:self
-                                                                userInfo:@{ SRGPlaylistUidKey : playlistUid,
-                                                                            SRGPlaylistEntriesUidsKey : changedUids }];
-            });
-        }
-        completionBlock ? completionBlock(error) : nil;
+            [self.membershipIndex removeEntriesWithUids:changedUids fromPlaylistWithUid:playlistUid];
+            [self.userData.notificationDispatcher postNotificationName:SRGPlaylistEntriesDidChangeNotification
+                                                                object:self
+                                                              userInfo:@{ SRGPlaylistUidKey : playlistUid,
+                                                                          SRGPlaylistEntriesUidsKey : changedUids }
+                                                  coalescingUidsForKey:SRGPlaylistEntriesUidsKey];
+        }
+        [self.userData.notificationDispatcher dispatchBlock:^{
+            completionBlock ? completionBlock(error) : nil;
+        }];
     }];
 }
 
@@ -10,8 +10,10 @@ NS_ASSUME_NONNULL_BEGIN
 
 // Block signatures.
 typedef void (^SRGPlaylistsCompletionBlock)(NSArray<NSDictionary *> * _Nullable playlistDictionaries, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error);
+typedef void (^SRGPlaylistsUpdatesCompletionBlock)(NSArray<NSDictionary *> * _Nullable playlistDictionaries, NSDate * _Nullable serverDate, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error);
 typedef void (^SRGPlaylistPostCompletionBlock)(NSDictionary * _Nullable playlistDictionary, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error);
 typedef void (^SRGPlaylistEntriesCompletionBlock)(NSArray<NSDictionary *> * _Nullable playlistEntryDictionaries, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error);
+typedef void (^SRGPlaylistEntriesUpdatesCompletionBlock)(NSArray<NSDictionary *> * _Nullable playlistEntryDictionaries, NSDate * _Nullable serverDate, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error);
 typedef void (^SRGPlaylistDeleteCompletionBlock)(NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error);
 
 /**
@@ -27,6 +29,17 @@ typedef void (^SRGPlaylistDeleteCompletionBlock)(NSHTTPURLResponse * _Nullable H
                             withSession:(NSURLSession *)session
                         completionBlock:(SRGPlaylistsCompletionBlock)completionBlock;
 
+/**
+ *  Retrieve playlists updated after the specified date, including deleted ones, or all playlists if no date is
+ *  provided. The server date is returned if the service supports updates, in which case it must be used as date for
+ *  the next request. If no server date is returned, the complete list of playlists has been returned.
+ */
++ (SRGRequest *)playlistUpdatesFromServiceURL:(NSURL *)serviceURL
+                              forSessionToken:(NSString *)sessionToken
+                                    afterDate:(nullable NSDate *)date
+                                  withSession:(NSURLSession *)session
+                              completionBlock:(SRGPlaylistsUpdatesCompletionBlock)completionBlock;
+
 /**
  *  Submit a playlist.
  */
@@ -54,6 +67,17 @@ typedef void (^SRGPlaylistDeleteCompletionBlock)(NSHTTPURLResponse * _Nullable H
                               withSession:(NSURLSession *)session
                           completionBlock:(SRGPlaylistEntriesCompletionBlock)completionBlock;
 
+/**
+ *  Retrieve entries of the specified playlist updated after the specified date, including deleted ones, or all entries
+ *  if no date is provided. Same server date semantics as for `+playlistUpdatesFromServiceURL:forSessionToken:afterDate:withSession:completionBlock:`.
+ */
++ (SRGRequest *)entryUpdatesForPlaylistWithUid:(NSString *)playlistUid
+                                fromServiceURL:(NSURL *)serviceURL
+                               forSessionToken:(NSString *)sessionToken
+                                     afterDate:(nullable NSDate *)date
+                                   withSession:(NSURLSession *)session
+                               completionBlock:(SRGPlaylistEntriesUpdatesCompletionBlock)completionBlock;
+
 /**
  *  Update entries for the specified playlist.
  */
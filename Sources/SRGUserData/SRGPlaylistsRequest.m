@@ -8,6 +8,27 @@
 
 @import libextobjc;
 
+// Return a request for updates made after the specified date, or for all items if no date is provided.
+static NSURLRequest *SRGPlaylistsUpdatesURLRequest(NSURL *URL, NSString *sessionToken, NSDate *date)
+{
+    NSURLComponents *URLComponents = [NSURLComponents componentsWithURL:URL resolvingAgainstBaseURL:NO];
+    if (date) {
+        NSTimeInterval timestamp = round(date.timeIntervalSince1970 * 1000.);
+        URLComponents.queryItems = @[ [NSURLQueryItem queryItemWithName:@"after" value:@(timestamp).stringValue],
+                                      [NSURLQueryItem queryItemWithName:@"with_deleted" value:@"true"] ];
+    }
+    
+    NSMutableURLRequest *URLRequest = [NSMutableURLRequest requestWithURL:URLComponents.URL];
+    [URLRequest setValue:[NSString stringWithFormat:@"sessionToken %@", sessionToken] forHTTPHeaderField:@"Authorization"];
+    return URLRequest.copy;
+}
+
+static NSDate *SRGPlaylistsServerDate(NSDictionary *JSONDictionary)
+{
+    NSNumber *serverTimestamp = JSONDictionary[@"last_update"];
+    return [serverTimestamp isKindOfClass:NSNumber.class] ? [NSDate dateWithTimeIntervalSince1970:serverTimestamp.doubleValue / 1000.] : nil;
+}
+
 @implementation SRGPlaylistsRequest
 
 + (SRGRequest *)playlistsFromServiceURL:(NSURL *)serviceURL
@@ -26,6 +47,21 @@
     }];
 }
 
++ (SRGRequest *)playlistUpdatesFromServiceURL:(NSURL *)serviceURL
+                              forSessionToken:(NSString *)sessionToken
+                                    afterDate:(NSDate *)date
+                                  withSession:(NSURLSession *)session
+                              completionBlock:(SRGPlaylistsUpdatesCompletionBlock)completionBlock
+{
+    NSURL *URL = [serviceURL URLByAppendingPathComponent:@"v3"];
+    NSURLRequest *URLRequest = SRGPlaylistsUpdatesURLRequest(URL, sessionToken, date);
+    
+    return [SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        NSHTTPURLResponse *HTTPResponse = [response isKindOfClass:NSHTTPURLResponse.class] ? (NSHTTPURLResponse *)response : nil;
+        completionBlock(JSONDictionary[@"playlists"], SRGPlaylistsServerDate(JSONDictionary), HTTPResponse, error);
+    }];
+}
+
 + (SRGRequest *)postPlaylistDictionary:(NSDictionary *)dictionary
                           toServiceURL:(NSURL *)serviceURL
                        forSessionToken:(NSString *)sessionToken
@@ -85,6 +121,22 @@
     }];
 }
 
++ (SRGRequest *)entryUpdatesForPlaylistWithUid:(NSString *)playlistUid
+                                fromServiceURL:(NSURL *)serviceURL
+                               forSessionToken:(NSString *)sessionToken
+                                     afterDate:(NSDate *)date
+                                   withSession:(NSURLSession *)session
+                               completionBlock:(SRGPlaylistEntriesUpdatesCompletionBlock)completionBlock
+{
+    NSURL *URL = [[serviceURL URLByAppendingPathComponent:@"v3"] URLByAppendingPathComponent:playlistUid];
+    NSURLRequest *URLRequest = SRGPlaylistsUpdatesURLRequest(URL, sessionToken, date);
+    
+    return [SRGRequest JSONDictionaryRequestWithURLRequest:URLRequest session:session completionBlock:^(NSDictionary * _Nullable JSONDictionary, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        NSHTTPURLResponse *HTTPResponse = [response isKindOfClass:NSHTTPURLResponse.class] ? (NSHTTPURLResponse *)response : nil;
+        completionBlock(JSONDictionary[@"bookmarks"], SRGPlaylistsServerDate(JSONDictionary), HTTPResponse, error);
+    }];
+}
+
 + (SRGRequest *)putPlaylistEntryDictionaries:(NSArray<NSDictionary *> *)dictionaries
                           forPlaylistWithUid:(NSString *)playlistUid
                                 toServiceURL:(NSURL *)serviceURL
@@ -0,0 +1,23 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPreferencePath.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Private interface for implementation purposes.
+ */
+@interface SRGPreferencePath (Private)
+
+/**
+ *  The components to follow from the preference tree root, starting with the domain.
+ */
+@property (nonatomic, readonly) NSArray<NSString *> *pathComponents;
+
+@end
+
+NS_ASSUME_NONNULL_END
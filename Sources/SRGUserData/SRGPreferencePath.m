@@ -0,0 +1,147 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPreferencePath+Private.h"
+
+#import "SRGUserDataLogger.h"
+
+// Maximum number of cached domains, and of cached paths per domain.
+static const NSUInteger SRGPreferencePathMaximumCachedDomainCount = 32;
+static const NSUInteger SRGPreferencePathMaximumCachedPathCount = 256;
+
+@interface SRGPreferencePath ()
+
+@property (nonatomic, copy) NSString *path;
+@property (nonatomic, copy) NSString *domain;
+@property (nonatomic) NSArray<NSString *> *pathComponents;
+
+@end
+
+@implementation SRGPreferencePath
+
+#pragma mark Class methods
+
+// Validated paths, cached by domain, then by path (`NSNull` for the domain root)
++ (NSCache<NSString *, NSCache<id, SRGPreferencePath *> *> *)cache
+{
+    static NSCache *s_cache;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_cache = [[NSCache alloc] init];
+        s_cache.countLimit = SRGPreferencePathMaximumCachedDomainCount;
+    });
+    return s_cache;
+}
+
++ (SRGPreferencePath *)preferencePathWithPath:(NSString *)path inDomain:(NSString *)domain
+{
+    NSParameterAssert(domain);
+    
+    NSCache<NSString *, NSCache<id, SRGPreferencePath *> *> *cache = [self cache];
+    NSCache<id, SRGPreferencePath *> *domainCache = [cache objectForKey:domain];
+    
+    id pathKey = path ?: NSNull.null;
+    SRGPreferencePath *preferencePath = [domainCache objectForKey:pathKey];
+    if (preferencePath) {
+        return preferencePath;
+    }
+    
+    NSArray<NSString *> *pathComponents = [self pathComponentsForPath:path inDomain:domain];
+    if (! pathComponents) {
+        return nil;
+    }
+    
+    preferencePath = [[self alloc] initWithPath:path domain:domain pathComponents:pathComponents];
+    
+    if (! domainCache) {
+        domainCache = [[NSCache alloc] init];
+        domainCache.countLimit = SRGPreferencePathMaximumCachedPathCount;
+        [cache setObject:domainCache forKey:domain.copy];
+    }
+    [domainCache setObject:preferencePath forKey:[pathKey copy]];
+    
+    return preferencePath;
+}
+
++ (NSArray<NSString *> *)pathComponentsForPath:(NSString *)path inDomain:(NSString *)domain
+{
+    if (domain.length == 0 || [domain containsString:@"/"]) {
+        SRGUserDataLogWarning(@"preferences", @"Unsupported domain '%@'", domain);
+        return nil;
+    }
+    
+    if ([domain rangeOfCharacterFromSet:NSCharacterSet.URLPathAllowedCharacterSet.invertedSet].location != NSNotFound) {
+        SRGUserDataLogWarning(@"preferences", @"Unsupported path '%@'", path);
+        return nil;
+    }
+    
+    if (! path) {
+        return @[domain];
+    }
+    
+    NSString *trimmedPath = [path stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"/"]];
+    if (trimmedPath.length == 0) {
+        SRGUserDataLogWarning(@"preferences", @"Unsupported path '%@'", path);
+        return nil;
+    }
+    
+    if ([trimmedPath rangeOfCharacterFromSet:NSCharacterSet.URLPathAllowedCharacterSet.invertedSet].location != NSNotFound) {
+        SRGUserDataLogWarning(@"preferences", @"Unsupported path '%@'", path);
+        return nil;
+    }
+    
+    return [@[domain] arrayByAddingObjectsFromArray:trimmedPath.pathComponents];
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithPath:(NSString *)path domain:(NSString *)domain pathComponents:(NSArray<NSString *> *)pathComponents
+{
+    if (self = [super init]) {
+        self.path = [path stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"/"]];
+        self.domain = domain;
+        self.pathComponents = pathComponents.copy;
+    }
+    return self;
+}
+
+#pragma mark NSCopying protocol
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    // Immutable
+    return self;
+}
+
+#pragma mark Equality
+
+- (BOOL)isEqual:(id)object
+{
+    if (! [object isKindOfClass:self.class]) {
+        return NO;
+    }
+    
+    SRGPreferencePath *otherPreferencePath = object;
+    return [self.pathComponents isEqualToArray:otherPreferencePath.pathComponents];
+}
+
+- (NSUInteger)hash
+{
+    return self.domain.hash ^ self.pathComponents.lastObject.hash;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; domain = %@; path = %@>",
+            self.class,
+            self,
+            self.domain,
+            self.path];
+}
+
+@end
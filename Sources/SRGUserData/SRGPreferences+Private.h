@@ -0,0 +1,35 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPreferences.h"
+#import "SRGPreferencesSnapshot.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Private interface for implementation purposes.
+ */
+@interface SRGPreferences (Private)
+
+/**
+ *  The maximum number of preference push requests running at the same time. Default is 4.
+ */
+@property (nonatomic) NSUInteger maximumConcurrentPushCount;
+
+/**
+ *  The format in which preference snapshots are saved. Existing snapshots are read whatever their format. Default is
+ *  JSON, which earlier library versions can still read.
+ *
+ *  @discussion The binary format is opt-in only. Earlier library versions cannot read binary snapshots, and would
+ *              therefore lose all locally stored preferences if an application using them was downgraded. JSON
+ *              snapshots are not migrated on load for the same reason; they are only saved in binary format at the
+ *              next compaction once this property has been set.
+ */
+@property (nonatomic) SRGPreferencesSnapshotFormat snapshotFormat;
+
+@end
+
+NS_ASSUME_NONNULL_END
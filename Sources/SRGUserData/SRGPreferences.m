@@ -4,10 +4,14 @@
 //  License information is available from the LICENSE file.
 //
 
-#import "SRGPreferences.h"
+#import "SRGPreferences+Private.h"
 
 #import "NSSet+SRGUserData.h"
+#import "SRGPreferencePath+Private.h"
 #import "SRGPreferencesChangelog.h"
+#import "SRGPreferencesJournal.h"
+#import "SRGPreferencesObserver.h"
+#import "SRGPreferencesPushScheduler.h"
 #import "SRGPreferencesRequest.h"
 #import "SRGUser+Private.h"
 #import "SRGUserData+Private.h"
@@ -17,174 +21,179 @@
 
 NSString * const SRGPreferencesDidChangeNotification = @"SRGPreferencesDidChangeNotification";
 NSString * const SRGPreferencesDomainsKey = @"SRGPreferencesDomains";
+NSString * const SRGPreferencesPathsKey = @"SRGPreferencesPaths";
 
-static NSDictionary *SRGDictionaryMakeImmutableCopy(NSDictionary *dictionary)
+// Deep immutable copy of a JSON-compatible object.
+static id SRGObjectMakeImmutableCopy(id object)
 {
-    if (! dictionary) {
-        return nil;
+    if ([object isKindOfClass:NSDictionary.class]) {
+        NSMutableDictionary *mutableDictionary = [NSMutableDictionary dictionaryWithCapacity:[object count]];
+        [object enumerateKeysAndObjectsUsingBlock:^(id _Nonnull key, id _Nonnull value, BOOL * _Nonnull stop) {
+            mutableDictionary[key] = SRGObjectMakeImmutableCopy(value);
+        }];
+        return mutableDictionary.copy;
+    }
+    else if ([object isKindOfClass:NSArray.class]) {
+        NSMutableArray *mutableArray = [NSMutableArray arrayWithCapacity:[object count]];
+        for (id value in object) {
+            [mutableArray addObject:SRGObjectMakeImmutableCopy(value)];
+        }
+        return mutableArray.copy;
     }
+    else if ([object isKindOfClass:NSString.class]) {
+        return [object copy];
+    }
+    else {
+        return object;
+    }
+}
+
+// Return a dictionary with the object set (or removed if `nil`) at the specified path components, starting at the
+// given index. Only dictionaries along the path are copied, all other branches are shared with the original
+// dictionary. If no change is made, the original dictionary is returned.
+static NSDictionary *SRGDictionaryByUpdatingObject(NSDictionary *dictionary, id object, NSArray<NSString *> *pathComponents, NSUInteger index)
+{
+    NSString *pathComponent = pathComponents[index];
+    id currentObject = dictionary[pathComponent];
     
-    NSMutableDictionary *mutableDictionary = [NSMutableDictionary dictionary];
-    [dictionary enumerateKeysAndObjectsUsingBlock:^(id _Nonnull key, id _Nonnull object, BOOL * _Nonnull stop) {
-        if ([object isKindOfClass:NSMutableDictionary.class]) {
-            mutableDictionary[key] = SRGDictionaryMakeImmutableCopy(object);
+    id updatedObject = nil;
+    if (index == pathComponents.count - 1) {
+        if (currentObject == object || [currentObject isEqual:object]) {
+            return dictionary;
         }
-        else {
-            mutableDictionary[key] = object;
+        updatedObject = object;
+    }
+    else {
+        NSDictionary *currentDictionary = [currentObject isKindOfClass:NSDictionary.class] ? currentObject : nil;
+        
+        // Nothing to remove
+        if (! currentDictionary && ! object) {
+            return dictionary;
         }
-    }];
+        
+        NSDictionary *updatedDictionary = SRGDictionaryByUpdatingObject(currentDictionary ?: @{}, object, pathComponents, index + 1);
+        if (updatedDictionary == currentDictionary) {
+            return dictionary;
+        }
+        updatedObject = updatedDictionary;
+    }
+    
+    NSMutableDictionary *mutableDictionary = dictionary.mutableCopy;
+    mutableDictionary[pathComponent] = updatedObject;
     return mutableDictionary.copy;
 }
 
-static NSDictionary *SRGDictionaryMakeMutableCopy(NSDictionary *dictionary)
+// Add the paths at which two objects differ. Paths are reported at the deepest level where a change can be found,
+// i.e. where one of the objects is not a dictionary. Branches shared by both objects are not compared.
+static void SRGAddChangedPaths(id previousObject, id object, NSString *path, NSMutableSet<NSString *> *paths)
 {
-    if (! dictionary) {
-        return nil;
+    if (previousObject == object) {
+        return;
     }
     
-    NSMutableDictionary *mutableDictionary = [NSMutableDictionary dictionary];
-    [dictionary enumerateKeysAndObjectsUsingBlock:^(id _Nonnull key, id _Nonnull object, BOOL * _Nonnull stop) {
-        if ([object isKindOfClass:NSDictionary.class]) {
-            mutableDictionary[key] = SRGDictionaryMakeMutableCopy(object);
-        }
-        else {
-            mutableDictionary[key] = object;
+    if ([previousObject isKindOfClass:NSDictionary.class] && [object isKindOfClass:NSDictionary.class]) {
+        NSMutableSet<NSString *> *keys = [NSMutableSet setWithArray:[previousObject allKeys]];
+        [keys addObjectsFromArray:[object allKeys]];
+        
+        for (NSString *key in keys) {
+            NSString *subpath = path ? [path stringByAppendingFormat:@"/%@", key] : key;
+            SRGAddChangedPaths(previousObject[key], object[key], subpath, paths);
         }
-    }];
-    return mutableDictionary;
+    }
+    else if (! [previousObject isEqual:object]) {
+        [paths addObject:path];
+    }
 }
 
 @interface SRGPreferences ()
 
 @property (nonatomic) NSURL *fileURL;
-@property (nonatomic) NSMutableDictionary *dictionary;
+// Immutable snapshot of the preference tree, replaced as a whole when preferences change. Writers are serialized, while
+// readers can access the snapshot from any thread without further synchronization.
+@property (atomic) NSDictionary *dictionary;
+@property (nonatomic) SRGPreferencesJournal *journal;
 @property (nonatomic) SRGPreferencesChangelog *changelog;
 
-@property (nonatomic, weak) SRGRequest *pushRequest;
+// Validators received with the preferences of each domain during the last pull
+@property (nonatomic) NSURL *validatorsFileURL;
+@property (nonatomic) NSDictionary<NSString *, NSDictionary *> *validators;
+
+@property (nonatomic, weak) SRGPreferencesPushScheduler *pushScheduler;
+@property (nonatomic) NSHashTable<SRGRequest *> *pushRequests;
+@property (nonatomic) NSUInteger maximumConcurrentPushCount;
 @property (nonatomic) SRGRequestQueue *requestQueue;
 
 @property (nonatomic) NSURLSession *session;
 
+// Observers, by domain
+@property (nonatomic) NSMutableDictionary<NSString *, NSMutableArray<SRGPreferencesObserver *> *> *observers;
+
 @end
 
 @implementation SRGPreferences
 
 #pragma mark Class methods
 
-+ (NSArray<NSString *> *)pathComponentsForPath:(NSString *)path inDomain:(NSString *)domain
-{
-    NSParameterAssert(domain);
-    
-    if (domain.length == 0 || [domain containsString:@"/"]) {
-        SRGUserDataLogWarning(@"preferences", @"Unsupported domain '%@'", domain);
-        return nil;
-    }
-    
-    if ([domain rangeOfCharacterFromSet:NSCharacterSet.URLPathAllowedCharacterSet.invertedSet].location != NSNotFound) {
-        SRGUserDataLogWarning(@"preferences", @"Unsupported path '%@'", path);
-        return nil;
-    }
-    
-    if (! path) {
-        return @[domain];
-    }
-    
-    NSString *trimmedPath = [path stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"/"]];
-    if (trimmedPath.length == 0) {
-        SRGUserDataLogWarning(@"preferences", @"Unsupported path '%@'", path);
-        return nil;
-    }
-    
-    if ([trimmedPath rangeOfCharacterFromSet:NSCharacterSet.URLPathAllowedCharacterSet.invertedSet].location != NSNotFound) {
-        SRGUserDataLogWarning(@"preferences", @"Unsupported path '%@'", path);
-        return nil;
-    }
-    
-    return [@[domain] arrayByAddingObjectsFromArray:trimmedPath.pathComponents];    
-}
-
-+ (BOOL)updateDictionary:(NSMutableDictionary *)dictionary withObject:(id)object atPath:(NSString *)path inDomain:(NSString *)domain
++ (NSDictionary *)dictionary:(NSDictionary *)dictionary byUpdatingObject:(id)object atPath:(NSString *)path inDomain:(NSString *)domain
 {
     if (object && ! [object isKindOfClass:NSString.class] && ! [object isKindOfClass:NSNumber.class] && ! [NSJSONSerialization isValidJSONObject:object]) {
-        return NO;
+        return dictionary;
     }
     
-    NSArray<NSString *> *pathComponents = [SRGPreferences pathComponentsForPath:path inDomain:domain];
-    if (! pathComponents) {
-        return NO;
+    SRGPreferencePath *preferencePath = [SRGPreferencePath preferencePathWithPath:path inDomain:domain];
+    if (! preferencePath) {
+        return dictionary;
     }
     
-    NSMutableDictionary *currentDictionary = dictionary;
-    for (NSUInteger i = 0; i < pathComponents.count; ++i) {
-        NSString *pathComponent = pathComponents[i];
-        if (i == pathComponents.count - 1) {
-            id currentObject = currentDictionary[pathComponent];
-            if ([currentObject isEqual:object]) {
-                return NO;
-            }
-            else {
-                currentDictionary[pathComponent] = object;
-            }
-        }
-        else {
-            id value = currentDictionary[pathComponent];
-            if (! [value isKindOfClass:NSDictionary.class]) {
-                currentDictionary[pathComponent] = [NSMutableDictionary dictionary];
-            }
-            currentDictionary = currentDictionary[pathComponent];
-        }
-    }
+    NSDictionary *updatedDictionary = SRGDictionaryByUpdatingObject(dictionary, object, preferencePath.pathComponents, 0);
     
-    NSMutableDictionary *domainDictionary = dictionary[domain];
-    if (domainDictionary.count == 0) {
-        dictionary[domain] = nil;
+    NSDictionary *domainDictionary = updatedDictionary[domain];
+    if (domainDictionary && domainDictionary.count == 0) {
+        NSMutableDictionary *mutableDictionary = updatedDictionary.mutableCopy;
+        mutableDictionary[domain] = nil;
+        updatedDictionary = mutableDictionary.copy;
     }
     
-    return YES;
+    return updatedDictionary;
 }
 
-+ (void)savePreferenceDictionary:(NSDictionary *)dictionary toFileURL:(NSURL *)fileURL
++ (NSDictionary *)savedPreferenceDictionaryFromFileURL:(NSURL *)fileURL
 {
-    NSError *JSONError = nil;
-    NSData *data = [NSJSONSerialization dataWithJSONObject:dictionary options:0 error:NULL];
-    if (JSONError) {
-        SRGUserDataLogError(@"preferences", @"Could not save preferences. Reason %@", JSONError);
-        return;
+    if (! [NSFileManager.defaultManager fileExistsAtPath:fileURL.path]) {
+        return nil;
     }
     
-    NSError *writeError = nil;
-    if (! [data writeToURL:fileURL options:NSDataWritingAtomic error:&writeError]) {
-        SRGUserDataLogError(@"preferences", @"Could not save preferences. Reason %@", writeError);
-        return;
+    // Snapshots are read whatever their format, so that JSON snapshots saved by earlier versions are migrated when
+    // the next snapshot is saved.
+    NSError *error = nil;
+    NSDictionary *dictionary = [SRGPreferencesSnapshot dictionaryWithContentsOfFileURL:fileURL error:&error];
+    if (! dictionary) {
+        SRGUserDataLogError(@"preferences", @"Could not read preferences. Reason %@", error);
+        return nil;
     }
     
-    SRGUserDataLogInfo(@"preferences", @"Preferences successfully saved");
+    return dictionary;
 }
 
-+ (NSMutableDictionary *)savedPreferenceDictionaryFromFileURL:(NSURL *)fileURL
++ (NSDictionary<NSString *, NSDictionary *> *)savedValidatorsFromFileURL:(NSURL *)fileURL
 {
-    if (! [NSFileManager.defaultManager fileExistsAtPath:fileURL.path]) {
-        return nil;
-    }
-    
     NSData *data = [NSData dataWithContentsOfURL:fileURL];
     if (! data) {
         return nil;
     }
     
-    NSError *JSONError = nil;
-    id JSONObject = [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingMutableContainers error:&JSONError];
-    if (JSONError) {
-        SRGUserDataLogError(@"preferences", @"Could not read preferences. Reason %@", JSONError);
-        return nil;
-    }
+    id JSONObject = [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL];
+    return [JSONObject isKindOfClass:NSDictionary.class] ? JSONObject : nil;
+}
+
++ (void)saveValidators:(NSDictionary<NSString *, NSDictionary *> *)validators toFileURL:(NSURL *)fileURL
+{
+    NSData *data = [NSJSONSerialization dataWithJSONObject:validators options:0 error:NULL];
     
-    if (! [JSONObject isKindOfClass:NSDictionary.class]) {
-        SRGUserDataLogError(@"preferences", @"Could not read preferences. The format is invalid");
-        return nil;
+    NSError *writeError = nil;
+    if (! [data writeToURL:fileURL options:NSDataWritingAtomic error:&writeError]) {
+        SRGUserDataLogError(@"preferences", @"Could not save validators. Reason %@", writeError);
     }
-    
-    return JSONObject;
 }
 
 #pragma mark Object lifecycle
@@ -193,25 +202,59 @@ static NSDictionary *SRGDictionaryMakeMutableCopy(NSDictionary *dictionary)
 {
     if (self = [super initWithServiceURL:serviceURL userData:userData]) {
         self.fileURL = [[userData.storeFileURL URLByDeletingPathExtension] URLByAppendingPathExtension:@"prefs"];
-        self.dictionary = [SRGPreferences savedPreferenceDictionaryFromFileURL:self.fileURL] ?: [NSMutableDictionary dictionary];
+        
+        __block NSDictionary *dictionary = [SRGPreferences savedPreferenceDictionaryFromFileURL:self.fileURL] ?: @{};
+        self.journal = [[SRGPreferencesJournal alloc] initForPreferencesFileWithURL:self.fileURL];
+        [self.journal enumerateRecordsUsingBlock:^(id _Nullable object, NSString * _Nullable path, NSString * _Nonnull domain) {
+            dictionary = [SRGPreferences dictionary:dictionary byUpdatingObject:object atPath:path inDomain:domain];
+        }];
+        self.dictionary = dictionary;
+        [self compactJournalIfNeeded];
+        
         self.changelog = [[SRGPreferencesChangelog alloc] initForPreferencesFileWithURL:self.fileURL];
         
+        self.validatorsFileURL = [self.fileURL URLByAppendingPathExtension:@"validators"];
+        self.validators = [SRGPreferences savedValidatorsFromFileURL:self.validatorsFileURL] ?: @{};
+        
+        self.pushRequests = [NSHashTable weakObjectsHashTable];
+        self.observers = [NSMutableDictionary dictionary];
+        self.maximumConcurrentPushCount = 4;
+        
         NSURLSessionConfiguration *sessionConfiguration = [NSURLSessionConfiguration defaultSessionConfiguration];
         self.session = [NSURLSession sessionWithConfiguration:sessionConfiguration];
+        
+        [NSNotificationCenter.defaultCenter addObserver:self
+                                               selector:@selector(preferencesDidChange:)
+                                                   name:SRGPreferencesDidChangeNotification
+                                                 object:self];
     }
     return self;
 }
 
+#pragma mark Getters and setters
+
+- (SRGPreferencesSnapshotFormat)snapshotFormat
+{
+    return self.journal.snapshotFormat;
+}
+
+- (void)setSnapshotFormat:(SRGPreferencesSnapshotFormat)snapshotFormat
+{
+    self.journal.snapshotFormat = snapshotFormat;
+}
+
 #pragma mark Preference management
 
 - (BOOL)hasObjectAtPath:(NSString *)path inDomain:(NSString *)domain
 {
-    NSArray<NSString *> *pathComponents = [SRGPreferences pathComponentsForPath:path inDomain:domain];
-    if (! pathComponents) {
-        return 0;
-    }
-    
-    NSMutableDictionary *dictionary = self.dictionary;
+    SRGPreferencePath *preferencePath = [SRGPreferencePath preferencePathWithPath:path inDomain:domain];
+    return preferencePath ? [self hasObjectAtPreferencePath:preferencePath] : NO;
+}
+
+- (BOOL)hasObjectAtPreferencePath:(SRGPreferencePath *)preferencePath
+{
+    NSArray<NSString *> *pathComponents = preferencePath.pathComponents;
+    NSDictionary *dictionary = self.dictionary;
     for (NSUInteger i = 0; i < pathComponents.count; ++i) {
         NSString *pathComponent = pathComponents[i];
         id value = dictionary[pathComponent];
@@ -231,18 +274,25 @@ static NSDictionary *SRGDictionaryMakeMutableCopy(NSDictionary *dictionary)
 
 - (void)setObject:(id)object atPath:(NSString *)path inDomain:(NSString *)domain
 {
-    NSDictionary *previousDictionary = SRGDictionaryMakeImmutableCopy(self.dictionary);
-    [SRGPreferences updateDictionary:self.dictionary withObject:object atPath:path inDomain:domain];
-    
-    if ([self.dictionary isEqualToDictionary:previousDictionary]) {
-        return;
+    // Never store objects which could be mutated afterwards
+    object = SRGObjectMakeImmutableCopy(object);
+    
+    NSDictionary *previousDictionary = nil;
+    NSDictionary *dictionary = nil;
+    @synchronized(self) {
+        previousDictionary = self.dictionary;
+        dictionary = [SRGPreferences dictionary:previousDictionary byUpdatingObject:object atPath:path inDomain:domain];
+        if (dictionary == previousDictionary) {
+            return;
+        }
+        
+        self.dictionary = dictionary;
+        [self.journal appendRecordWithObject:object atPath:path inDomain:domain];
+        [self compactJournalIfNeeded];
+        
+        [self postChangeNotificationFromDictionary:previousDictionary toDictionary:dictionary forDomains:[NSSet setWithObject:domain]];
     }
     
-    [SRGPreferences savePreferenceDictionary:self.dictionary toFileURL:self.fileURL];
-    [NSNotificationCenter.defaultCenter postNotificationName:SRGPreferencesDidChangeNotification
-                                                      object:self
-                                                    userInfo:@{ SRGPreferencesDomainsKey : [NSSet setWithObject:domain] }];
-    
     [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
         return [SRGUser userInManagedObjectContext:managedObjectContext];
     } withPriority:NSOperationQueuePriorityNormal completionBlock:^(SRGUser * _Nullable user, NSError * _Nullable error) {
@@ -255,12 +305,14 @@ static NSDictionary *SRGDictionaryMakeMutableCopy(NSDictionary *dictionary)
 
 - (id)objectAtPath:(NSString *)path inDomain:(NSString *)domain withClass:(Class)cls
 {
-    NSArray<NSString *> *pathComponents = [SRGPreferences pathComponentsForPath:path inDomain:domain];
-    if (! pathComponents) {
-        return nil;
-    }
-    
-    NSMutableDictionary *dictionary = self.dictionary;
+    SRGPreferencePath *preferencePath = [SRGPreferencePath preferencePathWithPath:path inDomain:domain];
+    return preferencePath ? [self objectAtPreferencePath:preferencePath withClass:cls] : nil;
+}
+
+- (id)objectAtPreferencePath:(SRGPreferencePath *)preferencePath withClass:(Class)cls
+{
+    NSArray<NSString *> *pathComponents = preferencePath.pathComponents;
+    NSDictionary *dictionary = self.dictionary;
     for (NSUInteger i = 0; i < pathComponents.count; ++i) {
         NSString *pathComponent = pathComponents[i];
         id value = dictionary[pathComponent];
@@ -301,29 +353,38 @@ static NSDictionary *SRGDictionaryMakeMutableCopy(NSDictionary *dictionary)
     if (dictionary && ! [NSJSONSerialization isValidJSONObject:dictionary]) {
         return;
     }
-    [self setObject:SRGDictionaryMakeMutableCopy(dictionary) atPath:path inDomain:domain];
+    [self setObject:dictionary atPath:path inDomain:domain];
 }
 
 - (void)setObjectsAtPaths:(NSDictionary<NSString *,id> *)objectsAtPaths inDomain:(NSString *)domain
 {
-    NSDictionary *previousDictionary = SRGDictionaryMakeImmutableCopy(self.dictionary);
+    objectsAtPaths = SRGObjectMakeImmutableCopy(objectsAtPaths);
     
     NSMutableArray<NSString *> *updatedPaths = [NSMutableArray array];
-    [objectsAtPaths enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull path, id  _Nonnull object, BOOL * _Nonnull stop) {
-        if ([SRGPreferences updateDictionary:self.dictionary withObject:object atPath:path inDomain:domain]) {
-            [updatedPaths addObject:path];
+    NSDictionary *previousDictionary = nil;
+    __block NSDictionary *dictionary = nil;
+    @synchronized(self) {
+        previousDictionary = self.dictionary;
+        dictionary = previousDictionary;
+        [objectsAtPaths enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull path, id  _Nonnull object, BOOL * _Nonnull stop) {
+            NSDictionary *updatedDictionary = [SRGPreferences dictionary:dictionary byUpdatingObject:object atPath:path inDomain:domain];
+            if (updatedDictionary != dictionary) {
+                dictionary = updatedDictionary;
+                [self.journal appendRecordWithObject:object atPath:path inDomain:domain];
+                [updatedPaths addObject:path];
+            }
+        }];
+        
+        if (updatedPaths.count == 0) {
+            return;
         }
-    }];
-    
-    if ([self.dictionary isEqualToDictionary:previousDictionary]) {
-        return;
+        
+        self.dictionary = dictionary;
+        [self compactJournalIfNeeded];
+        
+        [self postChangeNotificationFromDictionary:previousDictionary toDictionary:dictionary forDomains:[NSSet setWithObject:domain]];
     }
     
-    [SRGPreferences savePreferenceDictionary:self.dictionary toFileURL:self.fileURL];
-    [NSNotificationCenter.defaultCenter postNotificationName:SRGPreferencesDidChangeNotification
-                                                      object:self
-                                                    userInfo:@{ SRGPreferencesDomainsKey : [NSSet setWithObject:domain] }];
-    
     [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
         return [SRGUser userInManagedObjectContext:managedObjectContext];
     } withPriority:NSOperationQueuePriorityNormal completionBlock:^(SRGUser * _Nullable user, NSError * _Nullable error) {
@@ -353,29 +414,56 @@ static NSDictionary *SRGDictionaryMakeMutableCopy(NSDictionary *dictionary)
 
 - (NSDictionary *)dictionaryAtPath:(NSString *)path inDomain:(NSString *)domain
 {
-    return SRGDictionaryMakeImmutableCopy([self objectAtPath:path inDomain:domain withClass:NSDictionary.class]);
+    return [self objectAtPath:path inDomain:domain withClass:NSDictionary.class];
+}
+
+- (NSString *)stringAtPreferencePath:(SRGPreferencePath *)preferencePath
+{
+    return [self objectAtPreferencePath:preferencePath withClass:NSString.class];
+}
+
+- (NSNumber *)numberAtPreferencePath:(SRGPreferencePath *)preferencePath
+{
+    return [self objectAtPreferencePath:preferencePath withClass:NSNumber.class];
+}
+
+- (NSArray *)arrayAtPreferencePath:(SRGPreferencePath *)preferencePath
+{
+    return [self objectAtPreferencePath:preferencePath withClass:NSArray.class];
+}
+
+- (NSDictionary *)dictionaryAtPreferencePath:(SRGPreferencePath *)preferencePath
+{
+    return [self objectAtPreferencePath:preferencePath withClass:NSDictionary.class];
 }
 
 - (void)removeObjectsAtPaths:(NSArray<NSString *> *)paths inDomain:(NSString *)domain
 {
-    NSDictionary *previousDictionary = SRGDictionaryMakeImmutableCopy(self.dictionary);
-    
     NSMutableSet<NSString *> *removedPaths = [NSMutableSet set];
-    for (NSString *path in paths) {
-        if ([SRGPreferences updateDictionary:self.dictionary withObject:nil atPath:path inDomain:domain]) {
-            [removedPaths addObject:path];
+    NSDictionary *previousDictionary = nil;
+    NSDictionary *dictionary = nil;
+    @synchronized(self) {
+        previousDictionary = self.dictionary;
+        dictionary = previousDictionary;
+        for (NSString *path in paths) {
+            NSDictionary *updatedDictionary = [SRGPreferences dictionary:dictionary byUpdatingObject:nil atPath:path inDomain:domain];
+            if (updatedDictionary != dictionary) {
+                dictionary = updatedDictionary;
+                [self.journal appendRecordWithObject:nil atPath:path inDomain:domain];
+                [removedPaths addObject:path];
+            }
         }
+        
+        if (removedPaths.count == 0) {
+            return;
+        }
+        
+        self.dictionary = dictionary;
+        [self compactJournalIfNeeded];
+        
+        [self postChangeNotificationFromDictionary:previousDictionary toDictionary:dictionary forDomains:[NSSet setWithObject:domain]];
     }
     
-    if ([self.dictionary isEqualToDictionary:previousDictionary]) {
-        return;
-    }
-    
-    [SRGPreferences savePreferenceDictionary:self.dictionary toFileURL:self.fileURL];
-    [NSNotificationCenter.defaultCenter postNotificationName:SRGPreferencesDidChangeNotification
-                                                      object:self
-                                                    userInfo:@{ SRGPreferencesDomainsKey : [NSSet setWithObject:domain] }];
-    
     [self.userData.dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
         return [SRGUser userInManagedObjectContext:managedObjectContext];
     } withPriority:NSOperationQueuePriorityNormal completionBlock:^(SRGUser * _Nullable user, NSError * _Nullable error) {
@@ -388,71 +476,149 @@ static NSDictionary *SRGDictionaryMakeMutableCopy(NSDictionary *dictionary)
     }];
 }
 
-#pragma mark Requests
+#pragma mark Observers
 
-- (void)pushPreferencesForSessionToken:(NSString *)sessionToken
-                   withCompletionBlock:(void (^)(NSError *error))completionBlock
+- (id<NSObject>)addObserverForPath:(NSString *)path inDomain:(NSString *)domain usingBlock:(void (^)(NSSet<NSString *> * _Nonnull))block
+{
+    SRGPreferencePath *preferencePath = [SRGPreferencePath preferencePathWithPath:path inDomain:domain];
+    if (! preferencePath) {
+        return nil;
+    }
+    
+    SRGPreferencesObserver *observer = [[SRGPreferencesObserver alloc] initWithPreferencePath:preferencePath block:block];
+    @synchronized(self.observers) {
+        NSMutableArray<SRGPreferencesObserver *> *domainObservers = self.observers[domain];
+        if (! domainObservers) {
+            domainObservers = [NSMutableArray array];
+            self.observers[domain] = domainObservers;
+        }
+        [domainObservers addObject:observer];
+    }
+    return observer;
+}
+
+- (void)removeObserver:(id<NSObject>)observer
 {
-    NSArray<SRGPreferencesChangelogEntry *> *entries = self.changelog.entries;
-    if (entries.count == 0) {
-        completionBlock(nil);
+    if (! [observer isKindOfClass:SRGPreferencesObserver.class]) {
         return;
     }
     
-    typedef void (^PushEntryBlock)(NSUInteger index);
-    __block __weak PushEntryBlock weakPushEntry = nil;
+    NSString *domain = ((SRGPreferencesObserver *)observer).preferencePath.domain;
+    @synchronized(self.observers) {
+        [self.observers[domain] removeObjectIdenticalTo:observer];
+        if (self.observers[domain].count == 0) {
+            [self.observers removeObjectForKey:domain];
+        }
+    }
+}
+
+#pragma mark Notifications
+
+// Must be called within a synchronized block, so that notifications are delivered in the order changes were made
+- (void)postChangeNotificationFromDictionary:(NSDictionary *)previousDictionary toDictionary:(NSDictionary *)dictionary forDomains:(NSSet<NSString *> *)domains
+{
+    NSMutableDictionary<NSString *, NSSet<NSString *> *> *changedPaths = [NSMutableDictionary dictionary];
+    for (NSString *domain in domains) {
+        // Compare domain contents so that paths are reported relative to the domain
+        NSMutableSet<NSString *> *paths = [NSMutableSet set];
+        SRGAddChangedPaths(previousDictionary[domain] ?: @{}, dictionary[domain] ?: @{}, nil, paths);
+        if (paths.count != 0) {
+            changedPaths[domain] = paths.copy;
+        }
+    }
     
-    // TODO: Implementation could / should be simpler. The requests should be serializable by HTTPMaximumConnectionsPerHost
-    //       to 1 on the session configuration. Sadly this is not serialized enough for the server which will drop some of
-    //       the submitted changes randomly.
-    PushEntryBlock pushEntry = ^(NSUInteger index) {
-        PushEntryBlock strongPushEntry = weakPushEntry;
-        
-        SRGPreferencesChangelogEntry *entry = entries[index];
+    if (changedPaths.count == 0) {
+        return;
+    }
+    
+    [self.userData.notificationDispatcher postNotificationName:SRGPreferencesDidChangeNotification
+                                                        object:self
+                                                      userInfo:@{ SRGPreferencesDomainsKey : [NSSet setWithArray:changedPaths.allKeys],
+                                                                  SRGPreferencesPathsKey : changedPaths.copy }
+                                          coalescingUidsForKey:nil];
+}
+
+- (void)preferencesDidChange:(NSNotification *)notification
+{
+    NSDictionary<NSString *, NSSet<NSString *> *> *changedPaths = notification.userInfo[SRGPreferencesPathsKey];
+    [changedPaths enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull domain, NSSet<NSString *> * _Nonnull paths, BOOL * _Nonnull stop) {
+        NSArray<SRGPreferencesObserver *> *observers = nil;
+        @synchronized(self.observers) {
+            observers = self.observers[domain].copy;
+        }
         
+        for (SRGPreferencesObserver *observer in observers) {
+            [observer notifyChangedPaths:paths];
+        }
+    }];
+}
+
+#pragma mark Persistence
+
+- (void)saveSnapshot
+{
+    [self.journal saveSnapshotWithDictionary:self.dictionary];
+}
+
+// Changes are appended to the journal, so that a set only costs the size of the change. The whole tree is only written
+// again once the journal has grown larger than the last snapshot.
+- (void)compactJournalIfNeeded
+{
+    if (self.journal.needsCompaction) {
+        [self saveSnapshot];
+    }
+}
+
+#pragma mark Requests
+
+- (void)pushPreferencesForSessionToken:(NSString *)sessionToken
+                   withCompletionBlock:(void (^)(NSError *error))completionBlock
+{
+    // Requests submitted concurrently for the same path might be applied in any order by the server. Changes made to
+    // overlapping locations are therefore pushed one after the other, in the order they were made.
+    SRGPreferencesPushScheduler *pushScheduler = [[SRGPreferencesPushScheduler alloc] initWithEntries:self.changelog.entries maximumConcurrentPushCount:self.maximumConcurrentPushCount pushBlock:^(SRGPreferencesChangelogEntry * _Nonnull entry, SRGPreferencesPushCompletionBlock _Nonnull completionBlock) {
         void (^pushCompletionBlock)(NSHTTPURLResponse *, NSError *) = ^(NSHTTPURLResponse * _Nullable HTTPResponse, NSError *error) {
-            if (error) {
-                completionBlock(error);
-                return;
-            }
-            
-            [self.changelog removeEntry:entry];
-            
-            if (index < entries.count - 1) {
-                strongPushEntry(index + 1);
-            }
-            else {
-                completionBlock(nil);
+            if (! error) {
+                [self.changelog removeEntry:entry];
             }
+            completionBlock(error);
         };
         
+        SRGRequest *request = nil;
         if (entry.object) {
-            SRGRequest *request = [[SRGPreferencesRequest putPreferenceWithObject:entry.object atPath:entry.path inDomain:entry.domain toServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:pushCompletionBlock] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled | SRGRequestOptionCancellationErrorsEnabled];
-            [request resume];
-            self.pushRequest = request;
+            request = [SRGPreferencesRequest putPreferenceWithObject:entry.object atPath:entry.path inDomain:entry.domain toServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:pushCompletionBlock];
         }
         else {
-            SRGRequest *request = [[SRGPreferencesRequest deletePreferenceAtPath:entry.path inDomain:entry.domain fromServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:pushCompletionBlock] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled | SRGRequestOptionCancellationErrorsEnabled];
-            [request resume];
-            self.pushRequest = request;
+            request = [SRGPreferencesRequest deletePreferenceAtPath:entry.path inDomain:entry.domain fromServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:pushCompletionBlock];
         }
-    };
-    weakPushEntry = pushEntry;
+        request = [request requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled | SRGRequestOptionCancellationErrorsEnabled];
+        [request resume];
         
-    pushEntry(0);
+        @synchronized(self.pushRequests) {
+            [self.pushRequests addObject:request];
+        }
+    }];
+    [pushScheduler startWithCompletionBlock:completionBlock];
+    self.pushScheduler = pushScheduler;
 }
 
 - (void)pullPreferencesForSessionToken:(NSString *)sessionToken
                    withCompletionBlock:(void (^)(NSError *error))completionBlock
 {
-    NSMutableSet<NSString *> *changedDomains = [NSMutableSet setWithArray:self.dictionary.allKeys];
+    NSDictionary<NSString *, NSDictionary *> *validators = self.validators.copy;
+    
+    // Results are collected and applied at once when all requests have been successfully completed. Only domains which
+    // changed since the last pull are received.
+    NSMutableDictionary<NSString *, NSDictionary *> *pulledDictionaries = [NSMutableDictionary dictionary];
+    NSMutableDictionary<NSString *, NSDictionary *> *pulledValidators = [NSMutableDictionary dictionary];
+    NSMutableArray<NSString *> *remoteDomains = [NSMutableArray array];
     
     self.requestQueue = [[[SRGRequestQueue alloc] initWithStateChangeBlock:^(BOOL finished, NSError * _Nullable error) {
         if (finished) {
-            if (changedDomains.count != 0) {
-                [NSNotificationCenter.defaultCenter postNotificationName:SRGPreferencesDidChangeNotification
-                                                                  object:self
-                                                                userInfo:@{ SRGPreferencesDomainsKey : changedDomains }];
+            if (! error) {
+                @synchronized(pulledDictionaries) {
+                    [self applyPulledDictionaries:pulledDictionaries withValidators:pulledValidators forRemoteDomains:remoteDomains];
+                }
             }
             completionBlock(error);
         }
@@ -464,43 +630,86 @@ static NSDictionary *SRGDictionaryMakeMutableCopy(NSDictionary *dictionary)
             return;
         }
         
-        NSSet<NSString *> *deletedDomains = [changedDomains srguserdata_setByRemovingObjectsInArray:domains];
-        if (deletedDomains.count != 0) {
-            for (NSString *domain in deletedDomains) {
-                [self.dictionary removeObjectForKey:domain];
-            }
-            [SRGPreferences savePreferenceDictionary:self.dictionary toFileURL:self.fileURL];
+        @synchronized(pulledDictionaries) {
+            [remoteDomains addObjectsFromArray:domains];
         }
         
-        if (domains.count != 0) {
-            [changedDomains addObjectsFromArray:domains];
-            
-            for (NSString *domain in domains) {
-                SRGRequest *preferencesRequest = [SRGPreferencesRequest preferencesAtPath:nil inDomain:domain fromServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:^(NSDictionary * _Nullable dictionary, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
+        for (NSString *domain in domains) {
+            SRGRequest *preferencesRequest = [SRGPreferencesRequest preferencesInDomain:domain withValidators:validators[domain] fromServiceURL:self.serviceURL forSessionToken:sessionToken withSession:self.session completionBlock:^(NSDictionary * _Nullable dictionary, NSHTTPURLResponse * _Nullable HTTPResponse, NSError * _Nullable error) {
+                if (error) {
                     [self.requestQueue reportError:error];
-                    
-                    if (dictionary && ! [self.dictionary isEqualToDictionary:dictionary]) {
-                        self.dictionary[domain] = SRGDictionaryMakeMutableCopy(dictionary);
-                        [SRGPreferences savePreferenceDictionary:self.dictionary toFileURL:self.fileURL];
+                    return;
+                }
+                
+                @synchronized(pulledDictionaries) {
+                    if (dictionary) {
+                        pulledDictionaries[domain] = dictionary;
+                        pulledValidators[domain] = [SRGPreferencesRequest validatorsForHTTPResponse:HTTPResponse];
                     }
-                }];
-                [self.requestQueue addRequest:preferencesRequest resume:YES];
-            }
+                    else {
+                        pulledValidators[domain] = validators[domain];
+                    }
+                }
+            }];
+            [self.requestQueue addRequest:preferencesRequest resume:YES];
         }
     }] requestWithOptions:SRGRequestOptionBackgroundCompletionEnabled | SRGRequestOptionCancellationErrorsEnabled];
     [self.requestQueue addRequest:domainsRequest resume:YES];
 }
 
+- (void)applyPulledDictionaries:(NSDictionary<NSString *, NSDictionary *> *)pulledDictionaries
+                 withValidators:(NSDictionary<NSString *, NSDictionary *> *)validators
+               forRemoteDomains:(NSArray<NSString *> *)remoteDomains
+{
+    NSMutableSet<NSString *> *changedDomains = [NSMutableSet set];
+    
+    NSDictionary *previousDictionary = nil;
+    NSMutableDictionary *dictionary = nil;
+    @synchronized(self) {
+        previousDictionary = self.dictionary;
+        dictionary = previousDictionary.mutableCopy;
+        
+        NSSet<NSString *> *deletedDomains = [[NSSet setWithArray:dictionary.allKeys] srguserdata_setByRemovingObjectsInArray:remoteDomains];
+        for (NSString *domain in deletedDomains) {
+            [dictionary removeObjectForKey:domain];
+            [changedDomains addObject:domain];
+        }
+        
+        [pulledDictionaries enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull domain, NSDictionary * _Nonnull pulledDictionary, BOOL * _Nonnull stop) {
+            // Empty domains are not stored
+            NSDictionary *currentDictionary = dictionary[domain] ?: @{};
+            if ([currentDictionary isEqualToDictionary:pulledDictionary]) {
+                return;
+            }
+            
+            dictionary[domain] = (pulledDictionary.count != 0) ? pulledDictionary : nil;
+            [changedDomains addObject:domain];
+        }];
+        
+        if (changedDomains.count != 0) {
+            self.dictionary = dictionary.copy;
+            [self saveSnapshot];
+            
+            [self postChangeNotificationFromDictionary:previousDictionary toDictionary:dictionary forDomains:changedDomains];
+        }
+    }
+    
+    if (! [self.validators isEqualToDictionary:validators]) {
+        self.validators = validators.copy;
+        [SRGPreferences saveValidators:self.validators toFileURL:self.validatorsFileURL];
+    }
+}
+
 #pragma mark Subclassing hooks
 
 - (void)prepareDataForInitialSynchronizationWithCompletionBlock:(void (^)(void))completionBlock
 {
-    if (! [NSFileManager.defaultManager fileExistsAtPath:self.fileURL.path]) {
+    if (self.dictionary.count == 0) {
         completionBlock();
         return;
     }
     
-    NSArray<SRGPreferencesChangelogEntry *> *entries = [SRGPreferencesChangelogEntry changelogEntriesFromPreferencesFileAtURL:self.fileURL];
+    NSArray<SRGPreferencesChangelogEntry *> *entries = [SRGPreferencesChangelogEntry changelogEntriesForPreferenceDictionary:self.dictionary];
     [entries enumerateObjectsUsingBlock:^(SRGPreferencesChangelogEntry * _Nonnull entry, NSUInteger idx, BOOL * _Nonnull stop) {
         [self.changelog addEntry:entry];
     }];
@@ -524,24 +733,31 @@ static NSDictionary *SRGDictionaryMakeMutableCopy(NSDictionary *dictionary)
 
 - (void)cancelSynchronization
 {
-    [self.pushRequest cancel];
+    [self.pushScheduler cancel];
     [self.requestQueue cancel];
+    
+    NSArray<SRGRequest *> *pushRequests = nil;
+    @synchronized(self.pushRequests) {
+        pushRequests = self.pushRequests.allObjects;
+    }
+    [pushRequests makeObjectsPerformSelector:@selector(cancel)];
 }
 
 - (void)clearData
 {
-    NSSet<NSString *> *previousDomains = [NSSet setWithArray:self.dictionary.allKeys];
+    @synchronized(self) {
+        NSDictionary *previousDictionary = self.dictionary;
+        
+        self.dictionary = @{};
+        [self.journal erase];
+        
+        [self postChangeNotificationFromDictionary:previousDictionary toDictionary:@{} forDomains:[NSSet setWithArray:previousDictionary.allKeys]];
+    }
     
-    [NSFileManager.defaultManager removeItemAtURL:self.fileURL error:NULL];
-    [self.dictionary removeAllObjects];
+    [NSFileManager.defaultManager removeItemAtURL:self.validatorsFileURL error:NULL];
+    self.validators = @{};
     
     [self.changelog removeAllEntries];
-    
-    dispatch_async(dispatch_get_main_queue(), ^{
-        [NSNotificationCenter.defaultCenter postNotificationName:SRGPreferencesDidChangeNotification
-                                                          object:self
-                                                        userInfo:@{ SRGPreferencesDomainsKey : previousDomains }];
-    });
 }
 
 #pragma mark Description
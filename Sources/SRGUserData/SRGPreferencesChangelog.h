@@ -10,6 +10,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  *  Changelog saving non-submitted single changes made to preferences.
+ *
+ *  At most one entry is kept per domain and path. Adding an entry supersedes the pending entry for the same location,
+ *  if any. Entries are saved in an append-only log, periodically compacted.
  */
 @interface SRGPreferencesChangelog : NSObject
 
@@ -24,7 +27,7 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, readonly) NSArray<SRGPreferencesChangelogEntry *> *entries;
 
 /**
- *  Manage single entries in the changelog.
+ *  Manage single entries in the changelog. Removing an entry which has been superseded in the meantime does nothing.
  */
 - (void)addEntry:(SRGPreferencesChangelogEntry *)entry;
 - (void)removeEntry:(SRGPreferencesChangelogEntry *)entry;
@@ -34,6 +37,11 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)removeAllEntries;
 
+/**
+ *  Wait until all pending file operations have been performed.
+ */
+- (void)synchronize;
+
 @end
 
 @interface SRGPreferencesChangelog (Unavailable)
@@ -6,12 +6,35 @@
 
 #import "SRGPreferencesChangelog.h"
 
+#import "NSData+SRGUserData.h"
+#import "NSFileHandle+SRGUserData.h"
 #import "SRGUserDataLogger.h"
 
+// Number of records below which the log is never compacted.
+static const NSUInteger SRGPreferencesChangelogMinimumCompactionRecordCount = 256;
+
+// Record keys. A record without object corresponds to a removal, an acknowledged record to an entry which has been
+// removed from the changelog.
+static NSString * const SRGPreferencesChangelogSequenceNumberKey = @"s";
+static NSString * const SRGPreferencesChangelogDomainKey = @"d";
+static NSString * const SRGPreferencesChangelogPathKey = @"p";
+static NSString * const SRGPreferencesChangelogObjectKey = @"o";
+static NSString * const SRGPreferencesChangelogAcknowledgedKey = @"a";
+
 @interface SRGPreferencesChangelog ()
 
 @property (nonatomic) NSURL *fileURL;
-@property (nonatomic) NSArray<SRGPreferencesChangelogEntry *> *changelogEntries;
+@property (nonatomic) NSURL *legacyFileURL;
+@property (nonatomic) NSFileHandle *fileHandle;
+
+// Pending entries and their sequence numbers, by location
+@property (nonatomic) NSMutableDictionary<NSString *, SRGPreferencesChangelogEntry *> *pendingEntries;
+@property (nonatomic) NSMutableDictionary<NSString *, NSNumber *> *sequenceNumbers;
+
+@property (nonatomic) NSUInteger lastSequenceNumber;
+@property (nonatomic) NSUInteger recordCount;
+
+@property (nonatomic) dispatch_queue_t queue;
 
 @end
 
@@ -19,29 +42,25 @@
 
 #pragma mark Class methods
 
-+ (void)saveChangelogEntries:(NSArray<SRGPreferencesChangelogEntry *> *)changelogEntries toFileURL:(NSURL *)fileURL
++ (NSString *)locationForEntryInDomain:(NSString *)domain atPath:(NSString *)path
 {
-    NSError *adapterError = nil;
-    NSArray *JSONArray = [MTLJSONAdapter JSONArrayFromModels:changelogEntries error:&adapterError];
-    if (adapterError) {
-        SRGUserDataLogError(@"preference_changelog", @"Could not save changelog. Reason %@", adapterError);
-        return;
-    }
-    
-    NSError *JSONError = nil;
-    NSData *data = [NSJSONSerialization dataWithJSONObject:JSONArray options:0 error:&JSONError];
-    if (JSONError) {
-        SRGUserDataLogError(@"preference_changelog", @"Could not save changelog. Reason %@", JSONError);
-        return;
+    NSString *trimmedPath = [path stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"/"]];
+    return [NSString stringWithFormat:@"%@/%@", domain, trimmedPath ?: @""];
+}
+
++ (NSDictionary *)recordForEntry:(SRGPreferencesChangelogEntry *)entry withSequenceNumber:(NSUInteger)sequenceNumber acknowledged:(BOOL)acknowledged
+{
+    NSMutableDictionary *record = [NSMutableDictionary dictionary];
+    record[SRGPreferencesChangelogSequenceNumberKey] = @(sequenceNumber);
+    record[SRGPreferencesChangelogDomainKey] = entry.domain;
+    record[SRGPreferencesChangelogPathKey] = entry.path;
+    if (acknowledged) {
+        record[SRGPreferencesChangelogAcknowledgedKey] = @YES;
     }
-    
-    NSError *writeError = nil;
-    if (! [data writeToURL:fileURL options:NSDataWritingAtomic error:&writeError]) {
-        SRGUserDataLogError(@"preference_changelog", @"Could not save changelog. Reason %@", writeError);
-        return;
+    else {
+        record[SRGPreferencesChangelogObjectKey] = entry.object;
     }
-    
-    SRGUserDataLogInfo(@"preference_changelog", @"Changelog successfully saved");
+    return record.copy;
 }
 
 + (NSArray<SRGPreferencesChangelogEntry *> *)savedChangelogEntriesFromFileURL:(NSURL *)fileURL
@@ -82,39 +101,212 @@
 - (instancetype)initForPreferencesFileWithURL:(NSURL *)preferencesFileURL
 {
     if (self = [super init]) {
-        self.fileURL = [preferencesFileURL URLByAppendingPathExtension:@"changes"];
-        self.changelogEntries = [SRGPreferencesChangelog savedChangelogEntriesFromFileURL:self.fileURL] ?: [NSArray array];
+        self.fileURL = [preferencesFileURL URLByAppendingPathExtension:@"changelog"];
+        self.legacyFileURL = [preferencesFileURL URLByAppendingPathExtension:@"changes"];
+        self.pendingEntries = [NSMutableDictionary dictionary];
+        self.sequenceNumbers = [NSMutableDictionary dictionary];
+        self.queue = dispatch_queue_create("ch.srgssr.userdata.preferences.changelog", DISPATCH_QUEUE_SERIAL);
+        
+        [self loadRecords];
+        [self migrateLegacyEntries];
     }
     return self;
 }
 
+- (void)dealloc
+{
+    [_fileHandle closeFile];
+}
+
 #pragma mark Getters and setters
 
 - (NSArray<SRGPreferencesChangelogEntry *> *)entries
 {
-    return self.changelogEntries.copy;
+    @synchronized(self) {
+        NSArray<NSString *> *locations = [self.sequenceNumbers keysSortedByValueUsingSelector:@selector(compare:)];
+        return [self.pendingEntries objectsForKeys:locations notFoundMarker:NSNull.null];
+    }
 }
 
 #pragma mark Changelog management
 
 - (void)addEntry:(SRGPreferencesChangelogEntry *)entry
 {
-    // TODO: Could be optimized. Some operations (e.g. a deletion followed by an insertion) could namely be coalesced
-    //       into a single operation, reducing the number of operations to be submitted afterwards.
-    self.changelogEntries = [self.changelogEntries arrayByAddingObject:entry];
-    [SRGPreferencesChangelog saveChangelogEntries:self.changelogEntries toFileURL:self.fileURL];
+    @synchronized(self) {
+        // A pending entry for the same location is superseded, and therefore simply replaced.
+        NSString *location = [SRGPreferencesChangelog locationForEntryInDomain:entry.domain atPath:entry.path];
+        NSUInteger sequenceNumber = ++self.lastSequenceNumber;
+        self.pendingEntries[location] = entry;
+        self.sequenceNumbers[location] = @(sequenceNumber);
+        
+        [self appendRecord:[SRGPreferencesChangelog recordForEntry:entry withSequenceNumber:sequenceNumber acknowledged:NO]];
+    }
 }
 
 - (void)removeEntry:(SRGPreferencesChangelogEntry *)entry
 {
-    self.changelogEntries = [self.changelogEntries mtl_arrayByRemovingObject:entry];
-    [SRGPreferencesChangelog saveChangelogEntries:self.changelogEntries toFileURL:self.fileURL];
+    @synchronized(self) {
+        NSString *location = [SRGPreferencesChangelog locationForEntryInDomain:entry.domain atPath:entry.path];
+        if (self.pendingEntries[location] != entry) {
+            return;
+        }
+        
+        NSUInteger sequenceNumber = self.sequenceNumbers[location].unsignedIntegerValue;
+        [self.pendingEntries removeObjectForKey:location];
+        [self.sequenceNumbers removeObjectForKey:location];
+        
+        [self appendRecord:[SRGPreferencesChangelog recordForEntry:entry withSequenceNumber:sequenceNumber acknowledged:YES]];
+    }
 }
 
 - (void)removeAllEntries
 {
-    [NSFileManager.defaultManager removeItemAtURL:self.fileURL error:NULL];
-    self.changelogEntries = @[];
+    @synchronized(self) {
+        [self.pendingEntries removeAllObjects];
+        [self.sequenceNumbers removeAllObjects];
+        self.recordCount = 0;
+        
+        dispatch_async(self.queue, ^{
+            [self.fileHandle closeFile];
+            self.fileHandle = nil;
+            
+            [NSFileManager.defaultManager removeItemAtURL:self.fileURL error:NULL];
+        });
+    }
+}
+
+- (void)synchronize
+{
+    dispatch_sync(self.queue, ^{
+        [self.fileHandle synchronizeFile];
+    });
+}
+
+#pragma mark Persistence
+
+- (void)loadRecords
+{
+    NSData *data = [NSData dataWithContentsOfURL:self.fileURL options:NSDataReadingMappedIfSafe error:NULL];
+    [data srguserdata_enumerateJSONLinesUsingBlock:^(id _Nullable JSONObject) {
+        NSDictionary *record = JSONObject;
+        if (! [record isKindOfClass:NSDictionary.class]
+                || ! [record[SRGPreferencesChangelogSequenceNumberKey] isKindOfClass:NSNumber.class]
+                || ! [record[SRGPreferencesChangelogDomainKey] isKindOfClass:NSString.class]) {
+            SRGUserDataLogWarning(@"preference_changelog", @"Ignored invalid changelog record");
+            return;
+        }
+        
+        self.recordCount += 1;
+        
+        NSNumber *sequenceNumber = record[SRGPreferencesChangelogSequenceNumberKey];
+        self.lastSequenceNumber = MAX(self.lastSequenceNumber, sequenceNumber.unsignedIntegerValue);
+        
+        NSString *domain = record[SRGPreferencesChangelogDomainKey];
+        NSString *path = [record[SRGPreferencesChangelogPathKey] isKindOfClass:NSString.class] ? record[SRGPreferencesChangelogPathKey] : nil;
+        NSString *location = [SRGPreferencesChangelog locationForEntryInDomain:domain atPath:path];
+        
+        if ([record[SRGPreferencesChangelogAcknowledgedKey] boolValue]) {
+            if ([self.sequenceNumbers[location] isEqualToNumber:sequenceNumber]) {
+                [self.pendingEntries removeObjectForKey:location];
+                [self.sequenceNumbers removeObjectForKey:location];
+            }
+        }
+        else {
+            self.pendingEntries[location] = [SRGPreferencesChangelogEntry changelogEntryWithObject:record[SRGPreferencesChangelogObjectKey] atPath:path inDomain:domain];
+            self.sequenceNumbers[location] = sequenceNumber;
+        }
+    }];
+}
+
+// Changelogs were previously saved as a JSON array of entries, rewritten after each change.
+- (void)migrateLegacyEntries
+{
+    NSArray<SRGPreferencesChangelogEntry *> *legacyEntries = [SRGPreferencesChangelog savedChangelogEntriesFromFileURL:self.legacyFileURL];
+    if (! legacyEntries) {
+        return;
+    }
+    
+    for (SRGPreferencesChangelogEntry *entry in legacyEntries) {
+        [self addEntry:entry];
+    }
+    
+    dispatch_async(self.queue, ^{
+        [NSFileManager.defaultManager removeItemAtURL:self.legacyFileURL error:NULL];
+    });
+}
+
+// Must be called within a synchronized block
+- (void)appendRecord:(NSDictionary *)record
+{
+    NSError *JSONError = nil;
+    NSData *data = [NSData srguserdata_JSONLineWithObject:record error:&JSONError];
+    if (! data) {
+        SRGUserDataLogError(@"preference_changelog", @"Could not save changelog record. Reason %@", JSONError);
+        return;
+    }
+    
+    self.recordCount += 1;
+    
+    // Superseded and acknowledged entries are only cleaned up once they make for most of the log.
+    if (self.recordCount > MAX(SRGPreferencesChangelogMinimumCompactionRecordCount, 2 * self.pendingEntries.count)) {
+        [self compact];
+        return;
+    }
+    
+    dispatch_async(self.queue, ^{
+        if (! self.fileHandle) {
+            // A truncated record left by a previous session is discarded, so that new records are not merged into it
+            self.fileHandle = [NSFileHandle srguserdata_fileHandleForAppendingJSONLinesAtURL:self.fileURL];
+            if (! self.fileHandle) {
+                SRGUserDataLogError(@"preference_changelog", @"Could not open changelog for writing");
+                return;
+            }
+        }
+        
+        [self.fileHandle writeData:data];
+    });
+}
+
+// Must be called within a synchronized block
+- (void)compact
+{
+    NSMutableData *data = [NSMutableData data];
+    NSArray<NSString *> *locations = [self.sequenceNumbers keysSortedByValueUsingSelector:@selector(compare:)];
+    for (NSString *location in locations) {
+        NSDictionary *record = [SRGPreferencesChangelog recordForEntry:self.pendingEntries[location]
+                                                    withSequenceNumber:self.sequenceNumbers[location].unsignedIntegerValue
+                                                          acknowledged:NO];
+        NSData *recordData = [NSData srguserdata_JSONLineWithObject:record error:NULL];
+        if (recordData) {
+            [data appendData:recordData];
+        }
+    }
+    
+    self.recordCount = locations.count;
+    
+    dispatch_async(self.queue, ^{
+        [self.fileHandle closeFile];
+        self.fileHandle = nil;
+        
+        NSError *writeError = nil;
+        if (! [data writeToURL:self.fileURL options:NSDataWritingAtomic error:&writeError]) {
+            SRGUserDataLogError(@"preference_changelog", @"Could not save changelog. Reason %@", writeError);
+            return;
+        }
+        
+        SRGUserDataLogInfo(@"preference_changelog", @"Changelog successfully compacted");
+    });
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; fileURL = %@; entries = %@>",
+            self.class,
+            self,
+            self.fileURL,
+            self.entries];
 }
 
 @end
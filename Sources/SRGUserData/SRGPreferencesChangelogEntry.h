@@ -20,10 +20,9 @@ NS_ASSUME_NONNULL_BEGIN
 + (SRGPreferencesChangelogEntry *)changelogEntryWithObject:(nullable id)object atPath:(NSString *)path inDomain:(NSString *)domain;
 
 /**
- *  Convert an existing preferences file into a list of equivalent changelog entries. Returns `nil` if the file does not
- *  exist or is invalid.
+ *  Convert an existing preference tree (with domains as top-level keys) into a list of equivalent changelog entries.
  */
-+ (nullable NSArray<SRGPreferencesChangelogEntry *> *)changelogEntriesFromPreferencesFileAtURL:(NSURL *)fileURL;
++ (NSArray<SRGPreferencesChangelogEntry *> *)changelogEntriesForPreferenceDictionary:(NSDictionary *)dictionary;
 
 /**
  *  Entry properties.
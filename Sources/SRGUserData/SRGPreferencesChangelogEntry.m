@@ -27,32 +27,14 @@
     return [[self.class alloc] initWithObject:object atPath:path inDomain:domain];
 }
 
-+ (NSArray<SRGPreferencesChangelogEntry *> *)changelogEntriesFromPreferencesFileAtURL:(NSURL *)fileURL
++ (NSArray<SRGPreferencesChangelogEntry *> *)changelogEntriesForPreferenceDictionary:(NSDictionary *)dictionary
 {
-    NSData *data = [NSData dataWithContentsOfURL:fileURL];
-    if (! data) {
-        return nil;
-    }
-    
-    NSError *JSONError = nil;
-    id JSONObject = [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingMutableContainers error:&JSONError];
-    if (JSONError) {
-        SRGUserDataLogError(@"changelog_entry", @"Could not read preference file. Reason %@", JSONError);
-        return nil;
-    }
-    
-    if (! [JSONObject isKindOfClass:NSDictionary.class]) {
-        SRGUserDataLogError(@"preferences", @"Could not read preference file. The format is invalid");
-        return nil;
-    }
-    
-    NSDictionary *JSONDictionary = JSONObject;
-    
     NSMutableArray<SRGPreferencesChangelogEntry *> *entries = [NSMutableArray array];
-    for (NSString *domain in JSONDictionary) {
-        id value = JSONDictionary[domain];
+    for (NSString *domain in dictionary) {
+        id value = dictionary[domain];
         if (! [value isKindOfClass:NSDictionary.class]) {
             SRGUserDataLogWarning(@"preferences", @"Could not recover entries in the '%@' domain. The format is invalid", domain);
+            continue;
         }
         
         NSArray<SRGPreferencesChangelogEntry *> *domainEntries = [self changelogEntriesForDictionary:value atPath:nil inDomain:domain];
@@ -0,0 +1,72 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPreferencesSnapshot.h"
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Persistence of a preference file as a snapshot of the whole preference tree, followed by an append-only journal of
+ *  the changes made since the snapshot was saved. Preferences are restored by reading the snapshot, then replaying the
+ *  journal records.
+ *
+ *  All file operations are performed in order on a background serial queue.
+ */
+@interface SRGPreferencesJournal : NSObject
+
+/**
+ *  Create a journal associated with the specified preference (snapshot) file.
+ */
+- (instancetype)initForPreferencesFileWithURL:(NSURL *)preferencesFileURL;
+
+/**
+ *  Enumerate the records saved in the journal, from the oldest to the most recent one. A `nil` object corresponds to
+ *  a removal.
+ */
+- (void)enumerateRecordsUsingBlock:(void (^)(id _Nullable object, NSString * _Nullable path, NSString *domain))block;
+
+/**
+ *  Append a record for setting an object at a specific path in a domain. The object might be `nil` for removal.
+ */
+- (void)appendRecordWithObject:(nullable id)object atPath:(nullable NSString *)path inDomain:(NSString *)domain;
+
+/**
+ *  Return `YES` iff the journal has grown large enough for compaction into a new snapshot to be worth it.
+ */
+@property (nonatomic, readonly) BOOL needsCompaction;
+
+/**
+ *  The format in which snapshots are saved. Snapshots are read whatever their format. Default is JSON.
+ */
+@property (atomic) SRGPreferencesSnapshotFormat snapshotFormat;
+
+/**
+ *  Save the specified preference tree as new snapshot, discarding all records appended so far. The dictionary must
+ *  not be mutated afterwards.
+ */
+- (void)saveSnapshotWithDictionary:(NSDictionary *)dictionary;
+
+/**
+ *  Delete the snapshot and the journal.
+ */
+- (void)erase;
+
+/**
+ *  Wait until all pending file operations have been performed.
+ */
+- (void)synchronize;
+
+@end
+
+@interface SRGPreferencesJournal (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
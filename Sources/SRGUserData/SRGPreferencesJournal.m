@@ -0,0 +1,191 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPreferencesJournal.h"
+
+#import "NSData+SRGUserData.h"
+#import "NSFileHandle+SRGUserData.h"
+#import "SRGUserDataLogger.h"
+
+// Journal size below which compaction is never performed.
+static const unsigned long long SRGPreferencesJournalMinimumCompactionLength = 64 * 1024;
+
+// Record keys. A record without object corresponds to a removal.
+static NSString * const SRGPreferencesJournalDomainKey = @"d";
+static NSString * const SRGPreferencesJournalPathKey = @"p";
+static NSString * const SRGPreferencesJournalObjectKey = @"o";
+
+@interface SRGPreferencesJournal ()
+
+@property (nonatomic) NSURL *snapshotFileURL;
+@property (nonatomic) NSURL *fileURL;
+@property (nonatomic) NSFileHandle *fileHandle;
+
+@property (atomic) unsigned long long length;
+@property (atomic) unsigned long long snapshotLength;
+
+@property (nonatomic) dispatch_queue_t queue;
+
+@end
+
+@implementation SRGPreferencesJournal
+
+#pragma mark Object lifecycle
+
+- (instancetype)initForPreferencesFileWithURL:(NSURL *)preferencesFileURL
+{
+    if (self = [super init]) {
+        self.snapshotFileURL = preferencesFileURL;
+        self.fileURL = [preferencesFileURL URLByAppendingPathExtension:@"journal"];
+        self.queue = dispatch_queue_create("ch.srgssr.userdata.preferences.journal", DISPATCH_QUEUE_SERIAL);
+        
+        NSDictionary<NSFileAttributeKey, id> *attributes = [NSFileManager.defaultManager attributesOfItemAtPath:self.fileURL.path error:NULL];
+        self.length = attributes.fileSize;
+        
+        NSDictionary<NSFileAttributeKey, id> *snapshotAttributes = [NSFileManager.defaultManager attributesOfItemAtPath:self.snapshotFileURL.path error:NULL];
+        self.snapshotLength = snapshotAttributes.fileSize;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_fileHandle closeFile];
+}
+
+#pragma mark Getters and setters
+
+- (BOOL)needsCompaction
+{
+    return self.length > MAX(SRGPreferencesJournalMinimumCompactionLength, self.snapshotLength);
+}
+
+#pragma mark Records
+
+- (void)enumerateRecordsUsingBlock:(void (^)(id _Nullable, NSString * _Nullable, NSString * _Nonnull))block
+{
+    __block NSData *data = nil;
+    dispatch_sync(self.queue, ^{
+        data = [NSData dataWithContentsOfURL:self.fileURL options:NSDataReadingMappedIfSafe error:NULL];
+    });
+    
+    [data srguserdata_enumerateJSONLinesUsingBlock:^(id _Nullable JSONObject) {
+        // A truncated record can only be found at the end of the journal, if the application was killed while it
+        // was being written. It is discarded when the journal is next opened for writing.
+        NSDictionary *record = JSONObject;
+        if (! [record isKindOfClass:NSDictionary.class] || ! [record[SRGPreferencesJournalDomainKey] isKindOfClass:NSString.class]) {
+            SRGUserDataLogWarning(@"preferences_journal", @"Ignored invalid journal record");
+            return;
+        }
+        
+        NSString *path = record[SRGPreferencesJournalPathKey];
+        block(record[SRGPreferencesJournalObjectKey], [path isKindOfClass:NSString.class] ? path : nil, record[SRGPreferencesJournalDomainKey]);
+    }];
+}
+
+- (void)appendRecordWithObject:(id)object atPath:(NSString *)path inDomain:(NSString *)domain
+{
+    NSMutableDictionary *record = [NSMutableDictionary dictionary];
+    record[SRGPreferencesJournalDomainKey] = domain;
+    record[SRGPreferencesJournalPathKey] = path;
+    record[SRGPreferencesJournalObjectKey] = object;
+    
+    // Encode on the caller thread, as the object might be mutated afterwards
+    NSError *JSONError = nil;
+    NSData *data = [NSData srguserdata_JSONLineWithObject:record error:&JSONError];
+    if (! data) {
+        SRGUserDataLogError(@"preferences_journal", @"Could not append journal record. Reason %@", JSONError);
+        return;
+    }
+    
+    self.length += data.length;
+    
+    dispatch_async(self.queue, ^{
+        if (! self.fileHandle) {
+            // A truncated record left by a previous session is discarded, so that new records are not merged into it
+            self.fileHandle = [NSFileHandle srguserdata_fileHandleForAppendingJSONLinesAtURL:self.fileURL];
+            if (! self.fileHandle) {
+                SRGUserDataLogError(@"preferences_journal", @"Could not open journal for writing");
+                return;
+            }
+        }
+        
+        [self.fileHandle writeData:data];
+    });
+}
+
+#pragma mark Snapshots
+
+- (void)saveSnapshotWithDictionary:(NSDictionary *)dictionary
+{
+    // Records appended until now are part of the snapshot.
+    self.length = 0;
+    
+    SRGPreferencesSnapshotFormat format = self.snapshotFormat;
+    dispatch_async(self.queue, ^{
+        NSError *encodingError = nil;
+        NSData *data = [SRGPreferencesSnapshot dataWithDictionary:dictionary format:format error:&encodingError];
+        if (! data) {
+            SRGUserDataLogError(@"preferences_journal", @"Could not save preferences. Reason %@", encodingError);
+            return;
+        }
+        
+        NSError *writeError = nil;
+        if (! [data writeToURL:self.snapshotFileURL options:NSDataWritingAtomic error:&writeError]) {
+            SRGUserDataLogError(@"preferences_journal", @"Could not save preferences. Reason %@", writeError);
+            return;
+        }
+        
+        self.snapshotLength = data.length;
+        
+        // If the application is killed before the journal has been deleted, records will be replayed again over the
+        // new snapshot. This is harmless since records are absolute changes, applied in the same order.
+        [self closeAndRemoveJournal];
+        
+        SRGUserDataLogInfo(@"preferences_journal", @"Preferences successfully saved");
+    });
+}
+
+- (void)erase
+{
+    self.length = 0;
+    
+    dispatch_async(self.queue, ^{
+        [NSFileManager.defaultManager removeItemAtURL:self.snapshotFileURL error:NULL];
+        self.snapshotLength = 0;
+        
+        [self closeAndRemoveJournal];
+    });
+}
+
+- (void)synchronize
+{
+    dispatch_sync(self.queue, ^{
+        [self.fileHandle synchronizeFile];
+    });
+}
+
+// Must be called on the journal queue
+- (void)closeAndRemoveJournal
+{
+    [self.fileHandle closeFile];
+    self.fileHandle = nil;
+    
+    [NSFileManager.defaultManager removeItemAtURL:self.fileURL error:NULL];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; fileURL = %@; length = %@>",
+            self.class,
+            self,
+            self.fileURL,
+            @(self.length)];
+}
+
+@end
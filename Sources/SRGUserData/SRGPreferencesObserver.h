@@ -0,0 +1,41 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPreferencePath.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Observer of preference changes made at or below a preference path.
+ */
+@interface SRGPreferencesObserver : NSObject
+
+/**
+ *  Create an observer calling the specified block when changes are made at or below a preference path.
+ */
+- (instancetype)initWithPreferencePath:(SRGPreferencePath *)preferencePath block:(void (^)(NSSet<NSString *> *paths))block;
+
+/**
+ *  The observed preference path.
+ */
+@property (nonatomic, readonly) SRGPreferencePath *preferencePath;
+
+/**
+ *  Call the observer block if some of the specified paths, changed in the observed domain, concern the observed path.
+ *  The block receives changed paths at or below the observed path, or the observed path itself if one of its parents
+ *  has changed.
+ */
+- (void)notifyChangedPaths:(NSSet<NSString *> *)paths;
+
+@end
+
+@interface SRGPreferencesObserver (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
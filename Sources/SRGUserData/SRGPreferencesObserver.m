@@ -0,0 +1,83 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPreferencesObserver.h"
+
+#import "SRGPreferencePath+Private.h"
+
+@interface SRGPreferencesObserver ()
+
+@property (nonatomic) SRGPreferencePath *preferencePath;
+@property (nonatomic, copy) void (^block)(NSSet<NSString *> *paths);
+
+@end
+
+@implementation SRGPreferencesObserver
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithPreferencePath:(SRGPreferencePath *)preferencePath block:(void (^)(NSSet<NSString *> * _Nonnull))block
+{
+    NSParameterAssert(block);
+    
+    if (self = [super init]) {
+        self.preferencePath = preferencePath;
+        self.block = block;
+    }
+    return self;
+}
+
+#pragma mark Notification
+
+- (void)notifyChangedPaths:(NSSet<NSString *> *)paths
+{
+    // The first path component is the domain
+    NSArray<NSString *> *pathComponents = self.preferencePath.pathComponents;
+    NSUInteger count = pathComponents.count - 1;
+    
+    NSMutableSet<NSString *> *observedPaths = [NSMutableSet set];
+    for (NSString *path in paths) {
+        NSArray<NSString *> *changedPathComponents = [path componentsSeparatedByString:@"/"];
+        
+        BOOL overlapping = YES;
+        NSUInteger commonCount = MIN(count, changedPathComponents.count);
+        for (NSUInteger i = 0; i < commonCount; ++i) {
+            if (! [pathComponents[i + 1] isEqualToString:changedPathComponents[i]]) {
+                overlapping = NO;
+                break;
+            }
+        }
+        
+        if (! overlapping) {
+            continue;
+        }
+        
+        // A change made to a parent of the observed path might have changed anything below it
+        if (changedPathComponents.count < count) {
+            NSArray<NSString *> *observedPathComponents = [pathComponents subarrayWithRange:NSMakeRange(1, count)];
+            [observedPaths addObject:[observedPathComponents componentsJoinedByString:@"/"]];
+        }
+        else {
+            [observedPaths addObject:path];
+        }
+    }
+    
+    if (observedPaths.count != 0) {
+        self.block(observedPaths.copy);
+    }
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; preferencePath = %@>",
+            self.class,
+            self,
+            self.preferencePath];
+}
+
+@end
@@ -0,0 +1,53 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPreferencesChangelogEntry.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Block signatures.
+typedef void (^SRGPreferencesPushCompletionBlock)(NSError * _Nullable error);
+typedef void (^SRGPreferencesPushBlock)(SRGPreferencesChangelogEntry *entry, SRGPreferencesPushCompletionBlock completionBlock);
+
+/**
+ *  Push of changelog entries, running several pushes at the same time.
+ *
+ *  Entries touching overlapping locations (the same domain, with one path equal to or containing the other) are pushed
+ *  one after the other, in the order they were supplied. Other entries are pushed concurrently, up to a maximum count.
+ */
+@interface SRGPreferencesPushScheduler : NSObject
+
+/**
+ *  Create a scheduler.
+ *
+ *  @param entries                    The entries to push, from the oldest to the most recent one.
+ *  @param maximumConcurrentPushCount The maximum number of pushes running at the same time (at least 1).
+ *  @param pushBlock                  Block pushing a single entry, calling its completion block when done.
+ */
+- (instancetype)initWithEntries:(NSArray<SRGPreferencesChangelogEntry *> *)entries
+     maximumConcurrentPushCount:(NSUInteger)maximumConcurrentPushCount
+                      pushBlock:(SRGPreferencesPushBlock)pushBlock;
+
+/**
+ *  Start pushing entries. The completion block is called once, either after all entries have been pushed, or with the
+ *  first error encountered. No new push is started after an error.
+ */
+- (void)startWithCompletionBlock:(void (^)(NSError * _Nullable error))completionBlock;
+
+/**
+ *  Stop pushing entries and complete with a cancellation error. Pushes already started are not cancelled.
+ */
+- (void)cancel;
+
+@end
+
+@interface SRGPreferencesPushScheduler (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
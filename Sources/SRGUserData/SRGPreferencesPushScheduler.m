@@ -0,0 +1,224 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPreferencesPushScheduler.h"
+
+#import "NSBundle+SRGUserData.h"
+#import "SRGUserDataError.h"
+
+@interface SRGPreferencesPushScheduler ()
+
+@property (nonatomic) NSArray<SRGPreferencesChangelogEntry *> *entries;
+@property (nonatomic) NSUInteger maximumConcurrentPushCount;
+
+@property (nonatomic, copy) SRGPreferencesPushBlock pushBlock;
+@property (nonatomic, copy) void (^completionBlock)(NSError * _Nullable error);
+
+// For each entry, the indexes of the entries which must wait for it, and the number of entries it still waits for
+@property (nonatomic) NSArray<NSIndexSet *> *dependentIndexes;
+@property (nonatomic) NSMutableArray<NSNumber *> *dependencyCounts;
+
+@property (nonatomic) NSMutableIndexSet *readyIndexes;
+@property (nonatomic) NSUInteger runningCount;
+@property (nonatomic) NSUInteger completedCount;
+@property (nonatomic, getter=isFinished) BOOL finished;
+
+@property (nonatomic) dispatch_queue_t queue;
+
+@end
+
+@implementation SRGPreferencesPushScheduler
+
+#pragma mark Class methods
+
++ (NSArray<NSString *> *)pathComponentsForEntry:(SRGPreferencesChangelogEntry *)entry
+{
+    NSString *trimmedPath = [entry.path stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"/"]];
+    return (trimmedPath.length != 0) ? trimmedPath.pathComponents : @[];
+}
+
+// Two locations overlap if one is equal to or contains the other
++ (BOOL)pathComponents:(NSArray<NSString *> *)pathComponents overlapWithPathComponents:(NSArray<NSString *> *)otherPathComponents
+{
+    NSUInteger count = MIN(pathComponents.count, otherPathComponents.count);
+    for (NSUInteger i = 0; i < count; ++i) {
+        if (! [pathComponents[i] isEqualToString:otherPathComponents[i]]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithEntries:(NSArray<SRGPreferencesChangelogEntry *> *)entries
+     maximumConcurrentPushCount:(NSUInteger)maximumConcurrentPushCount
+                      pushBlock:(SRGPreferencesPushBlock)pushBlock
+{
+    NSParameterAssert(pushBlock);
+    
+    if (self = [super init]) {
+        self.entries = entries.copy;
+        self.maximumConcurrentPushCount = MAX(maximumConcurrentPushCount, 1);
+        self.pushBlock = pushBlock;
+        self.queue = dispatch_queue_create("ch.srgssr.userdata.preferences.pushscheduler", DISPATCH_QUEUE_SERIAL);
+        
+        [self buildDependencies];
+    }
+    return self;
+}
+
+#pragma mark Dependencies
+
+- (void)buildDependencies
+{
+    NSMutableArray<NSMutableIndexSet *> *dependentIndexes = [NSMutableArray arrayWithCapacity:self.entries.count];
+    NSMutableArray<NSNumber *> *dependencyCounts = [NSMutableArray arrayWithCapacity:self.entries.count];
+    
+    // Only entries belonging to the same domain can overlap
+    NSMutableDictionary<NSString *, NSMutableIndexSet *> *domainIndexes = [NSMutableDictionary dictionary];
+    NSMutableArray<NSArray<NSString *> *> *pathComponents = [NSMutableArray arrayWithCapacity:self.entries.count];
+    
+    [self.entries enumerateObjectsUsingBlock:^(SRGPreferencesChangelogEntry * _Nonnull entry, NSUInteger idx, BOOL * _Nonnull stop) {
+        NSArray<NSString *> *entryPathComponents = [SRGPreferencesPushScheduler pathComponentsForEntry:entry];
+        [pathComponents addObject:entryPathComponents];
+        
+        NSMutableIndexSet *indexes = domainIndexes[entry.domain];
+        if (! indexes) {
+            indexes = [NSMutableIndexSet indexSet];
+            domainIndexes[entry.domain] = indexes;
+        }
+        
+        __block NSUInteger dependencyCount = 0;
+        [indexes enumerateIndexesUsingBlock:^(NSUInteger previousIdx, BOOL * _Nonnull stop) {
+            if ([SRGPreferencesPushScheduler pathComponents:pathComponents[previousIdx] overlapWithPathComponents:entryPathComponents]) {
+                [dependentIndexes[previousIdx] addIndex:idx];
+                ++dependencyCount;
+            }
+        }];
+        [indexes addIndex:idx];
+        
+        [dependentIndexes addObject:[NSMutableIndexSet indexSet]];
+        [dependencyCounts addObject:@(dependencyCount)];
+    }];
+    
+    self.dependentIndexes = dependentIndexes.copy;
+    self.dependencyCounts = dependencyCounts;
+    
+    self.readyIndexes = [NSMutableIndexSet indexSet];
+    [dependencyCounts enumerateObjectsUsingBlock:^(NSNumber * _Nonnull dependencyCount, NSUInteger idx, BOOL * _Nonnull stop) {
+        if (dependencyCount.unsignedIntegerValue == 0) {
+            [self.readyIndexes addIndex:idx];
+        }
+    }];
+}
+
+#pragma mark Scheduling
+
+- (void)startWithCompletionBlock:(void (^)(NSError * _Nullable))completionBlock
+{
+    NSParameterAssert(completionBlock);
+    
+    dispatch_async(self.queue, ^{
+        NSAssert(! self.completionBlock && ! self.finished, @"A scheduler can only be started once");
+        
+        self.completionBlock = completionBlock;
+        
+        if (self.entries.count == 0) {
+            [self finishWithError:nil];
+        }
+        else {
+            [self schedulePushes];
+        }
+    });
+}
+
+- (void)cancel
+{
+    dispatch_async(self.queue, ^{
+        NSError *error = [NSError errorWithDomain:SRGUserDataErrorDomain
+                                             code:SRGUserDataErrorCancelled
+                                         userInfo:@{ NSLocalizedDescriptionKey : SRGUserDataLocalizedString(@"The operation has been cancelled", @"Error message returned when an operation has been cancelled") }];
+        [self finishWithError:error];
+    });
+}
+
+// Must be called on the scheduler queue
+- (void)schedulePushes
+{
+    while (! self.finished && self.runningCount < self.maximumConcurrentPushCount && self.readyIndexes.count != 0) {
+        NSUInteger idx = self.readyIndexes.firstIndex;
+        [self.readyIndexes removeIndex:idx];
+        
+        self.runningCount += 1;
+        self.pushBlock(self.entries[idx], ^(NSError * _Nullable error) {
+            dispatch_async(self.queue, ^{
+                [self pushDidCompleteAtIndex:idx withError:error];
+            });
+        });
+    }
+}
+
+// Must be called on the scheduler queue
+- (void)pushDidCompleteAtIndex:(NSUInteger)idx withError:(NSError *)error
+{
+    if (self.finished) {
+        return;
+    }
+    
+    if (error) {
+        [self finishWithError:error];
+        return;
+    }
+    
+    self.runningCount -= 1;
+    self.completedCount += 1;
+    
+    [self.dependentIndexes[idx] enumerateIndexesUsingBlock:^(NSUInteger dependentIdx, BOOL * _Nonnull stop) {
+        NSUInteger dependencyCount = self.dependencyCounts[dependentIdx].unsignedIntegerValue - 1;
+        self.dependencyCounts[dependentIdx] = @(dependencyCount);
+        if (dependencyCount == 0) {
+            [self.readyIndexes addIndex:dependentIdx];
+        }
+    }];
+    
+    if (self.completedCount == self.entries.count) {
+        [self finishWithError:nil];
+    }
+    else {
+        [self schedulePushes];
+    }
+}
+
+// Must be called on the scheduler queue
+- (void)finishWithError:(NSError *)error
+{
+    if (self.finished) {
+        return;
+    }
+    
+    self.finished = YES;
+    
+    // Release blocks, which might retain the scheduler
+    self.pushBlock = nil;
+    
+    void (^completionBlock)(NSError *) = self.completionBlock;
+    self.completionBlock = nil;
+    completionBlock ? completionBlock(error) : nil;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; entries = %@; maximumConcurrentPushCount = %@>",
+            self.class,
+            self,
+            @(self.entries.count),
+            @(self.maximumConcurrentPushCount)];
+}
+
+@end
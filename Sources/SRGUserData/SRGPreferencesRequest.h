@@ -37,6 +37,23 @@ typedef void (^SRGPreferencesDeleteCompletionBlock)(NSHTTPURLResponse * _Nullabl
                       withSession:(NSURLSession *)session
                   completionBlock:(SRGPreferencesCompletionBlock)completionBlock;
 
+/**
+ *  Retrieve all preferences in a domain, unless they have not changed since a previous response, identified by its
+ *  validators (see `+validatorsForHTTPResponse:`). If preferences have not changed, the completion block is called
+ *  with a `nil` dictionary and a 304 response.
+ */
++ (SRGRequest *)preferencesInDomain:(NSString *)domain
+                     withValidators:(nullable NSDictionary<NSString *, NSString *> *)validators
+                     fromServiceURL:(NSURL *)serviceURL
+                    forSessionToken:(NSString *)sessionToken
+                        withSession:(NSURLSession *)session
+                    completionBlock:(SRGPreferencesCompletionBlock)completionBlock;
+
+/**
+ *  Return the validators (entity tag and last modification date) received with a response, if any.
+ */
++ (nullable NSDictionary<NSString *, NSString *> *)validatorsForHTTPResponse:(nullable NSHTTPURLResponse *)HTTPResponse;
+
 /**
  *  Create or update a preference at a specific path in a domain.
  *
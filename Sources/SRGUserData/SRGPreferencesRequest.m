@@ -6,6 +6,10 @@
 
 #import "SRGPreferencesRequest.h"
 
+// Validator headers received with a response, and the corresponding conditional request headers.
+static NSString * const SRGPreferencesEntityTagHeaderField = @"ETag";
+static NSString * const SRGPreferencesLastModifiedHeaderField = @"Last-Modified";
+
 static NSNumberFormatter *SRGLocaleIndependentNumberFormatter(void)
 {
     static dispatch_once_t s_onceToken;
@@ -54,6 +58,49 @@ static NSNumberFormatter *SRGLocaleIndependentNumberFormatter(void)
     }];
 }
 
++ (SRGRequest *)preferencesInDomain:(NSString *)domain
+                     withValidators:(NSDictionary<NSString *, NSString *> *)validators
+                     fromServiceURL:(NSURL *)serviceURL
+                    forSessionToken:(NSString *)sessionToken
+                        withSession:(NSURLSession *)session
+                    completionBlock:(SRGPreferencesCompletionBlock)completionBlock
+{
+    NSURL *URL = [serviceURL URLByAppendingPathComponent:domain];
+    
+    // Validation is performed explicitly, the local cache must not interfere
+    NSMutableURLRequest *URLRequest = [NSMutableURLRequest requestWithURL:URL];
+    URLRequest.cachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+    [URLRequest setValue:[NSString stringWithFormat:@"sessionToken %@", sessionToken] forHTTPHeaderField:@"Authorization"];
+    [URLRequest setValue:validators[SRGPreferencesEntityTagHeaderField] forHTTPHeaderField:@"If-None-Match"];
+    [URLRequest setValue:validators[SRGPreferencesLastModifiedHeaderField] forHTTPHeaderField:@"If-Modified-Since"];
+    
+    return [SRGRequest dataRequestWithURLRequest:URLRequest session:session completionBlock:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        NSHTTPURLResponse *HTTPResponse = [response isKindOfClass:NSHTTPURLResponse.class] ? (NSHTTPURLResponse *)response : nil;
+        if (error || HTTPResponse.statusCode == 304) {
+            completionBlock(nil, HTTPResponse, error);
+            return;
+        }
+        
+        NSError *JSONError = nil;
+        id JSONObject = [NSJSONSerialization JSONObjectWithData:data options:0 error:&JSONError];
+        if (! [JSONObject isKindOfClass:NSDictionary.class]) {
+            NSError *invalidDataError = JSONError ?: [NSError errorWithDomain:SRGNetworkErrorDomain code:SRGNetworkErrorInvalidData userInfo:nil];
+            completionBlock(nil, HTTPResponse, invalidDataError);
+            return;
+        }
+        
+        completionBlock(JSONObject, HTTPResponse, nil);
+    }];
+}
+
++ (NSDictionary<NSString *, NSString *> *)validatorsForHTTPResponse:(NSHTTPURLResponse *)HTTPResponse
+{
+    NSMutableDictionary<NSString *, NSString *> *validators = [NSMutableDictionary dictionary];
+    validators[SRGPreferencesEntityTagHeaderField] = [HTTPResponse valueForHTTPHeaderField:SRGPreferencesEntityTagHeaderField];
+    validators[SRGPreferencesLastModifiedHeaderField] = [HTTPResponse valueForHTTPHeaderField:SRGPreferencesLastModifiedHeaderField];
+    return (validators.count != 0) ? validators.copy : nil;
+}
+
 + (SRGRequest *)putPreferenceWithObject:(id)object
                                  atPath:(NSString *)path
                                inDomain:(NSString *)domain
@@ -0,0 +1,53 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Snapshot formats.
+ */
+typedef NS_ENUM(NSInteger, SRGPreferencesSnapshotFormat) {
+    /**
+     *  JSON.
+     */
+    SRGPreferencesSnapshotFormatJSON = 0,
+    /**
+     *  Compact binary format, loaded lazily from a memory-mapped file.
+     */
+    SRGPreferencesSnapshotFormatBinary
+};
+
+/**
+ *  Encoding and decoding of preference tree snapshots.
+ *
+ *  The binary format stores length-prefixed keys, typed scalars and, for each dictionary, a table of key and value
+ *  offsets sorted by key. Dictionaries read from binary data are decoded lazily, one level at a time, when their values
+ *  are first accessed. They are immutable and can be read from any thread.
+ */
+@interface SRGPreferencesSnapshot : NSObject
+
+/**
+ *  Return the data of a snapshot of the specified dictionary in the specified format, `nil` if the dictionary cannot be
+ *  encoded.
+ */
++ (nullable NSData *)dataWithDictionary:(NSDictionary *)dictionary format:(SRGPreferencesSnapshotFormat)format error:(NSError * __autoreleasing *)error;
+
+/**
+ *  Return the immutable dictionary stored in snapshot data, whose format is automatically detected. Return `nil` if the
+ *  data is invalid.
+ */
++ (nullable NSDictionary *)dictionaryWithData:(NSData *)data error:(NSError * __autoreleasing *)error;
+
+/**
+ *  Same as `+dictionaryWithData:error:`, reading data from a file. Binary snapshot files are memory-mapped.
+ */
++ (nullable NSDictionary *)dictionaryWithContentsOfFileURL:(NSURL *)fileURL error:(NSError * __autoreleasing *)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,534 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGPreferencesSnapshot.h"
+
+#import <stdatomic.h>
+
+// Binary snapshot layout (little endian):
+//   - Header: magic (4 bytes), version (uint32), root dictionary offset (uint32).
+//   - Key: length (uint32), UTF-8 bytes.
+//   - Value: type (1 byte), followed by:
+//       * String: length (uint32), UTF-8 bytes.
+//       * Integer: int64.
+//       * Double: double.
+//       * True, false, null: nothing.
+//       * Array: count (uint32), value offsets (count x uint32).
+//       * Dictionary: count (uint32), key and value offsets (count x 2 x uint32), sorted by key bytes.
+// Values are always written before the array or dictionary containing them. Child value offsets are therefore strictly
+// lower than the offset of their parent, which guarantees that reading corrupt data cannot loop forever.
+static const char SRGPreferencesSnapshotMagic[4] = { 'S', 'R', 'G', 'P' };
+static const uint32_t SRGPreferencesSnapshotVersion = 1;
+static const uint32_t SRGPreferencesSnapshotHeaderLength = 12;
+
+typedef NS_ENUM(uint8_t, SRGPreferencesSnapshotType) {
+    SRGPreferencesSnapshotTypeString = 1,
+    SRGPreferencesSnapshotTypeInteger,
+    SRGPreferencesSnapshotTypeDouble,
+    SRGPreferencesSnapshotTypeTrue,
+    SRGPreferencesSnapshotTypeFalse,
+    SRGPreferencesSnapshotTypeNull,
+    SRGPreferencesSnapshotTypeArray,
+    SRGPreferencesSnapshotTypeDictionary
+};
+
+static NSError *SRGPreferencesSnapshotCorruptError(void)
+{
+    return [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadCorruptFileError userInfo:nil];
+}
+
+#pragma mark Reading
+
+// Read a uint32 at the specified offset, returning `NO` if out of bounds.
+static BOOL SRGPreferencesSnapshotReadUInt32(NSData *data, uint64_t offset, uint32_t *value)
+{
+    if (offset + sizeof(uint32_t) > data.length) {
+        return NO;
+    }
+    memcpy(value, (const uint8_t *)data.bytes + offset, sizeof(uint32_t));
+    *value = CFSwapInt32LittleToHost(*value);
+    return YES;
+}
+
+// Read a length-prefixed byte sequence at the specified offset, returning `NO` if out of bounds.
+static BOOL SRGPreferencesSnapshotReadBytes(NSData *data, uint64_t offset, const uint8_t **bytes, uint32_t *length)
+{
+    if (! SRGPreferencesSnapshotReadUInt32(data, offset, length) || offset + sizeof(uint32_t) + *length > data.length) {
+        return NO;
+    }
+    *bytes = (const uint8_t *)data.bytes + offset + sizeof(uint32_t);
+    return YES;
+}
+
+static int SRGPreferencesSnapshotCompareBytes(const uint8_t *bytes1, uint32_t length1, const uint8_t *bytes2, uint32_t length2)
+{
+    int result = memcmp(bytes1, bytes2, MIN(length1, length2));
+    if (result != 0) {
+        return result;
+    }
+    return (length1 < length2) ? -1 : ((length1 > length2) ? 1 : 0);
+}
+
+static id SRGPreferencesSnapshotReadValue(NSData *data, uint64_t offset);
+
+/**
+ *  Dictionary backed by binary snapshot data. Values are decoded when first accessed, then cached.
+ */
+@interface SRGPreferencesSnapshotDictionary : NSDictionary {
+@private
+    NSData *_data;
+    uint64_t _offset;
+    uint64_t _entriesOffset;
+    uint32_t _count;
+    
+    // Decoded values and keys, set once without locking
+    _Atomic(void *) *_values;
+    _Atomic(void *) _keys;
+}
+
+- (instancetype)initWithData:(NSData *)data offset:(uint64_t)offset;
+
+@end
+
+@implementation SRGPreferencesSnapshotDictionary
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithData:(NSData *)data offset:(uint64_t)offset
+{
+    // Type byte and count
+    uint32_t count = 0;
+    if (! SRGPreferencesSnapshotReadUInt32(data, offset + 1, &count)) {
+        return nil;
+    }
+    
+    uint64_t entriesOffset = offset + 1 + sizeof(uint32_t);
+    if (entriesOffset + (uint64_t)count * 2 * sizeof(uint32_t) > data.length) {
+        return nil;
+    }
+    
+    if (self = [super init]) {
+        _data = data;
+        _offset = offset;
+        _entriesOffset = entriesOffset;
+        _count = count;
+        _values = calloc(MAX(count, 1), sizeof(_Atomic(void *)));
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    for (uint32_t i = 0; i < _count; ++i) {
+        void *value = atomic_load(&_values[i]);
+        if (value) {
+            CFRelease(value);
+        }
+    }
+    free(_values);
+    
+    void *keys = atomic_load(&_keys);
+    if (keys) {
+        CFRelease(keys);
+    }
+}
+
+#pragma mark Lazy decoding
+
+// Store a decoded object in a cache slot, unless another thread did it first. Return the object in the slot.
+static id SRGPreferencesSnapshotCacheObject(_Atomic(void *) *slot, id object)
+{
+    void *expected = NULL;
+    void *desired = (void *)CFBridgingRetain(object);
+    if (atomic_compare_exchange_strong(slot, &expected, desired)) {
+        return object;
+    }
+    else {
+        CFRelease(desired);
+        return (__bridge id)expected;
+    }
+}
+
+- (BOOL)readKeyAtIndex:(uint32_t)index bytes:(const uint8_t **)bytes length:(uint32_t *)length
+{
+    uint32_t keyOffset = 0;
+    return SRGPreferencesSnapshotReadUInt32(_data, _entriesOffset + (uint64_t)index * 2 * sizeof(uint32_t), &keyOffset)
+        && SRGPreferencesSnapshotReadBytes(_data, keyOffset, bytes, length);
+}
+
+- (id)valueAtIndex:(uint32_t)index
+{
+    void *value = atomic_load(&_values[index]);
+    if (value) {
+        return (__bridge id)value;
+    }
+    
+    uint32_t valueOffset = 0;
+    if (! SRGPreferencesSnapshotReadUInt32(_data, _entriesOffset + (uint64_t)index * 2 * sizeof(uint32_t) + sizeof(uint32_t), &valueOffset)
+            || valueOffset >= _offset) {
+        return nil;
+    }
+    
+    id object = SRGPreferencesSnapshotReadValue(_data, valueOffset);
+    return object ? SRGPreferencesSnapshotCacheObject(&_values[index], object) : nil;
+}
+
+- (NSArray<NSString *> *)keys
+{
+    void *keys = atomic_load(&_keys);
+    if (keys) {
+        return (__bridge NSArray *)keys;
+    }
+    
+    NSMutableArray<NSString *> *mutableKeys = [NSMutableArray arrayWithCapacity:_count];
+    for (uint32_t i = 0; i < _count; ++i) {
+        const uint8_t *bytes = NULL;
+        uint32_t length = 0;
+        if (! [self readKeyAtIndex:i bytes:&bytes length:&length]) {
+            break;
+        }
+        
+        NSString *key = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+        if (key) {
+            [mutableKeys addObject:key];
+        }
+    }
+    return SRGPreferencesSnapshotCacheObject(&_keys, mutableKeys.copy);
+}
+
+#pragma mark NSDictionary primitive methods
+
+- (NSUInteger)count
+{
+    return _count;
+}
+
+- (id)objectForKey:(id)key
+{
+    if (! [key isKindOfClass:NSString.class]) {
+        return nil;
+    }
+    
+    const char *keyBytes = [key UTF8String];
+    uint32_t keyLength = (uint32_t)strlen(keyBytes);
+    
+    // Keys are sorted, use binary search
+    uint32_t lowerIndex = 0;
+    uint32_t upperIndex = _count;
+    while (lowerIndex < upperIndex) {
+        uint32_t index = lowerIndex + (upperIndex - lowerIndex) / 2;
+        
+        const uint8_t *bytes = NULL;
+        uint32_t length = 0;
+        if (! [self readKeyAtIndex:index bytes:&bytes length:&length]) {
+            return nil;
+        }
+        
+        int result = SRGPreferencesSnapshotCompareBytes(bytes, length, (const uint8_t *)keyBytes, keyLength);
+        if (result == 0) {
+            return [self valueAtIndex:index];
+        }
+        else if (result < 0) {
+            lowerIndex = index + 1;
+        }
+        else {
+            upperIndex = index;
+        }
+    }
+    return nil;
+}
+
+- (NSEnumerator *)keyEnumerator
+{
+    return self.keys.objectEnumerator;
+}
+
+#pragma mark NSCopying protocol
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    // Immutable
+    return self;
+}
+
+@end
+
+static id SRGPreferencesSnapshotReadValue(NSData *data, uint64_t offset)
+{
+    if (offset >= data.length) {
+        return nil;
+    }
+    
+    SRGPreferencesSnapshotType type = ((const uint8_t *)data.bytes)[offset];
+    uint64_t payloadOffset = offset + 1;
+    
+    if (type == SRGPreferencesSnapshotTypeString) {
+        const uint8_t *bytes = NULL;
+        uint32_t length = 0;
+        if (! SRGPreferencesSnapshotReadBytes(data, payloadOffset, &bytes, &length)) {
+            return nil;
+        }
+        return [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+    }
+    else if (type == SRGPreferencesSnapshotTypeInteger || type == SRGPreferencesSnapshotTypeDouble) {
+        uint64_t bits = 0;
+        if (payloadOffset + sizeof(uint64_t) > data.length) {
+            return nil;
+        }
+        memcpy(&bits, (const uint8_t *)data.bytes + payloadOffset, sizeof(uint64_t));
+        bits = CFSwapInt64LittleToHost(bits);
+        
+        if (type == SRGPreferencesSnapshotTypeInteger) {
+            return @((int64_t)bits);
+        }
+        else {
+            double value = 0.;
+            memcpy(&value, &bits, sizeof(double));
+            return @(value);
+        }
+    }
+    else if (type == SRGPreferencesSnapshotTypeTrue) {
+        return @YES;
+    }
+    else if (type == SRGPreferencesSnapshotTypeFalse) {
+        return @NO;
+    }
+    else if (type == SRGPreferencesSnapshotTypeNull) {
+        return NSNull.null;
+    }
+    else if (type == SRGPreferencesSnapshotTypeArray) {
+        // Arrays are usually small and decoded at once
+        uint32_t count = 0;
+        if (! SRGPreferencesSnapshotReadUInt32(data, payloadOffset, &count)) {
+            return nil;
+        }
+        
+        NSMutableArray *array = [NSMutableArray arrayWithCapacity:MIN(count, 1024)];
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t valueOffset = 0;
+            if (! SRGPreferencesSnapshotReadUInt32(data, payloadOffset + sizeof(uint32_t) + (uint64_t)i * sizeof(uint32_t), &valueOffset)
+                    || valueOffset >= offset) {
+                return nil;
+            }
+            
+            id value = SRGPreferencesSnapshotReadValue(data, valueOffset);
+            if (! value) {
+                return nil;
+            }
+            [array addObject:value];
+        }
+        return array.copy;
+    }
+    else if (type == SRGPreferencesSnapshotTypeDictionary) {
+        return [[SRGPreferencesSnapshotDictionary alloc] initWithData:data offset:offset];
+    }
+    else {
+        return nil;
+    }
+}
+
+#pragma mark Writing
+
+static void SRGPreferencesSnapshotAppendUInt32(NSMutableData *data, uint32_t value)
+{
+    value = CFSwapInt32HostToLittle(value);
+    [data appendBytes:&value length:sizeof(uint32_t)];
+}
+
+static void SRGPreferencesSnapshotAppendType(NSMutableData *data, SRGPreferencesSnapshotType type)
+{
+    [data appendBytes:&type length:1];
+}
+
+static void SRGPreferencesSnapshotAppendBytes(NSMutableData *data, NSData *bytes)
+{
+    SRGPreferencesSnapshotAppendUInt32(data, (uint32_t)bytes.length);
+    [data appendData:bytes];
+}
+
+// Append the value and return its offset, or return `NO` if the value cannot be encoded.
+static BOOL SRGPreferencesSnapshotAppendValue(NSMutableData *data, id value, uint32_t *offset)
+{
+    if (data.length > UINT32_MAX) {
+        return NO;
+    }
+    
+    if ([value isKindOfClass:NSString.class]) {
+        *offset = (uint32_t)data.length;
+        SRGPreferencesSnapshotAppendType(data, SRGPreferencesSnapshotTypeString);
+        SRGPreferencesSnapshotAppendBytes(data, [value dataUsingEncoding:NSUTF8StringEncoding]);
+        return YES;
+    }
+    else if ([value isKindOfClass:NSNumber.class]) {
+        *offset = (uint32_t)data.length;
+        if (value == (void *)kCFBooleanTrue) {
+            SRGPreferencesSnapshotAppendType(data, SRGPreferencesSnapshotTypeTrue);
+        }
+        else if (value == (void *)kCFBooleanFalse) {
+            SRGPreferencesSnapshotAppendType(data, SRGPreferencesSnapshotTypeFalse);
+        }
+        else if (CFNumberIsFloatType((__bridge CFNumberRef)value)) {
+            double doubleValue = [value doubleValue];
+            uint64_t bits = 0;
+            memcpy(&bits, &doubleValue, sizeof(uint64_t));
+            bits = CFSwapInt64HostToLittle(bits);
+            
+            SRGPreferencesSnapshotAppendType(data, SRGPreferencesSnapshotTypeDouble);
+            [data appendBytes:&bits length:sizeof(uint64_t)];
+        }
+        else {
+            uint64_t bits = CFSwapInt64HostToLittle((uint64_t)[value longLongValue]);
+            
+            SRGPreferencesSnapshotAppendType(data, SRGPreferencesSnapshotTypeInteger);
+            [data appendBytes:&bits length:sizeof(uint64_t)];
+        }
+        return YES;
+    }
+    else if ([value isKindOfClass:NSNull.class]) {
+        *offset = (uint32_t)data.length;
+        SRGPreferencesSnapshotAppendType(data, SRGPreferencesSnapshotTypeNull);
+        return YES;
+    }
+    else if ([value isKindOfClass:NSArray.class]) {
+        // Values are written first, followed by the offset table
+        NSArray *array = value;
+        NSMutableData *offsets = [NSMutableData dataWithCapacity:array.count * sizeof(uint32_t)];
+        for (id arrayValue in array) {
+            uint32_t valueOffset = 0;
+            if (! SRGPreferencesSnapshotAppendValue(data, arrayValue, &valueOffset)) {
+                return NO;
+            }
+            SRGPreferencesSnapshotAppendUInt32(offsets, valueOffset);
+        }
+        
+        *offset = (uint32_t)data.length;
+        SRGPreferencesSnapshotAppendType(data, SRGPreferencesSnapshotTypeArray);
+        SRGPreferencesSnapshotAppendUInt32(data, (uint32_t)array.count);
+        [data appendData:offsets];
+        return YES;
+    }
+    else if ([value isKindOfClass:NSDictionary.class]) {
+        NSDictionary *dictionary = value;
+        
+        // Keys are sorted by their UTF-8 representation, as compared when searched
+        NSMutableArray<NSData *> *keyDatas = [NSMutableArray arrayWithCapacity:dictionary.count];
+        NSMutableDictionary<NSData *, NSString *> *keys = [NSMutableDictionary dictionaryWithCapacity:dictionary.count];
+        for (id key in dictionary) {
+            if (! [key isKindOfClass:NSString.class]) {
+                return NO;
+            }
+            
+            NSData *keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+            [keyDatas addObject:keyData];
+            keys[keyData] = key;
+        }
+        [keyDatas sortUsingComparator:^NSComparisonResult(NSData * _Nonnull keyData1, NSData * _Nonnull keyData2) {
+            int result = SRGPreferencesSnapshotCompareBytes(keyData1.bytes, (uint32_t)keyData1.length, keyData2.bytes, (uint32_t)keyData2.length);
+            return (result < 0) ? NSOrderedAscending : ((result > 0) ? NSOrderedDescending : NSOrderedSame);
+        }];
+        
+        NSMutableData *offsets = [NSMutableData dataWithCapacity:dictionary.count * 2 * sizeof(uint32_t)];
+        for (NSData *keyData in keyDatas) {
+            if (data.length > UINT32_MAX) {
+                return NO;
+            }
+            
+            uint32_t keyOffset = (uint32_t)data.length;
+            SRGPreferencesSnapshotAppendBytes(data, keyData);
+            
+            uint32_t valueOffset = 0;
+            if (! SRGPreferencesSnapshotAppendValue(data, dictionary[keys[keyData]], &valueOffset)) {
+                return NO;
+            }
+            
+            SRGPreferencesSnapshotAppendUInt32(offsets, keyOffset);
+            SRGPreferencesSnapshotAppendUInt32(offsets, valueOffset);
+        }
+        
+        *offset = (uint32_t)data.length;
+        SRGPreferencesSnapshotAppendType(data, SRGPreferencesSnapshotTypeDictionary);
+        SRGPreferencesSnapshotAppendUInt32(data, (uint32_t)dictionary.count);
+        [data appendData:offsets];
+        return YES;
+    }
+    else {
+        return NO;
+    }
+}
+
+@implementation SRGPreferencesSnapshot
+
+#pragma mark Class methods
+
++ (NSData *)dataWithDictionary:(NSDictionary *)dictionary format:(SRGPreferencesSnapshotFormat)format error:(NSError * __autoreleasing *)error
+{
+    if (format == SRGPreferencesSnapshotFormatJSON) {
+        return [NSJSONSerialization dataWithJSONObject:dictionary options:0 error:error];
+    }
+    
+    NSMutableData *data = [NSMutableData data];
+    [data appendBytes:SRGPreferencesSnapshotMagic length:sizeof(SRGPreferencesSnapshotMagic)];
+    SRGPreferencesSnapshotAppendUInt32(data, SRGPreferencesSnapshotVersion);
+    SRGPreferencesSnapshotAppendUInt32(data, 0);
+    
+    uint32_t rootOffset = 0;
+    if (! SRGPreferencesSnapshotAppendValue(data, dictionary, &rootOffset) || data.length > UINT32_MAX) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSPropertyListWriteInvalidError userInfo:nil];
+        }
+        return nil;
+    }
+    
+    rootOffset = CFSwapInt32HostToLittle(rootOffset);
+    [data replaceBytesInRange:NSMakeRange(sizeof(SRGPreferencesSnapshotMagic) + sizeof(uint32_t), sizeof(uint32_t)) withBytes:&rootOffset];
+    return data.copy;
+}
+
++ (NSDictionary *)dictionaryWithData:(NSData *)data error:(NSError * __autoreleasing *)error
+{
+    if (data.length < sizeof(SRGPreferencesSnapshotMagic) || memcmp(data.bytes, SRGPreferencesSnapshotMagic, sizeof(SRGPreferencesSnapshotMagic)) != 0) {
+        id JSONObject = [NSJSONSerialization JSONObjectWithData:data options:0 error:error];
+        if (JSONObject && ! [JSONObject isKindOfClass:NSDictionary.class]) {
+            if (error) {
+                *error = SRGPreferencesSnapshotCorruptError();
+            }
+            return nil;
+        }
+        return JSONObject;
+    }
+    
+    uint32_t version = 0;
+    uint32_t rootOffset = 0;
+    if (data.length < SRGPreferencesSnapshotHeaderLength
+            || ! SRGPreferencesSnapshotReadUInt32(data, sizeof(SRGPreferencesSnapshotMagic), &version)
+            || version != SRGPreferencesSnapshotVersion
+            || ! SRGPreferencesSnapshotReadUInt32(data, sizeof(SRGPreferencesSnapshotMagic) + sizeof(uint32_t), &rootOffset)) {
+        if (error) {
+            *error = SRGPreferencesSnapshotCorruptError();
+        }
+        return nil;
+    }
+    
+    id rootObject = SRGPreferencesSnapshotReadValue(data, rootOffset);
+    if (! [rootObject isKindOfClass:NSDictionary.class]) {
+        if (error) {
+            *error = SRGPreferencesSnapshotCorruptError();
+        }
+        return nil;
+    }
+    return rootObject;
+}
+
++ (NSDictionary *)dictionaryWithContentsOfFileURL:(NSURL *)fileURL error:(NSError * __autoreleasing *)error
+{
+    NSData *data = [NSData dataWithContentsOfURL:fileURL options:NSDataReadingMappedIfSafe error:error];
+    if (! data) {
+        return nil;
+    }
+    return [self dictionaryWithData:data error:error];
+}
+
+@end
@@ -0,0 +1,70 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGDataStore.h"
+
+@import SRGNetwork;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Block signatures.
+typedef void (^SRGRequestSchedulerWriteBlock)(NSManagedObjectContext *managedObjectContext);
+typedef void (^SRGRequestSchedulerWriteCompletionBlock)(NSError * _Nullable error);
+typedef void (^SRGRequestSchedulerResultBlock)(SRGRequestSchedulerWriteBlock _Nullable writeBlock, SRGRequestSchedulerWriteCompletionBlock _Nullable writeCompletionBlock, NSError * _Nullable error);
+typedef SRGRequest * _Nullable (^SRGRequestSchedulerRequestBlock)(SRGRequestSchedulerResultBlock resultBlock);
+
+/**
+ *  Execution of a set of independent requests, running a bounded number of them at the same time.
+ *
+ *  Each request delivers its result as a block writing to the data store. Results received while a write is running
+ *  are batched and written together in a single store transaction once the write completes, so that the number of
+ *  transactions does not grow with the number of requests.
+ */
+@interface SRGRequestScheduler : NSObject
+
+/**
+ *  Create a scheduler.
+ *
+ *  @param dataStore                     The data store results are written to.
+ *  @param maximumConcurrentRequestCount The maximum number of requests running at the same time (at least 1).
+ */
+- (instancetype)initWithDataStore:(SRGDataStore *)dataStore maximumConcurrentRequestCount:(NSUInteger)maximumConcurrentRequestCount;
+
+/**
+ *  Add a request. The block is called when the request can be started, and must return the request to resume (or `nil`
+ *  if no request is needed), calling the result block with a write block (if any) when it completes. The optional write
+ *  completion block is called after the write has been committed.
+ *
+ *  @discussion Requests must be added before the scheduler is started.
+ */
+- (void)addRequestWithBlock:(SRGRequestSchedulerRequestBlock)requestBlock;
+
+/**
+ *  Start executing requests. The completion block is called once, either after all requests have completed and their
+ *  results have been written, or with the first error encountered. After an error no new request is started, running
+ *  requests are cancelled, and results already received are written before the completion block is called.
+ */
+- (void)startWithCompletionBlock:(void (^)(NSError * _Nullable error))completionBlock;
+
+/**
+ *  Cancel running requests, discard results not written yet and complete with a cancellation error.
+ */
+- (void)cancel;
+
+/**
+ *  The number of store transactions performed so far.
+ */
+@property (atomic, readonly) NSUInteger writeCount;
+
+@end
+
+@interface SRGRequestScheduler (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
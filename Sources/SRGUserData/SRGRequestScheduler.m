@@ -0,0 +1,269 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGRequestScheduler.h"
+
+#import "NSBundle+SRGUserData.h"
+#import "SRGUserDataError.h"
+#import "SRGUserDataLogger.h"
+
+@interface SRGRequestScheduler ()
+
+@property (nonatomic) SRGDataStore *dataStore;
+@property (nonatomic) NSUInteger maximumConcurrentRequestCount;
+
+@property (nonatomic) NSMutableArray<SRGRequestSchedulerRequestBlock> *requestBlocks;
+@property (nonatomic, copy) void (^completionBlock)(NSError * _Nullable error);
+
+@property (nonatomic) NSHashTable<SRGRequest *> *runningRequests;
+@property (nonatomic) NSUInteger runningCount;
+@property (nonatomic) NSUInteger requestCount;
+
+// Results received but not written yet
+@property (nonatomic) NSMutableArray<SRGRequestSchedulerWriteBlock> *writeBlocks;
+@property (nonatomic) NSMutableArray<SRGRequestSchedulerWriteCompletionBlock> *writeCompletionBlocks;
+@property (nonatomic, getter=isWriting) BOOL writing;
+
+@property (atomic) NSUInteger writeCount;
+
+@property (nonatomic) NSError *error;
+@property (nonatomic) NSDate *startDate;
+@property (nonatomic, getter=isFinished) BOOL finished;
+
+@property (nonatomic) dispatch_queue_t queue;
+
+@end
+
+@implementation SRGRequestScheduler
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithDataStore:(SRGDataStore *)dataStore maximumConcurrentRequestCount:(NSUInteger)maximumConcurrentRequestCount
+{
+    NSParameterAssert(dataStore);
+    
+    if (self = [super init]) {
+        self.dataStore = dataStore;
+        self.maximumConcurrentRequestCount = MAX(maximumConcurrentRequestCount, 1);
+        self.requestBlocks = [NSMutableArray array];
+        self.runningRequests = [NSHashTable weakObjectsHashTable];
+        self.writeBlocks = [NSMutableArray array];
+        self.writeCompletionBlocks = [NSMutableArray array];
+        self.queue = dispatch_queue_create("ch.srgssr.userdata.requestscheduler", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+#pragma mark Scheduling
+
+- (void)addRequestWithBlock:(SRGRequestSchedulerRequestBlock)requestBlock
+{
+    NSParameterAssert(requestBlock);
+    
+    dispatch_async(self.queue, ^{
+        NSAssert(! self.completionBlock && ! self.finished, @"Requests must be added before the scheduler is started");
+        
+        [self.requestBlocks addObject:[requestBlock copy]];
+        self.requestCount += 1;
+    });
+}
+
+- (void)startWithCompletionBlock:(void (^)(NSError * _Nullable))completionBlock
+{
+    NSParameterAssert(completionBlock);
+    
+    dispatch_async(self.queue, ^{
+        NSAssert(! self.completionBlock && ! self.finished, @"A scheduler can only be started once");
+        
+        self.completionBlock = completionBlock;
+        self.startDate = NSDate.date;
+        
+        [self scheduleRequests];
+        [self finishIfPossible];
+    });
+}
+
+- (void)cancel
+{
+    dispatch_async(self.queue, ^{
+        if (self.finished) {
+            return;
+        }
+        
+        [self.requestBlocks removeAllObjects];
+        [self.writeBlocks removeAllObjects];
+        [self.writeCompletionBlocks removeAllObjects];
+        [self cancelRunningRequests];
+        
+        NSError *error = [NSError errorWithDomain:SRGUserDataErrorDomain
+                                             code:SRGUserDataErrorCancelled
+                                         userInfo:@{ NSLocalizedDescriptionKey : SRGUserDataLocalizedString(@"The operation has been cancelled", @"Error message returned when an operation has been cancelled") }];
+        [self finishWithError:error];
+    });
+}
+
+// Must be called on the scheduler queue
+- (void)scheduleRequests
+{
+    while (! self.finished && ! self.error && self.runningCount < self.maximumConcurrentRequestCount && self.requestBlocks.count != 0) {
+        SRGRequestSchedulerRequestBlock requestBlock = self.requestBlocks.firstObject;
+        [self.requestBlocks removeObjectAtIndex:0];
+        
+        self.runningCount += 1;
+        
+        // Each request must report its result only once
+        __block BOOL resultReported = NO;
+        SRGRequest *request = requestBlock(^(SRGRequestSchedulerWriteBlock _Nullable writeBlock, SRGRequestSchedulerWriteCompletionBlock _Nullable writeCompletionBlock, NSError * _Nullable error) {
+            dispatch_async(self.queue, ^{
+                if (resultReported) {
+                    return;
+                }
+                resultReported = YES;
+                
+                [self requestDidCompleteWithWriteBlock:writeBlock writeCompletionBlock:writeCompletionBlock error:error];
+            });
+        });
+        
+        if (request) {
+            [self.runningRequests addObject:request];
+            [request resume];
+        }
+    }
+}
+
+// Must be called on the scheduler queue
+- (void)requestDidCompleteWithWriteBlock:(SRGRequestSchedulerWriteBlock)writeBlock
+                    writeCompletionBlock:(SRGRequestSchedulerWriteCompletionBlock)writeCompletionBlock
+                                   error:(NSError *)error
+{
+    if (self.finished) {
+        return;
+    }
+    
+    self.runningCount -= 1;
+    
+    if (error) {
+        [self failWithError:error];
+    }
+    else if (! self.error) {
+        if (writeBlock) {
+            [self.writeBlocks addObject:[writeBlock copy]];
+        }
+        if (writeCompletionBlock) {
+            [self.writeCompletionBlocks addObject:[writeCompletionBlock copy]];
+        }
+    }
+    
+    [self writeResults];
+    [self scheduleRequests];
+    [self finishIfPossible];
+}
+
+// Must be called on the scheduler queue
+- (void)writeResults
+{
+    if (self.finished || self.writing || (self.writeBlocks.count == 0 && self.writeCompletionBlocks.count == 0)) {
+        return;
+    }
+    
+    NSArray<SRGRequestSchedulerWriteBlock> *writeBlocks = self.writeBlocks.copy;
+    NSArray<SRGRequestSchedulerWriteCompletionBlock> *writeCompletionBlocks = self.writeCompletionBlocks.copy;
+    [self.writeBlocks removeAllObjects];
+    [self.writeCompletionBlocks removeAllObjects];
+    
+    self.writing = YES;
+    self.writeCount += 1;
+    
+    [self.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        for (SRGRequestSchedulerWriteBlock writeBlock in writeBlocks) {
+            writeBlock(managedObjectContext);
+        }
+    } withPriority:NSOperationQueuePriorityLow completionBlock:^(NSError * _Nullable error) {
+        dispatch_async(self.queue, ^{
+            self.writing = NO;
+            
+            for (SRGRequestSchedulerWriteCompletionBlock writeCompletionBlock in writeCompletionBlocks) {
+                writeCompletionBlock(error);
+            }
+            
+            if (error) {
+                [self failWithError:error];
+            }
+            
+            [self writeResults];
+            [self scheduleRequests];
+            [self finishIfPossible];
+        });
+    }];
+}
+
+// Must be called on the scheduler queue
+- (void)failWithError:(NSError *)error
+{
+    if (self.error) {
+        return;
+    }
+    
+    self.error = error;
+    
+    [self.requestBlocks removeAllObjects];
+    [self cancelRunningRequests];
+}
+
+// Must be called on the scheduler queue
+- (void)cancelRunningRequests
+{
+    for (SRGRequest *request in self.runningRequests.allObjects) {
+        [request cancel];
+    }
+    [self.runningRequests removeAllObjects];
+}
+
+// Must be called on the scheduler queue
+- (void)finishIfPossible
+{
+    if (! self.completionBlock || self.writing || self.writeBlocks.count != 0 || self.writeCompletionBlocks.count != 0) {
+        return;
+    }
+    
+    // Requests cancelled after an error are not waited for
+    if (self.error || (self.runningCount == 0 && self.requestBlocks.count == 0)) {
+        [self finishWithError:self.error];
+    }
+}
+
+// Must be called on the scheduler queue
+- (void)finishWithError:(NSError *)error
+{
+    if (self.finished) {
+        return;
+    }
+    
+    self.finished = YES;
+    
+    if (self.startDate) {
+        SRGUserDataLogDebug(@"request_scheduler", @"Completed %@ requests with %@ store writes in %.0f ms",
+                            @(self.requestCount), @(self.writeCount), [NSDate.date timeIntervalSinceDate:self.startDate] * 1000.);
+    }
+    
+    void (^completionBlock)(NSError *) = self.completionBlock;
+    self.completionBlock = nil;
+    completionBlock ? completionBlock(error) : nil;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; requestCount = %@; maximumConcurrentRequestCount = %@; writeCount = %@>",
+            self.class,
+            self,
+            @(self.requestCount),
+            @(self.maximumConcurrentRequestCount),
+            @(self.writeCount)];
+}
+
+@end
@@ -7,6 +7,7 @@
 #import "SRGUserData.h"
 
 #import "SRGDataStore.h"
+#import "SRGUserDataNotificationDispatcher.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -25,6 +26,11 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, readonly) SRGDataStore *dataStore;
 
+/**
+ *  The dispatcher with which change notifications must be delivered from background workers.
+ */
+@property (nonatomic, readonly) SRGUserDataNotificationDispatcher *notificationDispatcher;
+
 /**
  *  The data store file location.
  */
@@ -12,6 +12,7 @@
 #import "SRGHistory.h"
 #import "SRGUser+Private.h"
 #import "SRGUserDataLogger.h"
+#import "SRGUserDataNotificationDispatcher.h"
 #import "SRGUserDataService+Private.h"
 #import "SRGUserDataService+Subclassing.h"
 #import "SRGUserObject+Private.h"
@@ -20,7 +21,10 @@
 @import libextobjc;
 @import SRGNetwork;
 
-static NSUInteger s_currentPersistentStoreVersion = 7;
+static NSUInteger s_currentPersistentStoreVersion = 9;
+
+// Migrations from this version onwards can be inferred and do not need a mapping model file.
+static NSUInteger s_firstInferredMappingPersistentStoreVersion = 7;
 
 typedef NSString * SRGUserDataServiceType NS_TYPED_ENUM;
 
@@ -62,6 +66,7 @@ static BOOL SRGUserDataIsUnauthorizationError(NSError *error)
 @property (nonatomic) SRGIdentityService *identityService;
 
 @property (nonatomic) SRGDataStore *dataStore;
+@property (nonatomic) SRGUserDataNotificationDispatcher *notificationDispatcher;
 @property (nonatomic) NSDictionary<SRGUserDataServiceType, SRGUserDataService *> *services;
 
 @property (nonatomic, getter=isSynchronizing) BOOL synchronizing;
@@ -141,6 +146,8 @@ static BOOL SRGUserDataIsUnauthorizationError(NSError *error)
         
         self.dataStore = [[SRGDataStore alloc] initWithPersistentContainer:persistentContainer];
         
+        self.notificationDispatcher = [[SRGUserDataNotificationDispatcher alloc] init];
+        
         dispatch_group_t group = dispatch_group_create();
         
         dispatch_group_enter(group);
@@ -266,13 +273,6 @@ static BOOL SRGUserDataIsUnauthorizationError(NSError *error)
 {
     NSUInteger toVersion = fromVersion + 1;
     
-    NSString *mappingModelFilePath = [SWIFTPM_MODULE_BUNDLE pathForResource:[NSString stringWithFormat:@"SRGUserData_v%@_v%@", @(fromVersion), @(toVersion)] ofType:@"cdm"];
-    if (! mappingModelFilePath) {
-        return NO;
-    }
-    NSURL *mappingModelFileURL = [NSURL fileURLWithPath:mappingModelFilePath];
-    NSMappingModel *mappingModel = [[NSMappingModel alloc] initWithContentsOfURL:mappingModelFileURL];
-    
     NSString *sourceModelFilePath = [SWIFTPM_MODULE_BUNDLE pathForResource:[NSString stringWithFormat:@"SRGUserData_v%@", @(fromVersion)] ofType:@"mom" inDirectory:@"SRGUserData.momd"];
     if (! sourceModelFilePath) {
         return NO;
@@ -287,6 +287,22 @@ static BOOL SRGUserDataIsUnauthorizationError(NSError *error)
     NSURL *destinationeModelFileURL = [NSURL fileURLWithPath:destinationModelFilePath];
     NSManagedObjectModel *destinationModel = [[NSManagedObjectModel alloc] initWithContentsOfURL:destinationeModelFileURL];
     
+    NSMappingModel *mappingModel = nil;
+    NSString *mappingModelFilePath = [SWIFTPM_MODULE_BUNDLE pathForResource:[NSString stringWithFormat:@"SRGUserData_v%@_v%@", @(fromVersion), @(toVersion)] ofType:@"cdm"];
+    if (mappingModelFilePath) {
+        NSURL *mappingModelFileURL = [NSURL fileURLWithPath:mappingModelFilePath];
+        mappingModel = [[NSMappingModel alloc] initWithContentsOfURL:mappingModelFileURL];
+    }
+    else if (fromVersion >= s_firstInferredMappingPersistentStoreVersion) {
+        // Versions only adding indexes (e.g. v7 to v8) or dropping relationship ordering (v8 to v9) do not require a custom
+        // mapping model.
+        mappingModel = [NSMappingModel inferredMappingModelForSourceModel:sourceModel destinationModel:destinationModel error:NULL];
+    }
+    
+    if (! mappingModel) {
+        return NO;
+    }
+    
     NSString *migratedLastPathComponent = [fileURL.lastPathComponent stringByAppendingString:@"-migrated"];
     NSURL *migratedFileURL = [fileURL.URLByDeletingLastPathComponent URLByAppendingPathComponent:migratedLastPathComponent];
     
@@ -366,10 +382,11 @@ static BOOL SRGUserDataIsUnauthorizationError(NSError *error)
                 } withPriority:NSOperationQueuePriorityLow completionBlock:^(NSError * _Nullable error) {
                     self.synchronizing = NO;
                     
-                    dispatch_sync(dispatch_get_main_queue(), ^{
-                        NSDictionary *userInfo = (errors.count != 0) ? @{ SRGUserDataSynchronizationErrorsKey : errors } : nil;
-                        [NSNotificationCenter.defaultCenter postNotificationName:SRGUserDataDidFinishSynchronizationNotification object:self userInfo:userInfo];
-                    });
+                    NSDictionary *userInfo = (errors.count != 0) ? @{ SRGUserDataSynchronizationErrorsKey : errors } : nil;
+                    [self.notificationDispatcher postNotificationName:SRGUserDataDidFinishSynchronizationNotification
+                                                               object:self
+                                                             userInfo:userInfo
+                                                 coalescingUidsForKey:nil];
                     
                     SRGUserDataLogInfo(@"user_data", @"Finished synchronization");
                 }];
@@ -390,7 +407,7 @@ static BOOL SRGUserDataIsUnauthorizationError(NSError *error)
             --remainingServices;
             if (remainingServices == 0) {
                 if (! NSThread.isMainThread) {
-                    dispatch_sync(dispatch_get_main_queue(), ^{
+                    dispatch_async(dispatch_get_main_queue(), ^{
                         [self synchronize];
                     });
                 }
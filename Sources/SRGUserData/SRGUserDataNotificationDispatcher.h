@@ -0,0 +1,40 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Dispatcher delivering notifications asynchronously on the main thread, so that background workers never have to
+ *  wait for the main thread to be available.
+ *
+ *  Notifications posted before the main thread gets a chance to deliver them are coalesced. Blocks submitted with
+ *  `-dispatchBlock:` are executed on a background serial queue, in submission order, and only after all notifications
+ *  posted before them have been delivered.
+ */
+@interface SRGUserDataNotificationDispatcher : NSObject
+
+/**
+ *  Post a notification on the main thread.
+ *
+ *  @parameter uidsKey If not `nil`, the `userInfo` key pointing at an `NSSet` of uids. Pending notifications with the
+ *                     same name and object, and an identical `userInfo` except for this key, are merged into a single
+ *                     notification whose uid set is the union of all uid sets. Otherwise no coalescing occurs.
+ */
+- (void)postNotificationName:(NSNotificationName)name
+                      object:(nullable id)object
+                    userInfo:(nullable NSDictionary *)userInfo
+        coalescingUidsForKey:(nullable NSString *)uidsKey;
+
+/**
+ *  Execute a block on a background serial queue, after all notifications previously posted have been delivered.
+ */
+- (void)dispatchBlock:(void (^)(void))block;
+
+@end
+
+NS_ASSUME_NONNULL_END
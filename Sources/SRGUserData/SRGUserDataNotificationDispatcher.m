@@ -0,0 +1,134 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGUserDataNotificationDispatcher.h"
+
+/**
+ *  Notifications waiting for delivery, and blocks to execute once they have been delivered.
+ */
+@interface SRGUserDataNotificationBatch : NSObject
+
+@property (nonatomic) NSMutableArray<NSNotification *> *notifications;
+@property (nonatomic) NSMutableArray<void (^)(void)> *blocks;
+
+@end
+
+@implementation SRGUserDataNotificationBatch
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        self.notifications = [NSMutableArray array];
+        self.blocks = [NSMutableArray array];
+    }
+    return self;
+}
+
+@end
+
+@interface SRGUserDataNotificationDispatcher ()
+
+@property (nonatomic) SRGUserDataNotificationBatch *pendingBatch;
+@property (nonatomic) NSMutableArray<SRGUserDataNotificationBatch *> *deliveringBatches;
+
+@property (nonatomic) dispatch_queue_t queue;
+@property (nonatomic) dispatch_queue_t blockQueue;
+
+@end
+
+@implementation SRGUserDataNotificationDispatcher
+
+#pragma mark Object lifecycle
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        self.deliveringBatches = [NSMutableArray array];
+        self.queue = dispatch_queue_create("ch.srgssr.userdata.notifications", DISPATCH_QUEUE_SERIAL);
+        self.blockQueue = dispatch_queue_create("ch.srgssr.userdata.notifications.blocks", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+#pragma mark Dispatch
+
+- (void)postNotificationName:(NSNotificationName)name object:(id)object userInfo:(NSDictionary *)userInfo coalescingUidsForKey:(NSString *)uidsKey
+{
+    dispatch_async(self.queue, ^{
+        if (! self.pendingBatch) {
+            self.pendingBatch = [[SRGUserDataNotificationBatch alloc] init];
+            
+            // Everything posted until the main thread is available is delivered at once.
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [self deliverPendingBatch];
+            });
+        }
+        
+        NSMutableArray<NSNotification *> *notifications = self.pendingBatch.notifications;
+        if (uidsKey) {
+            NSMutableDictionary *otherUserInfo = userInfo.mutableCopy;
+            [otherUserInfo removeObjectForKey:uidsKey];
+            
+            for (NSUInteger i = 0; i < notifications.count; ++i) {
+                NSNotification *notification = notifications[i];
+                if (! [notification.name isEqualToString:name] || notification.object != object) {
+                    continue;
+                }
+                
+                NSMutableDictionary *notificationOtherUserInfo = notification.userInfo.mutableCopy;
+                [notificationOtherUserInfo removeObjectForKey:uidsKey];
+                if (! [notificationOtherUserInfo isEqualToDictionary:otherUserInfo]) {
+                    continue;
+                }
+                
+                NSMutableDictionary *mergedUserInfo = notification.userInfo.mutableCopy;
+                mergedUserInfo[uidsKey] = [notification.userInfo[uidsKey] setByAddingObjectsFromSet:userInfo[uidsKey]];
+                notifications[i] = [NSNotification notificationWithName:name object:object userInfo:mergedUserInfo.copy];
+                return;
+            }
+        }
+        [notifications addObject:[NSNotification notificationWithName:name object:object userInfo:userInfo]];
+    });
+}
+
+- (void)dispatchBlock:(void (^)(void))block
+{
+    dispatch_async(self.queue, ^{
+        SRGUserDataNotificationBatch *batch = self.pendingBatch ?: self.deliveringBatches.lastObject;
+        if (batch) {
+            [batch.blocks addObject:block];
+        }
+        else {
+            dispatch_async(self.blockQueue, block);
+        }
+    });
+}
+
+- (void)deliverPendingBatch
+{
+    NSAssert(NSThread.isMainThread, @"Must be called from the main thread");
+    
+    __block SRGUserDataNotificationBatch *batch = nil;
+    dispatch_sync(self.queue, ^{
+        batch = self.pendingBatch;
+        self.pendingBatch = nil;
+        [self.deliveringBatches addObject:batch];
+    });
+    
+    for (NSNotification *notification in batch.notifications) {
+        [NSNotificationCenter.defaultCenter postNotification:notification];
+    }
+    
+    // Blocks might still be attached to the batch until it is marked as delivered.
+    dispatch_async(self.queue, ^{
+        [self.deliveringBatches removeObject:batch];
+        for (void (^block)(void) in batch.blocks) {
+            dispatch_async(self.blockQueue, block);
+        }
+    });
+}
+
+@end
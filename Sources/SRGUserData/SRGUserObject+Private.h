@@ -5,6 +5,8 @@
 //
 
 #import "SRGUserObject.h"
+#import "SRGUserObjectCursor.h"
+#import "SRGUserObjectReconciliation.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -21,16 +23,60 @@ NS_ASSUME_NONNULL_BEGIN
                                           sortedWithDescriptors:(nullable NSArray<NSSortDescriptor *> *)sortDescriptors
                                          inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
 
+/**
+ *  Return a page of at most `limit` existing objects, optionally matching a specific predicate, sorted by date, then by
+ *  descending identifier. The page starts after the specified cursor (at the beginning if `nil`). A cursor to the next
+ *  page is returned if more objects are available, `nil` otherwise.
+ */
++ (NSArray<__kindof SRGUserObject *> *)objectsMatchingPredicate:(nullable NSPredicate *)predicate
+                                                  dateAscending:(BOOL)dateAscending
+                                                          limit:(NSUInteger)limit
+                                                    afterCursor:(nullable SRGUserObjectCursor *)cursor
+                                                     nextCursor:(SRGUserObjectCursor * _Nullable __autoreleasing * _Nullable)pNextCursor
+                                         inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
+
 /**
  *  Return an existing object for the specified identifier, `nil` if none is found.
  */
 + (nullable __kindof SRGUserObject *)objectWithUid:(NSString *)uid matchingPredicate:(nullable NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
 
+/**
+ *  Return existing objects for the specified identifiers, indexed by identifier, with a single fetch. Identifiers for
+ *  which no object is found are omitted.
+ */
++ (NSDictionary<NSString *, __kindof SRGUserObject *> *)objectsWithUids:(NSArray<NSString *> *)uids matchingPredicate:(nullable NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
+
+/**
+ *  Return the number of existing objects, optionally matching a specific predicate, without fetching them. If the count
+ *  fails, 0 is returned and error information is provided.
+ */
++ (NSUInteger)countOfObjectsMatchingPredicate:(nullable NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext error:(NSError * __autoreleasing *)error;
+
+/**
+ *  Return the sum of the numeric values at the specified key path for existing objects, optionally matching a specific
+ *  predicate. The sum is calculated by the store. If the calculation fails, 0 is returned and error information is
+ *  provided.
+ */
++ (double)sumOfValuesForKeyPath:(NSString *)keyPath ofObjectsMatchingPredicate:(nullable NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext error:(NSError * __autoreleasing *)error;
+
+/**
+ *  Return the number of existing objects, optionally matching a specific predicate, for each value found at the specified
+ *  key path, with a single grouped query. Objects without value are ignored. If the count fails, `nil` is returned and
+ *  error information is provided.
+ */
++ (nullable NSDictionary<id, NSNumber *> *)countsOfObjectsMatchingPredicate:(nullable NSPredicate *)predicate groupedByKeyPath:(NSString *)keyPath inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext error:(NSError * __autoreleasing *)error;
+
 /**
  *  Create an entry with the specified identifier, or return an existing one for update purposes.
  */
 + (__kindof SRGUserObject *)upsertWithUid:(NSString *)uid matchingPredicate:(nullable NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
 
+/**
+ *  Same as `-upsertWithUid:matchingPredicate:inManagedObjectContext:`, but for several identifiers at once. Objects are
+ *  returned in identifier order.
+ */
++ (NSArray<__kindof SRGUserObject *> *)upsertWithUids:(NSArray<NSString *> *)uids matchingPredicate:(nullable NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
+
 /**
  *  Synchronize the receiver with the information from the provided dictionary. The entry might be created, updated
  *  or deleted automatically, in which case it is returned by the method.
@@ -40,10 +86,21 @@ NS_ASSUME_NONNULL_BEGIN
 + (nullable __kindof SRGUserObject *)synchronizeWithDictionary:(NSDictionary *)dictionary matchingPredicate:(nullable NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
 
 /**
- *  Return the list of dictionaries which would need to be saved in order to replace a list of objects with a list of
- *  dictionaries representing another object list.
+ *  Synchronize the receiver with the information from a list of dictionaries, as if each dictionary was applied in
+ *  order with `-synchronizeWithDictionary:matchingPredicate:inManagedObjectContext:`. Objects which have been created,
+ *  updated or deleted are returned in the same order. Existing objects are fetched at once.
+ *
+ *  @discussion To persist changes, the Core Data managed object context needs to be saved.
  */
-+ (NSArray<NSDictionary *> *)dictionariesForObjects:(NSArray<SRGUserObject *> *)objects replacedWithDictionaries:(NSArray<NSDictionary *> *)dictionaries;
++ (NSArray<__kindof SRGUserObject *> *)synchronizeWithDictionaries:(NSArray<NSDictionary *> *)dictionaries
+                                                 matchingPredicate:(nullable NSPredicate *)predicate
+                                            inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
+
+/**
+ *  Reconcile a list of local objects with a list of dictionaries representing the remote object list. The dictionaries
+ *  which need to be saved in order to replace local objects are available from the result.
+ */
++ (SRGUserObjectReconciliation *)reconciliationForObjects:(NSArray<SRGUserObject *> *)objects withRemoteDictionaries:(NSArray<NSDictionary *> *)dictionaries;
 
 /**
  *  Discard the objects with the specified identifiers. Since some of them might not be found, the method returns the actual
@@ -62,6 +119,11 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (void)deleteAllObjectsMatchingPredicate:(nullable NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext;
 
+/**
+ *  @see `SRGUserObject.h`
+ */
+@property (nonatomic, copy, nullable) NSDate *date;
+
 /**
  *  Set to `YES` to flag the object as requiring a synchronization for the currently logged in user.
  *
@@ -74,6 +136,11 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, readonly) BOOL discarded;
 
+/**
+ *  Return a dictionary representation of the entry, marked as deleted.
+ */
+@property (nonatomic, readonly) NSDictionary *deletedDictionary;
+
 @end
 
 NS_ASSUME_NONNULL_END
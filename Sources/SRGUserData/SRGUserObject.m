@@ -10,6 +10,7 @@
 #import "SRGUser+Private.h"
 #import "SRGUserObject+Private.h"
 #import "SRGUserObject+Subclassing.h"
+#import "SRGUserObjectCursor+Private.h"
 
 @import libextobjc;
 
@@ -55,6 +56,51 @@
     return [managedObjectContext executeFetchRequest:fetchRequest error:NULL];
 }
 
++ (NSArray<SRGUserObject *> *)objectsMatchingPredicate:(NSPredicate *)predicate
+                                         dateAscending:(BOOL)dateAscending
+                                                 limit:(NSUInteger)limit
+                                           afterCursor:(SRGUserObjectCursor *)cursor
+                                            nextCursor:(SRGUserObjectCursor * __autoreleasing *)pNextCursor
+                                inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    NSParameterAssert(limit > 0);
+    
+    NSPredicate *objectsPredicate = predicate;
+    
+    // Keyset matching the (date, uid) sort order, so that only the requested page is read
+    if (cursor) {
+        NSString *dateOperator = dateAscending ? @">" : @"<";
+        NSString *format = [NSString stringWithFormat:@"%%K %@ %%@ OR (%%K == %%@ AND %%K < %%@)", dateOperator];
+        NSPredicate *cursorPredicate = [NSPredicate predicateWithFormat:format, @keypath(SRGUserObject.new, date), cursor.date,
+                                        @keypath(SRGUserObject.new, date), cursor.date, @keypath(SRGUserObject.new, uid), cursor.uid];
+        objectsPredicate = predicate ? [NSCompoundPredicate andPredicateWithSubpredicates:@[predicate, cursorPredicate]] : cursorPredicate;
+    }
+    
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass(self)];
+    fetchRequest.predicate = objectsPredicate;
+    fetchRequest.sortDescriptors = @[ [NSSortDescriptor sortDescriptorWithKey:@keypath(SRGUserObject.new, date) ascending:dateAscending],
+                                      [NSSortDescriptor sortDescriptorWithKey:@keypath(SRGUserObject.new, uid) ascending:NO] ];
+    
+    // Fetch one more object to know whether a next page exists
+    fetchRequest.fetchLimit = limit + 1;
+    
+    NSArray<SRGUserObject *> *objects = [managedObjectContext executeFetchRequest:fetchRequest error:NULL];
+    SRGUserObjectCursor *nextCursor = nil;
+    if (objects.count > limit) {
+        objects = [objects subarrayWithRange:NSMakeRange(0, limit)];
+        
+        SRGUserObject *lastObject = objects.lastObject;
+        if (lastObject.date && lastObject.uid) {
+            nextCursor = [[SRGUserObjectCursor alloc] initWithDate:lastObject.date uid:lastObject.uid];
+        }
+    }
+    
+    if (pNextCursor) {
+        *pNextCursor = nextCursor;
+    }
+    return objects ?: @[];
+}
+
 + (SRGUserObject *)objectWithUid:(NSString *)uid matchingPredicate:(NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
 {
     NSPredicate *objectPredicate = [NSPredicate predicateWithFormat:@"%K == %@", @keypath(SRGUserObject.new, uid), uid];
@@ -64,6 +110,83 @@
     return [self objectsMatchingPredicate:objectPredicate sortedWithDescriptors:nil inManagedObjectContext:managedObjectContext].firstObject;
 }
 
++ (NSDictionary<NSString *, SRGUserObject *> *)objectsWithUids:(NSArray<NSString *> *)uids matchingPredicate:(NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    if (uids.count == 0) {
+        return @{};
+    }
+    
+    NSPredicate *objectsPredicate = [NSPredicate predicateWithFormat:@"%K IN %@", @keypath(SRGUserObject.new, uid), uids];
+    if (predicate) {
+        objectsPredicate = [NSCompoundPredicate andPredicateWithSubpredicates:@[objectsPredicate, predicate]];
+    }
+    
+    // Results are indexed by uid, no sorting is required
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass(self)];
+    fetchRequest.predicate = objectsPredicate;
+    fetchRequest.returnsObjectsAsFaults = NO;
+    
+    NSArray<SRGUserObject *> *objects = [managedObjectContext executeFetchRequest:fetchRequest error:NULL];
+    NSMutableDictionary<NSString *, SRGUserObject *> *objectIndex = [NSMutableDictionary dictionaryWithCapacity:objects.count];
+    for (SRGUserObject *object in objects) {
+        objectIndex[object.uid] = object;
+    }
+    return objectIndex.copy;
+}
+
++ (NSUInteger)countOfObjectsMatchingPredicate:(NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext error:(NSError * __autoreleasing *)error
+{
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass(self)];
+    fetchRequest.predicate = predicate;
+    
+    NSUInteger count = [managedObjectContext countForFetchRequest:fetchRequest error:error];
+    return (count != NSNotFound) ? count : 0;
+}
+
++ (double)sumOfValuesForKeyPath:(NSString *)keyPath ofObjectsMatchingPredicate:(NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext error:(NSError * __autoreleasing *)error
+{
+    NSExpressionDescription *sumExpressionDescription = [[NSExpressionDescription alloc] init];
+    sumExpressionDescription.name = @"sum";
+    sumExpressionDescription.expression = [NSExpression expressionForFunction:@"sum:" arguments:@[ [NSExpression expressionForKeyPath:keyPath] ]];
+    sumExpressionDescription.expressionResultType = NSDoubleAttributeType;
+    
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass(self)];
+    fetchRequest.predicate = predicate;
+    fetchRequest.resultType = NSDictionaryResultType;
+    fetchRequest.propertiesToFetch = @[ sumExpressionDescription ];
+    
+    NSDictionary *result = [managedObjectContext executeFetchRequest:fetchRequest error:error].firstObject;
+    return [result[sumExpressionDescription.name] doubleValue];
+}
+
++ (NSDictionary<id, NSNumber *> *)countsOfObjectsMatchingPredicate:(NSPredicate *)predicate groupedByKeyPath:(NSString *)keyPath inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext error:(NSError * __autoreleasing *)error
+{
+    NSExpressionDescription *countExpressionDescription = [[NSExpressionDescription alloc] init];
+    countExpressionDescription.name = @"count";
+    countExpressionDescription.expression = [NSExpression expressionForFunction:@"count:" arguments:@[ [NSExpression expressionForKeyPath:@keypath(SRGUserObject.new, uid)] ]];
+    countExpressionDescription.expressionResultType = NSInteger64AttributeType;
+    
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass(self)];
+    fetchRequest.predicate = predicate;
+    fetchRequest.resultType = NSDictionaryResultType;
+    fetchRequest.propertiesToFetch = @[ keyPath, countExpressionDescription ];
+    fetchRequest.propertiesToGroupBy = @[ keyPath ];
+    
+    NSArray<NSDictionary *> *results = [managedObjectContext executeFetchRequest:fetchRequest error:error];
+    if (! results) {
+        return nil;
+    }
+    
+    NSMutableDictionary<id, NSNumber *> *counts = [NSMutableDictionary dictionaryWithCapacity:results.count];
+    for (NSDictionary *result in results) {
+        id value = result[keyPath];
+        if (value) {
+            counts[value] = result[countExpressionDescription.name];
+        }
+    }
+    return counts.copy;
+}
+
 + (SRGUserObject *)upsertWithUid:(NSString *)uid matchingPredicate:(NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
 {
     SRGUserObject *object = [self objectWithUid:uid matchingPredicate:predicate inManagedObjectContext:managedObjectContext];
@@ -77,72 +200,113 @@
     return object;
 }
 
-+ (SRGUserObject *)synchronizeWithDictionary:(NSDictionary *)dictionary matchingPredicate:(NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
++ (NSArray<SRGUserObject *> *)upsertWithUids:(NSArray<NSString *> *)uids matchingPredicate:(NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
 {
-    NSString *uid = dictionary[self.uidKey];
-    if (! uid) {
-        return nil;
+    if (uids.count == 0) {
+        return @[];
     }
     
-    // If the local entry is dirty and more recent than the server version, keep the local version as is.
-    NSNumber *timestamp = dictionary[@"date"];
-    NSDate *date = timestamp ? [NSDate dateWithTimeIntervalSince1970:timestamp.doubleValue / 1000.] : NSDate.date;
-    SRGUserObject *object = [self objectWithUid:uid matchingPredicate:predicate inManagedObjectContext:managedObjectContext];
-    if (object.dirty && [object.date compare:date] == NSOrderedDescending) {
-        return object;
-    }
+    NSMutableDictionary<NSString *, SRGUserObject *> *objectIndex = [[self objectsWithUids:uids matchingPredicate:predicate inManagedObjectContext:managedObjectContext] mutableCopy];
     
-    BOOL isDeleted = [dictionary[@"deleted"] boolValue];
-    if (isDeleted) {
-        if (object) {
-            [managedObjectContext deleteObject:object];
+    NSDate *date = NSDate.date;
+    NSMutableArray<SRGUserObject *> *objects = [NSMutableArray arrayWithCapacity:uids.count];
+    for (NSString *uid in uids) {
+        SRGUserObject *object = objectIndex[uid];
+        if (! object) {
+            object = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass(self) inManagedObjectContext:managedObjectContext];
+            object.uid = uid;
+            objectIndex[uid] = object;
         }
-        return object;
-    }
-    
-    if (! object) {
-        object = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass(self) inManagedObjectContext:managedObjectContext];
+        object.dirty = YES;
+        object.discarded = NO;
+        object.date = date;
+        [objects addObject:object];
     }
-    
-    [object updateWithDictionary:dictionary];
-    object.dirty = NO;
-    return object;
+    return objects.copy;
+}
+
++ (SRGUserObject *)synchronizeWithDictionary:(NSDictionary *)dictionary matchingPredicate:(NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
+{
+    return [self synchronizeWithDictionaries:@[dictionary] matchingPredicate:predicate inManagedObjectContext:managedObjectContext].firstObject;
 }
 
-+ (NSArray<NSDictionary *> *)dictionariesForObjects:(NSArray<SRGUserObject *> *)objects replacedWithDictionaries:(NSArray<NSDictionary *> *)dictionaries
++ (NSArray<SRGUserObject *> *)synchronizeWithDictionaries:(NSArray<NSDictionary *> *)dictionaries matchingPredicate:(NSPredicate *)predicate inManagedObjectContext:(NSManagedObjectContext *)managedObjectContext
 {
-    NSMutableDictionary<NSString *, NSDictionary *> *dictionaryIndex = [NSMutableDictionary dictionary];
+    NSMutableSet<NSString *> *uids = [NSMutableSet set];
     for (NSDictionary *dictionary in dictionaries) {
-        NSString *uid = dictionary[self.class.uidKey];
-        if ([self.reservedUids containsObject:uid]) {
-            continue;
-        }
-        
+        NSString *uid = dictionary[self.uidKey];
         if (uid) {
-            dictionaryIndex[uid] = dictionary;
+            [uids addObject:uid];
         }
     }
     
-    NSMutableArray<NSDictionary *> *mergedDictionaries = [NSMutableArray array];
-    for (SRGUserObject *object in objects) {
-        if ([self.reservedUids containsObject:object.uid]) {
-            continue;
-        }
-        else if (object.dirty) {
-            [mergedDictionaries addObject:object.dictionary];
-        }
-        else if ([dictionaryIndex.allKeys containsObject:object.uid]) {
-            [mergedDictionaries addObject:dictionaryIndex[object.uid]];
-        }
-        else {
-            [mergedDictionaries addObject:object.deletedDictionary];
-        }
-        
-        dictionaryIndex[object.uid] = nil;
+    if (uids.count == 0) {
+        return @[];
+    }
+    
+    // Fetch all affected objects at once, instead of once per dictionary
+    NSPredicate *objectsPredicate = [NSPredicate predicateWithFormat:@"%K IN %@", @keypath(SRGUserObject.new, uid), uids];
+    if (predicate) {
+        objectsPredicate = [NSCompoundPredicate andPredicateWithSubpredicates:@[objectsPredicate, predicate]];
+    }
+    
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass(self)];
+    fetchRequest.predicate = objectsPredicate;
+    fetchRequest.returnsObjectsAsFaults = NO;
+    
+    NSMutableDictionary<NSString *, SRGUserObject *> *objectIndex = [NSMutableDictionary dictionary];
+    for (SRGUserObject *object in [managedObjectContext executeFetchRequest:fetchRequest error:NULL]) {
+        objectIndex[object.uid] = object;
     }
     
-    [mergedDictionaries addObjectsFromArray:dictionaryIndex.allValues];
-    return mergedDictionaries.copy;
+    static const NSUInteger kAutoreleasePoolDrainCount = 100;
+    
+    NSMutableArray<SRGUserObject *> *objects = [NSMutableArray array];
+    for (NSUInteger i = 0; i < dictionaries.count; i += kAutoreleasePoolDrainCount) {
+        @autoreleasepool {
+            NSUInteger length = MIN(kAutoreleasePoolDrainCount, dictionaries.count - i);
+            for (NSDictionary *dictionary in [dictionaries subarrayWithRange:NSMakeRange(i, length)]) {
+                NSString *uid = dictionary[self.uidKey];
+                if (! uid) {
+                    continue;
+                }
+                
+                // If the local entry is dirty and more recent than the server version, keep the local version as is.
+                NSNumber *timestamp = dictionary[@"date"];
+                NSDate *date = timestamp ? [NSDate dateWithTimeIntervalSince1970:timestamp.doubleValue / 1000.] : NSDate.date;
+                SRGUserObject *object = objectIndex[uid];
+                if (object.dirty && [object.date compare:date] == NSOrderedDescending) {
+                    [objects addObject:object];
+                    continue;
+                }
+                
+                BOOL isDeleted = [dictionary[@"deleted"] boolValue];
+                if (isDeleted) {
+                    if (object) {
+                        [managedObjectContext deleteObject:object];
+                        [objects addObject:object];
+                        objectIndex[uid] = nil;
+                    }
+                    continue;
+                }
+                
+                if (! object) {
+                    object = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass(self) inManagedObjectContext:managedObjectContext];
+                    objectIndex[uid] = object;
+                }
+                
+                [object updateWithDictionary:dictionary];
+                object.dirty = NO;
+                [objects addObject:object];
+            }
+        }
+    }
+    return objects.copy;
+}
+
++ (SRGUserObjectReconciliation *)reconciliationForObjects:(NSArray<SRGUserObject *> *)objects withRemoteDictionaries:(NSArray<NSDictionary *> *)dictionaries
+{
+    return [[SRGUserObjectReconciliation alloc] initWithObjectClass:self objects:objects remoteDictionaries:dictionaries];
 }
 
 + (NSArray<NSString *> *)discardObjectsWithUids:(NSArray<NSString *> *)uids
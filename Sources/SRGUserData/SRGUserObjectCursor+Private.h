@@ -0,0 +1,29 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGUserObjectCursor.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Private interface for implementation purposes.
+ */
+@interface SRGUserObjectCursor (Private)
+
+/**
+ *  Create a cursor positioned after the object having the specified date and identifier.
+ */
+- (instancetype)initWithDate:(NSDate *)date uid:(NSString *)uid;
+
+/**
+ *  The date and identifier of the last object before the cursor.
+ */
+@property (nonatomic, readonly, copy) NSDate *date;
+@property (nonatomic, readonly, copy) NSString *uid;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,68 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGUserObjectCursor+Private.h"
+
+@interface SRGUserObjectCursor ()
+
+@property (nonatomic, copy) NSDate *date;
+@property (nonatomic, copy) NSString *uid;
+
+@end
+
+@implementation SRGUserObjectCursor
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithDate:(NSDate *)date uid:(NSString *)uid
+{
+    NSParameterAssert(date);
+    NSParameterAssert(uid);
+    
+    if (self = [super init]) {
+        self.date = date;
+        self.uid = uid;
+    }
+    return self;
+}
+
+#pragma mark NSCopying protocol
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    // Immutable
+    return self;
+}
+
+#pragma mark Equality
+
+- (BOOL)isEqual:(id)object
+{
+    if (! [object isKindOfClass:self.class]) {
+        return NO;
+    }
+    
+    SRGUserObjectCursor *otherCursor = object;
+    return [self.date isEqualToDate:otherCursor.date] && [self.uid isEqualToString:otherCursor.uid];
+}
+
+- (NSUInteger)hash
+{
+    return self.date.hash ^ self.uid.hash;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; date = %@; uid = %@>",
+            self.class,
+            self,
+            self.date,
+            self.uid];
+}
+
+@end
@@ -0,0 +1,65 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGUserObject.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Result of the reconciliation of a list of local objects with the list of dictionaries received from a service, which
+ *  is considered as the complete remote state. Reserved uids are ignored.
+ *
+ *  The reconciliation is computed in linear time.
+ */
+@interface SRGUserObjectReconciliation : NSObject
+
+/**
+ *  Reconcile local objects of the specified class with remote dictionaries.
+ */
+- (instancetype)initWithObjectClass:(Class)objectClass
+                            objects:(NSArray<SRGUserObject *> *)objects
+                 remoteDictionaries:(NSArray<NSDictionary *> *)dictionaries;
+
+/**
+ *  The dictionaries to synchronize local objects with in order to apply the reconciliation result
+ *  (@see `+[SRGUserObject synchronizeWithDictionaries:matchingPredicate:inManagedObjectContext:]`).
+ */
+@property (nonatomic, readonly) NSArray<NSDictionary *> *dictionaries;
+
+/**
+ *  Uids of objects only available remotely.
+ */
+@property (nonatomic, readonly) NSSet<NSString *> *insertedUids;
+
+/**
+ *  Uids of non-dirty local objects also available remotely.
+ */
+@property (nonatomic, readonly) NSSet<NSString *> *updatedUids;
+
+/**
+ *  Uids of non-dirty local objects not available remotely anymore, or deleted remotely.
+ */
+@property (nonatomic, readonly) NSSet<NSString *> *deletedUids;
+
+/**
+ *  Uids of dirty local objects, whose local version is kept.
+ */
+@property (nonatomic, readonly) NSSet<NSString *> *keptDirtyUids;
+
+/**
+ *  Uids of all objects affected by the reconciliation.
+ */
+@property (nonatomic, readonly) NSSet<NSString *> *changedUids;
+
+@end
+
+@interface SRGUserObjectReconciliation (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,124 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "SRGUserObjectReconciliation.h"
+
+#import "SRGUserObject+Private.h"
+#import "SRGUserObject+Subclassing.h"
+
+@interface SRGUserObjectReconciliation ()
+
+@property (nonatomic) NSArray<NSDictionary *> *dictionaries;
+
+@property (nonatomic) NSSet<NSString *> *insertedUids;
+@property (nonatomic) NSSet<NSString *> *updatedUids;
+@property (nonatomic) NSSet<NSString *> *deletedUids;
+@property (nonatomic) NSSet<NSString *> *keptDirtyUids;
+
+@end
+
+@implementation SRGUserObjectReconciliation
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithObjectClass:(Class)objectClass objects:(NSArray<SRGUserObject *> *)objects remoteDictionaries:(NSArray<NSDictionary *> *)dictionaries
+{
+    NSParameterAssert([objectClass isSubclassOfClass:SRGUserObject.class]);
+    
+    if (self = [super init]) {
+        NSString *uidKey = [objectClass uidKey];
+        NSSet<NSString *> *reservedUids = [NSSet setWithArray:[objectClass reservedUids]];
+        
+        NSMutableDictionary<NSString *, NSDictionary *> *dictionaryIndex = [NSMutableDictionary dictionaryWithCapacity:dictionaries.count];
+        for (NSDictionary *dictionary in dictionaries) {
+            NSString *uid = dictionary[uidKey];
+            if (uid && ! [reservedUids containsObject:uid]) {
+                dictionaryIndex[uid] = dictionary;
+            }
+        }
+        
+        NSMutableArray<NSDictionary *> *mergedDictionaries = [NSMutableArray arrayWithCapacity:MAX(objects.count, dictionaries.count)];
+        NSMutableSet<NSString *> *insertedUids = [NSMutableSet set];
+        NSMutableSet<NSString *> *updatedUids = [NSMutableSet set];
+        NSMutableSet<NSString *> *deletedUids = [NSMutableSet set];
+        NSMutableSet<NSString *> *keptDirtyUids = [NSMutableSet set];
+        
+        NSMutableSet<NSString *> *localUids = [NSMutableSet setWithCapacity:objects.count];
+        for (SRGUserObject *object in objects) {
+            NSString *uid = object.uid;
+            if (! uid || [reservedUids containsObject:uid] || [localUids containsObject:uid]) {
+                continue;
+            }
+            [localUids addObject:uid];
+            
+            NSDictionary *dictionary = dictionaryIndex[uid];
+            if (object.dirty) {
+                [mergedDictionaries addObject:object.dictionary];
+                [keptDirtyUids addObject:uid];
+            }
+            else if (dictionary) {
+                [mergedDictionaries addObject:dictionary];
+                if ([dictionary[@"deleted"] boolValue]) {
+                    [deletedUids addObject:uid];
+                }
+                else {
+                    [updatedUids addObject:uid];
+                }
+            }
+            else {
+                [mergedDictionaries addObject:object.deletedDictionary];
+                [deletedUids addObject:uid];
+            }
+        }
+        
+        // Remaining remote objects, in their original order. Remote tombstones for objects which do not exist locally
+        // can be ignored.
+        for (NSDictionary *dictionary in dictionaries) {
+            NSString *uid = dictionary[uidKey];
+            if (! uid || [localUids containsObject:uid] || [insertedUids containsObject:uid] || dictionaryIndex[uid] != dictionary) {
+                continue;
+            }
+            
+            if (! [dictionary[@"deleted"] boolValue]) {
+                [mergedDictionaries addObject:dictionary];
+                [insertedUids addObject:uid];
+            }
+        }
+        
+        self.dictionaries = mergedDictionaries.copy;
+        self.insertedUids = insertedUids.copy;
+        self.updatedUids = updatedUids.copy;
+        self.deletedUids = deletedUids.copy;
+        self.keptDirtyUids = keptDirtyUids.copy;
+    }
+    return self;
+}
+
+#pragma mark Getters and setters
+
+- (NSSet<NSString *> *)changedUids
+{
+    NSMutableSet<NSString *> *changedUids = [NSMutableSet setWithSet:self.insertedUids];
+    [changedUids unionSet:self.updatedUids];
+    [changedUids unionSet:self.deletedUids];
+    [changedUids unionSet:self.keptDirtyUids];
+    return changedUids.copy;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; inserted = %@; updated = %@; deleted = %@; keptDirty = %@>",
+            self.class,
+            self,
+            @(self.insertedUids.count),
+            @(self.updatedUids.count),
+            @(self.deletedUids.count),
+            @(self.keptDirtyUids.count)];
+}
+
+@end
@@ -6,6 +6,7 @@
 
 #import "SRGHistoryEntry.h"
 #import "SRGUserDataService.h"
+#import "SRGUserObjectCursor.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -26,10 +27,22 @@ OBJC_EXPORT NSString * const SRGHistoryEntriesUidsKey;
  *  local and distant histories are automatically kept in sync.
  *
  *  You can register for history change notifications, see above. These will be sent by the `SRGHistory` instance
- *  itself and received on the main thread.
+ *  itself and received on the main thread. Changes made in quick succession might be reported by a single notification.
+ *  Completion blocks of write operations are called after the corresponding notifications have been received.
  */
 @interface SRGHistory : SRGUserDataService
 
+/**
+ *  Players usually save the playback position of the same entry repeatedly. Except for the first one, such updates
+ *  are kept in memory and written to the store at most once per interval, keeping only the most recent value for each
+ *  entry. Buffered updates are reflected by returned entries immediately, and written as well when the application
+ *  enters the background or before synchronization. Their change notifications and completion blocks are delivered
+ *  once they have been written.
+ *
+ *  Default is 1 second. Set to 0 to write all updates immediately.
+ */
+@property (nonatomic) NSTimeInterval playbackPositionFlushInterval;
+
 /**
  *  Return history entries, optionally matching a specific predicate and / or sorted with descriptors. If no sort
  *  descriptors are provided, entries are still returned in a stable order.
@@ -55,6 +68,34 @@ OBJC_EXPORT NSString * const SRGHistoryEntriesUidsKey;
                         sortedWithDescriptors:(nullable NSArray<NSSortDescriptor *> *)sortDescriptors
                               completionBlock:(void (^)(NSArray<SRGHistoryEntry *> * _Nullable historyEntries, NSError * _Nullable error))completionBlock;
 
+/**
+ *  Return a page of at most `limit` history entries, optionally matching a specific predicate, most recent first. The
+ *  page starts after the specified cursor, or with the most recent entry if none. When more entries are available, a
+ *  cursor to the next page is returned in `nextCursor`.
+ *
+ *  @discussion This method can only be called from the main thread. Only the entries of the requested page are read.
+ */
+- (NSArray<SRGHistoryEntry *> *)historyEntriesMatchingPredicate:(nullable NSPredicate *)predicate
+                                                          limit:(NSUInteger)limit
+                                                    afterCursor:(nullable SRGUserObjectCursor *)cursor
+                                                     nextCursor:(SRGUserObjectCursor * _Nullable __autoreleasing * _Nullable)nextCursor;
+
+/**
+ *  Return a page of at most `limit` history entries, optionally matching a specific predicate, most recent first. The
+ *  page starts after the specified cursor, or with the most recent entry if none. The read occurs asynchronously, calling
+ *  the provided block on completion with a cursor to the next page if more entries are available.
+ *
+ *  @return `NSString` An opaque task handle which can be used to cancel it. For cancelled tasks, the completion block
+ *                     will be called with an error.
+ *
+ *  @discussion The completion block is called on a background thread. You can only use the returned objects on this
+ *              thread.
+ */
+- (NSString *)historyEntriesMatchingPredicate:(nullable NSPredicate *)predicate
+                                        limit:(NSUInteger)limit
+                                  afterCursor:(nullable SRGUserObjectCursor *)cursor
+                              completionBlock:(void (^)(NSArray<SRGHistoryEntry *> * _Nullable historyEntries, SRGUserObjectCursor * _Nullable nextCursor, NSError * _Nullable error))completionBlock;
+
 /**
  *  Return the history entry matching the specified identifier, if any.
  *
@@ -74,6 +115,68 @@ OBJC_EXPORT NSString * const SRGHistoryEntriesUidsKey;
  */
 - (NSString *)historyEntryWithUid:(NSString *)uid completionBlock:(void (^)(SRGHistoryEntry * _Nullable historyEntry, NSError * _Nullable error))completionBlock;
 
+/**
+ *  Return the history entries matching the specified identifiers, indexed by identifier. Identifiers without entry are
+ *  omitted. All entries are read at once, which is more efficient than reading them one by one.
+ *
+ *  @discussion This method can only be called from the main thread.
+ */
+- (NSDictionary<NSString *, SRGHistoryEntry *> *)historyEntriesWithUids:(NSArray<NSString *> *)uids;
+
+/**
+ *  Return the history entries matching the specified identifiers, indexed by identifier. Identifiers without entry are
+ *  omitted. The read occurs asynchronously, calling the provided block on completion.
+ *
+ *  @return `NSString` An opaque task handle which can be used to cancel it. For cancelled tasks, the completion block
+ *                     will be called with an error.
+ *
+ *  @discussion The completion block is called on a background thread. You can only use the returned objects on this
+ *              thread.
+ */
+- (NSString *)historyEntriesWithUids:(NSArray<NSString *> *)uids completionBlock:(void (^)(NSDictionary<NSString *, SRGHistoryEntry *> * _Nullable historyEntries, NSError * _Nullable error))completionBlock;
+
+/**
+ *  Return the number of history entries, optionally matching a specific predicate. Entries are counted by the store
+ *  without being read.
+ *
+ *  @discussion This method can only be called from the main thread.
+ */
+- (NSUInteger)historyEntryCountMatchingPredicate:(nullable NSPredicate *)predicate;
+
+/**
+ *  Return the number of history entries, optionally matching a specific predicate. Entries are counted by the store
+ *  without being read. The count occurs asynchronously, calling the provided block on completion.
+ *
+ *  @return `NSString` An opaque task handle which can be used to cancel it. For cancelled tasks, or if the count fails,
+ *                     the completion block will be called with an error.
+ *
+ *  @discussion The completion block is called on a background thread.
+ */
+- (NSString *)historyEntryCountMatchingPredicate:(nullable NSPredicate *)predicate
+                                 completionBlock:(void (^)(NSUInteger count, NSError * _Nullable error))completionBlock;
+
+/**
+ *  Return the sum of the last playback positions (in seconds) of history entries, optionally matching a specific
+ *  predicate. The sum is calculated by the store without reading entries.
+ *
+ *  @discussion This method can only be called from the main thread. Playback positions saved in quick succession are
+ *              only taken into account once written to the store.
+ */
+- (double)totalLastPlaybackPositionOfHistoryEntriesMatchingPredicate:(nullable NSPredicate *)predicate;
+
+/**
+ *  Return the sum of the last playback positions (in seconds) of history entries, optionally matching a specific
+ *  predicate. The sum is calculated by the store without reading entries. The calculation occurs asynchronously,
+ *  calling the provided block on completion.
+ *
+ *  @return `NSString` An opaque task handle which can be used to cancel it. For cancelled tasks, or if the calculation
+ *                     fails, the completion block will be called with an error.
+ *
+ *  @discussion The completion block is called on a background thread.
+ */
+- (NSString *)totalLastPlaybackPositionOfHistoryEntriesMatchingPredicate:(nullable NSPredicate *)predicate
+                                                         completionBlock:(void (^)(double totalLastPlaybackPosition, NSError * _Nullable error))completionBlock;
+
 /**
  *  Asynchronously save a history entry for a given identifier, calling the specified block on completion.
  *
@@ -101,6 +204,8 @@ OBJC_EXPORT NSString * const SRGHistoryEntriesUidsKey;
 
 /**
  *  Cancel the task having the specified handle.
+ *
+ *  @discussion Cancelling a buffered playback position update also cancels the updates of the same entry it replaced.
  */
 - (void)cancelTaskWithHandle:(NSString *)handle;
 
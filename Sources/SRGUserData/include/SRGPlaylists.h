@@ -7,6 +7,7 @@
 #import "SRGPlaylist.h"
 #import "SRGPlaylistEntry.h"
 #import "SRGUserDataService.h"
+#import "SRGUserObjectCursor.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -39,7 +40,8 @@ OBJC_EXPORT NSString * const SRGPlaylistEntriesUidsKey;
  *  automatically kept in sync.
  *
  *  You can register for playlists update notifications, see above. These will be sent by the `SRGPlaylists` instance
- *  itself and received on the main thread.
+ *  itself and received on the main thread. Changes made in quick succession might be reported by a single notification.
+ *  Completion blocks of write operations are called after the corresponding notifications have been received.
  */
 @interface SRGPlaylists : SRGUserDataService
 
@@ -68,6 +70,35 @@ OBJC_EXPORT NSString * const SRGPlaylistEntriesUidsKey;
                    sortedWithDescriptors:(nullable NSArray<NSSortDescriptor *> *)sortDescriptors
                          completionBlock:(void (^)(NSArray<SRGPlaylist *> * _Nullable playlists, NSError * _Nullable error))completionBlock;
 
+/**
+ *  Return a page of at most `limit` playlists, optionally matching a specific predicate, most recently updated first.
+ *  The page starts after the specified cursor, or with the most recently updated playlist if none. When more playlists
+ *  are available, a cursor to the next page is returned in `nextCursor`.
+ *
+ *  @discussion This method can only be called from the main thread. Only the playlists of the requested page are read.
+ */
+- (NSArray<SRGPlaylist *> *)playlistsMatchingPredicate:(nullable NSPredicate *)predicate
+                                                 limit:(NSUInteger)limit
+                                           afterCursor:(nullable SRGUserObjectCursor *)cursor
+                                            nextCursor:(SRGUserObjectCursor * _Nullable __autoreleasing * _Nullable)nextCursor;
+
+/**
+ *  Return a page of at most `limit` playlists, optionally matching a specific predicate, most recently updated first.
+ *  The page starts after the specified cursor, or with the most recently updated playlist if none. The read occurs
+ *  asynchronously, calling the provided block on completion with a cursor to the next page if more playlists are
+ *  available.
+ *
+ *  @return `NSString` An opaque task handle which can be used to cancel it. For cancelled tasks, the completion block
+ *                     will be called with an error.
+ *
+ *  @discussion The completion block is called on a background thread. You can only use the returned objects on this
+ *              thread.
+ */
+- (NSString *)playlistsMatchingPredicate:(nullable NSPredicate *)predicate
+                                   limit:(NSUInteger)limit
+                             afterCursor:(nullable SRGUserObjectCursor *)cursor
+                         completionBlock:(void (^)(NSArray<SRGPlaylist *> * _Nullable playlists, SRGUserObjectCursor * _Nullable nextCursor, NSError * _Nullable error))completionBlock;
+
 /**
  *  Return the playlist matching the specified identifier, if any.
  *
@@ -143,6 +174,123 @@ OBJC_EXPORT NSString * const SRGPlaylistEntriesUidsKey;
                          sortedWithDescriptors:(nullable NSArray<NSSortDescriptor *> *)sortDescriptors
                                completionBlock:(void (^)(NSArray<SRGPlaylistEntry *> * _Nullable playlistEntries, NSError * _Nullable error))completionBlock;
 
+/**
+ *  Return a page of at most `limit` entries of a given playlist, optionally matching a specific predicate, in playlist
+ *  order (oldest first). The page starts after the specified cursor, or with the first entry if none. When more entries
+ *  are available, a cursor to the next page is returned in `nextCursor`.
+ *
+ *  @discussion This method can only be called from the main thread. Only the entries of the requested page are read.
+ *              This method returns `nil` if no playlist exists for the specified identifier.
+ */
+- (nullable NSArray<SRGPlaylistEntry *> *)playlistEntriesInPlaylistWithUid:(NSString *)playlistUid
+                                                         matchingPredicate:(nullable NSPredicate *)predicate
+                                                                     limit:(NSUInteger)limit
+                                                               afterCursor:(nullable SRGUserObjectCursor *)cursor
+                                                                nextCursor:(SRGUserObjectCursor * _Nullable __autoreleasing * _Nullable)nextCursor;
+
+/**
+ *  Return a page of at most `limit` entries of a given playlist, optionally matching a specific predicate, in playlist
+ *  order (oldest first). The page starts after the specified cursor, or with the first entry if none. The read occurs
+ *  asynchronously, calling the provided block on completion with a cursor to the next page if more entries are
+ *  available.
+ *
+ *  @return `NSString` An opaque task handle which can be used to cancel it. For cancelled tasks, the completion block
+ *                     will be called with an error.
+ *
+ *  @discussion The completion block is called on a background thread. You can only use the returned objects on this
+ *              thread. This method returns `nil` if no playlist exists for the specified identifier.
+ */
+- (NSString *)playlistEntriesInPlaylistWithUid:(NSString *)playlistUid
+                             matchingPredicate:(nullable NSPredicate *)predicate
+                                         limit:(NSUInteger)limit
+                                   afterCursor:(nullable SRGUserObjectCursor *)cursor
+                               completionBlock:(void (^)(NSArray<SRGPlaylistEntry *> * _Nullable playlistEntries, SRGUserObjectCursor * _Nullable nextCursor, NSError * _Nullable error))completionBlock;
+
+/**
+ *  Return the entries of a given playlist matching the specified identifiers, indexed by identifier. Identifiers without
+ *  entry are omitted. All entries are read at once, which is more efficient than reading them one by one.
+ *
+ *  @discussion This method can only be called from the main thread. This method returns `nil` if no playlist exists
+ *              for the specified identifier.
+ */
+- (nullable NSDictionary<NSString *, SRGPlaylistEntry *> *)playlistEntriesWithUids:(NSArray<NSString *> *)uids
+                                                                  inPlaylistWithUid:(NSString *)playlistUid;
+
+/**
+ *  Return the entries of a given playlist matching the specified identifiers, indexed by identifier. Identifiers without
+ *  entry are omitted. The read occurs asynchronously, calling the provided block on completion.
+ *
+ *  @return `NSString` An opaque task handle which can be used to cancel it. For cancelled tasks, the completion block
+ *                     will be called with an error.
+ *
+ *  @discussion The completion block is called on a background thread. You can only use the returned objects on this
+ *              thread. This method returns `nil` if no playlist exists for the specified identifier.
+ */
+- (NSString *)playlistEntriesWithUids:(NSArray<NSString *> *)uids
+                    inPlaylistWithUid:(NSString *)playlistUid
+                      completionBlock:(void (^)(NSDictionary<NSString *, SRGPlaylistEntry *> * _Nullable playlistEntries, NSError * _Nullable error))completionBlock;
+
+/**
+ *  Return the number of entries of a given playlist, optionally matching a specific predicate. Entries are counted by
+ *  the store without being read.
+ *
+ *  @discussion This method can only be called from the main thread. This method returns 0 if no playlist exists for
+ *              the specified identifier.
+ */
+- (NSUInteger)playlistEntryCountInPlaylistWithUid:(NSString *)playlistUid matchingPredicate:(nullable NSPredicate *)predicate;
+
+/**
+ *  Return the number of entries of a given playlist, optionally matching a specific predicate. Entries are counted by
+ *  the store without being read. The count occurs asynchronously, calling the provided block on completion.
+ *
+ *  @return `NSString` An opaque task handle which can be used to cancel it. For cancelled tasks, or if the count fails,
+ *                     the completion block will be called with an error.
+ *
+ *  @discussion The completion block is called on a background thread. The count is 0 if no playlist exists for the
+ *              specified identifier.
+ */
+- (NSString *)playlistEntryCountInPlaylistWithUid:(NSString *)playlistUid
+                                matchingPredicate:(nullable NSPredicate *)predicate
+                                  completionBlock:(void (^)(NSUInteger count, NSError * _Nullable error))completionBlock;
+
+/**
+ *  Return the number of entries, optionally matching a specific predicate, of every playlist, indexed by playlist
+ *  identifier. Counts for all playlists are obtained from a single grouped query. Playlists without matching entries
+ *  are omitted.
+ *
+ *  @discussion This method can only be called from the main thread.
+ */
+- (NSDictionary<NSString *, NSNumber *> *)playlistEntryCountsMatchingPredicate:(nullable NSPredicate *)predicate;
+
+/**
+ *  Return the number of entries, optionally matching a specific predicate, of every playlist, indexed by playlist
+ *  identifier. Counts for all playlists are obtained from a single grouped query. Playlists without matching entries
+ *  are omitted. The count occurs asynchronously, calling the provided block on completion.
+ *
+ *  @return `NSString` An opaque task handle which can be used to cancel it. For cancelled tasks, or if the count fails,
+ *                     the completion block will be called with an error.
+ *
+ *  @discussion The completion block is called on a background thread.
+ */
+- (NSString *)playlistEntryCountsMatchingPredicate:(nullable NSPredicate *)predicate
+                                   completionBlock:(void (^)(NSDictionary<NSString *, NSNumber *> * _Nullable playlistEntryCounts, NSError * _Nullable error))completionBlock;
+
+/**
+ *  Return the identifiers of the playlists containing an entry with the specified identifier (an empty set if none).
+ *
+ *  @discussion This method can be called from any thread and returns synchronously. Memberships are read from the store
+ *              once when first needed and then kept in memory, so that checking whether some media belongs to a
+ *              playlist does not require any fetch. Changes are reflected when the corresponding notifications are
+ *              received.
+ */
+- (NSSet<NSString *> *)playlistUidsContainingEntryWithUid:(NSString *)uid;
+
+/**
+ *  Same as `-playlistUidsContainingEntryWithUid:`, for several entries at once. Entries contained in no playlist are
+ *  omitted from the returned dictionary.
+ */
+- (NSDictionary<NSString *, NSSet<NSString *> *> *)playlistUidsContainingEntriesWithUids:(NSArray<NSString *> *)uids;
+
 /**
  *  Asynchronously add a playlist entry with a given identifier to the specified playlist, calling the provided block on
  *  completion.
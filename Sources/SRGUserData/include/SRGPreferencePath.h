@@ -0,0 +1,48 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Validated location of a preference, i.e. a path in a domain (see `SRGPreferences` for valid domains and paths).
+ *
+ *  Paths are validated and split when created. Applications frequently reading the same preference can keep a preference
+ *  path and use it with `SRGPreferences` reading methods, so that no validation is needed when reading preferences.
+ *
+ *  @discussion Preference paths are immutable and can be shared among threads.
+ */
+@interface SRGPreferencePath : NSObject <NSCopying>
+
+/**
+ *  Return the preference path matching a path in a domain, `nil` if the path or the domain is invalid. A `nil` path
+ *  corresponds to the domain root.
+ *
+ *  @discussion Recently used preference paths are cached, so that calling this method several times for the same
+ *              location is cheap.
+ */
++ (nullable SRGPreferencePath *)preferencePathWithPath:(nullable NSString *)path inDomain:(NSString *)domain;
+
+/**
+ *  The path, with leading and trailing slashes removed. `nil` for the domain root.
+ */
+@property (nonatomic, readonly, copy, nullable) NSString *path;
+
+/**
+ *  The domain.
+ */
+@property (nonatomic, readonly, copy) NSString *domain;
+
+@end
+
+@interface SRGPreferencePath (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -4,13 +4,15 @@
 //  License information is available from the LICENSE file.
 //
 
+#import "SRGPreferencePath.h"
 #import "SRGUserDataService.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 /**
  *  Notification sent when preferences change. Use the keys below to retrieve detailed information from the notification
- *  `userInfo` dictionary.
+ *  `userInfo` dictionary. The notification is received on the main thread, in the order changes were made, whichever
+ *  thread they were made from.
  */
 OBJC_EXPORT NSString * const SRGPreferencesDidChangeNotification;
 
@@ -18,6 +20,7 @@ OBJC_EXPORT NSString * const SRGPreferencesDidChangeNotification;
  *  Information available for `SRGPreferencesDidChangeNotification`.
  */
 OBJC_EXPORT NSString * const SRGPreferencesDomainsKey;                           // Key to access the domains for which changes have been detected, as an `NSSet` of `NSString` objects.
+OBJC_EXPORT NSString * const SRGPreferencesPathsKey;                             // Key to access the paths at which changes have been detected, as an `NSDictionary` mapping each changed domain to an `NSSet` of `NSString` paths.
 
 /**
  *  Manages a local cache of user preferences, similar to `NSUserDefaults`. For logged in users, and provided a service
@@ -36,6 +39,9 @@ OBJC_EXPORT NSString * const SRGPreferencesDomainsKey;
  *  You can register for preference update notifications, see above. These will be sent by the `SRGPreferences` instance
  *  itself and received on the main thread. No notifications are sent when no changes have actually been made.
  *
+ *  Preferences can be read and written from any thread. Reads never wait for writes to complete, and returned arrays and
+ *  dictionaries are immutable snapshots which are not affected by later changes.
+ *
  *  ## Valid domains and paths
  *
  *  Domains may not contain slashes, spaces or characters not in `NSCharacterSet.URLPathAllowedCharacterSet`. Path
@@ -92,12 +98,37 @@ OBJC_EXPORT NSString * const SRGPreferencesDomainsKey;
 - (nullable NSArray *)arrayAtPath:(NSString *)path inDomain:(NSString *)domain;
 - (nullable NSDictionary *)dictionaryAtPath:(nullable NSString *)path inDomain:(NSString *)domain;
 
+/**
+ *  Same as the above methods, for a preference path which has already been validated. Prefer these methods for
+ *  preferences read frequently.
+ */
+- (BOOL)hasObjectAtPreferencePath:(SRGPreferencePath *)preferencePath;
+- (nullable NSString *)stringAtPreferencePath:(SRGPreferencePath *)preferencePath;
+- (nullable NSNumber *)numberAtPreferencePath:(SRGPreferencePath *)preferencePath;
+- (nullable NSArray *)arrayAtPreferencePath:(SRGPreferencePath *)preferencePath;
+- (nullable NSDictionary *)dictionaryAtPreferencePath:(SRGPreferencePath *)preferencePath;
+
 /**
  *  Remove objects at the specific paths in a domain. The method does nothing when no object exists at a specified
  *  location.
  */
 - (void)removeObjectsAtPaths:(NSArray<NSString *> *)paths inDomain:(NSString *)domain;
 
+/**
+ *  Register a block to be called when preferences change at or below a specific path in a domain (`nil` for the whole
+ *  domain). The block is called with the changed paths, or with the observed path itself when one of its parents has
+ *  changed, on the main thread while `SRGPreferencesDidChangeNotification` is being sent. No block is called for changes
+ *  which do not concern the observed path.
+ *
+ *  @return An opaque observer to remove with `-removeObserver:`, or `nil` if the path or domain is invalid.
+ */
+- (nullable id<NSObject>)addObserverForPath:(nullable NSString *)path inDomain:(NSString *)domain usingBlock:(void (^)(NSSet<NSString *> *paths))block;
+
+/**
+ *  Remove an observer registered with `-addObserverForPath:inDomain:usingBlock:`.
+ */
+- (void)removeObserver:(id<NSObject>)observer;
+
 @end
 
 NS_ASSUME_NONNULL_END
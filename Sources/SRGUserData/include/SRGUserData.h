@@ -11,11 +11,13 @@
 #import "SRGHistoryEntry.h"
 #import "SRGPlaylist.h"
 #import "SRGPlaylists.h"
+#import "SRGPreferencePath.h"
 #import "SRGPreferences.h"
 #import "SRGUser.h"
 #import "SRGUserDataError.h"
 #import "SRGUserDataService.h"
 #import "SRGUserObject.h"
+#import "SRGUserObjectCursor.h"
 #import "SRGUserObjectService.h"
 
 NS_ASSUME_NONNULL_BEGIN
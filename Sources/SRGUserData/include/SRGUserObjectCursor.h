@@ -0,0 +1,30 @@
+//
+//  Copyright (c) SRG SSR. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Opaque position in a list of objects read page by page. A cursor is returned with each page having more objects
+ *  after it, and can be provided to read the next page.
+ *
+ *  Pages are delimited by the date and identifier of their last object, so that reading a page never requires reading
+ *  the pages before it. A cursor must only be used with the query which returned it.
+ *
+ *  @discussion Cursors are immutable and can be shared among threads.
+ */
+@interface SRGUserObjectCursor : NSObject <NSCopying>
+
+@end
+
+@interface SRGUserObjectCursor (Unavailable)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
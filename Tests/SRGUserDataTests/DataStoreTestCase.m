@@ -369,6 +369,526 @@
     [self waitForExpectationsWithTimeout:20. handler:nil];
 }
 
+- (void)testConcurrentBackgroundReadsWithPendingWrites
+{
+    SRGDataStore *dataStore = [self testDataStoreFromPackage:@"TestData_1"];
+    dataStore.maximumConcurrentBackgroundReadTaskCount = 4;
+    
+    __block BOOL writeFinished = NO;
+    
+    XCTestExpectation *writeExpectation = [self expectationWithDescription:@"Write finished"];
+    
+    [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        [NSThread sleepForTimeInterval:2.];
+        
+        Person *person = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass(Person.class) inManagedObjectContext:managedObjectContext];
+        person.name = @"Lisa";
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        writeFinished = YES;
+        [writeExpectation fulfill];
+    }];
+    
+    // Reads do not wait for the pending write and see the last committed state
+    for (NSInteger i = 0; i < 10; ++i) {
+        XCTestExpectation *readExpectation = [self expectationWithDescription:[NSString stringWithFormat:@"Read %@ finished", @(i)]];
+        
+        [dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+            return [managedObjectContext executeFetchRequest:[Person fetchRequest] error:NULL];
+        } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSArray<Person *> * _Nullable persons, NSError * _Nullable error) {
+            XCTAssertFalse(writeFinished);
+            XCTAssertEqual(persons.count, 1);
+            XCTAssertNil(error);
+            [readExpectation fulfill];
+        }];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Read finished"];
+    
+    [dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        return [managedObjectContext executeFetchRequest:[Person fetchRequest] error:NULL];
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSArray<Person *> * _Nullable persons, NSError * _Nullable error) {
+        XCTAssertEqual(persons.count, 2);
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testConcurrentBackgroundReadTaskCancellation
+{
+    SRGDataStore *dataStore = [self testDataStoreFromPackage:@"TestData_1"];
+    dataStore.maximumConcurrentBackgroundReadTaskCount = 4;
+    
+    for (NSInteger i = 0; i < 10; ++i) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Read %@ finished", @(i)]];
+        
+        NSString *readTask = [dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+            return [managedObjectContext executeFetchRequest:[Person fetchRequest] error:NULL].firstObject;
+        } withPriority:NSOperationQueuePriorityNormal completionBlock:^(id _Nullable result, NSError * _Nullable error) {
+            XCTAssertNil(result);
+            XCTAssertEqualObjects(error.domain, SRGUserDataErrorDomain);
+            XCTAssertEqual(error.code, SRGUserDataErrorCancelled);
+            [expectation fulfill];
+        }];
+        [dataStore cancelBackgroundTaskWithHandle:readTask];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)measureBackgroundReadLatencyUnderWriteLoadWithMaximumConcurrentReadTaskCount:(NSInteger)maximumConcurrentReadTaskCount
+{
+    SRGDataStore *dataStore = [self testDataStoreFromPackage:nil];
+    dataStore.maximumConcurrentBackgroundReadTaskCount = maximumConcurrentReadTaskCount;
+    
+    [self measureBlock:^{
+        // Sustained write load, similar to history pages saved during synchronization
+        for (NSInteger i = 0; i < 20; ++i) {
+            [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+                for (NSInteger j = 0; j < 500; ++j) {
+                    Person *person = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass(Person.class) inManagedObjectContext:managedObjectContext];
+                    person.name = [NSString stringWithFormat:@"%@-%@", @(i), @(j)];
+                }
+            } withPriority:NSOperationQueuePriorityNormal completionBlock:nil];
+        }
+        
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Read finished"];
+        
+        [dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+            NSFetchRequest *fetchRequest = [Person fetchRequest];
+            fetchRequest.fetchLimit = 20;
+            return [managedObjectContext executeFetchRequest:fetchRequest error:NULL];
+        } withPriority:NSOperationQueuePriorityNormal completionBlock:^(id _Nullable result, NSError * _Nullable error) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }];
+        
+        [self waitForExpectationsWithTimeout:60. handler:nil];
+    }];
+    
+    // Let pending writes finish before the store is discarded
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Writes finished"];
+    
+    [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {} withPriority:NSOperationQueuePriorityVeryLow completionBlock:^(NSError * _Nullable error) {
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:120. handler:nil];
+}
+
+- (void)testSerialBackgroundReadLatencyUnderWriteLoadPerformance
+{
+    [self measureBackgroundReadLatencyUnderWriteLoadWithMaximumConcurrentReadTaskCount:1];
+}
+
+- (void)testConcurrentBackgroundReadLatencyUnderWriteLoadPerformance
+{
+    [self measureBackgroundReadLatencyUnderWriteLoadWithMaximumConcurrentReadTaskCount:4];
+}
+
+- (void)testGroupCommitWrites
+{
+    SRGDataStore *dataStore = [self testDataStoreFromPackage:@"TestData_1"];
+    dataStore.groupCommitEnabled = YES;
+    
+    // Keep the worker busy so that subsequent writes are grouped
+    XCTestExpectation *blockingExpectation = [self expectationWithDescription:@"Blocking write finished"];
+    
+    [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        [NSThread sleepForTimeInterval:1.];
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [blockingExpectation fulfill];
+    }];
+    
+    __block NSInteger completionCount = 0;
+    
+    for (NSInteger i = 0; i < 10; ++i) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Write %@ finished", @(i)]];
+        
+        [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+            Person *person = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass(Person.class) inManagedObjectContext:managedObjectContext];
+            
+            // Persons require a name. The failing write must not affect other writes of the group
+            if (i != 5) {
+                person.name = [NSString stringWithFormat:@"Person %@", @(i)];
+            }
+        } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+            // Completion blocks are called in submission order
+            XCTAssertEqual(completionCount, i);
+            ++completionCount;
+            
+            if (i != 5) {
+                XCTAssertNil(error);
+            }
+            else {
+                XCTAssertNotNil(error);
+            }
+            [expectation fulfill];
+        }];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    NSArray<Person *> *persons = [dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        return [managedObjectContext executeFetchRequest:[Person fetchRequest] error:NULL];
+    }];
+    XCTAssertEqual(persons.count, 10);
+}
+
+- (void)testGroupCommitWriteTaskCancellation
+{
+    SRGDataStore *dataStore = [self testDataStoreFromPackage:@"TestData_1"];
+    dataStore.groupCommitEnabled = YES;
+    
+    XCTestExpectation *blockingExpectation = [self expectationWithDescription:@"Blocking write finished"];
+    
+    [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        [NSThread sleepForTimeInterval:1.];
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [blockingExpectation fulfill];
+    }];
+    
+    for (NSInteger i = 0; i < 10; ++i) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Write %@ finished", @(i)]];
+        
+        NSString *writeTask = [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+            Person *person = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass(Person.class) inManagedObjectContext:managedObjectContext];
+            person.name = [NSString stringWithFormat:@"Person %@", @(i)];
+        } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+            if (i % 2 == 0) {
+                XCTAssertEqualObjects(error.domain, SRGUserDataErrorDomain);
+                XCTAssertEqual(error.code, SRGUserDataErrorCancelled);
+            }
+            else {
+                XCTAssertNil(error);
+            }
+            [expectation fulfill];
+        }];
+        
+        if (i % 2 == 0) {
+            [dataStore cancelBackgroundTaskWithHandle:writeTask];
+        }
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    NSArray<Person *> *persons = [dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        return [managedObjectContext executeFetchRequest:[Person fetchRequest] error:NULL];
+    }];
+    XCTAssertEqual(persons.count, 6);
+}
+
+- (void)testGroupCommitWritesAfterPendingRead
+{
+    SRGDataStore *dataStore = [self testDataStoreFromPackage:@"TestData_1"];
+    dataStore.groupCommitEnabled = YES;
+    
+    XCTestExpectation *blockingExpectation = [self expectationWithDescription:@"Blocking write finished"];
+    
+    [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        [NSThread sleepForTimeInterval:1.];
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [blockingExpectation fulfill];
+    }];
+    
+    XCTestExpectation *writeExpectation1 = [self expectationWithDescription:@"Write 1 finished"];
+    
+    [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        Person *person = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass(Person.class) inManagedObjectContext:managedObjectContext];
+        person.name = @"Person 1";
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [writeExpectation1 fulfill];
+    }];
+    
+    XCTestExpectation *readExpectation = [self expectationWithDescription:@"Read finished"];
+    
+    // The read must not see changes of writes submitted after it, even if pending writes are grouped
+    [dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        return @([managedObjectContext countForFetchRequest:[Person fetchRequest] error:NULL]);
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSNumber * _Nullable count, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(count, @2);
+        [readExpectation fulfill];
+    }];
+    
+    XCTestExpectation *writeExpectation2 = [self expectationWithDescription:@"Write 2 finished"];
+    
+    [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        Person *person = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass(Person.class) inManagedObjectContext:managedObjectContext];
+        person.name = @"Person 2";
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [writeExpectation2 fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testGroupCommitWithBatchRequest
+{
+    SRGDataStore *dataStore = [self testDataStoreFromPackage:@"TestData_1"];
+    dataStore.groupCommitEnabled = YES;
+    
+    XCTestExpectation *blockingExpectation = [self expectationWithDescription:@"Blocking write finished"];
+    
+    [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        [NSThread sleepForTimeInterval:1.];
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [blockingExpectation fulfill];
+    }];
+    
+    for (NSInteger i = 0; i < 3; ++i) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Write %@ finished", @(i)]];
+        
+        [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+            // The batch deletion must apply to changes of previous writes of the group, but not to subsequent ones
+            if (i == 1) {
+                NSBatchDeleteRequest *batchDeleteRequest = [[NSBatchDeleteRequest alloc] initWithFetchRequest:[Person fetchRequest]];
+                NSError *error = nil;
+                XCTAssertNotNil([managedObjectContext executeRequest:batchDeleteRequest error:&error]);
+                XCTAssertNil(error);
+            }
+            
+            Person *person = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass(Person.class) inManagedObjectContext:managedObjectContext];
+            person.name = [NSString stringWithFormat:@"Person %@", @(i)];
+        } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    NSArray<NSString *> *names = [dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        NSArray<Person *> *persons = [managedObjectContext executeFetchRequest:[Person fetchRequest] error:NULL];
+        return [persons valueForKey:@"name"];
+    }];
+    XCTAssertEqualObjects([NSSet setWithArray:names], ([NSSet setWithObjects:@"Person 1", @"Person 2", nil]));
+}
+
+- (void)testGroupCommitSaveFailure
+{
+    SRGDataStore *dataStore = [self testDataStoreFromPackage:@"TestData_1"];
+    dataStore.groupCommitEnabled = YES;
+    
+    XCTestExpectation *blockingExpectation = [self expectationWithDescription:@"Blocking write finished"];
+    
+    [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        [NSThread sleepForTimeInterval:1.];
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [blockingExpectation fulfill];
+    }];
+    
+    NSCountedSet<NSNumber *> *executedTasks = [NSCountedSet set];
+    
+    for (NSInteger i = 0; i < 5; ++i) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Write %@ finished", @(i)]];
+        
+        [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+            @synchronized(executedTasks) {
+                [executedTasks addObject:@(i)];
+            }
+            
+            // The group save fails. Changes of other writes must be saved without their tasks being performed again.
+            Person *person = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass(Person.class) inManagedObjectContext:managedObjectContext];
+            person.name = (i != 2) ? [NSString stringWithFormat:@"Person %@", @(i)] : @"Rejected by store";
+        } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+            if (i != 2) {
+                XCTAssertNil(error);
+            }
+            else {
+                XCTAssertNotNil(error);
+            }
+            [expectation fulfill];
+        }];
+    }
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    @synchronized(executedTasks) {
+        XCTAssertEqual(executedTasks.count, 5);
+        for (NSNumber *executedTask in executedTasks) {
+            XCTAssertEqual([executedTasks countForObject:executedTask], 1);
+        }
+    }
+    
+    NSArray<NSString *> *names = [dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        NSArray<Person *> *persons = [managedObjectContext executeFetchRequest:[Person fetchRequest] error:NULL];
+        return [persons valueForKey:@"name"];
+    }];
+    XCTAssertEqualObjects([NSSet setWithArray:names], ([NSSet setWithObjects:@"Boris", @"Person 0", @"Person 1", @"Person 3", @"Person 4", nil]));
+}
+
+- (void)measureSmallWriteThroughputWithGroupCommitEnabled:(BOOL)groupCommitEnabled
+{
+    SRGDataStore *dataStore = [self testDataStoreFromPackage:nil];
+    dataStore.groupCommitEnabled = groupCommitEnabled;
+    
+    [self measureBlock:^{
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Writes finished"];
+        
+        // Many tiny writes, similar to playback position updates
+        static const NSInteger kWriteCount = 1000;
+        __block NSInteger completionCount = 0;
+        for (NSInteger i = 0; i < kWriteCount; ++i) {
+            [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+                Person *person = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass(Person.class) inManagedObjectContext:managedObjectContext];
+                person.name = @(i).stringValue;
+            } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+                XCTAssertNil(error);
+                if (++completionCount == kWriteCount) {
+                    [expectation fulfill];
+                }
+            }];
+        }
+        
+        [self waitForExpectationsWithTimeout:120. handler:nil];
+    }];
+}
+
+- (void)testSmallWriteThroughputPerformance
+{
+    [self measureSmallWriteThroughputWithGroupCommitEnabled:NO];
+}
+
+- (void)testGroupCommitSmallWriteThroughputPerformance
+{
+    [self measureSmallWriteThroughputWithGroupCommitEnabled:YES];
+}
+
+- (void)testPooledBackgroundContextReads
+{
+    SRGDataStore *dataStore = [self testDataStoreFromPackage:@"TestData_1"];
+    
+    // Counts only, so that read contexts are returned to the pool and reused
+    for (NSInteger i = 0; i < 3; ++i) {
+        XCTestExpectation *writeExpectation = [self expectationWithDescription:@"Write finished"];
+        
+        [dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+            Person *person = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass(Person.class) inManagedObjectContext:managedObjectContext];
+            person.name = [NSString stringWithFormat:@"Person %@", @(i)];
+        } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+            XCTAssertNil(error);
+            [writeExpectation fulfill];
+        }];
+        
+        [self waitForExpectationsWithTimeout:10. handler:nil];
+        
+        XCTestExpectation *readExpectation = [self expectationWithDescription:@"Read finished"];
+        
+        [dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+            return @([managedObjectContext countForFetchRequest:[Person fetchRequest] error:NULL]);
+        } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSNumber * _Nullable count, NSError * _Nullable error) {
+            XCTAssertEqualObjects(count, @(i + 2));
+            XCTAssertNil(error);
+            [readExpectation fulfill];
+        }];
+        
+        [self waitForExpectationsWithTimeout:10. handler:nil];
+    }
+    
+    // Managed objects returned from a read must remain valid after subsequent tasks have been executed
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Read finished"];
+    
+    __block Person *person = nil;
+    [dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        NSFetchRequest *fetchRequest = [Person fetchRequest];
+        fetchRequest.predicate = [NSPredicate predicateWithFormat:@"name == %@", @"Boris"];
+        return [managedObjectContext executeFetchRequest:fetchRequest error:NULL].firstObject;
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(Person * _Nullable result, NSError * _Nullable error) {
+        person = result;
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTestExpectation *otherExpectation = [self expectationWithDescription:@"Other read finished"];
+    
+    [dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        return @([managedObjectContext countForFetchRequest:[Person fetchRequest] error:NULL]);
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSNumber * _Nullable count, NSError * _Nullable error) {
+        [otherExpectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertFalse(person.fault);
+    XCTAssertEqualObjects(person.name, @"Boris");
+    
+    // Same for managed objects nested in collections
+    XCTestExpectation *nestedExpectation = [self expectationWithDescription:@"Nested read finished"];
+    
+    __block Person *nestedPerson = nil;
+    [dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        NSFetchRequest *fetchRequest = [Person fetchRequest];
+        fetchRequest.predicate = [NSPredicate predicateWithFormat:@"name == %@", @"Boris"];
+        return @{ @"Boris" : @[ [managedObjectContext executeFetchRequest:fetchRequest error:NULL].firstObject ] };
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSDictionary<NSString *, NSArray<Person *> *> * _Nullable result, NSError * _Nullable error) {
+        nestedPerson = result[@"Boris"].firstObject;
+        [nestedExpectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTestExpectation *nestedOtherExpectation = [self expectationWithDescription:@"Other read finished after nested read"];
+    
+    [dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        return @([managedObjectContext countForFetchRequest:[Person fetchRequest] error:NULL]);
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSNumber * _Nullable count, NSError * _Nullable error) {
+        [nestedOtherExpectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertFalse(nestedPerson.fault);
+    XCTAssertEqualObjects(nestedPerson.name, @"Boris");
+}
+
+- (void)measureTinyBackgroundReadsWithContextPoolSize:(NSUInteger)poolSize
+{
+    SRGDataStore *dataStore = [self testDataStoreFromPackage:@"TestData_1"];
+    dataStore.backgroundManagedObjectContextPoolSize = poolSize;
+    
+    [self measureBlock:^{
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Reads finished"];
+        
+        // Per-task overhead dominates for tiny reads
+        static const NSInteger kReadCount = 10000;
+        __block NSInteger completionCount = 0;
+        for (NSInteger i = 0; i < kReadCount; ++i) {
+            [dataStore performBackgroundReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+                return @([managedObjectContext countForFetchRequest:[Person fetchRequest] error:NULL]);
+            } withPriority:NSOperationQueuePriorityNormal completionBlock:^(id _Nullable result, NSError * _Nullable error) {
+                if (++completionCount == kReadCount) {
+                    [expectation fulfill];
+                }
+            }];
+        }
+        
+        [self waitForExpectationsWithTimeout:120. handler:nil];
+    }];
+}
+
+- (void)testTinyBackgroundReadsWithoutContextPoolPerformance
+{
+    [self measureTinyBackgroundReadsWithContextPoolSize:0];
+}
+
+- (void)testTinyBackgroundReadsWithContextPoolPerformance
+{
+    [self measureTinyBackgroundReadsWithContextPoolSize:4];
+}
+
 - (void)testParallelMainThreadReads
 {
     XCTestExpectation *expectation = [self expectationWithDescription:@"All operations finished"];
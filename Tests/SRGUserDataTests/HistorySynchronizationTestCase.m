@@ -6,10 +6,14 @@
 
 #import "UserDataBaseTestCase.h"
 
+#import "SRGHistory+Private.h"
 #import "SRGHistoryRequest.h"
+#import "SRGUser+Private.h"
+#import "SRGUserData+Private.h"
 #import "SRGUserObject+Private.h"
 
 @import libextobjc;
+@import OHHTTPStubs;
 
 @interface HistorySynchronizationTestCase : UserDataBaseTestCase
 
@@ -35,6 +39,57 @@
     [self logout];
 }
 
+#pragma mark Helpers
+
+- (void)markLocalHistoryEntriesAsDirtyWithCount:(NSInteger)count
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Local update"];
+    
+    // Bulk upsert, much faster than using the public API for large amounts of entries
+    [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        for (NSInteger i = 0; i < count; ++i) {
+            SRGHistoryEntry *historyEntry = [SRGHistoryEntry upsertWithUid:[NSString stringWithFormat:@"urn:rts:video:%@", @(i)] matchingPredicate:nil inManagedObjectContext:managedObjectContext];
+            historyEntry.deviceUid = @"User data UT";
+        }
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:300. handler:nil];
+}
+
+- (NSArray<NSString *> *)insertRemoteHistoryEntriesWithCount:(NSUInteger)count
+{
+    NSMutableArray<NSString *> *uids = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; ++i) {
+        [uids addObject:[NSString stringWithFormat:@"urn:rts:video:%@", @(i)]];
+    }
+    [self insertRemoteHistoryEntriesWithUids:uids];
+    return uids.copy;
+}
+
+// Pull remote changes made to all history entries with the specified prefetch depth, and measure how long the pull takes
+- (void)measurePullWithPrefetchDepth:(NSUInteger)prefetchDepth
+{
+    [self setupForLocalServiceWithLatency:0.1];
+    
+    NSArray<NSString *> *uids = [self insertRemoteHistoryEntriesWithCount:5000];
+    
+    [self loginAndWaitForInitialSynchronization];
+    
+    self.userData.history.pullPrefetchDepth = prefetchDepth;
+    
+    [self measureMetrics:self.class.defaultPerformanceMetrics automaticallyStartMeasuring:NO forBlock:^{
+        // Updating all entries remotely ensures they are all pulled again, in 10 pages
+        [self insertRemoteHistoryEntriesWithUids:uids];
+        
+        [self startMeasuring];
+        [self synchronizeAndWait];
+        [self stopMeasuring];
+    }];
+}
+
 #pragma mark Tests
 
 - (void)testInitialSynchronizationWithoutRemoteEntries
@@ -511,4 +566,136 @@
     [self waitForExpectationsWithTimeout:10. handler:nil];
 }
 
+- (void)testChunkedPush
+{
+    [self setupForAvailableService];
+    [self loginAndWaitForInitialSynchronization];
+    
+    self.userData.history.pushChunkSize = 2;
+    [self insertLocalHistoryEntriesWithUids:@[ @"a", @"b", @"c", @"d", @"e" ]];
+    
+    [self synchronizeAndWait];
+    
+    [self assertLocalHistoryUids:@[ @"a", @"b", @"c", @"d", @"e" ]];
+    [self assertRemoteHistoryUids:@[ @"a", @"b", @"c", @"d", @"e" ]];
+    
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == YES", @keypath(SRGHistoryEntry.new, dirty)];
+    NSArray<SRGHistoryEntry *> *dirtyHistoryEntries = [self.userData.history historyEntriesMatchingPredicate:predicate sortedWithDescriptors:nil];
+    XCTAssertEqual(dirtyHistoryEntries.count, 0);
+}
+
+- (void)testPushWithBufferedPlaybackPosition
+{
+    [self setupForLocalServiceWithLatency:0.];
+    [self loginAndWaitForInitialSynchronization];
+    
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"History entry saved"];
+    
+    [self.userData.history saveHistoryEntryWithUid:@"a" lastPlaybackTime:kCMTimeZero deviceUid:@"device1" completionBlock:^(NSError * _Nonnull error) {
+        XCTAssertNil(error);
+        [expectation1 fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // Buffered, thus not saved yet
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"History entry saved"];
+    
+    [self.userData.history saveHistoryEntryWithUid:@"a" lastPlaybackTime:CMTimeMakeWithSeconds(10, NSEC_PER_SEC) deviceUid:@"device2" completionBlock:^(NSError * _Nonnull error) {
+        XCTAssertNil(error);
+        [expectation2 fulfill];
+    }];
+    
+    // A history read returning no entry leaves its context (where the buffered update was visible) to be reused
+    XCTestExpectation *expectation3 = [self expectationWithDescription:@"History entry read"];
+    
+    [self.userData.history historyEntryWithUid:@"b" completionBlock:^(SRGHistoryEntry * _Nullable historyEntry, NSError * _Nullable error) {
+        XCTAssertNil(historyEntry);
+        [expectation3 fulfill];
+    }];
+    
+    [self waitForExpectations:@[ expectation3 ] timeout:10.];
+    
+    [self resetLocalServiceRequests];
+    
+    XCTestExpectation *expectation4 = [self expectationWithDescription:@"Synchronization finished"];
+    
+    [self.userData.history synchronizeSavedHistoryEntriesWithCompletionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation4 fulfill];
+    }];
+    
+    [self waitForExpectations:@[ expectation4 ] timeout:10.];
+    
+    // Only the saved values must have been pushed
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"HTTPMethod == %@", @"POST"];
+    NSArray<NSURLRequest *> *pushRequests = [[self localServiceRequestsToServiceURL:TestHistoryServiceURL()] filteredArrayUsingPredicate:predicate];
+    XCTAssertEqual(pushRequests.count, 1);
+    
+    NSDictionary *JSONDictionary = [NSJSONSerialization JSONObjectWithData:pushRequests.firstObject.ohhttpStubs_httpBody options:0 error:NULL];
+    NSArray<NSDictionary *> *historyEntryDictionaries = JSONDictionary[@"data"];
+    XCTAssertEqual(historyEntryDictionaries.count, 1);
+    XCTAssertEqualObjects(historyEntryDictionaries.firstObject[@"item_id"], @"a");
+    XCTAssertEqualObjects(historyEntryDictionaries.firstObject[@"device_id"], @"device1");
+    XCTAssertEqualObjects(historyEntryDictionaries.firstObject[@"last_playback_position"], @0);
+    
+    // The buffered update is still written afterwards, and pushed with the next synchronization
+    [self.userData.history flushPlaybackPositionsWithCompletionBlock:nil];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    SRGHistoryEntry *historyEntry = [self.userData.history historyEntryWithUid:@"a"];
+    XCTAssertEqual(historyEntry.lastPlaybackPosition, 10.);
+    XCTAssertTrue(historyEntry.dirty);
+}
+
+- (void)testChunkedPushPerformance
+{
+    if (@available(iOS 13, tvOS 13, *)) {
+        [self setupForAvailableService];
+        [self loginAndWaitForInitialSynchronization];
+        
+        XCTMeasureOptions *options = [XCTMeasureOptions defaultOptions];
+        options.invocationOptions = XCTMeasurementInvocationManuallyStart;
+        
+        NSArray<id<XCTMetric>> *metrics = @[ [[XCTClockMetric alloc] init], [[XCTMemoryMetric alloc] init] ];
+        [self measureWithMetrics:metrics options:options block:^{
+            [self markLocalHistoryEntriesAsDirtyWithCount:5000];
+            
+            [self startMeasuring];
+            [self synchronizeAndWait];
+            [self stopMeasuring];
+        }];
+    }
+}
+
+- (void)testPipelinedPull
+{
+    [self setupForLocalServiceWithLatency:0.01];
+    
+    NSArray<NSString *> *uids = [self insertRemoteHistoryEntriesWithCount:2500];
+    
+    self.userData.history.pullPrefetchDepth = 3;
+    [self resetLocalServiceRequests];
+    
+    [self loginAndWaitForInitialSynchronization];
+    
+    // All pages must have been received and saved before the synchronization completes
+    [self assertLocalHistoryUids:uids];
+    XCTAssertNotNil(self.userData.user.historySynchronizationDate);
+    
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"HTTPMethod == %@", @"GET"];
+    NSArray<NSURLRequest *> *pullRequests = [[self localServiceRequestsToServiceURL:TestHistoryServiceURL()] filteredArrayUsingPredicate:predicate];
+    XCTAssertEqual(pullRequests.count, 5);
+}
+
+- (void)testSequentialPullPerformance
+{
+    [self measurePullWithPrefetchDepth:1];
+}
+
+- (void)testPipelinedPullPerformance
+{
+    [self measurePullWithPrefetchDepth:2];
+}
+
 @end
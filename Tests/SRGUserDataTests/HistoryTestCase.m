@@ -6,6 +6,8 @@
 
 #import "UserDataBaseTestCase.h"
 
+#import "SRGHistory+Private.h"
+#import "SRGUserData+Private.h"
 #import "SRGUserObject+Private.h"
 
 @import libextobjc;
@@ -25,6 +27,29 @@
     [self setupForOfflineOnly];
 }
 
+#pragma mark Helpers
+
+- (void)insertLocalHistoryEntriesWithCount:(NSInteger)count
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Local insertion"];
+    
+    // Bulk insertion, much faster than using the public API for large amounts of entries
+    [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        NSDate *date = NSDate.date;
+        for (NSInteger i = 0; i < count; ++i) {
+            SRGHistoryEntry *historyEntry = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass(SRGHistoryEntry.class) inManagedObjectContext:managedObjectContext];
+            [historyEntry setValue:[NSString stringWithFormat:@"urn:rts:video:%@", @(i)] forKey:@keypath(SRGHistoryEntry.new, uid)];
+            [historyEntry setValue:[date dateByAddingTimeInterval:i] forKey:@keypath(SRGHistoryEntry.new, date)];
+            historyEntry.dirty = (i % 100 == 0);
+        }
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:300. handler:nil];
+}
+
 #pragma mark Tests
 
 - (void)testEmptyInitialization
@@ -59,6 +84,38 @@
     XCTAssertEqualObjects(historyEntry.deviceUid, @"device");
 }
 
+- (void)testSaveHistoryEntriesNotificationCoalescing
+{
+    __block BOOL notificationReceived = NO;
+    
+    [self expectationForSingleNotification:SRGHistoryEntriesDidChangeNotification object:self.userData.history handler:^BOOL(NSNotification * _Nonnull notification) {
+        XCTAssertTrue(NSThread.isMainThread);
+        XCTAssertEqualObjects(notification.userInfo[SRGHistoryEntriesUidsKey], ([NSSet setWithObjects:@"a", @"b", @"c", @"d", @"e", nil]));
+        notificationReceived = YES;
+        return YES;
+    }];
+    
+    NSArray<NSString *> *uids = @[ @"a", @"b", @"c", @"d", @"e" ];
+    for (NSString *uid in uids) {
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"History entry %@ saved", uid]];
+        
+        [self.userData.history saveHistoryEntryWithUid:uid lastPlaybackTime:CMTimeMakeWithSeconds(10., NSEC_PER_SEC) deviceUid:@"device" completionBlock:^(NSError * _Nonnull error) {
+            XCTAssertFalse(NSThread.isMainThread);
+            XCTAssertNil(error);
+            
+            // Completion blocks are called after the corresponding notification has been received
+            XCTAssertTrue(notificationReceived);
+            [expectation fulfill];
+        }];
+    }
+    
+    // Keep the main thread busy while writes are performed. Writes must not wait for the main thread, and all changes
+    // are delivered at once when it becomes available.
+    [NSThread sleepForTimeInterval:2.];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+}
+
 - (void)testHistoryEntryWithUid
 {
     XCTestExpectation *expectation1 = [self expectationWithDescription:@"History entry saved"];
@@ -109,6 +166,33 @@
     [self waitForExpectationsWithTimeout:30. handler:nil];
 }
 
+- (void)testHistoryEntriesWithUids
+{
+    [self insertLocalHistoryEntriesWithUids:@[ @"a", @"b", @"c" ]];
+    [self discardLocalHistoryEntriesWithUids:@[ @"c" ]];
+    
+    // Synchronous
+    NSDictionary<NSString *, SRGHistoryEntry *> *historyEntries = [self.userData.history historyEntriesWithUids:@[ @"a", @"b", @"c", @"d" ]];
+    XCTAssertEqualObjects([NSSet setWithArray:historyEntries.allKeys], ([NSSet setWithObjects:@"a", @"b", nil]));
+    XCTAssertEqualObjects(historyEntries[@"a"].uid, @"a");
+    XCTAssertEqualObjects(historyEntries[@"b"].uid, @"b");
+    
+    XCTAssertEqualObjects([self.userData.history historyEntriesWithUids:@[]], @{});
+    
+    // Asynchronous
+    XCTestExpectation *expectation = [self expectationWithDescription:@"History entries fetched"];
+    
+    [self.userData.history historyEntriesWithUids:@[ @"a", @"d" ] completionBlock:^(NSDictionary<NSString *, SRGHistoryEntry *> * _Nullable historyEntries, NSError * _Nullable error) {
+        XCTAssertFalse(NSThread.isMainThread);
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(historyEntries.allKeys, @[ @"a" ]);
+        XCTAssertEqualObjects(historyEntries[@"a"].uid, @"a");
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+}
+
 - (void)testHistoryEntries
 {
     [self insertLocalHistoryEntriesWithUids:@[ @"a", @"b", @"c", @"d", @"e" ]];
@@ -133,6 +217,91 @@
     [self waitForExpectationsWithTimeout:30. handler:nil];
 }
 
+- (void)testPagedHistoryEntries
+{
+    [self insertLocalHistoryEntriesWithUids:@[ @"a", @"b", @"c", @"d", @"e" ]];
+    
+    NSSortDescriptor *sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@keypath(SRGHistoryEntry.new, date) ascending:NO];
+    NSArray<SRGHistoryEntry *> *historyEntries = [self.userData.history historyEntriesMatchingPredicate:nil sortedWithDescriptors:@[sortDescriptor]];
+    NSArray<NSString *> *expectedUids = [historyEntries valueForKeyPath:@keypath(SRGHistoryEntry.new, uid)];
+    
+    // Synchronous
+    SRGUserObjectCursor *cursor1 = nil;
+    NSArray<SRGHistoryEntry *> *historyEntries1 = [self.userData.history historyEntriesMatchingPredicate:nil limit:2 afterCursor:nil nextCursor:&cursor1];
+    XCTAssertEqualObjects([historyEntries1 valueForKeyPath:@keypath(SRGHistoryEntry.new, uid)], [expectedUids subarrayWithRange:NSMakeRange(0, 2)]);
+    XCTAssertNotNil(cursor1);
+    
+    SRGUserObjectCursor *cursor2 = nil;
+    NSArray<SRGHistoryEntry *> *historyEntries2 = [self.userData.history historyEntriesMatchingPredicate:nil limit:2 afterCursor:cursor1 nextCursor:&cursor2];
+    XCTAssertEqualObjects([historyEntries2 valueForKeyPath:@keypath(SRGHistoryEntry.new, uid)], [expectedUids subarrayWithRange:NSMakeRange(2, 2)]);
+    XCTAssertNotNil(cursor2);
+    
+    SRGUserObjectCursor *cursor3 = nil;
+    NSArray<SRGHistoryEntry *> *historyEntries3 = [self.userData.history historyEntriesMatchingPredicate:nil limit:2 afterCursor:cursor2 nextCursor:&cursor3];
+    XCTAssertEqualObjects([historyEntries3 valueForKeyPath:@keypath(SRGHistoryEntry.new, uid)], [expectedUids subarrayWithRange:NSMakeRange(4, 1)]);
+    XCTAssertNil(cursor3);
+    
+    // Asynchronous
+    XCTestExpectation *expectation = [self expectationWithDescription:@"History entries fetched"];
+    
+    [self.userData.history historyEntriesMatchingPredicate:nil limit:3 afterCursor:cursor1 completionBlock:^(NSArray<SRGHistoryEntry *> * _Nullable historyEntries, SRGUserObjectCursor * _Nullable nextCursor, NSError * _Nullable error) {
+        XCTAssertFalse(NSThread.isMainThread);
+        XCTAssertNil(error);
+        XCTAssertEqualObjects([historyEntries valueForKeyPath:@keypath(SRGHistoryEntry.new, uid)], [expectedUids subarrayWithRange:NSMakeRange(2, 3)]);
+        XCTAssertNil(nextCursor);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+}
+
+- (void)testHistoryEntryCountAndTotalLastPlaybackPosition
+{
+    NSArray<NSString *> *uids = @[ @"a", @"b", @"c" ];
+    for (NSUInteger i = 0; i < uids.count; ++i) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"History entry saved"];
+        
+        [self.userData.history saveHistoryEntryWithUid:uids[i] lastPlaybackTime:CMTimeMakeWithSeconds(10. * (i + 1), NSEC_PER_SEC) deviceUid:@"device" completionBlock:^(NSError * _Nonnull error) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }];
+    }
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    [self discardLocalHistoryEntriesWithUids:@[ @"c" ]];
+    
+    // Synchronous
+    XCTAssertEqual([self.userData.history historyEntryCountMatchingPredicate:nil], 2);
+    
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K > 15.", @keypath(SRGHistoryEntry.new, lastPlaybackPosition)];
+    XCTAssertEqual([self.userData.history historyEntryCountMatchingPredicate:predicate], 1);
+    
+    XCTAssertEqualWithAccuracy([self.userData.history totalLastPlaybackPositionOfHistoryEntriesMatchingPredicate:nil], 30., 0.001);
+    XCTAssertEqualWithAccuracy([self.userData.history totalLastPlaybackPositionOfHistoryEntriesMatchingPredicate:predicate], 20., 0.001);
+    
+    // Asynchronous
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"History entries counted"];
+    
+    [self.userData.history historyEntryCountMatchingPredicate:nil completionBlock:^(NSUInteger count, NSError * _Nullable error) {
+        XCTAssertFalse(NSThread.isMainThread);
+        XCTAssertNil(error);
+        XCTAssertEqual(count, 2);
+        [expectation1 fulfill];
+    }];
+    
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"History entries summed"];
+    
+    [self.userData.history totalLastPlaybackPositionOfHistoryEntriesMatchingPredicate:nil completionBlock:^(double totalLastPlaybackPosition, NSError * _Nullable error) {
+        XCTAssertFalse(NSThread.isMainThread);
+        XCTAssertNil(error);
+        XCTAssertEqualWithAccuracy(totalLastPlaybackPosition, 30., 0.001);
+        [expectation2 fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+}
+
 - (void)testHistoryEntriesMatchingPredicate
 {
     [self insertLocalHistoryEntriesWithUids:@[@"a", @"b", @"c", @"d", @"e"]];
@@ -254,4 +423,220 @@
     XCTAssertEqualObjects(uids, @[]);
 }
 
+- (void)testHistoryEntryLookupPerformance
+{
+    [self insertLocalHistoryEntriesWithCount:50000];
+    
+    [self measureBlock:^{
+        for (NSInteger i = 0; i < 1000; ++i) {
+            NSString *uid = [NSString stringWithFormat:@"urn:rts:video:%@", @(i * 50)];
+            SRGHistoryEntry *historyEntry = [self.userData.history historyEntryWithUid:uid];
+            XCTAssertNotNil(historyEntry);
+        }
+    }];
+}
+
+- (void)testBulkHistoryEntryLookupPerformance
+{
+    [self insertLocalHistoryEntriesWithCount:50000];
+    
+    NSMutableArray<NSString *> *uids = [NSMutableArray array];
+    for (NSInteger i = 0; i < 1000; ++i) {
+        [uids addObject:[NSString stringWithFormat:@"urn:rts:video:%@", @(i * 50)]];
+    }
+    
+    [self measureBlock:^{
+        NSDictionary<NSString *, SRGHistoryEntry *> *historyEntries = [self.userData.history historyEntriesWithUids:uids];
+        XCTAssertEqual(historyEntries.count, 1000);
+    }];
+}
+
+- (void)testPagedHistoryEntriesPerformance
+{
+    [self insertLocalHistoryEntriesWithCount:50000];
+    
+    [self measureBlock:^{
+        NSArray<SRGHistoryEntry *> *historyEntries = [self.userData.history historyEntriesMatchingPredicate:nil limit:20 afterCursor:nil nextCursor:NULL];
+        XCTAssertEqual(historyEntries.count, 20);
+        for (SRGHistoryEntry *historyEntry in historyEntries) {
+            XCTAssertNotNil(historyEntry.uid);
+        }
+    }];
+}
+
+- (void)testHistoryEntryCountPerformance
+{
+    [self insertLocalHistoryEntriesWithCount:50000];
+    
+    [self measureBlock:^{
+        XCTAssertEqual([self.userData.history historyEntryCountMatchingPredicate:nil], 50000);
+    }];
+}
+
+- (void)testDirtyHistoryEntriesScanPerformance
+{
+    [self insertLocalHistoryEntriesWithCount:50000];
+    
+    [self measureBlock:^{
+        NSArray<SRGHistoryEntry *> *historyEntries = [self.userData.dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+            NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == YES", @keypath(SRGHistoryEntry.new, dirty)];
+            return [SRGHistoryEntry objectsMatchingPredicate:predicate sortedWithDescriptors:nil inManagedObjectContext:managedObjectContext];
+        }];
+        XCTAssertEqual(historyEntries.count, 500);
+    }];
+}
+
+- (void)testBufferedPlaybackPositionUpdates
+{
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"History entry saved"];
+    
+    [self.userData.history saveHistoryEntryWithUid:@"a" lastPlaybackTime:kCMTimeZero deviceUid:@"device" completionBlock:^(NSError * _Nonnull error) {
+        XCTAssertNil(error);
+        [expectation1 fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    // Subsequent updates are buffered, but immediately visible
+    [self expectationForSingleNotification:SRGHistoryEntriesDidChangeNotification object:self.userData.history handler:^BOOL(NSNotification * _Nonnull notification) {
+        XCTAssertEqualObjects(notification.userInfo[SRGHistoryEntriesUidsKey], [NSSet setWithObject:@"a"]);
+        return YES;
+    }];
+    
+    for (NSInteger i = 1; i <= 10; ++i) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"History entry saved"];
+        [self.userData.history saveHistoryEntryWithUid:@"a" lastPlaybackTime:CMTimeMakeWithSeconds(i, NSEC_PER_SEC) deviceUid:@"device" completionBlock:^(NSError * _Nonnull error) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }];
+    }
+    
+    XCTAssertTrue(CMTIME_COMPARE_INLINE([self.userData.history historyEntryWithUid:@"a"].lastPlaybackTime, ==, CMTimeMakeWithSeconds(10, NSEC_PER_SEC)));
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    self.userData.history.playbackPositionFlushInterval = 0.;
+    XCTAssertTrue(CMTIME_COMPARE_INLINE([self.userData.history historyEntryWithUid:@"a"].lastPlaybackTime, ==, CMTimeMakeWithSeconds(10, NSEC_PER_SEC)));
+}
+
+- (void)testBufferedPlaybackPositionOverlay
+{
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"History entry saved"];
+    
+    [self.userData.history saveHistoryEntryWithUid:@"a" lastPlaybackTime:kCMTimeZero deviceUid:@"device1" completionBlock:^(NSError * _Nonnull error) {
+        [expectation1 fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"History entry saved"];
+    
+    [self.userData.history saveHistoryEntryWithUid:@"a" lastPlaybackTime:CMTimeMakeWithSeconds(10, NSEC_PER_SEC) deviceUid:@"device2" completionBlock:^(NSError * _Nonnull error) {
+        XCTAssertNil(error);
+        [expectation2 fulfill];
+    }];
+    
+    // The buffered update is reflected without any change being made to the shared main thread context
+    SRGHistoryEntry *historyEntry = [self.userData.history historyEntryWithUid:@"a"];
+    XCTAssertEqual(historyEntry.lastPlaybackPosition, 10.);
+    XCTAssertEqualObjects(historyEntry.deviceUid, @"device2");
+    XCTAssertFalse(historyEntry.hasChanges);
+    XCTAssertFalse(historyEntry.managedObjectContext.hasChanges);
+    XCTAssertEqualObjects([historyEntry committedValuesForKeys:@[ @keypath(SRGHistoryEntry.new, lastPlaybackPosition) ]][@keypath(SRGHistoryEntry.new, lastPlaybackPosition)], @0);
+    
+    [self.userData.history flushPlaybackPositionsWithCompletionBlock:nil];
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    // Saved values are now read from the store
+    XCTAssertEqualObjects([historyEntry committedValuesForKeys:@[ @keypath(SRGHistoryEntry.new, lastPlaybackPosition) ]][@keypath(SRGHistoryEntry.new, lastPlaybackPosition)], @10);
+    XCTAssertEqual(historyEntry.lastPlaybackPosition, 10.);
+    XCTAssertEqualObjects(historyEntry.deviceUid, @"device2");
+}
+
+- (void)testBufferedPlaybackPositionUpdatesBeforeDiscard
+{
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"History entry saved"];
+    
+    [self.userData.history saveHistoryEntryWithUid:@"a" lastPlaybackTime:kCMTimeZero deviceUid:@"device" completionBlock:^(NSError * _Nonnull error) {
+        [expectation1 fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"History entry saved"];
+    XCTestExpectation *expectation3 = [self expectationWithDescription:@"History entry discarded"];
+    
+    [self.userData.history saveHistoryEntryWithUid:@"a" lastPlaybackTime:CMTimeMakeWithSeconds(10, NSEC_PER_SEC) deviceUid:@"device" completionBlock:^(NSError * _Nonnull error) {
+        [expectation2 fulfill];
+    }];
+    [self.userData.history discardHistoryEntriesWithUids:@[ @"a" ] completionBlock:^(NSError * _Nonnull error) {
+        XCTAssertNil(error);
+        [expectation3 fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    XCTAssertNil([self.userData.history historyEntryWithUid:@"a"]);
+}
+
+- (void)testBufferedPlaybackPositionUpdateCancellation
+{
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"History entry saved"];
+    
+    [self.userData.history saveHistoryEntryWithUid:@"a" lastPlaybackTime:kCMTimeZero deviceUid:@"device" completionBlock:^(NSError * _Nonnull error) {
+        [expectation1 fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"History entry save cancelled"];
+    
+    NSString *handle = [self.userData.history saveHistoryEntryWithUid:@"a" lastPlaybackTime:CMTimeMakeWithSeconds(10, NSEC_PER_SEC) deviceUid:@"device" completionBlock:^(NSError * _Nonnull error) {
+        XCTAssertEqualObjects(error.domain, SRGUserDataErrorDomain);
+        XCTAssertEqual(error.code, SRGUserDataErrorCancelled);
+        [expectation2 fulfill];
+    }];
+    [self.userData.history cancelTaskWithHandle:handle];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    XCTestExpectation *expectation3 = [self expectationWithDescription:@"Flushed"];
+    
+    [self.userData.history flushPlaybackPositionsWithCompletionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation3 fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    XCTAssertTrue(CMTIME_COMPARE_INLINE([self.userData.history historyEntryWithUid:@"a"].lastPlaybackTime, ==, kCMTimeZero));
+}
+
+- (void)measurePlaybackPositionUpdatesWithFlushInterval:(NSTimeInterval)flushInterval
+{
+    self.userData.history.playbackPositionFlushInterval = flushInterval;
+    
+    [self measureBlock:^{
+        for (NSInteger i = 0; i < 500; ++i) {
+            XCTestExpectation *expectation = [self expectationWithDescription:@"History entry saved"];
+            [self.userData.history saveHistoryEntryWithUid:[NSString stringWithFormat:@"%@", @(i % 5)] lastPlaybackTime:CMTimeMakeWithSeconds(i, NSEC_PER_SEC) deviceUid:@"device" completionBlock:^(NSError * _Nonnull error) {
+                [expectation fulfill];
+            }];
+        }
+        
+        [self.userData.history flushPlaybackPositionsWithCompletionBlock:nil];
+        [self waitForExpectationsWithTimeout:60. handler:nil];
+    }];
+}
+
+- (void)testPlaybackPositionUpdatesPerformance
+{
+    [self measurePlaybackPositionUpdatesWithFlushInterval:0.];
+}
+
+- (void)testBufferedPlaybackPositionUpdatesPerformance
+{
+    [self measurePlaybackPositionUpdatesWithFlushInterval:1.];
+}
+
 @end
@@ -7,7 +7,9 @@
 #import "UserDataBaseTestCase.h"
 
 // Private framework headers 
+#import "NSBundle+SRGUserData.h"
 #import "SRGUser+Private.h"
+#import "SRGUserData+Private.h"
 #import "SRGUserObject+Private.h"
 
 @import libextobjc;
@@ -27,6 +29,108 @@
     return @"dummy_token";
 }
 
+#pragma mark Helpers
+
+// No application release shipped model versions v7 and v8, and no store was therefore recorded with them. Stores are
+// generated from the versioned models instead, with the same history entries as recorded stores (by uid only) and
+// a playlist with dated entries.
+- (NSURL *)URLForStoreWithModelVersion:(NSUInteger)version
+{
+    NSString *modelName = [NSString stringWithFormat:@"SRGUserData_v%@", @(version)];
+    NSString *modelFilePath = [NSBundle.srg_userDataBundle pathForResource:modelName ofType:@"mom" inDirectory:@"SRGUserData.momd"];
+    XCTAssertNotNil(modelFilePath);
+    
+    NSManagedObjectModel *model = [[NSManagedObjectModel alloc] initWithContentsOfURL:[NSURL fileURLWithPath:modelFilePath]];
+    NSURL *fileURL = [self URLForStoreFromPackage:nil];
+    
+    NSPersistentStoreCoordinator *persistentStoreCoordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:model];
+    NSError *storeError = nil;
+    NSPersistentStore *persistentStore = [persistentStoreCoordinator addPersistentStoreWithType:NSSQLiteStoreType configuration:nil URL:fileURL options:nil error:&storeError];
+    XCTAssertNil(storeError);
+    
+    NSManagedObjectContext *managedObjectContext = [[NSManagedObjectContext alloc] initWithConcurrencyType:NSPrivateQueueConcurrencyType];
+    managedObjectContext.persistentStoreCoordinator = persistentStoreCoordinator;
+    [managedObjectContext performBlockAndWait:^{
+        NSManagedObject *user = [NSEntityDescription insertNewObjectForEntityForName:@"SRGUser" inManagedObjectContext:managedObjectContext];
+        [user setValue:@"1234" forKey:@"accountUid"];
+        [user setValue:[NSDate dateWithTimeIntervalSince1970:1000.] forKey:@"synchronizationDate"];
+        [user setValue:[NSDate dateWithTimeIntervalSince1970:1000.] forKey:@"historySynchronizationDate"];
+        [user setValue:[NSDate dateWithTimeIntervalSince1970:1000.] forKey:@"playlistsSynchronizationDate"];
+        
+        for (NSUInteger i = 0; i < 103; ++i) {
+            NSManagedObject *historyEntry = [NSEntityDescription insertNewObjectForEntityForName:@"SRGHistoryEntry" inManagedObjectContext:managedObjectContext];
+            [historyEntry setValue:(i == 0) ? @"urn:rts:video:10085364" : [NSString stringWithFormat:@"urn:rts:video:%@", @(i)] forKey:@"uid"];
+            [historyEntry setValue:[NSDate dateWithTimeIntervalSince1970:i] forKey:@"date"];
+            [historyEntry setValue:@12. forKey:@"lastPlaybackPosition"];
+            [historyEntry setValue:@"Migration UT" forKey:@"deviceUid"];
+            [historyEntry setValue:@NO forKey:@"discarded"];
+            [historyEntry setValue:@NO forKey:@"dirty"];
+        }
+        
+        NSManagedObject *playlist = [NSEntityDescription insertNewObjectForEntityForName:@"SRGPlaylist" inManagedObjectContext:managedObjectContext];
+        [playlist setValue:@"migration_playlist" forKey:@"uid"];
+        [playlist setValue:@"Migration" forKey:@"name"];
+        [playlist setValue:@(SRGPlaylistTypeStandard) forKey:@"type"];
+        [playlist setValue:[NSDate dateWithTimeIntervalSince1970:2000.] forKey:@"date"];
+        [playlist setValue:@NO forKey:@"discarded"];
+        [playlist setValue:@NO forKey:@"dirty"];
+        
+        // Entries are inserted in the ordered relationship in reverse date order, so that migrated entries can only
+        // be returned in date order if their dates have been preserved.
+        NSMutableOrderedSet *entries = [playlist mutableOrderedSetValueForKey:@"entries"];
+        for (NSUInteger i = 5; i > 0; --i) {
+            NSManagedObject *playlistEntry = [NSEntityDescription insertNewObjectForEntityForName:@"SRGPlaylistEntry" inManagedObjectContext:managedObjectContext];
+            [playlistEntry setValue:[NSString stringWithFormat:@"urn:rts:video:entry%@", @(i)] forKey:@"uid"];
+            [playlistEntry setValue:[NSDate dateWithTimeIntervalSince1970:2000. + i] forKey:@"date"];
+            [playlistEntry setValue:@(i == 3) forKey:@"discarded"];
+            [playlistEntry setValue:@(i == 3) forKey:@"dirty"];
+            [entries addObject:playlistEntry];
+        }
+        
+        NSError *saveError = nil;
+        XCTAssertTrue([managedObjectContext save:&saveError]);
+        XCTAssertNil(saveError);
+    }];
+    
+    // Close the store so that it can be opened (and migrated) by `SRGUserData`
+    XCTAssertTrue([persistentStoreCoordinator removePersistentStore:persistentStore error:NULL]);
+    
+    return fileURL;
+}
+
+- (void)assertMigratedPlaylistsInUserData:(SRGUserData *)userData
+{
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == NO", @keypath(SRGPlaylistEntry.new, discarded)];
+    NSSortDescriptor *sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@keypath(SRGPlaylistEntry.new, date) ascending:YES];
+    NSArray<SRGPlaylistEntry *> *playlistEntries = [userData.playlists playlistEntriesInPlaylistWithUid:@"migration_playlist"
+                                                                                      matchingPredicate:predicate
+                                                                                  sortedWithDescriptors:@[sortDescriptor]];
+    NSArray<NSString *> *expectedUids = @[ @"urn:rts:video:entry1", @"urn:rts:video:entry2", @"urn:rts:video:entry4", @"urn:rts:video:entry5" ];
+    XCTAssertEqualObjects([playlistEntries valueForKeyPath:@keypath(SRGPlaylistEntry.new, uid)], expectedUids);
+    XCTAssertEqualObjects(playlistEntries.firstObject.date, [NSDate dateWithTimeIntervalSince1970:2001.]);
+    XCTAssertEqualObjects(playlistEntries.lastObject.date, [NSDate dateWithTimeIntervalSince1970:2005.]);
+    
+    // Without sort descriptors, entries are still returned in playlist (date) order
+    NSArray<SRGPlaylistEntry *> *defaultPlaylistEntries = [userData.playlists playlistEntriesInPlaylistWithUid:@"migration_playlist" matchingPredicate:nil sortedWithDescriptors:nil];
+    XCTAssertEqualObjects([defaultPlaylistEntries valueForKeyPath:@keypath(SRGPlaylistEntry.new, uid)], expectedUids);
+    
+    SRGPlaylistEntry *discardedPlaylistEntry = [userData.dataStore performMainThreadReadTask:^id _Nullable(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        return [SRGPlaylistEntry objectWithUid:@"urn:rts:video:entry3" matchingPredicate:nil inManagedObjectContext:managedObjectContext];
+    }];
+    XCTAssertTrue(discardedPlaylistEntry.discarded);
+    XCTAssertEqualObjects(discardedPlaylistEntry.playlist.uid, @"migration_playlist");
+    XCTAssertEqualObjects(discardedPlaylistEntry.date, [NSDate dateWithTimeIntervalSince1970:2003.]);
+    
+    // The store has been migrated to the current model, which declares the index used by playlist entry reads
+    NSPersistentContainer *persistentContainer = userData.dataStore.persistentContainer;
+    NSPersistentStore *persistentStore = persistentContainer.persistentStoreCoordinator.persistentStores.firstObject;
+    NSDictionary<NSString *, id> *metadata = [persistentContainer.persistentStoreCoordinator metadataForPersistentStore:persistentStore];
+    XCTAssertTrue([persistentContainer.managedObjectModel isConfiguration:nil compatibleWithStoreMetadata:metadata]);
+    
+    NSEntityDescription *playlistEntryEntity = persistentContainer.managedObjectModel.entitiesByName[@"SRGPlaylistEntry"];
+    XCTAssertTrue([[playlistEntryEntity.indexes valueForKey:@keypath(NSFetchIndexDescription.new, name)] containsObject:@"byPlaylistAndDiscardedAndDateIndex"]);
+}
+
 #pragma mark Setup and teardown
 
 - (void)setUp
@@ -404,4 +508,111 @@
     XCTAssertEqual(itemUids3.count, 104);
 }
 
+
+// Version v7 was never shipped in an application release
+- (void)testMigrationFromV7
+{
+    NSURL *fileURL = [self URLForStoreWithModelVersion:7];
+    SRGUserData *userData = [[SRGUserData alloc] initWithStoreFileURL:fileURL serviceURL:nil identityService:self.identityService];
+    XCTAssertNotNil(userData);
+    
+    NSPredicate *predicate1 = [NSPredicate predicateWithFormat:@"%K == NO", @keypath(SRGHistoryEntry.new, discarded)];
+    NSSortDescriptor *sortDescriptor1 = [NSSortDescriptor sortDescriptorWithKey:@keypath(SRGHistoryEntry.new, date) ascending:NO];
+    NSArray<NSString *> *itemUids1 = [[userData.history historyEntriesMatchingPredicate:predicate1
+                                                                  sortedWithDescriptors:@[sortDescriptor1]] valueForKeyPath:@keypath(SRGHistoryEntry.new, uid)];
+    
+    XCTAssertEqual(itemUids1.count, 103);
+    
+    NSString *uid1 = @"urn:rts:video:10085364";
+    SRGHistoryEntry *historyEntry = [userData.history historyEntryWithUid:uid1];
+    
+    XCTAssertNotNil(historyEntry);
+    XCTAssertEqualObjects(historyEntry.uid, uid1);
+    XCTAssertTrue(CMTIME_COMPARE_INLINE(historyEntry.lastPlaybackTime, !=, kCMTimeZero));
+    XCTAssertEqualObjects(historyEntry.deviceUid, @"Migration UT");
+    
+    SRGUser *user = userData.user;
+    
+    XCTAssertNotNil(user);
+    XCTAssertNotNil([user valueForKey:@keypath(SRGUser.new, synchronizationDate)]);
+    XCTAssertNotNil([user valueForKey:@keypath(SRGUser.new, historySynchronizationDate)]);
+    XCTAssertNotNil([user valueForKey:@keypath(SRGUser.new, playlistsSynchronizationDate)]);
+    XCTAssertEqualObjects([user valueForKey:@keypath(SRGUser.new, accountUid)], @"1234");
+    
+    [self assertMigratedPlaylistsInUserData:userData];
+    
+    // Database is writable.
+    NSString *uid2 = @"urn:rts:video:1234567890";
+    [self expectationForSingleNotification:SRGPlaylistEntriesDidChangeNotification object:userData.playlists handler:^BOOL(NSNotification * _Nonnull notification) {
+        XCTAssertTrue(NSThread.isMainThread);
+        return [notification.userInfo[SRGPlaylistEntriesUidsKey] containsObject:uid2];
+    }];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Save playlist entry"];
+    
+    [userData.playlists savePlaylistEntryWithUid:uid2 inPlaylistWithUid:@"migration_playlist" completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    NSArray<SRGPlaylistEntry *> *playlistEntries = [userData.playlists playlistEntriesInPlaylistWithUid:@"migration_playlist" matchingPredicate:nil sortedWithDescriptors:nil];
+    XCTAssertEqual(playlistEntries.count, 5);
+    XCTAssertEqualObjects(playlistEntries.lastObject.uid, uid2);
+}
+
+// Version v8 was never shipped in an application release
+- (void)testMigrationFromV8
+{
+    NSURL *fileURL = [self URLForStoreWithModelVersion:8];
+    SRGUserData *userData = [[SRGUserData alloc] initWithStoreFileURL:fileURL serviceURL:nil identityService:self.identityService];
+    XCTAssertNotNil(userData);
+    
+    NSPredicate *predicate1 = [NSPredicate predicateWithFormat:@"%K == NO", @keypath(SRGHistoryEntry.new, discarded)];
+    NSSortDescriptor *sortDescriptor1 = [NSSortDescriptor sortDescriptorWithKey:@keypath(SRGHistoryEntry.new, date) ascending:NO];
+    NSArray<NSString *> *itemUids1 = [[userData.history historyEntriesMatchingPredicate:predicate1
+                                                                  sortedWithDescriptors:@[sortDescriptor1]] valueForKeyPath:@keypath(SRGHistoryEntry.new, uid)];
+    
+    XCTAssertEqual(itemUids1.count, 103);
+    
+    NSString *uid1 = @"urn:rts:video:10085364";
+    SRGHistoryEntry *historyEntry = [userData.history historyEntryWithUid:uid1];
+    
+    XCTAssertNotNil(historyEntry);
+    XCTAssertEqualObjects(historyEntry.uid, uid1);
+    XCTAssertTrue(CMTIME_COMPARE_INLINE(historyEntry.lastPlaybackTime, !=, kCMTimeZero));
+    XCTAssertEqualObjects(historyEntry.deviceUid, @"Migration UT");
+    
+    SRGUser *user = userData.user;
+    
+    XCTAssertNotNil(user);
+    XCTAssertNotNil([user valueForKey:@keypath(SRGUser.new, synchronizationDate)]);
+    XCTAssertNotNil([user valueForKey:@keypath(SRGUser.new, historySynchronizationDate)]);
+    XCTAssertNotNil([user valueForKey:@keypath(SRGUser.new, playlistsSynchronizationDate)]);
+    XCTAssertEqualObjects([user valueForKey:@keypath(SRGUser.new, accountUid)], @"1234");
+    
+    [self assertMigratedPlaylistsInUserData:userData];
+    
+    // Database is writable.
+    NSString *uid2 = @"urn:rts:video:1234567890";
+    [self expectationForSingleNotification:SRGPlaylistEntriesDidChangeNotification object:userData.playlists handler:^BOOL(NSNotification * _Nonnull notification) {
+        XCTAssertTrue(NSThread.isMainThread);
+        return [notification.userInfo[SRGPlaylistEntriesUidsKey] containsObject:uid2];
+    }];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Save playlist entry"];
+    
+    [userData.playlists savePlaylistEntryWithUid:uid2 inPlaylistWithUid:@"migration_playlist" completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    NSArray<SRGPlaylistEntry *> *playlistEntries = [userData.playlists playlistEntriesInPlaylistWithUid:@"migration_playlist" matchingPredicate:nil sortedWithDescriptors:nil];
+    XCTAssertEqual(playlistEntries.count, 5);
+    XCTAssertEqualObjects(playlistEntries.lastObject.uid, uid2);
+}
+
 @end
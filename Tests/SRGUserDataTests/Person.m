@@ -19,6 +19,14 @@
         return NO;
     }
     
+    // Only rejected when saved to the store, not to a parent context
+    if ([*pName isEqualToString:@"Rejected by store"] && ! self.managedObjectContext.parentContext) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:@"ch.srgssr.userdata-tests.validation" code:1013 userInfo:nil];
+        }
+        return NO;
+    }
+    
     return YES;
 }
 
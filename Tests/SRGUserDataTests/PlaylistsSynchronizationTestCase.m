@@ -6,7 +6,10 @@
 
 #import "UserDataBaseTestCase.h"
 
+#import "SRGPlaylists+Private.h"
 #import "SRGPlaylistsRequest.h"
+#import "SRGUser+Private.h"
+#import "SRGUserData+Private.h"
 #import "SRGUserObject+Private.h"
 
 @import libextobjc;
@@ -35,6 +38,69 @@
     [self logout];
 }
 
+#pragma mark Helpers
+
+- (NSArray<NSString *> *)insertRemotePlaylistsWithCount:(NSUInteger)count
+{
+    NSMutableArray<NSString *> *uids = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; ++i) {
+        NSString *uid = [NSString stringWithFormat:@"playlist_%@", @(i)];
+        [self insertRemotePlaylistWithUid:uid];
+        [self insertRemotePlaylistEntriesWithUids:@[ @"1" ] forPlaylistWithUid:uid];
+        [uids addObject:uid];
+    }
+    return uids.copy;
+}
+
+// Execute the specified block, returning the number of transactions committed to the store meanwhile
+- (NSUInteger)storeTransactionCountDuringBlock:(void (NS_NOESCAPE ^)(void))block
+{
+    NSPersistentStoreCoordinator *persistentStoreCoordinator = self.userData.dataStore.persistentContainer.persistentStoreCoordinator;
+    
+    __block NSUInteger transactionCount = 0;
+    id saveObserver = [NSNotificationCenter.defaultCenter addObserverForName:NSManagedObjectContextDidSaveNotification object:nil queue:nil usingBlock:^(NSNotification * _Nonnull notification) {
+        NSManagedObjectContext *managedObjectContext = notification.object;
+        if (managedObjectContext.persistentStoreCoordinator == persistentStoreCoordinator && ! managedObjectContext.parentContext) {
+            @synchronized(persistentStoreCoordinator) {
+                transactionCount += 1;
+            }
+        }
+    }];
+    
+    block();
+    
+    [NSNotificationCenter.defaultCenter removeObserver:saveObserver];
+    
+    @synchronized(persistentStoreCoordinator) {
+        return transactionCount;
+    }
+}
+
+// Synchronize changes made remotely to all playlists, and measure how long the synchronization takes
+- (void)measureSynchronizationWithMaximumConcurrentRequestCount:(NSUInteger)maximumConcurrentRequestCount
+{
+    [self setupForLocalServiceWithLatency:0.02];
+    
+    NSArray<NSString *> *uids = [self insertRemotePlaylistsWithCount:100];
+    
+    [self loginAndWaitForInitialSynchronization];
+    
+    self.userData.playlists.maximumConcurrentRequestCount = maximumConcurrentRequestCount;
+    
+    __block NSUInteger iteration = 0;
+    [self measureMetrics:self.class.defaultPerformanceMetrics automaticallyStartMeasuring:NO forBlock:^{
+        NSString *entryUid = [NSString stringWithFormat:@"entry_%@", @(iteration)];
+        for (NSString *uid in uids) {
+            [self insertRemotePlaylistEntriesWithUids:@[ entryUid ] forPlaylistWithUid:uid];
+        }
+        iteration++;
+        
+        [self startMeasuring];
+        [self synchronizeAndWait];
+        [self stopMeasuring];
+    }];
+}
+
 #pragma mark Tests
 
 - (void)testWatchLaterPlaylistAvailability
@@ -346,6 +412,134 @@
     [self assertRemotePlaylistEntriesUids:@[ @"a", @"e" ] forPlaylistWithUid:SRGPlaylistUidWatchLater];
 }
 
+- (void)testIncrementalSynchronization
+{
+    [self setupForLocalServiceWithLatency:0.01];
+    
+    [self insertRemotePlaylistWithUid:@"a"];
+    [self insertRemotePlaylistEntriesWithUids:@[ @"1", @"2" ] forPlaylistWithUid:@"a"];
+    [self insertRemotePlaylistEntriesWithUids:@[ @"1", @"2", @"3" ] forPlaylistWithUid:SRGPlaylistUidWatchLater];
+    
+    [self loginAndWaitForInitialSynchronization];
+    
+    NSDate *synchronizationDate = self.userData.user.playlistsSynchronizationDate;
+    XCTAssertNotNil(synchronizationDate);
+    
+    // Changes since the last synchronization only
+    [self insertRemotePlaylistWithUid:@"b"];
+    [self insertRemotePlaylistEntriesWithUids:@[ @"4" ] forPlaylistWithUid:@"b"];
+    [self discardRemotePlaylistEntriesWithUids:@[ @"2" ] forPlaylistWithUid:SRGPlaylistUidWatchLater];
+    
+    [self synchronizeAndWait];
+    
+    XCTAssertEqual([self.userData.user.playlistsSynchronizationDate compare:synchronizationDate], NSOrderedDescending);
+    
+    [self assertLocalPlaylistUids:@[ @"a", @"b" ]];
+    [self assertLocalPlaylistEntriesUids:@[ @"1", @"2" ] forPlaylistWithUid:@"a"];
+    [self assertLocalPlaylistEntriesUids:@[ @"4" ] forPlaylistWithUid:@"b"];
+    [self assertLocalPlaylistEntriesUids:@[ @"1", @"3" ] forPlaylistWithUid:SRGPlaylistUidWatchLater];
+    
+    // Without any change, a single request is needed to find out nothing must be pulled
+    [self resetLocalServiceRequests];
+    
+    [self synchronizeAndWait];
+    
+    XCTAssertEqual([self localServiceRequestsToServiceURL:TestPlaylistsServiceURL()].count, 1);
+    
+    [self discardRemotePlaylistsWithUids:@[ @"a" ]];
+    
+    [self synchronizeAndWait];
+    
+    [self assertLocalPlaylistUids:@[ @"b" ]];
+    [self assertRemotePlaylistUids:@[ @"b" ]];
+}
+
+- (void)testSynchronizationWithoutServerDate
+{
+    [self setupForLocalServiceWithLatency:0.01];
+    
+    self.localServicePlaylistsServerDateOmitted = YES;
+    
+    [self insertRemotePlaylistWithUid:@"a"];
+    [self insertRemotePlaylistEntriesWithUids:@[ @"1", @"2" ] forPlaylistWithUid:@"a"];
+    
+    [self loginAndWaitForInitialSynchronization];
+    
+    // The device clock must not be used as reference for the next synchronization
+    XCTAssertNil(self.userData.user.playlistsSynchronizationDate);
+    
+    [self assertLocalPlaylistUids:@[ @"a" ]];
+    [self assertLocalPlaylistEntriesUids:@[ @"1", @"2" ] forPlaylistWithUid:@"a"];
+    
+    // Once the service returns a server date, everything is pulled one last time
+    self.localServicePlaylistsServerDateOmitted = NO;
+    [self resetLocalServiceRequests];
+    
+    [self synchronizeAndWait];
+    
+    XCTAssertNotNil(self.userData.user.playlistsSynchronizationDate);
+    
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"HTTPMethod == %@", @"GET"];
+    NSArray<NSURLRequest *> *pullRequests = [[self localServiceRequestsToServiceURL:TestPlaylistsServiceURL()] filteredArrayUsingPredicate:predicate];
+    XCTAssertTrue(pullRequests.count > 0);
+    for (NSURLRequest *pullRequest in pullRequests) {
+        XCTAssertFalse([pullRequest.URL.query containsString:@"after="]);
+    }
+}
+
+- (void)testScheduledSynchronization
+{
+    [self setupForLocalServiceWithLatency:0.01];
+    
+    NSArray<NSString *> *uids = [self insertRemotePlaylistsWithCount:100];
+    
+    // Entries of all playlists are pulled with bounded concurrency, and results are written in batches
+    [self resetLocalServiceRequests];
+    
+    NSUInteger pullTransactionCount = [self storeTransactionCountDuringBlock:^{
+        [self loginAndWaitForInitialSynchronization];
+    }];
+    XCTAssertLessThan(pullTransactionCount, 100);
+    
+    XCTAssertGreaterThan([self localServiceRequestsToServiceURL:TestPlaylistsServiceURL()].count, 100);
+    XCTAssertGreaterThan([self localServiceMaximumConcurrentRequestCountToServiceURL:TestPlaylistsServiceURL()], 1);
+    XCTAssertLessThanOrEqual([self localServiceMaximumConcurrentRequestCountToServiceURL:TestPlaylistsServiceURL()], 4);
+    
+    [self assertLocalPlaylistUids:uids];
+    for (NSString *uid in uids) {
+        [self assertLocalPlaylistEntriesUids:@[ @"1" ] forPlaylistWithUid:uid];
+    }
+    
+    // Local entries of all playlists are pushed with bounded concurrency as well
+    for (NSString *uid in uids) {
+        [self insertLocalPlaylistEntriesWithUids:@[ @"2" ] forPlaylistWithUid:uid];
+    }
+    
+    [self resetLocalServiceRequests];
+    
+    NSUInteger pushTransactionCount = [self storeTransactionCountDuringBlock:^{
+        [self synchronizeAndWait];
+    }];
+    XCTAssertLessThan(pushTransactionCount, 100);
+    
+    XCTAssertGreaterThan([self localServiceMaximumConcurrentRequestCountToServiceURL:TestPlaylistsServiceURL()], 1);
+    XCTAssertLessThanOrEqual([self localServiceMaximumConcurrentRequestCountToServiceURL:TestPlaylistsServiceURL()], 4);
+    
+    for (NSString *uid in uids) {
+        [self assertRemotePlaylistEntriesUids:@[ @"1", @"2" ] forPlaylistWithUid:uid];
+    }
+}
+
+- (void)testSequentialSynchronizationPerformance
+{
+    [self measureSynchronizationWithMaximumConcurrentRequestCount:1];
+}
+
+- (void)testScheduledSynchronizationPerformance
+{
+    [self measureSynchronizationWithMaximumConcurrentRequestCount:4];
+}
+
 // TODO: Disabled. Too intensive for the service.
 #if 0
 - (void)testLargePlaylists
@@ -6,6 +6,11 @@
 
 #import "UserDataBaseTestCase.h"
 
+#import "SRGPlaylist+Private.h"
+#import "SRGPlaylistEntry+Private.h"
+#import "SRGPlaylistMembershipIndex.h"
+#import "SRGRequestScheduler.h"
+#import "SRGUserData+Private.h"
 #import "SRGUserObject+Private.h"
 
 @import libextobjc;
@@ -29,6 +34,31 @@
     [self waitForExpectationsWithTimeout:10. handler:nil];
 }
 
+- (void)insertPlaylistEntriesWithCount:(NSUInteger)count inPlaylistWithUid:(NSString *)playlistUid
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Entries inserted"];
+    
+    [self.userData.dataStore performBackgroundWriteTask:^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+        SRGPlaylist *playlist = [SRGPlaylist objectWithUid:playlistUid matchingPredicate:nil inManagedObjectContext:managedObjectContext];
+        
+        NSMutableArray<NSString *> *uids = [NSMutableArray arrayWithCapacity:count];
+        for (NSUInteger i = 0; i < count; ++i) {
+            [uids addObject:[NSString stringWithFormat:@"urn:rts:video:%@", @(i)]];
+        }
+        
+        NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %@", @keypath(SRGPlaylistEntry.new, playlist), playlist];
+        NSArray<SRGPlaylistEntry *> *playlistEntries = [SRGPlaylistEntry upsertWithUids:uids matchingPredicate:predicate inManagedObjectContext:managedObjectContext];
+        for (SRGPlaylistEntry *playlistEntry in playlistEntries) {
+            playlistEntry.playlist = playlist;
+        }
+    } withPriority:NSOperationQueuePriorityNormal completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:60. handler:nil];
+}
+
 #pragma mark Setup and tear down
 
 - (void)setUp
@@ -560,6 +590,109 @@
     [self waitForExpectationsWithTimeout:30. handler:nil];
 }
 
+- (void)testPagedPlaylistEntriesInPlaylist
+{
+    [self insertLocalPlaylistEntriesWithUids:@[ @"1", @"2", @"3" ] forPlaylistWithUid:SRGPlaylistUidWatchLater];
+    
+    NSArray<SRGPlaylistEntry *> *playlistEntries = [self.userData.playlists playlistEntriesInPlaylistWithUid:SRGPlaylistUidWatchLater matchingPredicate:nil sortedWithDescriptors:nil];
+    NSArray<NSString *> *expectedUids = [playlistEntries valueForKeyPath:@keypath(SRGPlaylistEntry.new, uid)];
+    
+    // Synchronous
+    SRGUserObjectCursor *cursor1 = nil;
+    NSArray<SRGPlaylistEntry *> *playlistEntries1 = [self.userData.playlists playlistEntriesInPlaylistWithUid:SRGPlaylistUidWatchLater matchingPredicate:nil limit:2 afterCursor:nil nextCursor:&cursor1];
+    XCTAssertEqualObjects([playlistEntries1 valueForKeyPath:@keypath(SRGPlaylistEntry.new, uid)], [expectedUids subarrayWithRange:NSMakeRange(0, 2)]);
+    XCTAssertNotNil(cursor1);
+    
+    SRGUserObjectCursor *cursor2 = nil;
+    NSArray<SRGPlaylistEntry *> *playlistEntries2 = [self.userData.playlists playlistEntriesInPlaylistWithUid:SRGPlaylistUidWatchLater matchingPredicate:nil limit:2 afterCursor:cursor1 nextCursor:&cursor2];
+    XCTAssertEqualObjects([playlistEntries2 valueForKeyPath:@keypath(SRGPlaylistEntry.new, uid)], [expectedUids subarrayWithRange:NSMakeRange(2, 1)]);
+    XCTAssertNil(cursor2);
+    
+    XCTAssertNil([self.userData.playlists playlistEntriesInPlaylistWithUid:@"b" matchingPredicate:nil limit:2 afterCursor:nil nextCursor:NULL]);
+    
+    // Asynchronous
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Playlist entries fetched"];
+    
+    [self.userData.playlists playlistEntriesInPlaylistWithUid:SRGPlaylistUidWatchLater matchingPredicate:nil limit:1 afterCursor:cursor1 completionBlock:^(NSArray<SRGPlaylistEntry *> * _Nullable playlistEntries, SRGUserObjectCursor * _Nullable nextCursor, NSError * _Nullable error) {
+        XCTAssertFalse(NSThread.isMainThread);
+        XCTAssertNil(error);
+        XCTAssertEqualObjects([playlistEntries valueForKeyPath:@keypath(SRGPlaylistEntry.new, uid)], [expectedUids subarrayWithRange:NSMakeRange(2, 1)]);
+        XCTAssertNil(nextCursor);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+}
+
+- (void)testPlaylistEntryCounts
+{
+    [self insertLocalPlaylistWithUid:@"a"];
+    [self insertLocalPlaylistWithUid:@"b"];
+    [self insertLocalPlaylistEntriesWithUids:@[ @"1", @"2" ] forPlaylistWithUid:@"a"];
+    [self insertLocalPlaylistEntriesWithUids:@[ @"3", @"4", @"5" ] forPlaylistWithUid:SRGPlaylistUidWatchLater];
+    [self discardLocalPlaylistEntriesWithUids:@[ @"5" ] forPlaylistWithUid:SRGPlaylistUidWatchLater];
+    
+    // Synchronous
+    XCTAssertEqual([self.userData.playlists playlistEntryCountInPlaylistWithUid:@"a" matchingPredicate:nil], 2);
+    XCTAssertEqual([self.userData.playlists playlistEntryCountInPlaylistWithUid:SRGPlaylistUidWatchLater matchingPredicate:nil], 2);
+    XCTAssertEqual([self.userData.playlists playlistEntryCountInPlaylistWithUid:@"b" matchingPredicate:nil], 0);
+    XCTAssertEqual([self.userData.playlists playlistEntryCountInPlaylistWithUid:@"c" matchingPredicate:nil], 0);
+    
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K == %@", @keypath(SRGPlaylistEntry.new, uid), @"1"];
+    XCTAssertEqual([self.userData.playlists playlistEntryCountInPlaylistWithUid:@"a" matchingPredicate:predicate], 1);
+    
+    XCTAssertEqualObjects([self.userData.playlists playlistEntryCountsMatchingPredicate:nil], (@{ @"a" : @2, SRGPlaylistUidWatchLater : @2 }));
+    XCTAssertEqualObjects([self.userData.playlists playlistEntryCountsMatchingPredicate:predicate], @{ @"a" : @1 });
+    
+    // Asynchronous
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"Playlist entry count obtained"];
+    
+    [self.userData.playlists playlistEntryCountInPlaylistWithUid:@"a" matchingPredicate:nil completionBlock:^(NSUInteger count, NSError * _Nullable error) {
+        XCTAssertFalse(NSThread.isMainThread);
+        XCTAssertNil(error);
+        XCTAssertEqual(count, 2);
+        [expectation1 fulfill];
+    }];
+    
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"Playlist entry counts obtained"];
+    
+    [self.userData.playlists playlistEntryCountsMatchingPredicate:nil completionBlock:^(NSDictionary<NSString *, NSNumber *> * _Nullable playlistEntryCounts, NSError * _Nullable error) {
+        XCTAssertFalse(NSThread.isMainThread);
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(playlistEntryCounts, (@{ @"a" : @2, SRGPlaylistUidWatchLater : @2 }));
+        [expectation2 fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+}
+
+- (void)testPlaylistEntriesWithUidsInPlaylist
+{
+    [self insertLocalPlaylistWithUid:@"a"];
+    [self insertLocalPlaylistEntriesWithUids:@[ @"1", @"2", @"3" ] forPlaylistWithUid:@"a"];
+    [self insertLocalPlaylistEntriesWithUids:@[ @"4" ] forPlaylistWithUid:SRGPlaylistUidWatchLater];
+    [self discardLocalPlaylistEntriesWithUids:@[ @"3" ] forPlaylistWithUid:@"a"];
+    
+    // Synchronous
+    NSDictionary<NSString *, SRGPlaylistEntry *> *playlistEntries = [self.userData.playlists playlistEntriesWithUids:@[ @"1", @"2", @"3", @"4" ] inPlaylistWithUid:@"a"];
+    XCTAssertEqualObjects([NSSet setWithArray:playlistEntries.allKeys], ([NSSet setWithObjects:@"1", @"2", nil]));
+    XCTAssertEqualObjects(playlistEntries[@"1"].uid, @"1");
+    
+    XCTAssertNil([self.userData.playlists playlistEntriesWithUids:@[ @"1" ] inPlaylistWithUid:@"b"]);
+    
+    // Asynchronous
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Playlist entries fetched"];
+    
+    [self.userData.playlists playlistEntriesWithUids:@[ @"1", @"4" ] inPlaylistWithUid:SRGPlaylistUidWatchLater completionBlock:^(NSDictionary<NSString *, SRGPlaylistEntry *> * _Nullable playlistEntries, NSError * _Nullable error) {
+        XCTAssertFalse(NSThread.isMainThread);
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(playlistEntries.allKeys, @[ @"4" ]);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+}
+
 - (void)testDiscardPlaylistEntriesInPlaylist
 {
     [self insertLocalPlaylistEntriesWithUids:@[ @"1", @"2", @"3", @"4", @"5" ] forPlaylistWithUid:SRGPlaylistUidWatchLater];
@@ -633,4 +766,201 @@
     XCTAssertEqualObjects(uids, @[]);
 }
 
+- (void)testPlaylistMemberships
+{
+    [self insertLocalPlaylistWithUid:@"a"];
+    [self insertLocalPlaylistWithUid:@"b"];
+    [self insertLocalPlaylistEntriesWithUids:@[ @"1", @"2" ] forPlaylistWithUid:@"a"];
+    [self insertLocalPlaylistEntriesWithUids:@[ @"1" ] forPlaylistWithUid:@"b"];
+    
+    XCTAssertEqualObjects([self.userData.playlists playlistUidsContainingEntryWithUid:@"1"], ([NSSet setWithObjects:@"a", @"b", nil]));
+    XCTAssertEqualObjects([self.userData.playlists playlistUidsContainingEntryWithUid:@"2"], [NSSet setWithObject:@"a"]);
+    XCTAssertEqualObjects([self.userData.playlists playlistUidsContainingEntryWithUid:@"3"], [NSSet set]);
+    
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"Entry inserted"];
+    
+    [self.userData.playlists savePlaylistEntryWithUid:@"3" inPlaylistWithUid:@"b" completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation1 fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    XCTAssertEqualObjects([self.userData.playlists playlistUidsContainingEntryWithUid:@"3"], [NSSet setWithObject:@"b"]);
+    
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"Entries discarded"];
+    
+    [self.userData.playlists discardPlaylistEntriesWithUids:@[ @"1", @"2" ] fromPlaylistWithUid:@"a" completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation2 fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    XCTAssertEqualObjects([self.userData.playlists playlistUidsContainingEntryWithUid:@"1"], [NSSet setWithObject:@"b"]);
+    XCTAssertEqualObjects([self.userData.playlists playlistUidsContainingEntryWithUid:@"2"], [NSSet set]);
+    
+    XCTestExpectation *expectation3 = [self expectationWithDescription:@"Playlist discarded"];
+    
+    [self.userData.playlists discardPlaylistsWithUids:@[ @"b" ] completionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation3 fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    XCTAssertEqualObjects([self.userData.playlists playlistUidsContainingEntriesWithUids:@[ @"1", @"2", @"3" ]], @{});
+}
+
+- (void)testPlaylistMembershipsForSeveralEntries
+{
+    [self insertLocalPlaylistWithUid:@"a"];
+    [self insertLocalPlaylistEntriesWithUids:@[ @"1", @"2" ] forPlaylistWithUid:@"a"];
+    [self insertLocalPlaylistEntriesWithUids:@[ @"2", @"3" ] forPlaylistWithUid:SRGPlaylistUidWatchLater];
+    
+    NSDictionary<NSString *, NSSet<NSString *> *> *playlistUids = [self.userData.playlists playlistUidsContainingEntriesWithUids:@[ @"1", @"2", @"3", @"4" ]];
+    XCTAssertEqualObjects(playlistUids, (@{ @"1" : [NSSet setWithObject:@"a"],
+                                            @"2" : [NSSet setWithObjects:@"a", SRGPlaylistUidWatchLater, nil],
+                                            @"3" : [NSSet setWithObject:SRGPlaylistUidWatchLater] }));
+}
+
+- (void)testPlaylistMembershipChangesDuringIndexLoading
+{
+    dispatch_semaphore_t loadingStartedSemaphore = dispatch_semaphore_create(0);
+    dispatch_semaphore_t loadingResumedSemaphore = dispatch_semaphore_create(0);
+    
+    SRGPlaylistMembershipIndex *membershipIndex = [[SRGPlaylistMembershipIndex alloc] initWithLoader:^(SRGPlaylistMembershipIndexLoaderCompletionBlock completionBlock) {
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            dispatch_semaphore_signal(loadingStartedSemaphore);
+            dispatch_semaphore_wait(loadingResumedSemaphore, DISPATCH_TIME_FOREVER);
+            completionBlock(@{ @"1" : [NSSet setWithObject:@"a"],
+                               @"2" : [NSSet setWithObject:@"a"] });
+        });
+    }];
+    [membershipIndex loadInBackground];
+    
+    dispatch_semaphore_wait(loadingStartedSemaphore, DISPATCH_TIME_FOREVER);
+    
+    // Changes can be recorded while the loader is running, and are applied once loaded
+    [membershipIndex addEntriesWithUids:[NSSet setWithObject:@"3"] toPlaylistWithUid:@"b"];
+    [membershipIndex removeEntriesWithUids:[NSSet setWithObject:@"1"] fromPlaylistWithUid:@"a"];
+    
+    dispatch_semaphore_signal(loadingResumedSemaphore);
+    
+    XCTAssertEqualObjects([membershipIndex playlistUidsContainingEntriesWithUids:@[ @"1", @"2", @"3" ]], (@{ @"2" : [NSSet setWithObject:@"a"],
+                                                                                                            @"3" : [NSSet setWithObject:@"b"] }));
+}
+
+- (void)testScheduledRequestsFailure
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Requests finished"];
+    
+    __block NSUInteger startedCount = 0;
+    __block BOOL written = NO;
+    
+    SRGRequestScheduler *scheduler = [[SRGRequestScheduler alloc] initWithDataStore:self.userData.dataStore maximumConcurrentRequestCount:1];
+    for (NSUInteger i = 0; i < 5; ++i) {
+        [scheduler addRequestWithBlock:^SRGRequest * _Nullable(SRGRequestSchedulerResultBlock  _Nonnull resultBlock) {
+            startedCount += 1;
+            if (i == 0) {
+                resultBlock(^(NSManagedObjectContext * _Nonnull managedObjectContext) {
+                    written = YES;
+                }, nil, nil);
+            }
+            else {
+                resultBlock(nil, nil, [NSError errorWithDomain:SRGUserDataErrorDomain code:SRGUserDataErrorNotFound userInfo:nil]);
+            }
+            return nil;
+        }];
+    }
+    [scheduler startWithCompletionBlock:^(NSError * _Nullable error) {
+        XCTAssertEqualObjects(error.domain, SRGUserDataErrorDomain);
+        XCTAssertEqual(error.code, SRGUserDataErrorNotFound);
+        
+        // No request is started after the first failure, but results received before are written
+        XCTAssertEqual(startedCount, 2);
+        XCTAssertTrue(written);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testLargePlaylistEntryInsertionPerformance
+{
+    [self insertPlaylistEntriesWithCount:5000 inPlaylistWithUid:SRGPlaylistUidWatchLater];
+    
+    __block NSUInteger iteration = 0;
+    [self measureBlock:^{
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Entries saved"];
+        
+        static const NSUInteger kEntryCount = 100;
+        __block NSUInteger savedCount = 0;
+        for (NSUInteger i = 0; i < kEntryCount; ++i) {
+            NSString *uid = [NSString stringWithFormat:@"urn:rts:audio:%@-%@", @(iteration), @(i)];
+            [self.userData.playlists savePlaylistEntryWithUid:uid inPlaylistWithUid:SRGPlaylistUidWatchLater completionBlock:^(NSError * _Nullable error) {
+                XCTAssertNil(error);
+                if (++savedCount == kEntryCount) {
+                    [expectation fulfill];
+                }
+            }];
+        }
+        
+        [self waitForExpectationsWithTimeout:60. handler:nil];
+        iteration += 1;
+    }];
+}
+
+- (void)testLargePlaylistEntryDiscardPerformance
+{
+    [self insertPlaylistEntriesWithCount:5000 inPlaylistWithUid:SRGPlaylistUidWatchLater];
+    
+    __block NSUInteger iteration = 0;
+    [self measureBlock:^{
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Entries discarded"];
+        
+        static const NSUInteger kEntryCount = 100;
+        __block NSUInteger discardedCount = 0;
+        for (NSUInteger i = 0; i < kEntryCount; ++i) {
+            NSString *uid = [NSString stringWithFormat:@"urn:rts:video:%@", @(iteration * kEntryCount + i)];
+            [self.userData.playlists discardPlaylistEntriesWithUids:@[ uid ] fromPlaylistWithUid:SRGPlaylistUidWatchLater completionBlock:^(NSError * _Nullable error) {
+                XCTAssertNil(error);
+                if (++discardedCount == kEntryCount) {
+                    [expectation fulfill];
+                }
+            }];
+        }
+        
+        [self waitForExpectationsWithTimeout:60. handler:nil];
+        iteration += 1;
+    }];
+}
+
+- (void)testLargePlaylistEntriesReadPerformance
+{
+    [self insertPlaylistEntriesWithCount:5000 inPlaylistWithUid:SRGPlaylistUidWatchLater];
+    
+    [self measureBlock:^{
+        NSArray<SRGPlaylistEntry *> *playlistEntries = [self.userData.playlists playlistEntriesInPlaylistWithUid:SRGPlaylistUidWatchLater matchingPredicate:nil sortedWithDescriptors:nil];
+        XCTAssertEqual(playlistEntries.count, 5000);
+    }];
+}
+
+- (void)testPlaylistMembershipsPerformance
+{
+    [self insertPlaylistEntriesWithCount:5000 inPlaylistWithUid:SRGPlaylistUidWatchLater];
+    
+    // Typical list of items each displaying whether the corresponding media is in a playlist
+    NSMutableArray<NSString *> *uids = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 200; ++i) {
+        [uids addObject:[NSString stringWithFormat:@"urn:rts:video:%@", @(i * 50)]];
+    }
+    
+    [self measureBlock:^{
+        for (NSString *uid in uids) {
+            XCTAssertTrue([[self.userData.playlists playlistUidsContainingEntryWithUid:uid] containsObject:SRGPlaylistUidWatchLater]);
+        }
+    }];
+}
+
 @end
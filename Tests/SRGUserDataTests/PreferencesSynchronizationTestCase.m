@@ -234,6 +234,65 @@
     [self assertRemotePreferences:@{ @"b" : @2 } inDomain:@"test"];
 }
 
+- (void)testConcurrentPushWithOverlappingPaths
+{
+    [self setupForLocalServiceWithLatency:0.05];
+    [self loginAndWaitForInitialSynchronization];
+    
+    // Independent paths, which can be pushed concurrently
+    NSMutableDictionary *otherDictionary = [NSMutableDictionary dictionary];
+    for (NSInteger i = 0; i < 20; ++i) {
+        NSString *path = [NSString stringWithFormat:@"p%@", @(i)];
+        [self insertLocalPreferenceWithObject:@(i) atPath:path inDomain:@"other"];
+        otherDictionary[path] = @(i);
+    }
+    
+    // Overlapping paths, whose changes must reach the service in the order they were made
+    [self insertLocalPreferenceWithObject:@"x" atPath:@"a/b" inDomain:@"test"];
+    [self insertLocalPreferenceWithObject:@"y" atPath:@"a/c" inDomain:@"test"];
+    [self discardLocalPreferenceAtPath:@"a" inDomain:@"test"];
+    [self insertLocalPreferenceWithObject:@"z" atPath:@"a/d" inDomain:@"test"];
+    [self insertLocalPreferenceWithObject:@1 atPath:@"e" inDomain:@"test"];
+    [self insertLocalPreferenceWithObject:@2 atPath:@"e" inDomain:@"test"];
+    
+    [self resetLocalServiceRequests];
+    
+    [self synchronizeAndWait];
+    
+    NSPredicate *pushPredicate = [NSPredicate predicateWithFormat:@"HTTPMethod IN %@", @[ @"PUT", @"DELETE" ]];
+    NSArray<NSURLRequest *> *pushRequests = [[self localServiceRequestsToServiceURL:TestPreferencesServiceURL()] filteredArrayUsingPredicate:pushPredicate];
+    XCTAssertEqual(pushRequests.count, 25);
+    
+    NSUInteger (^indexOfPushRequest)(NSString *, NSString *) = ^(NSString *HTTPMethod, NSString *path) {
+        return [pushRequests indexOfObjectPassingTest:^BOOL(NSURLRequest * _Nonnull request, NSUInteger idx, BOOL * _Nonnull stop) {
+            return [request.HTTPMethod isEqualToString:HTTPMethod] && [request.URL.path hasSuffix:path];
+        }];
+    };
+    
+    NSUInteger deletionIndex = indexOfPushRequest(@"DELETE", @"/test/a");
+    XCTAssertNotEqual(deletionIndex, NSNotFound);
+    XCTAssertLessThan(indexOfPushRequest(@"PUT", @"/test/a/b"), deletionIndex);
+    XCTAssertLessThan(indexOfPushRequest(@"PUT", @"/test/a/c"), deletionIndex);
+    XCTAssertGreaterThan(indexOfPushRequest(@"PUT", @"/test/a/d"), deletionIndex);
+    XCTAssertNotEqual(indexOfPushRequest(@"PUT", @"/test/a/d"), NSNotFound);
+    
+    NSUInteger maximumConcurrentRequestCount = [self localServiceMaximumConcurrentRequestCountToServiceURL:TestPreferencesServiceURL()];
+    XCTAssertGreaterThan(maximumConcurrentRequestCount, 1);
+    XCTAssertLessThanOrEqual(maximumConcurrentRequestCount, 4);
+    
+    [self assertLocalPreferences:@{ @"a" : @{ @"d" : @"z" }, @"e" : @2 } inDomain:@"test"];
+    [self assertRemotePreferences:@{ @"a" : @{ @"d" : @"z" }, @"e" : @2 } inDomain:@"test"];
+    [self assertLocalPreferences:otherDictionary inDomain:@"other"];
+    [self assertRemotePreferences:otherDictionary inDomain:@"other"];
+    
+    // Acknowledged changes have been removed from the changelog and are not pushed again
+    [self resetLocalServiceRequests];
+    
+    [self synchronizeAndWait];
+    
+    XCTAssertEqual([[self localServiceRequestsToServiceURL:TestPreferencesServiceURL()] filteredArrayUsingPredicate:pushPredicate].count, 0);
+}
+
 - (void)testLogout
 {
     [self setupForAvailableService];
@@ -378,16 +437,14 @@
     
     [self waitForExpectationsWithTimeout:30. handler:nil];
     
-    // No more changes must be received for empty domains when synchronizing
-    [self expectationForSingleNotification:SRGPreferencesDidChangeNotification object:self.userData.preferences handler:^BOOL(NSNotification * _Nonnull notification) {
-        XCTAssertTrue(NSThread.isMainThread);
-        XCTAssertEqualObjects(notification.userInfo[SRGPreferencesDomainsKey], ([NSSet setWithObjects:@"test2", nil]));
-        return YES;
+    // No more changes must be received when synchronizing, as local and remote preferences are the same
+    id changeObserver = [NSNotificationCenter.defaultCenter addObserverForName:SRGPreferencesDidChangeNotification object:self.userData.preferences queue:nil usingBlock:^(NSNotification * _Nonnull notification) {
+        XCTFail(@"No change notification is expected");
     }];
     
-    [self synchronize];
+    [self synchronizeAndWait];
     
-    [self waitForExpectationsWithTimeout:30. handler:nil];
+    [NSNotificationCenter.defaultCenter removeObserver:changeObserver];
     
     [self assertLocalPreferences:nil inDomain:@"test1"];
     [self assertLocalPreferences:@{ @"b" : @"y" } inDomain:@"test2"];
@@ -406,10 +463,10 @@
     
     [self discardRemotePreferenceAtPath:@"a" inDomain:@"test1"];
     
-    // Changes are notified when synchronization occurs with the remote changes
+    // Changes are notified when synchronization occurs with the remote changes, only for domains which changed
     [self expectationForSingleNotification:SRGPreferencesDidChangeNotification object:self.userData.preferences handler:^BOOL(NSNotification * _Nonnull notification) {
         XCTAssertTrue(NSThread.isMainThread);
-        XCTAssertEqualObjects(notification.userInfo[SRGPreferencesDomainsKey], ([NSSet setWithObjects:@"test1", @"test2", nil]));
+        XCTAssertEqualObjects(notification.userInfo[SRGPreferencesDomainsKey], ([NSSet setWithObjects:@"test1", nil]));
         return YES;
     }];
     
@@ -424,4 +481,37 @@
     [self assertRemotePreferences:@{ @"b" : @"y" } inDomain:@"test2"];
 }
 
+- (void)testNoNotificationsForUnchangedRemoteEntries
+{
+    [self insertRemotePreferenceWithObject:@"x" atPath:@"a" inDomain:@"test1"];
+    [self insertRemotePreferenceWithObject:@"y" atPath:@"b" inDomain:@"test2"];
+    
+    [self setupForAvailableService];
+    [self loginAndWaitForInitialSynchronization];
+    
+    [self insertRemotePreferenceWithObject:@"z" atPath:@"c" inDomain:@"test2"];
+    
+    [self expectationForSingleNotification:SRGPreferencesDidChangeNotification object:self.userData.preferences handler:^BOOL(NSNotification * _Nonnull notification) {
+        XCTAssertTrue(NSThread.isMainThread);
+        XCTAssertEqualObjects(notification.userInfo[SRGPreferencesDomainsKey], ([NSSet setWithObjects:@"test2", nil]));
+        XCTAssertEqualObjects(notification.userInfo[SRGPreferencesPathsKey], (@{ @"test2" : [NSSet setWithObject:@"c"] }));
+        return YES;
+    }];
+    
+    [self synchronize];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    id changeObserver = [NSNotificationCenter.defaultCenter addObserverForName:SRGPreferencesDidChangeNotification object:self.userData.preferences queue:nil usingBlock:^(NSNotification * _Nonnull notification) {
+        XCTFail(@"No change notification is expected");
+    }];
+    
+    [self synchronizeAndWait];
+    
+    [NSNotificationCenter.defaultCenter removeObserver:changeObserver];
+    
+    [self assertLocalPreferences:@{ @"a" : @"x" } inDomain:@"test1"];
+    [self assertLocalPreferences:(@{ @"b" : @"y", @"c" : @"z" }) inDomain:@"test2"];
+}
+
 @end
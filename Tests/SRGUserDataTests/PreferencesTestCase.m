@@ -4,6 +4,10 @@
 //  License information is available from the LICENSE file.
 //
 
+#import "SRGPreferencesChangelog.h"
+#import "SRGPreferencesJournal.h"
+#import "SRGPreferencesPushScheduler.h"
+#import "SRGPreferencesSnapshot.h"
 #import "UserDataBaseTestCase.h"
 
 @interface PreferencesTestCase : UserDataBaseTestCase
@@ -21,6 +25,129 @@
     [self setupForOfflineOnly];
 }
 
+#pragma mark Helpers
+
+- (NSDictionary *)largePreferenceDictionary
+{
+    // Roughly 1 MB of preferences, spread over several domains
+    NSMutableDictionary *dictionary = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < 10; ++i) {
+        NSMutableDictionary *domainDictionary = [NSMutableDictionary dictionary];
+        for (NSUInteger j = 0; j < 1000; ++j) {
+            domainDictionary[@(j).stringValue] = @{ @"title" : [@"" stringByPaddingToLength:80 withString:@"x" startingAtIndex:0],
+                                                    @"count" : @(j),
+                                                    @"tags" : @[ @"a", @"b" ] };
+        }
+        dictionary[[NSString stringWithFormat:@"domain%@", @(i)]] = domainDictionary.copy;
+    }
+    return dictionary.copy;
+}
+
+- (NSArray<SRGPreferencesChangelogEntry *> *)changelogEntriesWithCount:(NSUInteger)count
+{
+    NSMutableArray<SRGPreferencesChangelogEntry *> *entries = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; ++i) {
+        NSString *domain = [NSString stringWithFormat:@"domain%@", @(i % 3)];
+        
+        // Mix sibling, nested and parent paths, so that some entries overlap
+        NSString *path = nil;
+        if (i % 4 == 0) {
+            path = [NSString stringWithFormat:@"a/%@", @(i % 7)];
+        }
+        else if (i % 4 == 1) {
+            path = [NSString stringWithFormat:@"a/%@/x", @(i % 5)];
+        }
+        else if (i % 4 == 2) {
+            path = [NSString stringWithFormat:@"b%@", @(i % 11)];
+        }
+        else {
+            path = (i % 20 == 3) ? @"a" : [NSString stringWithFormat:@"c%@", @(i)];
+        }
+        
+        id object = (i % 9 == 0) ? nil : @(i);
+        [entries addObject:[SRGPreferencesChangelogEntry changelogEntryWithObject:object atPath:path inDomain:domain]];
+    }
+    return entries.copy;
+}
+
++ (BOOL)entry:(SRGPreferencesChangelogEntry *)entry overlapsWithEntry:(SRGPreferencesChangelogEntry *)otherEntry
+{
+    if (! [entry.domain isEqualToString:otherEntry.domain]) {
+        return NO;
+    }
+    
+    NSString *path = [entry.path stringByAppendingString:@"/"];
+    NSString *otherPath = [otherEntry.path stringByAppendingString:@"/"];
+    return [path hasPrefix:otherPath] || [otherPath hasPrefix:path];
+}
+
+// Push entries to a local stand-in server, checking that an entry is only received once all previous entries with
+// overlapping paths have been applied. Return the maximum number of requests received at the same time.
+- (NSUInteger)pushEntries:(NSArray<SRGPreferencesChangelogEntry *> *)entries withMaximumConcurrentPushCount:(NSUInteger)maximumConcurrentPushCount latency:(NSTimeInterval)latency
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Push finished"];
+    
+    NSMutableIndexSet *appliedIndexes = [NSMutableIndexSet indexSet];
+    __block NSUInteger runningCount = 0;
+    __block NSUInteger maximumRunningCount = 0;
+    
+    SRGPreferencesPushScheduler *scheduler = [[SRGPreferencesPushScheduler alloc] initWithEntries:entries maximumConcurrentPushCount:maximumConcurrentPushCount pushBlock:^(SRGPreferencesChangelogEntry * _Nonnull entry, SRGPreferencesPushCompletionBlock  _Nonnull completionBlock) {
+        NSUInteger index = [entries indexOfObjectIdenticalTo:entry];
+        
+        @synchronized(appliedIndexes) {
+            runningCount += 1;
+            maximumRunningCount = MAX(runningCount, maximumRunningCount);
+            
+            for (NSUInteger i = 0; i < index; ++i) {
+                if ([PreferencesTestCase entry:entries[i] overlapsWithEntry:entry]) {
+                    XCTAssertTrue([appliedIndexes containsIndex:i], @"Entry %@ received before entry %@", @(index), @(i));
+                }
+            }
+        }
+        
+        // Latency varies so that responses are received out of order
+        NSTimeInterval entryLatency = latency * (1. + (index % 3));
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(entryLatency * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            @synchronized(appliedIndexes) {
+                runningCount -= 1;
+                [appliedIndexes addIndex:index];
+            }
+            completionBlock(nil);
+        });
+    }];
+    [scheduler startWithCompletionBlock:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        
+        @synchronized(appliedIndexes) {
+            XCTAssertEqual(appliedIndexes.count, entries.count);
+            XCTAssertLessThanOrEqual(maximumRunningCount, MAX(maximumConcurrentPushCount, 1));
+        }
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:300. handler:nil];
+    
+    return maximumRunningCount;
+}
+
+- (void)measureSnapshotLoadWithData:(NSData *)data
+{
+    if (@available(iOS 13, tvOS 13, *)) {
+        NSString *fileName = [NSUUID.UUID.UUIDString stringByAppendingPathExtension:@"prefs"];
+        NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+        XCTAssertTrue([data writeToURL:fileURL atomically:YES]);
+        
+        // Typical startup access: load the snapshot, then read a few values
+        NSArray<id<XCTMetric>> *metrics = @[ [[XCTClockMetric alloc] init], [[XCTMemoryMetric alloc] init] ];
+        [self measureWithMetrics:metrics block:^{
+            NSDictionary *dictionary = [SRGPreferencesSnapshot dictionaryWithContentsOfFileURL:fileURL error:NULL];
+            XCTAssertEqualObjects(dictionary[@"domain3"][@"12"][@"count"], @12);
+        }];
+        
+        [NSFileManager.defaultManager removeItemAtURL:fileURL error:NULL];
+    }
+}
+
 #pragma mark Tests
 
 - (void)testBooleanChecks
@@ -321,6 +448,60 @@
     XCTAssertEqualObjects([self.userData.preferences stringAtPath:@"/c/" inDomain:@"domain"], @"x");
 }
 
+- (void)testPreferencePath
+{
+    SRGPreferencePath *preferencePath = [SRGPreferencePath preferencePathWithPath:@"/path/to/n/" inDomain:@"test"];
+    XCTAssertNotNil(preferencePath);
+    XCTAssertEqualObjects(preferencePath.path, @"path/to/n");
+    XCTAssertEqualObjects(preferencePath.domain, @"test");
+    
+    // Paths are cached
+    XCTAssertEqual([SRGPreferencePath preferencePathWithPath:@"/path/to/n/" inDomain:@"test"], preferencePath);
+    XCTAssertEqualObjects([SRGPreferencePath preferencePathWithPath:@"path/to/n" inDomain:@"test"], preferencePath);
+    XCTAssertNotEqualObjects([SRGPreferencePath preferencePathWithPath:@"path/to/n" inDomain:@"other"], preferencePath);
+    
+    XCTAssertNotNil([SRGPreferencePath preferencePathWithPath:nil inDomain:@"test"]);
+    XCTAssertNil([SRGPreferencePath preferencePathWithPath:@"/" inDomain:@"test"]);
+    XCTAssertNil([SRGPreferencePath preferencePathWithPath:@"path with spaces" inDomain:@"test"]);
+    XCTAssertNil([SRGPreferencePath preferencePathWithPath:@"path" inDomain:@"test/domain"]);
+    XCTAssertNil([SRGPreferencePath preferencePathWithPath:@"path" inDomain:@""]);
+    
+    XCTAssertFalse([self.userData.preferences hasObjectAtPreferencePath:preferencePath]);
+    XCTAssertNil([self.userData.preferences numberAtPreferencePath:preferencePath]);
+    
+    [self.userData.preferences setNumber:@1012 atPath:@"path/to/n" inDomain:@"test"];
+    XCTAssertTrue([self.userData.preferences hasObjectAtPreferencePath:preferencePath]);
+    XCTAssertEqualObjects([self.userData.preferences numberAtPreferencePath:preferencePath], @1012);
+    XCTAssertNil([self.userData.preferences stringAtPreferencePath:preferencePath]);
+    
+    SRGPreferencePath *parentPreferencePath = [SRGPreferencePath preferencePathWithPath:@"path" inDomain:@"test"];
+    XCTAssertEqualObjects([self.userData.preferences dictionaryAtPreferencePath:parentPreferencePath], (@{ @"to" : @{ @"n" : @1012 } }));
+    XCTAssertNil([self.userData.preferences arrayAtPreferencePath:parentPreferencePath]);
+}
+
+- (void)testReadPerformance
+{
+    [self.userData.preferences setNumber:@1012 atPath:@"path/to/n" inDomain:@"test"];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 1000000; ++i) {
+            [self.userData.preferences numberAtPath:@"path/to/n" inDomain:@"test"];
+        }
+    }];
+}
+
+- (void)testPreferencePathReadPerformance
+{
+    [self.userData.preferences setNumber:@1012 atPath:@"path/to/n" inDomain:@"test"];
+    
+    SRGPreferencePath *preferencePath = [SRGPreferencePath preferencePathWithPath:@"path/to/n" inDomain:@"test"];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 1000000; ++i) {
+            [self.userData.preferences numberAtPreferencePath:preferencePath];
+        }
+    }];
+}
+
 - (void)testNotificationOnInsertion
 {
     [self expectationForSingleNotification:SRGPreferencesDidChangeNotification object:self.userData.preferences handler:^BOOL(NSNotification * _Nonnull notification) {
@@ -334,11 +515,38 @@
     [self waitForExpectationsWithTimeout:10. handler:nil];
 }
 
+- (void)testNotificationOnBackgroundInsertion
+{
+    [self expectationForSingleNotification:SRGPreferencesDidChangeNotification object:self.userData.preferences handler:^BOOL(NSNotification * _Nonnull notification) {
+        XCTAssertTrue(NSThread.isMainThread);
+        XCTAssertEqualObjects(notification.userInfo[SRGPreferencesDomainsKey], [NSSet setWithObject:@"test"]);
+        return YES;
+    }];
+    
+    XCTestExpectation *observerExpectation = [self expectationWithDescription:@"Observer called"];
+    id observer = [self.userData.preferences addObserverForPath:@"a" inDomain:@"test" usingBlock:^(NSSet<NSString *> * _Nonnull paths) {
+        XCTAssertTrue(NSThread.isMainThread);
+        XCTAssertEqualObjects(paths, [NSSet setWithObject:@"a"]);
+        [observerExpectation fulfill];
+    }];
+    
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [self.userData.preferences setString:@"x" atPath:@"a" inDomain:@"test"];
+    });
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    [self.userData.preferences removeObserver:observer];
+}
+
 - (void)testNotificationOnModification
 {
     [self.userData.preferences setString:@"x" atPath:@"a" inDomain:@"test"];
     XCTAssertEqualObjects([self.userData.preferences stringAtPath:@"a" inDomain:@"test"], @"x");
     
+    [self expectationForPendingNotificationsOfUserData:self.userData];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
     [self expectationForSingleNotification:SRGPreferencesDidChangeNotification object:self.userData.preferences handler:^BOOL(NSNotification * _Nonnull notification) {
         XCTAssertTrue(NSThread.isMainThread);
         XCTAssertEqualObjects(notification.userInfo[SRGPreferencesDomainsKey], [NSSet setWithObject:@"test"]);
@@ -354,6 +562,9 @@
 {
     [self.userData.preferences setString:@"x" atPath:@"a" inDomain:@"test"];
     
+    [self expectationForPendingNotificationsOfUserData:self.userData];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
     [self expectationForSingleNotification:SRGPreferencesDidChangeNotification object:self.userData.preferences handler:^BOOL(NSNotification * _Nonnull notification) {
         XCTAssertTrue(NSThread.isMainThread);
         XCTAssertEqualObjects(notification.userInfo[SRGPreferencesDomainsKey], [NSSet setWithObject:@"test"]);
@@ -392,6 +603,9 @@
     [self.userData.preferences setString:@"x" atPath:@"a" inDomain:@"test"];
     [self.userData.preferences setString:@"y" atPath:@"b" inDomain:@"test"];
     
+    [self expectationForPendingNotificationsOfUserData:self.userData];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
     __block NSUInteger changeNotificationCount = 0;
     
     id changeObserver = [NSNotificationCenter.defaultCenter addObserverForName:SRGPreferencesDidChangeNotification object:self.userData.preferences queue:nil usingBlock:^(NSNotification * _Nonnull notification) {
@@ -439,6 +653,9 @@
     [self.userData.preferences setString:@"x" atPath:@"a" inDomain:@"test"];
     [self.userData.preferences setString:@"y" atPath:@"b" inDomain:@"test"];
     
+    [self expectationForPendingNotificationsOfUserData:self.userData];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
     __block NSUInteger changeNotificationCount = 0;
     
     id changeObserver = [NSNotificationCenter.defaultCenter addObserverForName:SRGPreferencesDidChangeNotification object:self.userData.preferences queue:nil usingBlock:^(NSNotification * _Nonnull notification) {
@@ -462,6 +679,9 @@
 {
     [self.userData.preferences setString:@"x" atPath:@"a" inDomain:@"test"];
     
+    [self expectationForPendingNotificationsOfUserData:self.userData];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
     __block NSUInteger changeNotificationCount = 0;
     
     id changeObserver = [NSNotificationCenter.defaultCenter addObserverForName:SRGPreferencesDidChangeNotification object:self.userData.preferences queue:nil usingBlock:^(NSNotification * _Nonnull notification) {
@@ -486,6 +706,9 @@
     [self.userData.preferences setString:@"x" atPath:@"a" inDomain:@"test"];
     [self.userData.preferences setString:@"y" atPath:@"b" inDomain:@"test"];
     
+    [self expectationForPendingNotificationsOfUserData:self.userData];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
     __block NSUInteger changeNotificationCount = 0;
     
     id changeObserver = [NSNotificationCenter.defaultCenter addObserverForName:SRGPreferencesDidChangeNotification object:self.userData.preferences queue:nil usingBlock:^(NSNotification * _Nonnull notification) {
@@ -536,6 +759,9 @@
     [self.userData.preferences setString:@"x" atPath:@"a" inDomain:@"test"];
     [self.userData.preferences setString:@"y" atPath:@"b" inDomain:@"test"];
     
+    [self expectationForPendingNotificationsOfUserData:self.userData];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
     __block NSUInteger changeNotificationCount = 0;
     
     id changeObserver = [NSNotificationCenter.defaultCenter addObserverForName:SRGPreferencesDidChangeNotification object:self.userData.preferences queue:nil usingBlock:^(NSNotification * _Nonnull notification) {
@@ -578,4 +804,526 @@
     XCTAssertEqual(changeNotificationCount, 0);
 }
 
+- (void)testChangedPathsInNotification
+{
+    [self expectationForSingleNotification:SRGPreferencesDidChangeNotification object:self.userData.preferences handler:^BOOL(NSNotification * _Nonnull notification) {
+        XCTAssertEqualObjects(notification.userInfo[SRGPreferencesPathsKey], (@{ @"test" : [NSSet setWithObject:@"a"] }));
+        return YES;
+    }];
+    
+    [self.userData.preferences setDictionary:@{ @"x" : @{ @"y" : @"z" }, @"w" : @1 } atPath:@"a" inDomain:@"test"];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // Only the leaf which actually changed is reported
+    [self expectationForSingleNotification:SRGPreferencesDidChangeNotification object:self.userData.preferences handler:^BOOL(NSNotification * _Nonnull notification) {
+        XCTAssertEqualObjects(notification.userInfo[SRGPreferencesPathsKey], (@{ @"test" : [NSSet setWithObject:@"a/x/y"] }));
+        return YES;
+    }];
+    
+    [self.userData.preferences setDictionary:@{ @"x" : @{ @"y" : @"v" }, @"w" : @1 } atPath:@"a" inDomain:@"test"];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    [self expectationForSingleNotification:SRGPreferencesDidChangeNotification object:self.userData.preferences handler:^BOOL(NSNotification * _Nonnull notification) {
+        XCTAssertEqualObjects(notification.userInfo[SRGPreferencesPathsKey], (@{ @"test" : [NSSet setWithObjects:@"a/w", @"b", nil] }));
+        return YES;
+    }];
+    
+    [self.userData.preferences setObjectsAtPaths:@{ @"a/w" : @2,
+                                                    @"a/x/y" : @"v",
+                                                    @"b" : @"s" } inDomain:@"test"];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    [self expectationForSingleNotification:SRGPreferencesDidChangeNotification object:self.userData.preferences handler:^BOOL(NSNotification * _Nonnull notification) {
+        XCTAssertEqualObjects(notification.userInfo[SRGPreferencesPathsKey], (@{ @"test" : [NSSet setWithObject:@"a"] }));
+        return YES;
+    }];
+    
+    [self.userData.preferences removeObjectsAtPaths:@[@"a", @"c"] inDomain:@"test"];
+    
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testPathObservers
+{
+    [self.userData.preferences setDictionary:@{ @"x" : @{ @"y" : @"z" } } atPath:@"a" inDomain:@"test"];
+    
+    [self expectationForPendingNotificationsOfUserData:self.userData];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    NSMutableArray<NSSet<NSString *> *> *nestedChanges = [NSMutableArray array];
+    id nestedObserver = [self.userData.preferences addObserverForPath:@"a/x" inDomain:@"test" usingBlock:^(NSSet<NSString *> * _Nonnull paths) {
+        [nestedChanges addObject:paths];
+    }];
+    XCTAssertNotNil(nestedObserver);
+    
+    NSMutableArray<NSSet<NSString *> *> *domainChanges = [NSMutableArray array];
+    id domainObserver = [self.userData.preferences addObserverForPath:nil inDomain:@"test" usingBlock:^(NSSet<NSString *> * _Nonnull paths) {
+        [domainChanges addObject:paths];
+    }];
+    
+    id otherDomainObserver = [self.userData.preferences addObserverForPath:@"a" inDomain:@"other" usingBlock:^(NSSet<NSString *> * _Nonnull paths) {
+        XCTFail(@"No change is expected in other domains");
+    }];
+    
+    XCTAssertNil([self.userData.preferences addObserverForPath:@"/" inDomain:@"test" usingBlock:^(NSSet<NSString *> * _Nonnull paths) {}]);
+    
+    [self.userData.preferences setString:@"v" atPath:@"a/x/y" inDomain:@"test"];
+    [self.userData.preferences setString:@"s" atPath:@"b" inDomain:@"test"];
+    [self.userData.preferences removeObjectsAtPaths:@[@"a"] inDomain:@"test"];
+    
+    [self expectationForPendingNotificationsOfUserData:self.userData];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    // Changes to parents are reported at the observed path
+    XCTAssertEqualObjects(nestedChanges, (@[ [NSSet setWithObject:@"a/x/y"], [NSSet setWithObject:@"a/x"] ]));
+    XCTAssertEqualObjects(domainChanges, (@[ [NSSet setWithObject:@"a/x/y"], [NSSet setWithObject:@"b"], [NSSet setWithObject:@"a"] ]));
+    
+    [self.userData.preferences removeObserver:nestedObserver];
+    [self.userData.preferences setString:@"z" atPath:@"a/x/y" inDomain:@"test"];
+    
+    [self expectationForPendingNotificationsOfUserData:self.userData];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+    
+    XCTAssertEqual(nestedChanges.count, 2);
+    XCTAssertEqual(domainChanges.count, 4);
+    
+    [self.userData.preferences removeObserver:domainObserver];
+    [self.userData.preferences removeObserver:otherDomainObserver];
+}
+
+- (void)testJournalReplay
+{
+    NSString *fileName = [NSUUID.UUID.UUIDString stringByAppendingPathExtension:@"prefs"];
+    NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+    
+    SRGPreferencesJournal *journal = [[SRGPreferencesJournal alloc] initForPreferencesFileWithURL:fileURL];
+    [journal appendRecordWithObject:@"x" atPath:@"s" inDomain:@"test"];
+    [journal appendRecordWithObject:@{ @"n" : @1012 } atPath:@"path/to" inDomain:@"test"];
+    [journal appendRecordWithObject:nil atPath:@"s" inDomain:@"test"];
+    [journal synchronize];
+    
+    NSMutableArray *records = [NSMutableArray array];
+    SRGPreferencesJournal *restoredJournal = [[SRGPreferencesJournal alloc] initForPreferencesFileWithURL:fileURL];
+    [restoredJournal enumerateRecordsUsingBlock:^(id _Nullable object, NSString * _Nullable path, NSString * _Nonnull domain) {
+        [records addObject:@[ object ?: NSNull.null, path, domain ]];
+    }];
+    
+    NSArray *expectedRecords = @[ @[ @"x", @"s", @"test" ],
+                                  @[ @{ @"n" : @1012 }, @"path/to", @"test" ],
+                                  @[ NSNull.null, @"s", @"test" ] ];
+    XCTAssertEqualObjects(records, expectedRecords);
+    
+    // Records are discarded once a snapshot has been saved
+    [restoredJournal saveSnapshotWithDictionary:@{ @"test" : @{ @"path" : @{ @"to" : @{ @"n" : @1012 } } } }];
+    [restoredJournal synchronize];
+    
+    XCTAssertTrue([NSFileManager.defaultManager fileExistsAtPath:fileURL.path]);
+    
+    __block NSUInteger recordCount = 0;
+    [[[SRGPreferencesJournal alloc] initForPreferencesFileWithURL:fileURL] enumerateRecordsUsingBlock:^(id _Nullable object, NSString * _Nullable path, NSString * _Nonnull domain) {
+        ++recordCount;
+    }];
+    XCTAssertEqual(recordCount, 0);
+    
+    [restoredJournal erase];
+    [restoredJournal synchronize];
+    
+    XCTAssertFalse([NSFileManager.defaultManager fileExistsAtPath:fileURL.path]);
+}
+
+- (void)testJournalAppendAfterTruncatedRecord
+{
+    NSString *fileName = [NSUUID.UUID.UUIDString stringByAppendingPathExtension:@"prefs"];
+    NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+    
+    SRGPreferencesJournal *journal = [[SRGPreferencesJournal alloc] initForPreferencesFileWithURL:fileURL];
+    [journal appendRecordWithObject:@"x" atPath:@"s" inDomain:@"test"];
+    [journal appendRecordWithObject:@"y" atPath:@"t" inDomain:@"test"];
+    [journal synchronize];
+    
+    // Simulate a crash while the last record was being written
+    NSURL *journalFileURL = [fileURL URLByAppendingPathExtension:@"journal"];
+    NSData *data = [NSData dataWithContentsOfURL:journalFileURL];
+    XCTAssertTrue([[data subdataWithRange:NSMakeRange(0, data.length - 5)] writeToURL:journalFileURL atomically:YES]);
+    
+    SRGPreferencesJournal *truncatedJournal = [[SRGPreferencesJournal alloc] initForPreferencesFileWithURL:fileURL];
+    [truncatedJournal appendRecordWithObject:@"z" atPath:@"u" inDomain:@"test"];
+    [truncatedJournal synchronize];
+    
+    NSMutableArray *records = [NSMutableArray array];
+    [[[SRGPreferencesJournal alloc] initForPreferencesFileWithURL:fileURL] enumerateRecordsUsingBlock:^(id _Nullable object, NSString * _Nullable path, NSString * _Nonnull domain) {
+        [records addObject:@[ object ?: NSNull.null, path, domain ]];
+    }];
+    
+    NSArray *expectedRecords = @[ @[ @"x", @"s", @"test" ],
+                                  @[ @"z", @"u", @"test" ] ];
+    XCTAssertEqualObjects(records, expectedRecords);
+}
+
+- (void)testSetPerformanceWithLargePreferences
+{
+    // Roughly 1 MB of preferences
+    NSMutableDictionary *dictionary = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < 10000; ++i) {
+        dictionary[@(i).stringValue] = @{ @"title" : [@"" stringByPaddingToLength:80 withString:@"x" startingAtIndex:0],
+                                          @"count" : @(i) };
+    }
+    [self.userData.preferences setDictionary:dictionary atPath:@"large" inDomain:@"test"];
+    
+    __block NSUInteger value = 0;
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 100; ++i) {
+            [self.userData.preferences setString:@(value).stringValue atPath:@"small/s" inDomain:@"test"];
+            ++value;
+        }
+    }];
+}
+
+- (void)testChangelogCoalescing
+{
+    NSString *fileName = [NSUUID.UUID.UUIDString stringByAppendingPathExtension:@"prefs"];
+    NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+    
+    SRGPreferencesChangelog *changelog = [[SRGPreferencesChangelog alloc] initForPreferencesFileWithURL:fileURL];
+    [changelog addEntry:[SRGPreferencesChangelogEntry changelogEntryWithObject:@"x" atPath:@"s" inDomain:@"test"]];
+    [changelog addEntry:[SRGPreferencesChangelogEntry changelogEntryWithObject:@1012 atPath:@"n" inDomain:@"test"]];
+    [changelog addEntry:[SRGPreferencesChangelogEntry changelogEntryWithObject:@"y" atPath:@"s" inDomain:@"test"]];
+    [changelog addEntry:[SRGPreferencesChangelogEntry changelogEntryWithObject:nil atPath:@"/n/" inDomain:@"test"]];
+    [changelog addEntry:[SRGPreferencesChangelogEntry changelogEntryWithObject:@"z" atPath:@"s" inDomain:@"other_test"]];
+    
+    NSArray<SRGPreferencesChangelogEntry *> *entries = changelog.entries;
+    XCTAssertEqual(entries.count, 3);
+    XCTAssertEqualObjects(entries[0].object, @"y");
+    XCTAssertEqualObjects(entries[0].domain, @"test");
+    XCTAssertNil(entries[1].object);
+    XCTAssertEqualObjects(entries[1].domain, @"test");
+    XCTAssertEqualObjects(entries[2].object, @"z");
+    XCTAssertEqualObjects(entries[2].domain, @"other_test");
+    
+    // Acknowledging a superseded entry does not remove the pending one
+    SRGPreferencesChangelogEntry *pushedEntry = entries[0];
+    [changelog addEntry:[SRGPreferencesChangelogEntry changelogEntryWithObject:@"w" atPath:@"s" inDomain:@"test"]];
+    [changelog removeEntry:pushedEntry];
+    [changelog removeEntry:entries[1]];
+    
+    entries = changelog.entries;
+    XCTAssertEqual(entries.count, 2);
+    XCTAssertEqualObjects(entries[0].object, @"z");
+    XCTAssertEqualObjects(entries[1].object, @"w");
+    
+    // The same entries are restored
+    [changelog synchronize];
+    
+    NSArray<SRGPreferencesChangelogEntry *> *restoredEntries = [[SRGPreferencesChangelog alloc] initForPreferencesFileWithURL:fileURL].entries;
+    XCTAssertEqualObjects(restoredEntries, entries);
+    
+    [changelog removeAllEntries];
+    [changelog synchronize];
+    
+    XCTAssertEqual([[SRGPreferencesChangelog alloc] initForPreferencesFileWithURL:fileURL].entries.count, 0);
+}
+
+- (void)testChangelogCompaction
+{
+    NSString *fileName = [NSUUID.UUID.UUIDString stringByAppendingPathExtension:@"prefs"];
+    NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+    
+    SRGPreferencesChangelog *changelog = [[SRGPreferencesChangelog alloc] initForPreferencesFileWithURL:fileURL];
+    for (NSUInteger i = 0; i < 10000; ++i) {
+        [changelog addEntry:[SRGPreferencesChangelogEntry changelogEntryWithObject:@(i) atPath:@(i % 10).stringValue inDomain:@"test"]];
+    }
+    [changelog synchronize];
+    
+    XCTAssertEqual(changelog.entries.count, 10);
+    
+    NSArray<SRGPreferencesChangelogEntry *> *restoredEntries = [[SRGPreferencesChangelog alloc] initForPreferencesFileWithURL:fileURL].entries;
+    XCTAssertEqualObjects(restoredEntries, changelog.entries);
+    XCTAssertEqualObjects(restoredEntries.lastObject.object, @9999);
+    
+    NSURL *changelogFileURL = [fileURL URLByAppendingPathExtension:@"changelog"];
+    NSDictionary<NSFileAttributeKey, id> *attributes = [NSFileManager.defaultManager attributesOfItemAtPath:changelogFileURL.path error:NULL];
+    XCTAssertLessThan(attributes.fileSize, 32 * 1024);
+}
+
+- (void)testChangelogAppendAfterTruncatedRecord
+{
+    NSString *fileName = [NSUUID.UUID.UUIDString stringByAppendingPathExtension:@"prefs"];
+    NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+    
+    SRGPreferencesChangelog *changelog = [[SRGPreferencesChangelog alloc] initForPreferencesFileWithURL:fileURL];
+    [changelog addEntry:[SRGPreferencesChangelogEntry changelogEntryWithObject:@"x" atPath:@"s" inDomain:@"test"]];
+    [changelog addEntry:[SRGPreferencesChangelogEntry changelogEntryWithObject:@"y" atPath:@"t" inDomain:@"test"]];
+    [changelog synchronize];
+    
+    // Simulate a crash while the last record was being written
+    NSURL *changelogFileURL = [fileURL URLByAppendingPathExtension:@"changelog"];
+    NSData *data = [NSData dataWithContentsOfURL:changelogFileURL];
+    XCTAssertTrue([[data subdataWithRange:NSMakeRange(0, data.length - 5)] writeToURL:changelogFileURL atomically:YES]);
+    
+    SRGPreferencesChangelog *truncatedChangelog = [[SRGPreferencesChangelog alloc] initForPreferencesFileWithURL:fileURL];
+    XCTAssertEqual(truncatedChangelog.entries.count, 1);
+    
+    [truncatedChangelog addEntry:[SRGPreferencesChangelogEntry changelogEntryWithObject:@"z" atPath:@"u" inDomain:@"test"]];
+    [truncatedChangelog synchronize];
+    
+    NSArray<SRGPreferencesChangelogEntry *> *restoredEntries = [[SRGPreferencesChangelog alloc] initForPreferencesFileWithURL:fileURL].entries;
+    XCTAssertEqual(restoredEntries.count, 2);
+    XCTAssertEqualObjects(restoredEntries.firstObject.object, @"x");
+    XCTAssertEqualObjects(restoredEntries.lastObject.object, @"z");
+}
+
+- (void)testChangelogAppendPerformance
+{
+    [self measureBlock:^{
+        NSString *fileName = [NSUUID.UUID.UUIDString stringByAppendingPathExtension:@"prefs"];
+        NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+        
+        SRGPreferencesChangelog *changelog = [[SRGPreferencesChangelog alloc] initForPreferencesFileWithURL:fileURL];
+        for (NSUInteger i = 0; i < 5000; ++i) {
+            [changelog addEntry:[SRGPreferencesChangelogEntry changelogEntryWithObject:@(i) atPath:@(i).stringValue inDomain:@"test"]];
+        }
+        [changelog synchronize];
+    }];
+}
+
+- (void)testPipelinedPush
+{
+    NSArray<SRGPreferencesChangelogEntry *> *entries = [self changelogEntriesWithCount:200];
+    NSUInteger maximumRunningCount = [self pushEntries:entries withMaximumConcurrentPushCount:4 latency:0.005];
+    XCTAssertEqual(maximumRunningCount, 4);
+}
+
+- (void)testPushError
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Push finished"];
+    
+    NSArray<SRGPreferencesChangelogEntry *> *entries = [self changelogEntriesWithCount:50];
+    
+    __block NSUInteger pushCount = 0;
+    SRGPreferencesPushScheduler *scheduler = [[SRGPreferencesPushScheduler alloc] initWithEntries:entries maximumConcurrentPushCount:4 pushBlock:^(SRGPreferencesChangelogEntry * _Nonnull entry, SRGPreferencesPushCompletionBlock  _Nonnull completionBlock) {
+        NSUInteger index = ++pushCount;
+        NSError *error = (index == 10) ? [NSError errorWithDomain:@"test" code:1012 userInfo:nil] : nil;
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            completionBlock(error);
+        });
+    }];
+    [scheduler startWithCompletionBlock:^(NSError * _Nullable error) {
+        XCTAssertEqualObjects(error.domain, @"test");
+        XCTAssertEqual(error.code, 1012);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:30. handler:nil];
+    
+    // No push must be started after the error
+    XCTAssertLessThan(pushCount, 10 + 4);
+}
+
+- (void)testSequentialPushPerformance
+{
+    NSArray<SRGPreferencesChangelogEntry *> *entries = [self changelogEntriesWithCount:200];
+    [self measureBlock:^{
+        [self pushEntries:entries withMaximumConcurrentPushCount:1 latency:0.005];
+    }];
+}
+
+- (void)testPipelinedPushPerformance
+{
+    NSArray<SRGPreferencesChangelogEntry *> *entries = [self changelogEntriesWithCount:200];
+    [self measureBlock:^{
+        [self pushEntries:entries withMaximumConcurrentPushCount:4 latency:0.005];
+    }];
+}
+
+- (void)testSnapshotSharing
+{
+    [self.userData.preferences setDictionary:@{ @"x" : @{ @"y" : @"z" } } atPath:@"a" inDomain:@"test"];
+    [self.userData.preferences setString:@"s" atPath:@"b/c" inDomain:@"test"];
+    
+    // Reads return the stored snapshot, without copying it
+    NSDictionary *dictionary = [self.userData.preferences dictionaryAtPath:@"a" inDomain:@"test"];
+    XCTAssertEqual([self.userData.preferences dictionaryAtPath:@"a" inDomain:@"test"], dictionary);
+    
+    // Changes made elsewhere in the tree do not copy unrelated branches
+    [self.userData.preferences setString:@"t" atPath:@"b/c" inDomain:@"test"];
+    XCTAssertEqual([self.userData.preferences dictionaryAtPath:@"a" inDomain:@"test"], dictionary);
+    
+    // Changes made along the path produce a new snapshot, leaving previously returned ones untouched
+    [self.userData.preferences setString:@"w" atPath:@"a/x/y" inDomain:@"test"];
+    XCTAssertNotEqual([self.userData.preferences dictionaryAtPath:@"a" inDomain:@"test"], dictionary);
+    XCTAssertEqualObjects(dictionary, (@{ @"x" : @{ @"y" : @"z" } }));
+    XCTAssertEqualObjects([self.userData.preferences dictionaryAtPath:@"a" inDomain:@"test"], (@{ @"x" : @{ @"y" : @"w" } }));
+}
+
+- (void)testMutableObjectCopy
+{
+    NSMutableArray *array = [NSMutableArray arrayWithObject:@"x"];
+    NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithObject:array forKey:@"a"];
+    [self.userData.preferences setDictionary:dictionary atPath:@"d" inDomain:@"test"];
+    
+    [array addObject:@"y"];
+    dictionary[@"b"] = @"z";
+    
+    XCTAssertEqualObjects([self.userData.preferences dictionaryAtPath:@"d" inDomain:@"test"], (@{ @"a" : @[ @"x" ] }));
+}
+
+- (void)testConcurrentReadsAndWrites
+{
+    [self.userData.preferences setNumber:@0 atPath:@"counter" inDomain:@"test"];
+    
+    dispatch_apply(1000, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        if (i % 10 == 0) {
+            [self.userData.preferences setNumber:@(i) atPath:[NSString stringWithFormat:@"values/%@", @(i)] inDomain:@"test"];
+        }
+        else {
+            XCTAssertEqualObjects([self.userData.preferences numberAtPath:@"counter" inDomain:@"test"], @0);
+            [self.userData.preferences dictionaryAtPath:@"values" inDomain:@"test"];
+        }
+    });
+    
+    XCTAssertEqual([self.userData.preferences dictionaryAtPath:@"values" inDomain:@"test"].count, 100);
+}
+
+- (void)testConcurrentReadPerformance
+{
+    [self.userData.preferences setNumber:@1012 atPath:@"path/to/n" inDomain:@"test"];
+    
+    [self measureBlock:^{
+        dispatch_apply(8, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+            for (NSUInteger j = 0; j < 100000; ++j) {
+                [self.userData.preferences numberAtPath:@"path/to/n" inDomain:@"test"];
+            }
+        });
+    }];
+}
+
+- (void)testBinarySnapshot
+{
+    NSDictionary *dictionary = @{ @"test" : @{ @"string" : @"x",
+                                               @"unicode" : @"éà😀",
+                                               @"été" : @"key",
+                                               @"integer" : @(-1012),
+                                               @"large_integer" : @(INT64_MAX),
+                                               @"double" : @3.14,
+                                               @"true" : @YES,
+                                               @"false" : @NO,
+                                               @"array" : @[ @1, @"2", @[ @3 ], @{ @"4" : @5 } ],
+                                               @"empty" : @{} } };
+    
+    NSError *error = nil;
+    NSData *data = [SRGPreferencesSnapshot dataWithDictionary:dictionary format:SRGPreferencesSnapshotFormatBinary error:&error];
+    XCTAssertNotNil(data);
+    XCTAssertNil(error);
+    
+    NSDictionary *decodedDictionary = [SRGPreferencesSnapshot dictionaryWithData:data error:&error];
+    XCTAssertEqualObjects(decodedDictionary, dictionary);
+    XCTAssertNil(error);
+    
+    NSDictionary *testDictionary = decodedDictionary[@"test"];
+    XCTAssertEqualObjects(testDictionary[@"été"], @"key");
+    XCTAssertNil(testDictionary[@"missing"]);
+    XCTAssertEqual([testDictionary[@"large_integer"] longLongValue], INT64_MAX);
+    XCTAssertEqual(testDictionary[@"true"], @YES);
+    XCTAssertEqual(testDictionary[@"false"], @NO);
+    
+    // Decoded values are cached
+    XCTAssertEqual(testDictionary[@"array"], testDictionary[@"array"]);
+    XCTAssertEqual(decodedDictionary.copy, decodedDictionary);
+    
+    // JSON data is still supported
+    NSData *JSONData = [SRGPreferencesSnapshot dataWithDictionary:dictionary format:SRGPreferencesSnapshotFormatJSON error:NULL];
+    XCTAssertEqualObjects([SRGPreferencesSnapshot dictionaryWithData:JSONData error:NULL], dictionary);
+}
+
+- (void)testInvalidBinarySnapshot
+{
+    NSData *data = [SRGPreferencesSnapshot dataWithDictionary:@{ @"test" : @{ @"a" : @"b" } } format:SRGPreferencesSnapshotFormatBinary error:NULL];
+    XCTAssertNotNil(data);
+    
+    NSError *error = nil;
+    XCTAssertNil([SRGPreferencesSnapshot dictionaryWithData:[data subdataWithRange:NSMakeRange(0, 10)] error:&error]);
+    XCTAssertNotNil(error);
+    
+    // Offsets pointing outside the data must not be followed
+    NSMutableData *corruptData = data.mutableCopy;
+    uint32_t rootOffset = CFSwapInt32HostToLittle(UINT32_MAX);
+    [corruptData replaceBytesInRange:NSMakeRange(8, sizeof(uint32_t)) withBytes:&rootOffset];
+    XCTAssertNil([SRGPreferencesSnapshot dictionaryWithData:corruptData error:NULL]);
+    
+    NSData *truncatedData = [data subdataWithRange:NSMakeRange(0, data.length - 1)];
+    NSDictionary *truncatedDictionary = [SRGPreferencesSnapshot dictionaryWithData:truncatedData error:NULL];
+    XCTAssertNil(truncatedDictionary[@"test"][@"a"]);
+    
+    // Objects which cannot be stored in JSON cannot be stored in binary format either
+    XCTAssertNil([SRGPreferencesSnapshot dataWithDictionary:@{ @"date" : NSDate.date } format:SRGPreferencesSnapshotFormatBinary error:&error]);
+    XCTAssertNotNil(error);
+}
+
+- (void)testCyclicBinarySnapshot
+{
+    // Header, then key "a" at offset 12, an array at offset 17 and the root dictionary at offset 26
+    const uint8_t bytes[] = {
+        'S', 'R', 'G', 'P', 1, 0, 0, 0, 26, 0, 0, 0,
+        1, 0, 0, 0, 'a',
+        7, 1, 0, 0, 0, 17, 0, 0, 0,
+        8, 1, 0, 0, 0, 12, 0, 0, 0, 17, 0, 0, 0
+    };
+    NSData *data = [NSData dataWithBytes:bytes length:sizeof(bytes)];
+    
+    // An array containing itself cannot be read
+    NSDictionary *dictionary = [SRGPreferencesSnapshot dictionaryWithData:data error:NULL];
+    XCTAssertEqualObjects(dictionary.allKeys, @[ @"a" ]);
+    XCTAssertNil(dictionary[@"a"]);
+    
+    // A dictionary containing itself cannot be read either
+    NSMutableData *cyclicData = data.mutableCopy;
+    uint32_t valueOffset = CFSwapInt32HostToLittle(26);
+    [cyclicData replaceBytesInRange:NSMakeRange(35, sizeof(uint32_t)) withBytes:&valueOffset];
+    
+    NSDictionary *cyclicDictionary = [SRGPreferencesSnapshot dictionaryWithData:cyclicData error:NULL];
+    XCTAssertEqualObjects(cyclicDictionary.allKeys, @[ @"a" ]);
+    XCTAssertNil(cyclicDictionary[@"a"]);
+}
+
+- (void)testBinarySnapshotJournal
+{
+    NSString *fileName = [NSUUID.UUID.UUIDString stringByAppendingPathExtension:@"prefs"];
+    NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+    
+    NSDictionary *dictionary = @{ @"test" : @{ @"path" : @{ @"to" : @{ @"n" : @1012 } } } };
+    
+    // Start with a JSON snapshot, then switch to binary
+    SRGPreferencesJournal *journal = [[SRGPreferencesJournal alloc] initForPreferencesFileWithURL:fileURL];
+    [journal saveSnapshotWithDictionary:dictionary];
+    [journal synchronize];
+    
+    XCTAssertEqualObjects([SRGPreferencesSnapshot dictionaryWithContentsOfFileURL:fileURL error:NULL], dictionary);
+    
+    journal.snapshotFormat = SRGPreferencesSnapshotFormatBinary;
+    [journal saveSnapshotWithDictionary:dictionary];
+    [journal synchronize];
+    
+    NSData *data = [NSData dataWithContentsOfURL:fileURL];
+    XCTAssertNil([NSJSONSerialization JSONObjectWithData:data options:0 error:NULL]);
+    XCTAssertEqualObjects([SRGPreferencesSnapshot dictionaryWithContentsOfFileURL:fileURL error:NULL], dictionary);
+    
+    [journal erase];
+    [journal synchronize];
+}
+
+- (void)testJSONSnapshotLoadPerformance
+{
+    NSData *data = [SRGPreferencesSnapshot dataWithDictionary:[self largePreferenceDictionary] format:SRGPreferencesSnapshotFormatJSON error:NULL];
+    [self measureSnapshotLoadWithData:data];
+}
+
+- (void)testBinarySnapshotLoadPerformance
+{
+    NSData *data = [SRGPreferencesSnapshot dataWithDictionary:[self largePreferenceDictionary] format:SRGPreferencesSnapshotFormatBinary error:NULL];
+    [self measureSnapshotLoadWithData:data];
+}
+
 @end
@@ -19,6 +19,11 @@ OBJC_EXPORT NSURL *TestHistoryServiceURL(void);
  */
 OBJC_EXPORT NSURL *TestPlaylistsServiceURL(void);
 
+/**
+ *  The URL of the preferences service.
+ */
+OBJC_EXPORT NSURL *TestPreferencesServiceURL(void);
+
 /**
  *  Base class for user data tests. Provides helpers to create a user data store and to perform remote insertions
  *  or deletions for synchronization test purposes. Setup is reset at the end of each test.
@@ -60,6 +65,11 @@ OBJC_EXPORT NSURL *TestPlaylistsServiceURL(void);
  */
 - (XCTestExpectation *)expectationForElapsedTimeInterval:(NSTimeInterval)timeInterval withHandler:(nullable void (^)(void))handler;
 
+/**
+ *  Expectation fulfilled once all notifications posted so far by the specified user data have been delivered.
+ */
+- (XCTestExpectation *)expectationForPendingNotificationsOfUserData:(SRGUserData *)userData;
+
 @end
 
 /**
@@ -100,6 +110,52 @@ OBJC_EXPORT NSURL *TestPlaylistsServiceURL(void);
 
 @end
 
+/**
+ *  Local stand-in for the user data service, so that synchronization can be tested without depending on the real
+ *  service. Once setup, all requests made to the service URL, including those of remote test data helpers, are served
+ *  from memory. The stand-in is removed at the end of each test.
+ */
+@interface UserDataBaseTestCase (LocalService)
+
+/**
+ *  Setup test conditions with the local stand-in, responding after the specified latency (in seconds). Remote data
+ *  is kept if the stand-in was already setup during the test.
+ */
+- (void)setupForLocalServiceWithLatency:(NSTimeInterval)latency;
+
+/**
+ *  The requests received by the local stand-in, in the order in which they were received.
+ */
+@property (nonatomic, readonly) NSArray<NSURLRequest *> *localServiceRequests;
+
+/**
+ *  The requests received by the local stand-in for the specified service (e.g. `TestPlaylistsServiceURL()`).
+ */
+- (NSArray<NSURLRequest *> *)localServiceRequestsToServiceURL:(NSURL *)serviceURL;
+
+/**
+ *  The maximum number of requests the local stand-in has been processing at the same time.
+ */
+@property (nonatomic, readonly) NSUInteger localServiceMaximumConcurrentRequestCount;
+
+/**
+ *  The maximum number of requests the local stand-in has been processing at the same time for the specified service.
+ */
+- (NSUInteger)localServiceMaximumConcurrentRequestCountToServiceURL:(NSURL *)serviceURL;
+
+/**
+ *  Forget about requests received so far.
+ */
+- (void)resetLocalServiceRequests;
+
+/**
+ *  If set to `YES`, the local stand-in returns playlist updates without server date, as services not supporting
+ *  updates do. Default is `NO`.
+ */
+@property (nonatomic, getter=isLocalServicePlaylistsServerDateOmitted) BOOL localServicePlaylistsServerDateOmitted;
+
+@end
+
 /**
  *  Session management.
  */
@@ -10,6 +10,7 @@
 #import "SRGHistoryRequest.h"
 #import "SRGPlaylistsRequest.h"
 #import "SRGPreferencesRequest.h"
+#import "SRGUserData+Private.h"
 #import "SRGUserObject+Private.h"
 
 @import libextobjc;
@@ -82,11 +83,453 @@ static NSURL *TestLoginCallbackURL(SRGIdentityService *identityService, NSString
 
 #endif
 
+// Internal key under which the stand-in stores the timestamp of the last modification of a record.
+static NSString * const LocalUserDataServiceTimestampKey = @"_timestamp";
+
+/**
+ *  In-memory stand-in for the history, playlists and preferences services, responding after some latency. Only the
+ *  subset of the service behavior needed by tests is implemented.
+ */
+@interface LocalUserDataService : NSObject
+
+- (instancetype)initWithLatency:(NSTimeInterval)latency;
+
+- (HTTPStubsResponse *)responseForRequest:(NSURLRequest *)request;
+
+@property (nonatomic, readonly) NSArray<NSURLRequest *> *requests;
+@property (nonatomic, readonly) NSUInteger maximumConcurrentRequestCount;
+
+@property (nonatomic, getter=isPlaylistsServerDateOmitted) BOOL playlistsServerDateOmitted;
+
+- (NSUInteger)maximumConcurrentRequestCountForService:(NSString *)service;
+
+- (void)resetRequests;
+
+@end
+
+@interface LocalUserDataService ()
+
+@property (nonatomic) NSTimeInterval latency;
+
+@property (nonatomic) NSMutableArray<NSURLRequest *> *receivedRequests;
+@property (nonatomic) NSUInteger runningRequestCount;
+@property (nonatomic) NSUInteger maximumConcurrentRequestCount;
+@property (nonatomic) NSMutableDictionary<NSString *, NSNumber *> *runningServiceRequestCounts;
+@property (nonatomic) NSMutableDictionary<NSString *, NSNumber *> *maximumConcurrentServiceRequestCounts;
+
+@property (nonatomic) long long lastTimestamp;
+
+@property (nonatomic) NSMutableDictionary<NSString *, NSDictionary *> *historyEntries;
+@property (nonatomic) NSMutableDictionary<NSString *, NSDictionary *> *playlists;
+@property (nonatomic) NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSDictionary *> *> *playlistEntries;
+@property (nonatomic) NSMutableDictionary<NSString *, id> *preferences;
+@property (nonatomic) NSMutableDictionary<NSString *, NSNumber *> *preferenceVersions;
+
+@end
+
+@implementation LocalUserDataService
+
+#pragma mark Class methods
+
+// Strip internal information from a stored record
++ (NSDictionary *)publicDictionaryFromRecord:(NSDictionary *)record
+{
+    NSMutableDictionary *dictionary = record.mutableCopy;
+    [dictionary removeObjectForKey:LocalUserDataServiceTimestampKey];
+    return dictionary.copy;
+}
+
++ (NSArray<NSDictionary *> *)publicDictionariesFromRecords:(NSArray<NSDictionary *> *)records afterTimestamp:(NSNumber *)timestamp withDeleted:(BOOL)withDeleted
+{
+    NSMutableArray<NSDictionary *> *dictionaries = [NSMutableArray array];
+    NSSortDescriptor *sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:LocalUserDataServiceTimestampKey ascending:YES];
+    for (NSDictionary *record in [records sortedArrayUsingDescriptors:@[ sortDescriptor ]]) {
+        if (timestamp && [record[LocalUserDataServiceTimestampKey] longLongValue] <= timestamp.longLongValue) {
+            continue;
+        }
+        if (! withDeleted && [record[@"deleted"] boolValue]) {
+            continue;
+        }
+        [dictionaries addObject:[self publicDictionaryFromRecord:record]];
+    }
+    return dictionaries.copy;
+}
+
++ (HTTPStubsResponse *)responseWithJSONObject:(id)JSONObject
+{
+    NSData *data = [NSJSONSerialization dataWithJSONObject:JSONObject options:0 error:NULL];
+    return [HTTPStubsResponse responseWithData:data statusCode:200 headers:@{ @"Content-Type" : @"application/json" }];
+}
+
++ (HTTPStubsResponse *)responseWithStatusCode:(int)statusCode
+{
+    return [HTTPStubsResponse responseWithData:[NSData data] statusCode:statusCode headers:nil];
+}
+
+#pragma mark Object lifecycle
+
+- (instancetype)initWithLatency:(NSTimeInterval)latency
+{
+    if (self = [super init]) {
+        self.latency = latency;
+        self.receivedRequests = [NSMutableArray array];
+        self.runningServiceRequestCounts = [NSMutableDictionary dictionary];
+        self.maximumConcurrentServiceRequestCounts = [NSMutableDictionary dictionary];
+        [self eraseData];
+    }
+    return self;
+}
+
+#pragma mark Getters and setters
+
+- (NSArray<NSURLRequest *> *)requests
+{
+    @synchronized(self) {
+        return self.receivedRequests.copy;
+    }
+}
+
+- (NSUInteger)maximumConcurrentRequestCountForService:(NSString *)service
+{
+    @synchronized(self) {
+        return self.maximumConcurrentServiceRequestCounts[service].unsignedIntegerValue;
+    }
+}
+
+#pragma mark Requests
+
+- (void)resetRequests
+{
+    @synchronized(self) {
+        [self.receivedRequests removeAllObjects];
+        self.maximumConcurrentRequestCount = 0;
+        [self.maximumConcurrentServiceRequestCounts removeAllObjects];
+    }
+}
+
+- (HTTPStubsResponse *)responseForRequest:(NSURLRequest *)request
+{
+    HTTPStubsResponse *response = nil;
+    NSString *service = nil;
+    @synchronized(self) {
+        // Path components relative to the service URL
+        NSArray<NSString *> *servicePathComponents = TestServiceURL().pathComponents;
+        NSArray<NSString *> *pathComponents = request.URL.pathComponents;
+        if (pathComponents.count > servicePathComponents.count) {
+            pathComponents = [pathComponents subarrayWithRange:NSMakeRange(servicePathComponents.count, pathComponents.count - servicePathComponents.count)];
+        }
+        else {
+            pathComponents = @[];
+        }
+        
+        NSMutableDictionary<NSString *, NSString *> *parameters = [NSMutableDictionary dictionary];
+        for (NSURLQueryItem *queryItem in [NSURLComponents componentsWithURL:request.URL resolvingAgainstBaseURL:NO].queryItems) {
+            parameters[queryItem.name] = queryItem.value;
+        }
+        
+        service = pathComponents.firstObject ?: @"";
+        
+        [self.receivedRequests addObject:request];
+        self.runningRequestCount += 1;
+        self.maximumConcurrentRequestCount = MAX(self.runningRequestCount, self.maximumConcurrentRequestCount);
+        
+        NSUInteger runningServiceRequestCount = self.runningServiceRequestCounts[service].unsignedIntegerValue + 1;
+        self.runningServiceRequestCounts[service] = @(runningServiceRequestCount);
+        self.maximumConcurrentServiceRequestCounts[service] = @(MAX(runningServiceRequestCount, self.maximumConcurrentServiceRequestCounts[service].unsignedIntegerValue));
+        
+        NSArray<NSString *> *resourcePathComponents = (pathComponents.count > 0) ? [pathComponents subarrayWithRange:NSMakeRange(1, pathComponents.count - 1)] : @[];
+        if ([service isEqualToString:@"history"]) {
+            response = [self historyResponseForRequest:request pathComponents:resourcePathComponents parameters:parameters];
+        }
+        else if ([service isEqualToString:@"playlist"]) {
+            response = [self playlistsResponseForRequest:request pathComponents:resourcePathComponents parameters:parameters];
+        }
+        else if ([service isEqualToString:@"preference"]) {
+            response = [self preferencesResponseForRequest:request pathComponents:resourcePathComponents];
+        }
+        else if ([service isEqualToString:@"data"] && [request.HTTPMethod isEqualToString:@"DELETE"]) {
+            [self eraseData];
+            response = [LocalUserDataService responseWithStatusCode:204];
+        }
+        else {
+            response = [LocalUserDataService responseWithStatusCode:404];
+        }
+    }
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.latency * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        @synchronized(self) {
+            self.runningRequestCount -= 1;
+            self.runningServiceRequestCounts[service] = @(self.runningServiceRequestCounts[service].unsignedIntegerValue - 1);
+        }
+    });
+    return [response requestTime:self.latency responseTime:0.];
+}
+
+#pragma mark Data
+
+// Must be called within a synchronized block. Timestamps are strictly increasing, so that updates made in the same
+// millisecond can still be told apart.
+- (NSNumber *)nextTimestamp
+{
+    long long timestamp = (long long)round(NSDate.date.timeIntervalSince1970 * 1000.);
+    self.lastTimestamp = MAX(timestamp, self.lastTimestamp + 1);
+    return @(self.lastTimestamp);
+}
+
+- (void)eraseData
+{
+    self.historyEntries = [NSMutableDictionary dictionary];
+    self.playlists = [NSMutableDictionary dictionary];
+    self.playlistEntries = [NSMutableDictionary dictionary];
+    self.preferences = [NSMutableDictionary dictionary];
+    self.preferenceVersions = [NSMutableDictionary dictionary];
+    
+    // The watch later playlist always exists
+    [self touchPlaylistWithUid:SRGPlaylistUidWatchLater name:nil];
+}
+
+#pragma mark History
+
+- (HTTPStubsResponse *)historyResponseForRequest:(NSURLRequest *)request pathComponents:(NSArray<NSString *> *)pathComponents parameters:(NSDictionary<NSString *, NSString *> *)parameters
+{
+    if (! [pathComponents.firstObject isEqualToString:@"v2"]) {
+        return [LocalUserDataService responseWithStatusCode:404];
+    }
+    
+    if ([request.HTTPMethod isEqualToString:@"POST"] && [pathComponents.lastObject isEqualToString:@"batch"]) {
+        NSDictionary *JSONDictionary = [NSJSONSerialization JSONObjectWithData:request.ohhttpStubs_httpBody options:0 error:NULL];
+        for (NSDictionary *dictionary in JSONDictionary[@"data"]) {
+            NSMutableDictionary *record = dictionary.mutableCopy;
+            record[LocalUserDataServiceTimestampKey] = [self nextTimestamp];
+            self.historyEntries[dictionary[@"item_id"]] = record.copy;
+        }
+        return [LocalUserDataService responseWithStatusCode:204];
+    }
+    else if ([request.HTTPMethod isEqualToString:@"GET"] && pathComponents.count == 1) {
+        NSNumber *after = parameters[@"after"] ? @(parameters[@"after"].longLongValue) : nil;
+        NSArray<NSDictionary *> *dictionaries = [LocalUserDataService publicDictionariesFromRecords:self.historyEntries.allValues
+                                                                                     afterTimestamp:after
+                                                                                        withDeleted:[parameters[@"with_deleted"] isEqualToString:@"true"]];
+        
+        NSUInteger offset = MIN((NSUInteger)parameters[@"offset"].integerValue, dictionaries.count);
+        NSUInteger limit = parameters[@"limit"] ? (NSUInteger)parameters[@"limit"].integerValue : dictionaries.count;
+        NSUInteger length = MIN(limit, dictionaries.count - offset);
+        
+        NSMutableDictionary *JSONDictionary = [NSMutableDictionary dictionary];
+        JSONDictionary[@"data"] = [dictionaries subarrayWithRange:NSMakeRange(offset, length)];
+        JSONDictionary[@"last_update"] = @(self.lastTimestamp);
+        
+        // The next page link is relative to the service version URL
+        if (offset + length < dictionaries.count) {
+            NSMutableDictionary<NSString *, NSString *> *nextParameters = parameters.mutableCopy;
+            nextParameters[@"offset"] = @(offset + length).stringValue;
+            
+            NSURLComponents *URLComponents = [[NSURLComponents alloc] init];
+            NSMutableArray<NSURLQueryItem *> *queryItems = [NSMutableArray array];
+            [nextParameters enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull name, NSString * _Nonnull value, BOOL * _Nonnull stop) {
+                [queryItems addObject:[NSURLQueryItem queryItemWithName:name value:value]];
+            }];
+            URLComponents.queryItems = queryItems.copy;
+            JSONDictionary[@"next"] = [@"?" stringByAppendingString:URLComponents.percentEncodedQuery];
+        }
+        return [LocalUserDataService responseWithJSONObject:JSONDictionary];
+    }
+    else {
+        return [LocalUserDataService responseWithStatusCode:404];
+    }
+}
+
+#pragma mark Playlists
+
+// Must be called within a synchronized block. Create the playlist if needed and mark it as modified.
+- (void)touchPlaylistWithUid:(NSString *)uid name:(NSString *)name
+{
+    NSNumber *timestamp = [self nextTimestamp];
+    
+    NSMutableDictionary *record = self.playlists[uid].mutableCopy ?: [NSMutableDictionary dictionary];
+    record[@"businessId"] = uid;
+    record[@"name"] = name ?: record[@"name"] ?: uid;
+    record[@"type"] = [uid isEqualToString:SRGPlaylistUidWatchLater] ? @"watch_later" : @"standard";
+    record[@"date"] = timestamp;
+    record[@"deleted"] = @NO;
+    record[LocalUserDataServiceTimestampKey] = timestamp;
+    self.playlists[uid] = record.copy;
+    
+    if (! self.playlistEntries[uid]) {
+        self.playlistEntries[uid] = [NSMutableDictionary dictionary];
+    }
+}
+
+- (HTTPStubsResponse *)playlistsResponseForRequest:(NSURLRequest *)request pathComponents:(NSArray<NSString *> *)pathComponents parameters:(NSDictionary<NSString *, NSString *> *)parameters
+{
+    if (! [pathComponents.firstObject isEqualToString:@"v3"]) {
+        return [LocalUserDataService responseWithStatusCode:404];
+    }
+    
+    NSNumber *after = parameters[@"after"] ? @(parameters[@"after"].longLongValue) : nil;
+    BOOL withDeleted = [parameters[@"with_deleted"] isEqualToString:@"true"];
+    
+    if (pathComponents.count == 1) {
+        if (! [request.HTTPMethod isEqualToString:@"GET"]) {
+            return [LocalUserDataService responseWithStatusCode:404];
+        }
+        
+        NSMutableDictionary *JSONDictionary = [NSMutableDictionary dictionary];
+        JSONDictionary[@"playlists"] = [LocalUserDataService publicDictionariesFromRecords:self.playlists.allValues afterTimestamp:after withDeleted:withDeleted];
+        JSONDictionary[@"last_update"] = self.playlistsServerDateOmitted ? nil : @(self.lastTimestamp);
+        return [LocalUserDataService responseWithJSONObject:JSONDictionary.copy];
+    }
+    
+    NSString *playlistUid = pathComponents[1];
+    BOOL exists = self.playlists[playlistUid] && ! [self.playlists[playlistUid][@"deleted"] boolValue];
+    
+    if (pathComponents.count == 2) {
+        if ([request.HTTPMethod isEqualToString:@"POST"]) {
+            NSDictionary *dictionary = [NSJSONSerialization JSONObjectWithData:request.ohhttpStubs_httpBody options:0 error:NULL];
+            [self touchPlaylistWithUid:playlistUid name:dictionary[@"name"]];
+            return [LocalUserDataService responseWithJSONObject:[LocalUserDataService publicDictionaryFromRecord:self.playlists[playlistUid]]];
+        }
+        else if (! exists) {
+            return [LocalUserDataService responseWithStatusCode:404];
+        }
+        else if ([request.HTTPMethod isEqualToString:@"DELETE"]) {
+            [self touchPlaylistWithUid:playlistUid name:nil];
+            
+            NSMutableDictionary *record = self.playlists[playlistUid].mutableCopy;
+            record[@"deleted"] = @YES;
+            self.playlists[playlistUid] = record.copy;
+            [self.playlistEntries removeObjectForKey:playlistUid];
+            return [LocalUserDataService responseWithStatusCode:204];
+        }
+        else if ([request.HTTPMethod isEqualToString:@"GET"]) {
+            NSMutableDictionary *JSONDictionary = [NSMutableDictionary dictionary];
+            JSONDictionary[@"bookmarks"] = [LocalUserDataService publicDictionariesFromRecords:self.playlistEntries[playlistUid].allValues afterTimestamp:after withDeleted:withDeleted];
+            JSONDictionary[@"last_update"] = self.playlistsServerDateOmitted ? nil : @(self.lastTimestamp);
+            return [LocalUserDataService responseWithJSONObject:JSONDictionary.copy];
+        }
+        else {
+            return [LocalUserDataService responseWithStatusCode:404];
+        }
+    }
+    else if (pathComponents.count == 3 && [pathComponents[2] isEqualToString:@"bookmarks"] && exists) {
+        NSMutableDictionary<NSString *, NSDictionary *> *entries = self.playlistEntries[playlistUid];
+        
+        if ([request.HTTPMethod isEqualToString:@"PUT"]) {
+            NSArray<NSDictionary *> *dictionaries = [NSJSONSerialization JSONObjectWithData:request.ohhttpStubs_httpBody options:0 error:NULL];
+            NSMutableArray<NSDictionary *> *savedDictionaries = [NSMutableArray array];
+            for (NSDictionary *dictionary in dictionaries) {
+                NSNumber *timestamp = [self nextTimestamp];
+                
+                NSMutableDictionary *record = dictionary.mutableCopy;
+                record[@"date"] = dictionary[@"date"] ?: timestamp;
+                record[@"deleted"] = @NO;
+                record[LocalUserDataServiceTimestampKey] = timestamp;
+                entries[dictionary[@"itemId"]] = record.copy;
+                
+                [savedDictionaries addObject:[LocalUserDataService publicDictionaryFromRecord:record]];
+            }
+            [self touchPlaylistWithUid:playlistUid name:nil];
+            return [LocalUserDataService responseWithJSONObject:savedDictionaries];
+        }
+        else if ([request.HTTPMethod isEqualToString:@"DELETE"]) {
+            NSArray<NSString *> *uids = parameters[@"mediaIds"] ? [parameters[@"mediaIds"] componentsSeparatedByString:@","] : entries.allKeys;
+            for (NSString *uid in uids) {
+                NSMutableDictionary *record = entries[uid].mutableCopy;
+                if (! record) {
+                    continue;
+                }
+                
+                record[@"deleted"] = @YES;
+                record[LocalUserDataServiceTimestampKey] = [self nextTimestamp];
+                entries[uid] = record.copy;
+            }
+            [self touchPlaylistWithUid:playlistUid name:nil];
+            return [LocalUserDataService responseWithStatusCode:204];
+        }
+        else {
+            return [LocalUserDataService responseWithStatusCode:404];
+        }
+    }
+    else {
+        return [LocalUserDataService responseWithStatusCode:404];
+    }
+}
+
+#pragma mark Preferences
+
+- (HTTPStubsResponse *)preferencesResponseForRequest:(NSURLRequest *)request pathComponents:(NSArray<NSString *> *)pathComponents
+{
+    if (pathComponents.count == 0) {
+        return [request.HTTPMethod isEqualToString:@"GET"] ? [LocalUserDataService responseWithJSONObject:self.preferences.allKeys] : [LocalUserDataService responseWithStatusCode:404];
+    }
+    
+    NSString *domain = pathComponents.firstObject;
+    NSArray<NSString *> *keys = [pathComponents subarrayWithRange:NSMakeRange(1, pathComponents.count - 1)];
+    
+    if ([request.HTTPMethod isEqualToString:@"GET"]) {
+        id object = self.preferences[domain];
+        for (NSString *key in keys) {
+            object = [object isKindOfClass:NSDictionary.class] ? object[key] : nil;
+        }
+        if (! [object isKindOfClass:NSDictionary.class]) {
+            return [LocalUserDataService responseWithStatusCode:404];
+        }
+        
+        NSString *entityTag = [NSString stringWithFormat:@"\"%@\"", self.preferenceVersions[domain]];
+        if ([[request valueForHTTPHeaderField:@"If-None-Match"] isEqualToString:entityTag]) {
+            return [HTTPStubsResponse responseWithData:[NSData data] statusCode:304 headers:@{ @"ETag" : entityTag }];
+        }
+        
+        NSData *data = [NSJSONSerialization dataWithJSONObject:object options:0 error:NULL];
+        return [HTTPStubsResponse responseWithData:data statusCode:200 headers:@{ @"Content-Type" : @"application/json",
+                                                                                   @"ETag" : entityTag }];
+    }
+    
+    id object = nil;
+    if ([request.HTTPMethod isEqualToString:@"PUT"]) {
+        object = [NSJSONSerialization JSONObjectWithData:request.ohhttpStubs_httpBody options:NSJSONReadingFragmentsAllowed error:NULL];
+        if (! object || keys.count == 0) {
+            return [LocalUserDataService responseWithStatusCode:400];
+        }
+    }
+    else if (! [request.HTTPMethod isEqualToString:@"DELETE"]) {
+        return [LocalUserDataService responseWithStatusCode:404];
+    }
+    
+    if (keys.count == 0) {
+        [self.preferences removeObjectForKey:domain];
+    }
+    else {
+        // Intermediate dictionaries are created as needed
+        NSMutableDictionary *dictionary = [self.preferences[domain] mutableCopy] ?: [NSMutableDictionary dictionary];
+        NSMutableArray<NSMutableDictionary *> *dictionaries = [NSMutableArray arrayWithObject:dictionary];
+        for (NSString *key in [keys subarrayWithRange:NSMakeRange(0, keys.count - 1)]) {
+            NSDictionary *childDictionary = [dictionary[key] isKindOfClass:NSDictionary.class] ? dictionary[key] : nil;
+            dictionary = childDictionary.mutableCopy ?: [NSMutableDictionary dictionary];
+            [dictionaries addObject:dictionary];
+        }
+        dictionary[keys.lastObject] = object;
+        
+        for (NSInteger i = (NSInteger)keys.count - 2; i >= 0; --i) {
+            dictionaries[i][keys[i]] = dictionaries[i + 1].copy;
+        }
+        self.preferences[domain] = dictionaries.firstObject.copy;
+    }
+    
+    self.preferenceVersions[domain] = @(self.preferenceVersions[domain].integerValue + 1);
+    return [LocalUserDataService responseWithStatusCode:204];
+}
+
+@end
+
 @interface UserDataBaseTestCase ()
 
 @property (nonatomic) SRGIdentityService *identityService;
 @property (nonatomic) SRGUserData *userData;
 
+@property (nonatomic) LocalUserDataService *localService;
+@property (nonatomic) id<HTTPStubsDescriptor> localServiceStub;
+
 @end
 
 @implementation UserDataBaseTestCase
@@ -171,6 +614,12 @@ static NSURL *TestLoginCallbackURL(SRGIdentityService *identityService, NSString
 {
     self.userData = nil;
     self.identityService = nil;
+    
+    if (self.localServiceStub) {
+        [HTTPStubs removeStub:self.localServiceStub];
+        self.localServiceStub = nil;
+    }
+    self.localService = nil;
 }
 
 #pragma mark Expectations
@@ -209,6 +658,15 @@ static NSURL *TestLoginCallbackURL(SRGIdentityService *identityService, NSString
     return expectation;
 }
 
+- (XCTestExpectation *)expectationForPendingNotificationsOfUserData:(SRGUserData *)userData
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Pending notifications delivered"];
+    [userData.notificationDispatcher dispatchBlock:^{
+        [expectation fulfill];
+    }];
+    return expectation;
+}
+
 #pragma mark Data
 
 - (void)setupWithServiceURL:(NSURL *)serviceURL
@@ -237,6 +695,61 @@ static NSURL *TestLoginCallbackURL(SRGIdentityService *identityService, NSString
     [self setupWithServiceURL:[NSURL URLWithString:@"https://missing.service"]];
 }
 
+#pragma mark Local service
+
+- (void)setupForLocalServiceWithLatency:(NSTimeInterval)latency
+{
+    if (! self.localService) {
+        LocalUserDataService *localService = [[LocalUserDataService alloc] initWithLatency:latency];
+        self.localServiceStub = [HTTPStubs stubRequestsPassingTest:^BOOL(NSURLRequest * _Nonnull request) {
+            return [request.URL.host isEqualToString:TestServiceURL().host];
+        } withStubResponse:^HTTPStubsResponse * _Nonnull(NSURLRequest * _Nonnull request) {
+            return [localService responseForRequest:request];
+        }];
+        self.localService = localService;
+    }
+    
+    [self setupWithServiceURL:TestServiceURL()];
+}
+
+- (NSArray<NSURLRequest *> *)localServiceRequests
+{
+    return self.localService.requests ?: @[];
+}
+
+- (NSArray<NSURLRequest *> *)localServiceRequestsToServiceURL:(NSURL *)serviceURL
+{
+    NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(NSURLRequest * _Nullable request, NSDictionary<NSString *, id> * _Nullable bindings) {
+        return [request.URL.path hasPrefix:serviceURL.path];
+    }];
+    return [self.localServiceRequests filteredArrayUsingPredicate:predicate];
+}
+
+- (NSUInteger)localServiceMaximumConcurrentRequestCount
+{
+    return self.localService.maximumConcurrentRequestCount;
+}
+
+- (NSUInteger)localServiceMaximumConcurrentRequestCountToServiceURL:(NSURL *)serviceURL
+{
+    return [self.localService maximumConcurrentRequestCountForService:serviceURL.lastPathComponent];
+}
+
+- (void)resetLocalServiceRequests
+{
+    [self.localService resetRequests];
+}
+
+- (BOOL)isLocalServicePlaylistsServerDateOmitted
+{
+    return self.localService.playlistsServerDateOmitted;
+}
+
+- (void)setLocalServicePlaylistsServerDateOmitted:(BOOL)localServicePlaylistsServerDateOmitted
+{
+    self.localService.playlistsServerDateOmitted = localServicePlaylistsServerDateOmitted;
+}
+
 - (void)synchronizeUserData
 {
     [self.userData synchronize];
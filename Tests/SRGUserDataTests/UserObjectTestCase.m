@@ -144,6 +144,140 @@
     }];
 }
 
+- (void)testSynchronizeBatch
+{
+    NSPersistentContainer *persistentContainer = [self persistentContainerFromPackage:@"UserData_DB_loggedIn"];
+    
+    NSManagedObjectContext *viewContext = persistentContainer.viewContext;
+    [viewContext performBlockAndWait:^{
+        NSArray<SRGHistoryEntry *> *historyEntries = [SRGHistoryEntry synchronizeWithDictionaries:@[ @{ @"item_id" : @"123456",
+                                                                                                        @"date" : @1550134222000,
+                                                                                                        @"device_id" : @"other_device" },
+                                                                                                     @{},
+                                                                                                     @{ @"item_id" : @"urn:rts:video:9992865",
+                                                                                                        @"date" : @1550134222000,
+                                                                                                        @"device_id" : @"other_device" },
+                                                                                                     @{ @"item_id" : @"123456",
+                                                                                                        @"date" : @1550134223000,
+                                                                                                        @"device_id" : @"yet_another_device" } ]
+                                                                                 matchingPredicate:nil
+                                                                            inManagedObjectContext:viewContext];
+        XCTAssertEqual(historyEntries.count, 3);
+        
+        XCTAssertEqualObjects(historyEntries[0].uid, @"123456");
+        XCTAssertEqualObjects(historyEntries[0].date, [NSDate dateWithTimeIntervalSince1970:1550134223]);
+        XCTAssertEqualObjects(historyEntries[0].deviceUid, @"yet_another_device");
+        
+        XCTAssertEqualObjects(historyEntries[1].uid, @"urn:rts:video:9992865");
+        XCTAssertEqualObjects(historyEntries[1].date, [NSDate dateWithTimeIntervalSince1970:1550134222]);
+        XCTAssertEqualObjects(historyEntries[1].deviceUid, @"other_device");
+        
+        // The same object is updated twice
+        XCTAssertEqual(historyEntries[2], historyEntries[0]);
+        
+        NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass(SRGHistoryEntry.class)];
+        fetchRequest.predicate = [NSPredicate predicateWithFormat:@"%K == %@", @keypath(SRGHistoryEntry.new, uid), @"123456"];
+        XCTAssertEqual([viewContext countForFetchRequest:fetchRequest error:NULL], 1);
+    }];
+}
+
+- (void)testSynchronizeBatchPerformance
+{
+    NSPersistentContainer *persistentContainer = [self persistentContainerFromPackage:@"UserData_DB_loggedIn"];
+    
+    // History page size used by the service
+    NSMutableArray<NSDictionary *> *dictionaries = [NSMutableArray array];
+    for (NSInteger i = 0; i < 500; ++i) {
+        [dictionaries addObject:@{ @"item_id" : [NSString stringWithFormat:@"urn:rts:video:%@", @(i)],
+                                   @"date" : @(1550134222000 + i),
+                                   @"device_id" : @"other_device" }];
+    }
+    
+    NSManagedObjectContext *viewContext = persistentContainer.viewContext;
+    [self measureBlock:^{
+        [viewContext performBlockAndWait:^{
+            [SRGHistoryEntry synchronizeWithDictionaries:dictionaries matchingPredicate:nil inManagedObjectContext:viewContext];
+            [viewContext rollback];
+        }];
+    }];
+}
+
+- (void)testReconciliation
+{
+    NSPersistentContainer *persistentContainer = [self persistentContainerFromPackage:@"UserData_DB_loggedIn"];
+    
+    NSManagedObjectContext *viewContext = persistentContainer.viewContext;
+    [viewContext performBlockAndWait:^{
+        SRGHistoryEntry *dirtyHistoryEntry = [SRGHistoryEntry objectWithUid:@"urn:rts:audio:10110418" matchingPredicate:nil inManagedObjectContext:viewContext];
+        SRGHistoryEntry *updatedHistoryEntry = [SRGHistoryEntry objectWithUid:@"urn:rts:video:9992865" matchingPredicate:nil inManagedObjectContext:viewContext];
+        SRGHistoryEntry *removedHistoryEntry = [SRGHistoryEntry upsertWithUid:@"removed" matchingPredicate:nil inManagedObjectContext:viewContext];
+        removedHistoryEntry.dirty = NO;
+        
+        NSArray<NSDictionary *> *dictionaries = @[ @{ @"item_id" : @"inserted",
+                                                      @"date" : @1550134222000 },
+                                                   @{ @"item_id" : @"urn:rts:video:9992865",
+                                                      @"date" : @1550134222000 },
+                                                   @{ @"item_id" : @"urn:rts:audio:10110418",
+                                                      @"date" : @1550134222000 },
+                                                   @{ @"item_id" : @"unknown_tombstone",
+                                                      @"date" : @1550134222000,
+                                                      @"deleted" : @YES } ];
+        SRGUserObjectReconciliation *reconciliation = [SRGHistoryEntry reconciliationForObjects:@[ dirtyHistoryEntry, updatedHistoryEntry, removedHistoryEntry ]
+                                                                         withRemoteDictionaries:dictionaries];
+        XCTAssertEqualObjects(reconciliation.insertedUids, [NSSet setWithObject:@"inserted"]);
+        XCTAssertEqualObjects(reconciliation.updatedUids, [NSSet setWithObject:@"urn:rts:video:9992865"]);
+        XCTAssertEqualObjects(reconciliation.deletedUids, [NSSet setWithObject:@"removed"]);
+        XCTAssertEqualObjects(reconciliation.keptDirtyUids, [NSSet setWithObject:@"urn:rts:audio:10110418"]);
+        XCTAssertEqual(reconciliation.changedUids.count, 4);
+        
+        NSArray<NSString *> *uids = [reconciliation.dictionaries valueForKey:@"item_id"];
+        NSArray<NSString *> *expectedUids = @[ @"urn:rts:audio:10110418", @"urn:rts:video:9992865", @"removed", @"inserted" ];
+        XCTAssertEqualObjects(uids, expectedUids);
+        XCTAssertTrue([reconciliation.dictionaries[2][@"deleted"] boolValue]);
+        
+        [viewContext rollback];
+    }];
+}
+
+- (void)measureReconciliationWithCount:(NSUInteger)count
+{
+    NSPersistentContainer *persistentContainer = [self persistentContainerFromPackage:@"UserData_DB_loggedIn"];
+    
+    NSManagedObjectContext *viewContext = persistentContainer.viewContext;
+    [viewContext performBlockAndWait:^{
+        // Half of the local objects are kept remotely, and the same number of new objects is added
+        NSMutableArray<SRGHistoryEntry *> *historyEntries = [NSMutableArray arrayWithCapacity:count];
+        NSMutableArray<NSDictionary *> *dictionaries = [NSMutableArray arrayWithCapacity:count];
+        for (NSUInteger i = 0; i < count; ++i) {
+            NSString *uid = [NSString stringWithFormat:@"urn:rts:video:%@", @(i)];
+            SRGHistoryEntry *historyEntry = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass(SRGHistoryEntry.class) inManagedObjectContext:viewContext];
+            [historyEntry setValue:uid forKey:@keypath(SRGHistoryEntry.new, uid)];
+            [historyEntries addObject:historyEntry];
+            
+            NSString *remoteUid = [NSString stringWithFormat:@"urn:rts:video:%@", @(i + count / 2)];
+            [dictionaries addObject:@{ @"item_id" : remoteUid,
+                                       @"date" : @(1550134222000 + i) }];
+        }
+        
+        [self measureBlock:^{
+            SRGUserObjectReconciliation *reconciliation = [SRGHistoryEntry reconciliationForObjects:historyEntries withRemoteDictionaries:dictionaries];
+            XCTAssertEqual(reconciliation.dictionaries.count, count + count / 2);
+        }];
+        
+        [viewContext rollback];
+    }];
+}
+
+- (void)testReconciliationPerformance
+{
+    [self measureReconciliationWithCount:10000];
+}
+
+- (void)testLargeReconciliationPerformance
+{
+    [self measureReconciliationWithCount:100000];
+}
+
 #warning "This flaky test has been disabled. See issue #7"
 - (void)testSynchronizeMoreRecentDirtyLocalEntry
 {